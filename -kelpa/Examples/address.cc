@@ -0,0 +1,119 @@
+/**
+ * Benchmark for the address text routines:
+ * 		parses and formats a million random IPv4 and IPv6 addresses with
+ * 		from_chars/to_chars and with libc's inet_pton/inet_ntop. Addresses
+ * 		are parsed in place from one access-log style buffer, the way a log
+ * 		or ACL pipeline sees them. Build with -march=native (or -mssse3) to
+ * 		let the dotted-quad parser use SSSE3
+ **/
+
+#include "../Src/Internet/internet.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace conet::net::ip;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Count 	{ 1 << 20 };
+/* keeps the measured calls from being optimized away */
+static volatile std::uint64_t 	Sink;
+
+struct line {
+	std::size_t offset;
+	std::size_t length;
+};
+
+/* nanoseconds per call of f over every line */
+template <typename F>
+static double measure(std::vector<line> const& lines, F&& f) {
+	std::uint64_t checksum {};
+	auto const begin { Clock::now() };
+	for(line const& entry: lines)
+		checksum += f(entry);
+	double const elapsed { std::chrono::duration<double, std::nano>(Clock::now() - begin).count() };
+	Sink = checksum;
+	return elapsed / lines.size();
+}
+
+int main() {
+	std::mt19937_64 random { 42 };
+	std::string log;
+	std::vector<line> v4, v6;
+	std::vector<address_v4> v4s;
+	std::vector<address_v6> v6s;
+	char text[64];
+	for(std::size_t index {}; index < Count; index ++) {
+		address_v4 const four { static_cast<address_v4::uint_type>(random()) };
+		v4.push_back({log.size(), static_cast<std::size_t>(to_chars(text, text + sizeof text, four).ptr - text)});
+		log.append(text, v4.back().length).append(" - - \"GET / HTTP/1.1\" 200\n");
+		v4s.push_back(four);
+
+		address_v6::bytes_type bytes;
+		for(unsigned char& byte: bytes)
+			byte = static_cast<unsigned char>(random());
+		/* some runs of zeros, as real addresses have */
+		for(std::size_t word { random() % 8 }, end { word + random() % 4 }; word < std::min<std::size_t>(end, 8); word ++)
+			bytes[2 * word] = bytes[2 * word + 1] = 0;
+		address_v6 const six { bytes };
+		v6.push_back({log.size(), static_cast<std::size_t>(to_chars(text, text + sizeof text, six).ptr - text)});
+		log.append(text, v6.back().length).append(" - - \"GET / HTTP/1.1\" 200\n");
+		v6s.push_back(six);
+	}
+	/* libc wants a terminated copy */
+	auto terminated = [&](line const& entry) {
+		std::memcpy(text, log.data() + entry.offset, entry.length);
+		text[entry.length] = '\0';
+		return text;
+	};
+
+	double const parse4 { measure(v4, [&](line const& entry) {
+		address_v4 address;
+		(void) from_chars(log.data() + entry.offset, log.data() + log.size(), address);
+		return address.to_uint();
+	}) };
+	double const libc_parse4 { measure(v4, [&](line const& entry) {
+		in_addr address;
+		(void) ::inet_pton(AF_INET, terminated(entry), &address);
+		return address.s_addr;
+	}) };
+	double const parse6 { measure(v6, [&](line const& entry) {
+		address_v6 address;
+		(void) from_chars(log.data() + entry.offset, log.data() + log.size(), address);
+		return address.to_bytes()[15] + 1u;
+	}) };
+	double const libc_parse6 { measure(v6, [&](line const& entry) {
+		in6_addr address;
+		(void) ::inet_pton(AF_INET6, terminated(entry), &address);
+		return address.s6_addr[15] + 1u;
+	}) };
+
+	std::size_t cursor {};
+	double const format4 { measure(v4, [&](line const&) {
+		return static_cast<std::size_t>(to_chars(text, text + sizeof text, v4s[cursor ++ % Count]).ptr - text);
+	}) };
+	double const libc_format4 { measure(v4, [&](line const&) {
+		in_addr address { htonl(v4s[cursor ++ % Count].to_uint()) };
+		return std::strlen(::inet_ntop(AF_INET, &address, text, sizeof text));
+	}) };
+	double const format6 { measure(v6, [&](line const&) {
+		return static_cast<std::size_t>(to_chars(text, text + sizeof text, v6s[cursor ++ % Count]).ptr - text);
+	}) };
+	double const libc_format6 { measure(v6, [&](line const&) {
+		auto const bytes { v6s[cursor ++ % Count].to_bytes() };
+		return std::strlen(::inet_ntop(AF_INET6, bytes.data(), text, sizeof text));
+	}) };
+	double const string4 { measure(v4, [&](line const&) { return v4s[cursor ++ % Count].to_string().size(); }) };
+
+	std::printf("%-14s %10s %10s\n", "ns/address", "kelpa", "libc");
+	std::printf("%-14s %10.1f %10.1f\n", "parse v4", parse4, libc_parse4);
+	std::printf("%-14s %10.1f %10.1f\n", "parse v6", parse6, libc_parse6);
+	std::printf("%-14s %10.1f %10.1f\n", "format v4", format4, libc_format4);
+	std::printf("%-14s %10.1f %10.1f\n", "format v6", format6, libc_format6);
+	std::printf("%-14s %10.1f\n", "to_string v4", string4);
+	return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Sample program for admission control:
+ * 		overloads a four-worker executor whose tasks stand for 1ms backend calls
+ * 		at 1.5x its capacity, then lets it recover, once with no admission
+ * 		control, once under an AIMD and once under a gradient concurrency limit.
+ * 		Prints how many requests were refused, how many finished within their
+ * 		deadline and the latency of the ones that ran. Then holds a flooding
+ * 		client to its share with per-address token buckets, and shows a leaky
+ * 		bucket turning a burst into bounded delays
+ **/
+
+#include "../Src/Thread/Executor.hpp"
+#include "../Src/Thread/Admission.hpp"
+#include "../Src/Internet/internet.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Thread;
+using Clock = std::chrono::steady_clock;
+
+static constexpr signed int 				Workers 	{ 4 };
+static constexpr std::chrono::microseconds 	Service 	{ 1000 };
+static constexpr std::chrono::milliseconds 	Deadline 	{ 100 };
+
+struct Phase { 	double rate; 	std::chrono::milliseconds length; 	};
+static constexpr Phase 						Load[] 		{ { 6000, std::chrono::milliseconds(2000) }, { 2000, std::chrono::milliseconds(1000) } };
+
+/* offers Load open-loop, the way clients do not wait for the server to catch up */
+template <typename Limiter>
+static void Overload(char const* name, Limiter* limiter) {
+	std::vector<double> 	latency;
+	std::mutex 				mutex;
+	std::size_t 			offered {}, refused {}, late {};
+
+	auto executor = std::make_unique<Executor>();
+	FormulateHandle const formulate = (* executor).Spawn()
+		.SetAssignmentThrottle(1 << 20)
+		.SetDynamicUpdateRange(Workers, Workers)
+		.SetInitialThread(Workers)
+		.SetRejectionPolicy(RejectionPolicy::DISCARD);
+	if(limiter)
+		(void) formulate.SetAdmission(* limiter);
+	SubmitHandle handle = formulate.Continue().Activate();
+
+	std::vector<std::future<void>> 	futures;
+	auto 							tick 	{ Clock::now() };
+	for(Phase const& phase: Load) {
+		auto const 	end 	{ tick + phase.length };
+		double 		owed 	{};
+		for(; tick < end; tick += std::chrono::milliseconds(1)) {
+			std::this_thread::sleep_until(tick);
+			for(owed += phase.rate / 1000; owed >= 1; owed --, offered ++) {
+				auto const submitted { Clock::now() };
+				auto future { handle.Submit(Priority::STANDARD, [&, submitted] {
+					std::this_thread::sleep_for(Service);
+					double const milli { std::chrono::duration<double, std::milli>(Clock::now() - submitted).count() };
+					std::lock_guard guard { mutex };
+					latency.push_back(milli);
+					late += milli > Deadline.count();
+				}) };
+				if(future.valid())
+					futures.push_back(std::move(future));
+				else
+					refused ++;
+			}
+		}
+	}
+	for(auto& future: futures)
+		future.wait();
+
+	std::ranges::sort(latency);
+	auto const percentile { [&] (std::size_t p) { return latency.empty() ? 0.0 : latency[std::min(latency.size() * p / 100, latency.size() - 1)]; } };
+	std::printf("%-10s %8zu %8zu %8zu %8zu %10.1f %10.1f %10.1f\n", name, offered, refused, latency.size() - late, late,
+		percentile(50), percentile(99), latency.empty() ? 0.0 : latency.back());
+}
+
+/* one client floods at 5000/s, a hundred others ask 40 times a second; simulated time, no sleeping */
+static void Fairness() {
+	using conet::net::ip::address_v4;
+	KeyedLimiter<address_v4, TokenBucket> limiter { TokenBucket { 50, 20 } };
+
+	std::size_t flooded {}, flooding {}, polite {}, asked {};
+	auto const start { Clock::now() };
+	for(std::size_t millisecond {}; millisecond < 2000; millisecond ++) {
+		auto const now { start + std::chrono::milliseconds(millisecond) };
+		for(std::size_t request {}; request < 5; request ++, flooding ++)
+			flooded += limiter.TryAcquire(address_v4 { 0xc6336401 }, 1, now);
+		if(millisecond % 25 == 0)
+			for(std::uint32_t client {}; client < 100; client ++, asked ++)
+				polite += limiter.TryAcquire(address_v4 { 0x0a000000 + client }, 1, now);
+	}
+	std::printf("\nper-address token buckets, 50/s with bursts of 20, over 2s:\n");
+	std::printf("  flooding client: %zu of %zu admitted\n", flooded, flooding);
+	std::printf("  100 polite ones: %zu of %zu admitted, %zu limiters tracked\n", polite, asked, limiter.Size());
+}
+
+/* 50 requests at once into a bucket draining 100/s that holds 20 */
+static void Shaping() {
+	LeakyBucket bucket { 100, 20 };
+	auto const now { Clock::now() };
+	std::size_t admitted {}, refused {};
+	std::chrono::nanoseconds longest {};
+	for(std::size_t request {}; request < 50; request ++)
+		if(auto const wait { bucket.Reserve(1, now) })
+			admitted ++, longest = std::max(longest, * wait);
+		else
+			refused ++;
+	std::printf("\nleaky bucket, 100/s holding 20, 50 at once: %zu delayed by up to %.0fms, %zu refused\n",
+		admitted, std::chrono::duration<double, std::milli>(longest).count(), refused);
+}
+
+int main() {
+	std::printf("%d workers x %lldus tasks, offered 6000/s for 2s then 2000/s for 1s, deadline %lldms\n", Workers,
+		static_cast<long long>(Service.count()), static_cast<long long>(Deadline.count()));
+	std::printf("%-10s %8s %8s %8s %8s %10s %10s %10s\n", "admission", "offered", "refused", "on time", "late", "p50(ms)", "p99(ms)", "max(ms)");
+
+	Overload<ConcurrencyLimiter<>>("none", nullptr);
+
+	AIMDLimit additive;
+	additive.minimum = Workers;
+	additive.timeout = std::chrono::milliseconds(20);
+	ConcurrencyLimiter<AIMDLimit> aimd { 16, additive };
+	Overload("AIMD", std::addressof(aimd));
+
+	GradientLimit gradual;
+	gradual.minimum = Workers;
+	ConcurrencyLimiter<GradientLimit> gradient { 16, gradual };
+	Overload("gradient", std::addressof(gradient));
+
+	Fairness();
+	Shaping();
+	return 0;
+}
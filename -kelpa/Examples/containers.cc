@@ -0,0 +1,156 @@
+/**
+ * Sample program for the concurrent containers in Thread/Sync:
+ * 		each container is hammered by writers while readers walk it, then the
+ * 		survivors are counted against what the writers did (build with
+ * 		-fsanitize=thread or -fsanitize=address to catch a reader touching an
+ * 		element that is not constructed yet or already freed)
+ * 			Vector 		pushers with a constructor that throws now and then,
+ * 						readers using size(), at() and for_each
+ * 			List 		pushers, poppers and removers, readers searching it
+ * 			MultiMap 	inserters and erasers on a few hot keys, readers
+ * 						checking key order and per-key insertion order
+ **/
+
+#include "../Src/Thread/Sync/Vector.hpp"
+#include "../Src/Thread/Sync/List.hpp"
+#include "../Src/Thread/Sync/MultiMap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Thread::Sync;
+
+static constexpr int 	Writers 	{ 4 };
+static constexpr int 	Readers 	{ 2 };
+static constexpr long 	Operations 	{ 50000 };
+
+/* a payload a reader can validate: the text always spells out the number */
+struct Item {
+	explicit Item(long number): number(number), text(std::to_string(number) + std::string(24, '.')) {
+		if(number % 97 == 0)
+			throw std::runtime_error { "unlucky" };
+	}
+	bool Valid() const { 	return text == std::to_string(number) + std::string(24, '.'); 	}
+
+	long 			number;
+	std::string 	text;
+};
+
+template <typename Write, typename Read>
+static void Hammer(Write&& write, Read&& read) {
+	std::atomic<int> 			running { Writers };
+	std::vector<std::thread> 	threads;
+	for(int index {}; index < Writers; index ++)
+		threads.emplace_back([&, index] {
+			write(index);
+			running --;
+		});
+	for(int index {}; index < Readers; index ++)
+		threads.emplace_back([&] {
+			while(running.load())
+				read();
+		});
+	for(auto& thread: threads)
+		thread.join();
+}
+
+static bool HammerVector() {
+	Vector<Item> 		vector;
+	std::atomic<long> 	thrown {}, broken {}, reads {};
+	Hammer(
+		[&] (int writer) {
+			for(long round {}; round < Operations; round ++)
+				try {
+					vector.emplace_back(round * Writers + writer + 1);
+				} catch(std::runtime_error const&) {
+					thrown ++;
+				}
+		},
+		[&] {
+			vector.for_each([&] (Item& item) {
+				broken += ! item.Valid();
+				reads ++;
+			});
+			for(std::size_t index {}, last { vector.size() }; index < last; index ++)
+				try {
+					broken += ! vector.at(index).Valid();
+				} catch(std::out_of_range const&) {}
+		});
+	long ready {};
+	vector.for_each([&] (Item&) { ready ++; });
+	bool const ok { ! broken && vector.size() == Writers * Operations && ready + thrown == Writers * Operations };
+	std::printf("Vector:   %zu slots, %ld built, %ld threw, %ld reads, %ld torn\n", vector.size(), ready, thrown.load(), reads.load(), broken.load());
+	return ok;
+}
+
+static bool HammerList() {
+	List<long> 			list;
+	std::atomic<long> 	popped {}, removed {}, broken {};
+	Hammer(
+		[&] (int writer) {
+			for(long round {}; round < Operations; round ++) {
+				list.push_front(round * Writers + writer + 1);
+				if(writer == 0 && round % 2)
+					popped += list.pop_front() != nullptr;
+				if(writer == 1 && round % 512 == 0)
+					removed += static_cast<long>(list.remove_if([] (long value) { return value % 3 == 0; }));
+			}
+		},
+		[&] {
+			if(auto const found { list.find_first_if([] (long value) { return value % 5 == 0; }) })
+				broken += * found % 5 != 0;
+			list.for_each([&] (long& value) { broken += value <= 0; });
+		});
+	long left {};
+	list.for_each([&] (long&) { left ++; });
+	bool const ok { ! broken && left == static_cast<long>(list.size()) && left + popped + removed == Writers * Operations };
+	std::printf("List:     %ld left, %ld popped, %ld removed, %ld torn\n", left, popped.load(), removed.load(), broken.load());
+	return ok;
+}
+
+static bool HammerMultiMap() {
+	static constexpr int Keys { 16 };
+	MultiMap<int, long> map;
+	std::atomic<long> 	erased {}, broken {};
+	Hammer(
+		[&] (int writer) {
+			for(long round {}; round < Operations; round ++) {
+				/* per key, each writer inserts increasing values, so insertion order is checkable */
+				map.insert(static_cast<int>(round % Keys), round * Writers + writer);
+				if(round % 3 == 0)
+					erased += map.erase(static_cast<int>((round + writer) % Keys));
+			}
+		},
+		[&] {
+			int 	previous { -1 };
+			map.for_each([&] (int const& key, long const&) {
+				broken += key < previous;
+				previous = key;
+			});
+			long last[Writers];
+			std::fill(std::begin(last), std::end(last), -1L);
+			map.for_each(3, [&] (long const& value) {
+				broken += value <= last[value % Writers];
+				last[value % Writers] = value;
+			});
+			(void) map.find(5);
+		});
+	long left {};
+	map.for_each([&] (int const&, long const&) { left ++; });
+	bool const ok { ! broken && left == static_cast<long>(map.size()) && left + erased == Writers * Operations };
+	std::printf("MultiMap: %ld left, %ld erased, %ld out of order\n", left, erased.load(), broken.load());
+	return ok;
+}
+
+int main() {
+	bool const vector 	{ HammerVector() };
+	bool const list 	{ HammerList() };
+	bool const map 		{ HammerMultiMap() };
+	std::printf("%s\n", vector && list && map ? "ok" : "FAILED");
+	return vector && list && map ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * Sample program for the coroutine sockets:
+ * 		a TCP echo server on port 8888 and a UDP echo server on port 8889, one
+ * 		coroutine per connection on a single reactor thread.
+ * 		Try it with `nc localhost 8888` and `nc -u localhost 8889`
+ **/
+
+#include "../Src/Internet/socket.hpp"
+#include "../Src/Coroutine/Detached.hpp"
+#include <cstdio>
+
+using namespace conet::net;
+using namespace conet::net::ip;
+using Kelpa::Coroutine::Detached;
+
+static Detached session(tcp::socket peer) {
+	char data[4096];
+	for(;;) {
+		std::error_code ec;
+		std::size_t const length = co_await peer.async_read_some(buffer(data), ec);
+		if(ec || length == 0)
+			co_return;
+		co_await peer.async_write(buffer(data, length), ec);
+		if(ec)
+			co_return;
+	}
+}
+
+static Detached listen(tcp::acceptor& acceptor) {
+	for(;;) {
+		std::error_code ec;
+		tcp::socket peer = co_await acceptor.async_accept(ec);
+		if(not ec)
+			session(std::move(peer));
+	}
+}
+
+static Detached datagrams(upd::socket& socket) {
+	char data[65536];
+	upd::endpoint sender;
+	for(;;) {
+		std::size_t const length = co_await socket.async_receive_from(buffer(data), sender);
+		co_await socket.async_send_to(buffer(data, length), sender);
+	}
+}
+
+int main() {
+	reactor_type reactor;
+	tcp::acceptor acceptor { reactor, tcp::endpoint { tcp::v4(), 8888 } };
+	upd::socket socket { reactor, upd::endpoint { upd::v4(), 8889 } };
+	listen(acceptor);
+	datagrams(socket);
+	std::puts("echoing on tcp 8888 and udp 8889");
+	reactor.Run();
+	return 0;
+}
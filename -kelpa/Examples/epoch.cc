@@ -0,0 +1,143 @@
+/**
+ * Sample program for epoch-based reclamation:
+ * 		1. stress: a Treiber stack hammered by pushers and poppers, every popped
+ * 		   node is retired instead of deleted (build with -fsanitize=thread or
+ * 		   -fsanitize=address to catch a premature free)
+ * 		2. benchmark: read-mostly pointer published through Epoch versus
+ * 		   std::atomic<std::shared_ptr>
+ **/
+
+#include "../Src/Thread/Epoch.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+using namespace Kelpa::Thread;
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<long> 	alive 	{};
+
+struct Node {
+	Node(long value) noexcept: value(value) 	{ 	alive ++; 	}
+   ~Node() noexcept 							{ 	alive --; value = -1; 	}
+	long 			value;
+	Node * 			next 	{ nullptr };
+};
+
+struct Stack {
+	void Push(long value) {
+		Node* node { new Node(value) };
+		(* node).next = head.load(std::memory_order_relaxed);
+		while(! head.compare_exchange_weak((* node).next, node, std::memory_order_release, std::memory_order_relaxed));
+	}
+	bool Pop(long& value) {
+		Epoch::Guard guard;
+		Node* node { head.load(std::memory_order_acquire) };
+		while(node && ! head.compare_exchange_weak(node, (* node).next, std::memory_order_acquire, std::memory_order_acquire));
+		if(! node)
+			return false;
+		value = (* node).value;
+		Epoch::Retire(node);
+		return true;
+	}
+	std::atomic<Node *> head { nullptr };
+};
+
+static void Stress() {
+	constexpr int 		Threads 	{ 4 };
+	constexpr long 		Operations 	{ 200000 };
+	Stack 				stack;
+	std::atomic<long> 	sum 		{};
+	std::vector<std::thread> threads;
+	for(int index {}; index < Threads; index ++)
+		threads.emplace_back([&, index] {
+			long local {}, value {};
+			for(long round {}; round < Operations; round ++) {
+				stack.Push(index * Operations + round + 1);
+				if(stack.Pop(value)) {
+					assert(value > 0);
+					local += value;
+				}
+			}
+			sum += local;
+		});
+	for(auto& thread: threads)
+		thread.join();
+	long value {};
+	while(stack.Pop(value))
+		sum += value;
+	for(int round {}; round < 16 && alive.load(); round ++)
+		Epoch::Quiescent();
+	long const expected { Threads * Operations * (Threads * Operations + 1) / 2 };
+	std::printf("stress: sum %s, %ld nodes still pending\n", sum == expected ? "ok" : "MISMATCH", alive.load());
+}
+
+struct Config {
+	long 	version;
+	char 	payload[56];
+};
+
+template <typename Read, typename Write>
+static double Measure(Read&& read, Write&& write) {
+	constexpr int 		Readers 	{ 4 };
+	std::atomic<bool> 	running 	{ true };
+	std::atomic<long> 	reads 		{};
+	std::vector<std::thread> threads;
+	for(int index {}; index < Readers; index ++)
+		threads.emplace_back([&] {
+			long local {}, checksum {};
+			while(running.load(std::memory_order_relaxed)) {
+				checksum += read();
+				local ++;
+			}
+			reads += local + (checksum < 0);
+		});
+	threads.emplace_back([&] {
+		for(long version { 1 }; running.load(std::memory_order_relaxed); version ++) {
+			write(version);
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	});
+	auto const begin { Clock::now() };
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	running = false;
+	for(auto& thread: threads)
+		thread.join();
+	return reads.load() / std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static void Benchmark() {
+	std::atomic<Config *> 					raw 	{ new Config { 0, {} } };
+	double const epoch { Measure(
+		[&] {
+			Epoch::Guard guard;
+			return (* raw.load(std::memory_order_acquire)).version;
+		},
+		[&] (long version) {
+			Epoch::Retire(raw.exchange(new Config { version, {} }, std::memory_order_acq_rel));
+		}) };
+	Epoch::Retire(raw.load());
+
+	std::atomic<std::shared_ptr<Config>> 	shared 	{ std::make_shared<Config>(Config { 0, {} }) };
+	double const atomic { Measure(
+		[&] {
+			return (* shared.load(std::memory_order_acquire)).version;
+		},
+		[&] (long version) {
+			shared.store(std::make_shared<Config>(Config { version, {} }), std::memory_order_release);
+		}) };
+
+	std::printf("%-28s %14s\n", "reader path", "reads/s");
+	std::printf("%-28s %14.0f\n", "Epoch::Guard + raw pointer", epoch);
+	std::printf("%-28s %14.0f\n", "atomic<shared_ptr>", atomic);
+}
+
+int main() {
+	Stress();
+	Benchmark();
+	return 0;
+}
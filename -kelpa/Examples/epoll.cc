@@ -0,0 +1,98 @@
+/**
+ * Sample program for the epoll reactor:
+ * 		N idle connections (socketpairs) are registered, 16 of them become readable
+ * 		per round; the cost of one wakeup is measured with EpollReactor and with a
+ * 		poll(2) loop scanning every descriptor, as the select-based reactor does.
+ * 		The descriptor limit is raised to the hard limit, run with `ulimit -Hn 300000`
+ * 		as root to reach 100k+ connections
+ **/
+
+#include "../Src/IOSchedule/Epoll.hpp"
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Kelpa::IOSchedule;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Ready 	{ 16 };
+static constexpr std::size_t 	Rounds 	{ 2000 };
+
+struct Pairs {
+	explicit Pairs(std::size_t count) {
+		for(std::size_t index {}; index < count; index ++) {
+			int pair[2];
+			if(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) == -1)
+				break;
+			readers.push_back(pair[0]);
+			writers.push_back(pair[1]);
+		}
+	}
+   ~Pairs() {
+		for(std::size_t index {}; index < readers.size(); index ++)
+			::close(readers[index]), ::close(writers[index]);
+	}
+	std::vector<int> readers, writers;
+};
+
+static void Drain(int fd) {
+	char buffer[64];
+	while(::read(fd, buffer, sizeof buffer) > 0);
+}
+
+template <typename Wait> static double PerWakeup(Pairs& pairs, Wait&& wait) {
+	std::mt19937 random { 42 };
+	double total {};
+	for(std::size_t round {}; round < Rounds; round ++) {
+		for(std::size_t index {}; index < Ready; index ++)
+			(void) ::write(pairs.writers[random() % pairs.writers.size()], "x", 1);
+		auto const begin { Clock::now() };
+		wait();
+		total += std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+	}
+	return total / Rounds;
+}
+
+static double Epoll(Pairs& pairs) {
+	EpollReactor reactor;
+	std::size_t handled {};
+	for(int fd: pairs.readers)
+		reactor.Listen(Event::READ, fd, [fd, &handled] { Drain(fd); handled ++; });
+	return PerWakeup(pairs, [&] { (void) reactor.RunOnce(); });
+}
+
+static double Poll(Pairs& pairs) {
+	std::vector<pollfd> fds;
+	for(int fd: pairs.readers)
+		fds.push_back(pollfd { .fd = fd, .events = POLLIN, .revents = 0 });
+	return PerWakeup(pairs, [&] {
+		(void) ::poll(fds.data(), fds.size(), -1);
+		for(auto& entry: fds)
+			if(entry.revents & POLLIN)
+				Drain(entry.fd);
+	});
+}
+
+int main() {
+	rlimit limit {};
+	(void) ::getrlimit(RLIMIT_NOFILE, &limit);
+	limit.rlim_cur = limit.rlim_max;
+	(void) ::setrlimit(RLIMIT_NOFILE, &limit);
+	std::size_t const most { static_cast<std::size_t>(limit.rlim_cur - 64) / 2 };
+
+	std::printf("%12s %20s %20s\n", "connections", "epoll us/wakeup", "poll us/wakeup");
+	for(std::size_t count: { std::size_t(100), std::size_t(1000), std::size_t(10000), std::size_t(100000) }) {
+		if(count > most)
+			count = most;
+		Pairs pairs { count };
+		std::printf("%12zu %20.2f %20.2f\n", pairs.readers.size(), Epoll(pairs), Poll(pairs));
+		if(count == most)
+			break;
+	}
+	return 0;
+}
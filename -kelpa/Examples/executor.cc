@@ -0,0 +1,61 @@
+/**
+ * Sample program for thread pool module:
+ * 		reports per-priority queueing latency under a mixed load
+ * 		that is dominated by URGENT and HARSH assignments
+ **/
+
+#include "../Src/Thread/Executor.hpp"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <algorithm>
+int main() {
+	using namespace Kelpa::Thread;
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::size_t 	Tasks 	{ 200000 };
+	constexpr Priority 		Mix[] 	{
+		Priority::HARSH, 	Priority::HARSH, 	Priority::URGENT, 	Priority::HARSH,
+		Priority::URGENT, 	Priority::STANDARD, Priority::HARSH, 	Priority::UNHURRIED
+	};
+
+	std::array<std::vector<double>, 5> 	latency;
+	std::mutex 							mutex;
+
+	auto executor = std::make_unique<Executor>();
+	SubmitHandle handle = (* executor).Spawn()
+		.SetAssignmentThrottle(static_cast<signed int>(Tasks))
+		.SetDynamicUpdateRange(4, 4)
+		.SetInitialThread(4)
+		.Continue()
+		.Activate();
+
+	std::vector<std::future<void>> 		futures;
+	futures.reserve(Tasks);
+	for(std::size_t index {}; index < Tasks; index ++) {
+		Priority 	priority 	{ Mix[index % std::size(Mix)] };
+		auto 		submitted 	{ Clock::now() };
+		futures.emplace_back(handle.Submit(priority, [&, priority, submitted] {
+			double micro = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+			for(auto spin = Clock::now(); Clock::now() - spin < std::chrono::microseconds(5); );
+			std::lock_guard guard { mutex };
+			latency[static_cast<std::size_t>(priority)].push_back(micro);
+		}));
+	}
+	for(auto& future: futures)
+		future.wait();
+
+	constexpr char const* Names[] { "DISCARD", "UNHURRIED", "STANDARD", "URGENT", "HARSH" };
+	std::printf("%-10s %10s %12s %12s %12s\n", "priority", "tasks", "p50(us)", "p99(us)", "max(us)");
+	for(std::size_t level { 1 }; level < latency.size(); level ++) {
+		auto& samples = latency[level];
+		if(samples.empty())
+			continue;
+		std::ranges::sort(samples);
+		std::printf("%-10s %10zu %12.1f %12.1f %12.1f\n", Names[level], samples.size(),
+			samples[samples.size() / 2], samples[samples.size() * 99 / 100], samples.back());
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * Sample program for pooled coroutine frames:
+ * 		spawn/complete rate of short coroutines whose frames come from the
+ * 		slab (the default), from global operator new (std::allocator passed
+ * 		through the arguments) and from a per-batch MonotonicArena
+ * 			single 		one coroutine created, run to completion and destroyed
+ * 			chain 		a parent awaiting four nested children, five frames a time
+ * 			runtime 	a million spawned onto a four-worker Runtime, frames freed
+ * 						on whichever worker finishes them
+ **/
+
+#include "../Src/Coroutine/Runtime.hpp"
+#include "../Src/Utility/Arena.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+using namespace Kelpa::Coroutine;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t Rounds { 2000000 };
+
+/* the same coroutine three times over: the frame source is picked by the leading std::allocator_arg */
+template <typename Allocator>
+static MainFuture<std::size_t> Leaf(std::allocator_arg_t, Allocator, std::size_t depth, std::size_t value) {
+	std::size_t scratch[8] {};
+	for(std::size_t index {}; index < 8; index ++)
+		scratch[index] = value + index;
+	if(depth) {
+		MainFuture<std::size_t> child { Leaf(std::allocator_arg, Allocator {}, depth - 1, value) };
+		value = co_await child;
+	}
+	co_return value + scratch[depth % 8];
+}
+
+static MainFuture<std::size_t> Leaf(std::size_t depth, std::size_t value) {
+	std::size_t scratch[8] {};
+	for(std::size_t index {}; index < 8; index ++)
+		scratch[index] = value + index;
+	if(depth) {
+		MainFuture<std::size_t> child { Leaf(depth - 1, value) };
+		value = co_await child;
+	}
+	co_return value + scratch[depth % 8];
+}
+
+static MainFuture<std::size_t> Leaf(std::allocator_arg_t, std::pmr::polymorphic_allocator<> arena, std::size_t depth, std::size_t value) {
+	std::size_t scratch[8] {};
+	for(std::size_t index {}; index < 8; index ++)
+		scratch[index] = value + index;
+	if(depth) {
+		MainFuture<std::size_t> child { Leaf(std::allocator_arg, arena, depth - 1, value) };
+		value = co_await child;
+	}
+	co_return value + scratch[depth % 8];
+}
+
+/* keeps the results alive; written from every Runtime worker, so relaxed atomic stores */
+static std::atomic<std::size_t> Sink;
+
+/* runs one coroutine to completion, its frame is released with the MainFuture */
+template <typename F>
+static std::size_t Drive(F&& make) {
+	MainFuture<std::size_t> future { make() };
+	future.Resume();
+	return future.TryFetch();
+}
+
+template <typename F>
+static void Measure(char const* name, std::size_t depth, F&& make) {
+	auto const start { Clock::now() };
+	for(std::size_t round {}; round < Rounds; round ++)
+		Sink.store(Drive([&] { return make(depth, round); }), std::memory_order_relaxed);
+	double const seconds { std::chrono::duration<double>(Clock::now() - start).count() };
+	std::printf("  %-10s %8.2fM frames/s %8.1fns each\n", name, static_cast<double>(Rounds * (depth + 1)) / seconds / 1e6,
+		seconds * 1e9 / static_cast<double>(Rounds * (depth + 1)));
+}
+
+static void Compare(char const* title, std::size_t depth) {
+	std::printf("%s:\n", title);
+	Measure("slab", depth, [] (std::size_t depth, std::size_t value) { return Leaf(depth, value); });
+	Measure("new", depth, [] (std::size_t depth, std::size_t value) {
+		return Leaf(std::allocator_arg, std::allocator<std::byte> {}, depth, value);
+	});
+	Kelpa::Utility::MonotonicArena arena;
+	Measure("arena", depth, [&] (std::size_t depth, std::size_t value) {
+		/* frames are freed before the next one starts, so every round can rewind the arena */
+		arena.Reset();
+		return Leaf(std::allocator_arg, std::pmr::polymorphic_allocator<> { &arena }, depth, value);
+	});
+}
+
+template <typename F>
+static void Spawning(char const* name, F&& make) {
+	Runtime runtime { 4 };
+	auto const start { Clock::now() };
+	for(std::size_t round {}; round < Rounds / 2; round ++)
+		runtime.Spawn([&, round] () -> MainFuture<void> {
+			MainFuture<std::size_t> leaf { make(round) };
+			Sink.store(co_await leaf, std::memory_order_relaxed);
+		});
+	runtime.Join();
+	double const seconds { std::chrono::duration<double>(Clock::now() - start).count() };
+	std::printf("  %-10s %8.2fM spawns/s\n", name, static_cast<double>(Rounds / 2) / seconds / 1e6);
+}
+
+int main() {
+	Compare("single", 0);
+	Compare("chain", 4);
+	std::printf("runtime:\n");
+	Spawning("slab", [] (std::size_t value) { return Leaf(0, value); });
+	Spawning("new", [] (std::size_t value) { return Leaf(std::allocator_arg, std::allocator<std::byte> {}, 0, value); });
+	return 0;
+}
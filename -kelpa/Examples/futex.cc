@@ -0,0 +1,136 @@
+/**
+ * Sample program for the futex-backed primitives:
+ * 		1. checks: CountingSemaphore never admits more holders than permits,
+ * 		   Barrier runs its completion once per phase, and consumers parked on
+ * 		   an EventCount never miss an item
+ * 		2. benchmark: two threads ping-ponging through a pair of semaphores,
+ * 		   CountingSemaphore against the mutex and condition variable Semaphore
+ **/
+
+#include "../Src/Thread/Futex.hpp"
+#include "../Src/Thread/Semaphore.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Thread;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int 	Threads 	{ 8 };
+
+static bool Permits() {
+	constexpr std::ptrdiff_t 	Limit 	{ 3 };
+	CountingSemaphore 			semaphore { Limit };
+	std::atomic<std::ptrdiff_t> holders {}, most {};
+	std::vector<std::thread> 	threads;
+	for(int index {}; index < Threads; index ++)
+		threads.emplace_back([&] {
+			for(int round {}; round < 20000; round ++) {
+				semaphore.Acquire();
+				std::ptrdiff_t const now { ++ holders };
+				for(std::ptrdiff_t seen { most.load() }; now > seen && ! most.compare_exchange_weak(seen, now); );
+				std::this_thread::yield();
+				holders --;
+				semaphore.Release();
+			}
+		});
+	for(auto& thread: threads)
+		thread.join();
+	std::printf("semaphore: at most %td of %td permits held, %td left\n", most.load(), Limit, semaphore.GetValue());
+	return most.load() <= Limit && semaphore.GetValue() == Limit;
+}
+
+static bool Phases() {
+	constexpr int 		Rounds 	{ 5000 };
+	std::atomic<int> 	phases 	{};
+	auto completion = [&] () noexcept { phases ++; };
+	Barrier<decltype(completion)> barrier { Threads, completion };
+	std::vector<std::thread> threads;
+	for(int index {}; index < Threads; index ++)
+		threads.emplace_back([&] {
+			for(int round {}; round < Rounds; round ++)
+				barrier.ArriveAndWait();
+		});
+	for(auto& thread: threads)
+		thread.join();
+	std::printf("barrier: %d completions for %d phases\n", phases.load(), Rounds);
+	return phases.load() == Rounds;
+}
+
+static bool Events() {
+	constexpr long 		Items 	{ 200000 };
+	EventCount 			events;
+	std::atomic<long> 	queued {}, taken {}, sum {};
+	auto pop = [&] (long& item) {
+		for(long count { queued.load() }; count > 0; )
+			if(queued.compare_exchange_weak(count, count - 1)) {
+				item = taken.fetch_add(1) + 1;
+				return true;
+			}
+		return false;
+	};
+	std::vector<std::thread> consumers;
+	for(int index {}; index < Threads / 2; index ++)
+		consumers.emplace_back([&] {
+			long item {};
+			while(true) {
+				if(pop(item)) {
+					if(item > Items) return;
+					sum += item;
+					continue;
+				}
+				auto const key { events.PrepareWait() };
+				if(pop(item)) {
+					events.CancelWait();
+					if(item > Items) return;
+					sum += item;
+				}
+				else
+					events.Wait(key);
+			}
+		});
+	/* one extra item per consumer tells it to stop */
+	for(long item {}; item < Items + Threads / 2; item ++) {
+		queued ++;
+		events.Notify();
+		if(item % 64 == 0)
+			std::this_thread::yield();
+	}
+	for(auto& consumer: consumers)
+		consumer.join();
+	std::printf("event count: consumed %s\n", sum.load() == Items * (Items + 1) / 2 ? "every item" : "a wrong sum");
+	return sum.load() == Items * (Items + 1) / 2;
+}
+
+template <typename S>
+static double PingPong(char const* name) {
+	constexpr int 	Rounds 	{ 200000 };
+	S 				ping 	{ 0 }, pong { 0 };
+	auto const 		start 	{ Clock::now() };
+	std::thread peer { [&] {
+		for(int round {}; round < Rounds; round ++) {
+			if constexpr(requires { ping.Acquire(); }) 	{ ping.Acquire(); pong.Release(); }
+			else 										{ ping.Wait(); pong.Notify(); }
+		}
+	} };
+	for(int round {}; round < Rounds; round ++) {
+		if constexpr(requires { ping.Acquire(); }) 	{ ping.Release(); pong.Acquire(); }
+		else 										{ ping.Notify(); pong.Wait(); }
+	}
+	peer.join();
+	double const each { std::chrono::duration<double, std::nano>(Clock::now() - start).count() / Rounds };
+	std::printf("  %-22s %8.0fns per round trip\n", name, each);
+	return each;
+}
+
+int main() {
+	bool const permits 	{ Permits() };
+	bool const phases 	{ Phases() };
+	bool const events 	{ Events() };
+	std::printf("ping-pong:\n");
+	PingPong<CountingSemaphore>("CountingSemaphore");
+	PingPong<Semaphore<>>("Semaphore (condvar)");
+	return permits && phases && events ? 0 : 1;
+}
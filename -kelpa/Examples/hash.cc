@@ -0,0 +1,116 @@
+/**
+ * Benchmark for the keyed hashes of addresses and endpoints:
+ * 		builds sets of peers the way a server sees them (clients behind a
+ * 		few NATs, one /16 of sequential addresses, SLAAC hosts of a few /64s,
+ * 		privacy addresses of one /64 with their ports) and hashes each set
+ * 		with the former std::hash combinations and with the current ones.
+ * 		Prints distinct hashes, the longest chain and the mean probes of a
+ * 		power-of-two table, and the time to fill and query an unordered_set
+ **/
+
+#include "../Src/Internet/internet.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace conet::net::ip;
+using Clock = std::chrono::steady_clock;
+
+/* keeps the lookups from being optimized away */
+static volatile std::size_t 	Sink;
+
+/* the hashes internet.hpp had before */
+struct LegacyHash {
+	std::size_t operator()(address_v4 const& address) const noexcept { return address.to_uint(); }
+	std::size_t operator()(address_v6 const& address) const noexcept {
+		std::size_t result {};
+		for(unsigned char byte: address.to_bytes())
+			result |= byte;
+		return result | address.scope_id();
+	}
+	std::size_t operator()(address const& address) const noexcept {
+		return address.is_v4() ? (* this)(address.to_v4()) : (* this)(address.to_v6());
+	}
+	std::size_t operator()(tcp::endpoint const& endpoint) const noexcept { return (* this)(endpoint.address()) | endpoint.port(); }
+};
+
+template <typename Key, typename Hasher>
+static void measure(char const* name, std::vector<Key> const& keys) {
+	std::vector<std::size_t> hashes;
+	for(Key const& key: keys)
+		hashes.push_back(Hasher{}(key));
+	std::vector<std::size_t> sorted { hashes };
+	std::ranges::sort(sorted);
+	std::size_t const distinct { static_cast<std::size_t>(std::ranges::unique(sorted).begin() - sorted.begin()) };
+
+	/* the low bits, as open addressing and power-of-two tables use them */
+	std::size_t const buckets { std::bit_ceil(keys.size()) };
+	std::vector<std::size_t> load(buckets);
+	for(std::size_t hash: hashes)
+		load[hash & (buckets - 1)] ++;
+	std::size_t probes {};
+	for(std::size_t count: load)
+		probes += count * (count + 1) / 2;
+
+	std::printf("  %-8s %9zu distinct %8zu longest %10.2f probes ", name, distinct, std::ranges::max(load), static_cast<double>(probes) / keys.size());
+	/* a few thousand keys per hash value make the set quadratic, minutes rather than milliseconds */
+	if(keys.size() / distinct > 1000) {
+		std::puts("  not timed");
+		return;
+	}
+	auto const begin { Clock::now() };
+	std::unordered_set<Key, Hasher> set;
+	for(Key const& key: keys)
+		set.insert(key);
+	std::size_t found {};
+	for(Key const& key: keys)
+		found += set.count(key);
+	Sink = found;
+	std::printf("%10.1f ms\n", std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+}
+
+template <typename Key>
+static void compare(char const* title, std::vector<Key> const& keys) {
+	std::printf("%s, %zu keys\n", title, keys.size());
+	measure<Key, LegacyHash>("before", keys);
+	measure<Key, std::hash<Key>>("after", keys);
+}
+
+int main() {
+	std::mt19937_64 random { 42 };
+
+	/* 8 NAT gateways, each with 25000 ephemeral ports in use */
+	std::vector<tcp::endpoint> nat;
+	for(std::uint32_t gateway {}; gateway < 8; gateway ++)
+		for(port_type port { 32768 }; port < 32768 + 25000; port ++)
+			nat.emplace_back(address_v4{ 0xc6336400 + gateway * 7 }, port);
+	compare("v4 endpoints behind NATs", nat);
+
+	std::vector<address> subnet;
+	for(std::uint32_t host {}; host < 65536; host ++)
+		subnet.emplace_back(address_v4{ 0x0a140000 | host });
+	compare("v4 addresses of a /16", subnet);
+
+	/* EUI-64 interface identifiers of one vendor, in 16 /64s */
+	std::vector<address> slaac;
+	for(std::size_t host {}; host < 200000; host ++) {
+		std::uint32_t const nic { static_cast<std::uint32_t>(random()) & 0xffffff };
+		slaac.emplace_back(address_v6{ address_v6::bytes_type(0x20, 0x01, 0x0d, 0xb8, 0x00, 0x42, 0x00, host % 16,
+			0x02, 0x1b, 0x21, 0xff, 0xfe, nic >> 16, nic >> 8, nic) });
+	}
+	compare("v6 SLAAC addresses", slaac);
+
+	/* random interface identifiers of one /64, each with a random port */
+	std::vector<tcp::endpoint> privacy;
+	for(std::size_t host {}; host < 200000; host ++) {
+		std::uint64_t const id { random() };
+		privacy.emplace_back(address_v6{ address_v6::bytes_type(0x24, 0x00, 0xcb, 0x00, 0x00, 0x10, 0x00, 0x01,
+			id >> 56, id >> 48, id >> 40, id >> 32, id >> 24, id >> 16, id >> 8, id) }, static_cast<port_type>(random()));
+	}
+	compare("v6 endpoints of a /64", privacy);
+	return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Sample program for the HTTP/1.1 server:
+ * 		a hello-world route served by one reactor per core on a SO_REUSEPORT
+ * 		port, and a load generator on localhost whose connections each keep
+ * 		Depth pipelined requests in flight. Prints requests per second
+ **/
+
+#include "../Src/Internet/http.hpp"
+#include "../Src/Coroutine/Detached.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace conet::net;
+using namespace conet::net::ip;
+using Kelpa::Coroutine::Detached;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Connections 	{ 64 };
+static constexpr std::size_t 	Depth 			{ 16 };
+static constexpr std::size_t 	Rounds 			{ 2000 };
+
+/* sends Depth requests at once, reads Depth responses, Rounds times */
+static Detached load(reactor_type& reactor, std::uint16_t port, std::atomic<std::size_t>& answered, std::size_t& running) {
+	tcp::socket socket { reactor };
+	std::error_code ec;
+	co_await socket.async_connect(tcp::endpoint { address_v4::loopback(), port }, ec);
+	socket.set_option(IPPROTO_TCP, TCP_NODELAY, 1, ec);
+	std::string batch;
+	for(std::size_t request {}; request < Depth; request ++)
+		batch += "GET /hello/world HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	std::vector<char> input(64 * 1024);
+	for(std::size_t round {}; round < Rounds and not ec; round ++) {
+		co_await socket.async_write(buffer(batch), ec);
+		std::size_t begin {}, end {}, responses {};
+		while(responses < Depth and not ec) {
+			std::size_t const received { co_await socket.async_read_some(buffer(input.data() + end, input.size() - end), ec) };
+			if(received == 0)
+				break;
+			end += received;
+			for(http::response_parser parser; parser.parse(input.data() + begin, end - begin) == http::parse_status::complete; parser.reset()) {
+				begin += parser.consumed();
+				responses ++;
+			}
+		}
+		answered += responses;
+		if(responses < Depth)
+			break;
+	}
+	if(-- running == 0)
+		reactor.Stop();
+}
+
+int main() {
+	std::size_t const cores { std::max(std::thread::hardware_concurrency() / 2, 1u) };
+	http::router routes;
+	routes.get("/hello/:name", [](http::request const& request, http::response& response) {
+		response.header("Content-Type", "text/plain").body("hello, ").body(request.param("name"));
+	});
+	routes.compile();
+
+	http::server_options options;
+	options.reuse_port = true;
+	std::atomic<std::uint16_t> port {};
+	std::vector<reactor_type> servers(cores);
+	std::vector<std::thread> threads;
+	for(std::size_t core {}; core < cores; core ++) {
+		/* the first server picks the port, the others join it */
+		while(core and not port.load())
+			std::this_thread::yield();
+		threads.emplace_back([&, core] {
+			http::server server { servers[core], tcp::endpoint { tcp::v4(), port.load() }, routes, options };
+			if(core == 0)
+				port = server.local_endpoint().port();
+			server.start();
+			servers[core].Run();
+		});
+	}
+	while(not port.load())
+		std::this_thread::yield();
+
+	std::atomic<std::size_t> answered {};
+	auto const begin { Clock::now() };
+	std::vector<std::thread> clients;
+	for(std::size_t core {}; core < cores; core ++)
+		clients.emplace_back([&] {
+			reactor_type reactor;
+			std::size_t running { Connections / cores + 1 };
+			for(std::size_t connection {}, count { running }; connection < count; connection ++)
+				load(reactor, port.load(), answered, running);
+			reactor.Run();
+		});
+	for(std::thread& client: clients)
+		client.join();
+	double const seconds { std::chrono::duration<double>(Clock::now() - begin).count() };
+
+	for(reactor_type& server: servers)
+		server.Stop();
+	for(std::thread& thread: threads)
+		thread.join();
+	std::printf("%zu server threads, %zu connections x %zu pipelined: %zu requests in %.2fs, %.0f requests/s\n",
+		cores, cores * (Connections / cores + 1), Depth, answered.load(), seconds, answered.load() / seconds);
+	return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * Sample program for the chained IOBuf and the code built on it:
+ * 		1. IOBuf: Prepend into the headroom and of whole buffers (a freshly
+ * 		   created one included), Split and Clone without copying, Coalesce
+ * 		   of a chain of blocks, and StreamBuffer writing and reading text
+ * 		   across block boundaries
+ * 		2. a SerdeStream round-trip over an IOBuf large enough to span blocks
+ * 		3. Varint at the boundary values 0, 127, 128 and 2^63, into a vector
+ * 		   and through IOBuf::Appender and IOBuf::Cursor
+ * 		each check prints ok or FAILED, and the exit code counts the failures
+ **/
+
+#include "../Src/Utility/IOBuf.hpp"
+#include "../Src/Serde/Serde.hpp"
+#include "../Src/Compress/Varint.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using Kelpa::Utility::IOBuf;
+namespace Compress = Kelpa::Compress;
+
+static int Failed {};
+
+static void Check(char const* name, bool ok) {
+	std::printf("  %-48s %s\n", name, ok ? "ok" : "FAILED");
+	Failed += ! ok;
+}
+
+/* the bytes of a chain, read slice by slice */
+static std::string Text(IOBuf const& buffer) {
+	std::string result;
+	buffer.Visit([&] (std::span<std::byte const> slice) {
+		result.append(reinterpret_cast<char const *>(slice.data()), slice.size());
+	});
+	return result;
+}
+
+static std::string Pattern(std::size_t size) {
+	std::string result(size, '\0');
+	for(std::size_t index {}; index < size; index ++)
+		result[index] = static_cast<char>('a' + index % 26);
+	return result;
+}
+
+static void Buffers() {
+	std::printf("IOBuf\n");
+	{
+		IOBuf buffer { IOBuf::Copy("body", 4) };
+		buffer.Prepend("head:", 5);
+		Check("Prepend(data) lands in the headroom", buffer.Slices() == 1 && Text(buffer) == "head:body");
+	}
+	{
+		IOBuf buffer { IOBuf::Create(256) };
+		buffer.Prepend(IOBuf::Copy("second", 6));
+		buffer.Prepend(IOBuf::Copy("first ", 6));
+		Check("Prepend(IOBuf) onto a created buffer", buffer.Slices() == 2 && buffer.Size() == 12 && Text(buffer) == "first second");
+		Check("the created block stays behind as tailroom", buffer.Tailroom() >= 256);
+		buffer.Append(IOBuf::Create(64));
+		buffer.Prepend(IOBuf::Create(64));
+		Check("Append and Prepend of empty buffers", buffer.Slices() == 2 && Text(buffer) == "first second");
+		iovec vectors[4];
+		Check("ToIovec skips nothing and adds nothing", buffer.ToIovec(vectors) == 2);
+	}
+
+	std::string const 	text 	{ Pattern(3 * IOBuf::BlockSize + 100) };
+	IOBuf 				buffer;
+	buffer.Append(text.data(), text.size());
+	std::size_t const 	slices 	{ buffer.Slices() };
+	{
+		IOBuf copy { buffer };
+		IOBuf head { copy.Split(5000) };
+		Check("Split cuts at the byte asked for", head.Size() == 5000 && copy.Size() == text.size() - 5000);
+		Check("Split keeps the bytes in order", Text(head) + Text(copy) == text);
+		Check("Split shares blocks, the source is untouched", Text(buffer) == text && buffer.Slices() == slices);
+		IOBuf const clone { buffer.Clone(text.size() + 1) };
+		Check("Clone past the end takes what there is", clone.Size() == text.size() && clone.Slices() == slices);
+	}
+	{
+		IOBuf copy { buffer };
+		std::span<std::byte const> const whole { copy.Coalesce() };
+		Check("Coalesce joins the blocks into one", slices > 1 && copy.Slices() == 1
+			&& std::string_view { reinterpret_cast<char const *>(whole.data()), whole.size() } == text);
+		Check("Coalesce of one slice is a no-op", copy.Coalesce().data() == whole.data());
+	}
+	{
+		IOBuf 				lines;
+		IOBuf::StreamBuffer stream { lines };
+		std::ostream 		out { std::addressof(stream) };
+		for(int line {}; line < 1000; line ++)
+			out << "line " << line << '\n';
+		out.flush();
+		std::istream 		in { std::addressof(stream) };
+		std::string 		word;
+		int 				number {}, expected {};
+		while(in >> word >> number && word == "line" && number == expected)
+			expected ++;
+		Check("StreamBuffer writes and reads across blocks", expected == 1000 && lines.Slices() > 1);
+		in.clear();
+		in.seekg(static_cast<std::streamoff>(lines.Size() - 9));
+		std::getline(in, word);
+		Check("StreamBuffer seeks into the last block", word == "line 999");
+	}
+}
+
+static void Serialization() {
+	std::printf("SerdeStream over IOBuf\n");
+	std::vector<long long> 			numbers;
+	/* varints of every length from one byte to nine, positive and negative */
+	for(long long index {}; index < 3000; index ++)
+		numbers.push_back((index % 2 ? -1 : 1) * ((index % 1000) << (index % 50)));
+	std::unordered_map<int, double> table { { 1, 0.5 }, { -7, 1e300 }, { 1 << 20, -0.0 } };
+
+	IOBuf 							buffer;
+	{
+		Kelpa::Serde::SerdeStream 	out { buffer };
+		/* the operators hand back the plain stream, so each SerdeStream one starts a statement */
+		out << 0;
+		out << 127;
+		out << 128;
+		out << static_cast<unsigned long long>(1ULL << 63);
+		out << static_cast<long long>(INT64_MIN);
+		out << 3.25;
+		out << true;
+		out << numbers;
+		out << table;
+		out.flush();
+	}
+	Check("the encoding spans several blocks", buffer.Slices() > 1);
+
+	Kelpa::Serde::SerdeStream 		in { buffer };
+	int 							zero { -1 }, small {}, large {};
+	unsigned long long 				top {};
+	long long 						bottom {};
+	double 							real {};
+	bool 							flag {};
+	std::vector<long long> 			numbers_;
+	std::unordered_map<int, double> table_;
+	in >> zero;
+	in >> small;
+	in >> large;
+	in >> top;
+	in >> bottom;
+	in >> real;
+	in >> flag;
+	Check("primitives come back", zero == 0 && small == 127 && large == 128 && top == 1ULL << 63 && bottom == INT64_MIN && real == 3.25 && flag);
+	in >> numbers_;
+	in >> table_;
+	Check("an array comes back across block boundaries", numbers_ == numbers);
+	Check("a dictionary comes back", table_ == table);
+	Check("nothing is left over", ! in.nextc());
+}
+
+static void Varints() {
+	std::printf("Varint\n");
+	struct Case { std::uint64_t value; std::vector<unsigned char> bytes; };
+	Case const cases[] {
+		{ 0, 			{ 0x00 } },
+		{ 127, 			{ 0x7f } },
+		{ 128, 			{ 0x80, 0x01 } },
+		{ 1ULL << 63, 	{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 } },
+	};
+	for(Case const& each: cases) {
+		char name[64];
+		std::snprintf(name, sizeof name, "%llu", static_cast<unsigned long long>(each.value));
+		std::vector<unsigned char> const bytes { Compress::ToVarint(each.value) };
+		bool ok { bytes == each.bytes && Compress::FromVarint<std::uint64_t>(bytes) == each.value };
+
+		IOBuf 								buffer;
+		IOBuf::Appender<unsigned char> 	const start { buffer };
+		auto const written { Compress::ToVarint(each.value, start) };
+		ok = ok && written == static_cast<std::ptrdiff_t>(each.bytes.size()) && buffer.Size() == each.bytes.size();
+		ok = ok && Compress::FromVarint<std::uint64_t>(buffer.begin(), buffer.end()) == each.value;
+		Check(name, ok);
+	}
+}
+
+int main() {
+	DynamicCodecInfos__()
+	Buffers();
+	Serialization();
+	Varints();
+	std::printf("%s\n", Failed ? "FAILED" : "ok");
+	return Failed;
+}
@@ -0,0 +1,193 @@
+/**
+ * Sample program for the memory subsystem:
+ * 		compares glibc malloc with Slab, ObjectPool and MonotonicArena on the
+ * 		allocation patterns found in Kelpa's hot paths
+ * 			events 		mixed 24..200 byte blocks churned on one thread (Journal::Event strings)
+ * 			handoff 	64 byte nodes allocated by a producer, freed by a consumer (Executor queue)
+ * 			tree 		a large binary tree built then torn down (Huffman nodes)
+ * 			document 	maps of strings to vectors built and dropped (CppJson::Node)
+ **/
+
+#include "../Src/Utility/Slab.hpp"
+#include "../Src/Utility/Arena.hpp"
+#include "../Src/Utility/ObjectPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Utility;
+using Clock = std::chrono::steady_clock;
+
+template <typename F> static double Time(F&& f) {
+	auto const begin { Clock::now() };
+	f();
+	return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+static void Report(char const* pattern, char const* allocator, double ms) {
+	std::printf("%-10s %-24s %10.1f ms\n", pattern, allocator, ms);
+}
+
+static void Events() {
+	constexpr std::size_t 	Rounds 	{ 4000000 };
+	constexpr std::size_t 	Window 	{ 256 };
+	std::vector<std::size_t> sizes(Rounds);
+	std::mt19937 random { 7 };
+	for(auto& size: sizes)
+		size = 24 + random() % 177;
+
+	auto churn = [&] (auto&& allocate, auto&& deallocate) {
+		std::vector<std::pair<void *, std::size_t>> live(Window, { nullptr, 0 });
+		for(std::size_t round {}; round < Rounds; round ++) {
+			auto& [pointer, size] = live[round % Window];
+			if(pointer)
+				deallocate(pointer, size);
+			size 	= sizes[round];
+			pointer = allocate(size);
+			static_cast<char *>(pointer)[0] = 1;
+		}
+		for(auto& [pointer, size]: live)
+			deallocate(pointer, size);
+	};
+	Report("events", "malloc", Time([&] {
+		churn([] (std::size_t size) { return std::malloc(size); }, [] (void* pointer, std::size_t) { std::free(pointer); });
+	}));
+	Report("events", "Slab", Time([&] {
+		churn([] (std::size_t size) { return Slab::Allocate(size); }, [] (void* pointer, std::size_t size) { Slab::Deallocate(pointer, size); });
+	}));
+}
+
+struct Task {
+	void * 			callable;
+	std::size_t 	priority;
+	char 			payload[48];
+};
+
+template <typename Allocate, typename Deallocate>
+static double Handoff(Allocate&& allocate, Deallocate&& deallocate) {
+	constexpr std::size_t 	Items 	{ 4000000 };
+	constexpr std::size_t 	Ring 	{ 1024 };
+	std::vector<std::atomic<Task *>> ring(Ring);
+	return Time([&] {
+		std::thread consumer([&] {
+			for(std::size_t index {}; index < Items; index ++) {
+				Task* task;
+				while(! (task = ring[index % Ring].exchange(nullptr, std::memory_order_acquire)))
+					std::this_thread::yield();
+				deallocate(task);
+			}
+		});
+		for(std::size_t index {}; index < Items; index ++) {
+			Task* task { allocate() };
+			(* task).priority = index;
+			while(ring[index % Ring].load(std::memory_order_relaxed))
+				std::this_thread::yield();
+			ring[index % Ring].store(task, std::memory_order_release);
+		}
+		consumer.join();
+	});
+}
+
+static void Handoffs() {
+	Report("handoff", "new/delete", Handoff([] { return new Task {}; }, [] (Task* task) { delete task; }));
+	Report("handoff", "ObjectPool", Handoff([] { return ObjectPool<Task>::Create(); }, [] (Task* task) { ObjectPool<Task>::Destroy(task); }));
+}
+
+template <typename Node, typename Make>
+static Node* Build(std::size_t depth, Make&& make) {
+	if(! depth)
+		return make(nullptr, nullptr);
+	Node* left { Build<Node>(depth - 1, make) };
+	return make(left, Build<Node>(depth - 1, make));
+}
+
+struct HeapNode {
+	HeapNode * 		left;
+	HeapNode * 		right;
+	std::size_t 	weight 	{ 1 };
+};
+struct PooledNode: Pooled<PooledNode> {
+	PooledNode(PooledNode* left, PooledNode* right) noexcept: left(left), right(right) {}
+	PooledNode * 	left;
+	PooledNode * 	right;
+	std::size_t 	weight 	{ 1 };
+};
+
+template <typename Node> static void Free(Node* node) {
+	if(! node)
+		return;
+	Free((* node).left);
+	Free((* node).right);
+	delete node;
+}
+
+static void Trees() {
+	constexpr std::size_t Depth 	{ 18 };
+	constexpr std::size_t Rounds 	{ 10 };
+	Report("tree", "new/delete", Time([&] {
+		for(std::size_t round {}; round < Rounds; round ++)
+			Free(Build<HeapNode>(Depth, [] (HeapNode* left, HeapNode* right) { return new HeapNode { left, right }; }));
+	}));
+	Report("tree", "Pooled", Time([&] {
+		for(std::size_t round {}; round < Rounds; round ++)
+			Free(Build<PooledNode>(Depth, [] (PooledNode* left, PooledNode* right) { return new PooledNode { left, right }; }));
+	}));
+	MonotonicArena arena;
+	Report("tree", "MonotonicArena", Time([&] {
+		for(std::size_t round {}; round < Rounds; round ++) {
+			(void) Build<HeapNode>(Depth, [&] (HeapNode* left, HeapNode* right) {
+				return new (arena.allocate(sizeof(HeapNode), alignof(HeapNode))) HeapNode { left, right };
+			});
+			arena.Reset();
+		}
+	}));
+}
+
+template <typename Map, typename String, typename Vector, typename... Allocator>
+static void Document(std::size_t rounds, std::function<void()> const& reset, Allocator... allocator) {
+	for(std::size_t round {}; round < rounds; round ++) {
+		{
+			Map object { allocator ... };
+			for(int key {}; key < 512; key ++) {
+				String name { "member.with.a.long.name.", allocator ... };
+				name += std::to_string(key);
+				Vector& values { object.try_emplace(std::move(name)).first -> second };
+				for(int value {}; value < 8; value ++)
+					values.push_back(value);
+			}
+		}
+		reset();
+	}
+}
+
+static void Documents() {
+	constexpr std::size_t Rounds { 2000 };
+	Report("document", "std::allocator", Time([&] {
+		Document<std::map<std::string, std::vector<int>>, std::string, std::vector<int>>(Rounds, [] {});
+	}));
+	MonotonicArena arena { 64 * 1024 };
+	Report("document", "pmr + MonotonicArena", Time([&] {
+		Document<std::pmr::map<std::pmr::string, std::pmr::vector<int>>, std::pmr::string, std::pmr::vector<int>>(
+			Rounds, [&] { arena.Reset(); }, std::pmr::polymorphic_allocator<> { &arena });
+	}));
+	Report("document", "pmr + SlabResource", Time([&] {
+		Document<std::pmr::map<std::pmr::string, std::pmr::vector<int>>, std::pmr::string, std::pmr::vector<int>>(
+			Rounds, [] {}, std::pmr::polymorphic_allocator<> { SlabResource::Get() });
+	}));
+}
+
+int main() {
+	Events();
+	Handoffs();
+	Trees();
+	Documents();
+	return 0;
+}
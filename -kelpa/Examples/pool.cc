@@ -0,0 +1,88 @@
+/**
+ * Sample program for the outbound connection pool:
+ * 		Clients coroutines send Requests GETs each to a local HTTP server
+ * 		through one pool capped at Connections per endpoint, so the clients
+ * 		queue for warm connections instead of opening their own. Prints
+ * 		requests per second and how many connections the server saw
+ **/
+
+#include "../Src/Internet/http.hpp"
+#include "../Src/Internet/pool.hpp"
+#include "../Src/Coroutine/Detached.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace conet::net;
+using namespace conet::net::ip;
+using Kelpa::Coroutine::Detached;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Clients 		{ 256 };
+static constexpr std::size_t 	Requests 		{ 400 };
+static constexpr std::size_t 	Connections 	{ 8 };
+
+struct counters {
+	std::size_t answered {};
+	std::size_t refused {};
+	std::size_t running { Clients };
+};
+
+static Detached client(connection_pool& pool, tcp::endpoint const& backend, counters& count) {
+	static constexpr std::string_view request { "GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n" };
+	std::vector<char> input(4096);
+	for(std::size_t round {}; round < Requests; round ++) {
+		std::error_code ec;
+		pooled_connection connection = co_await pool.acquire(backend, ec);
+		if(ec) {
+			count.refused ++;
+			continue;
+		}
+		co_await connection.socket().async_write(buffer(request), ec);
+		std::size_t received {};
+		http::response_parser parser;
+		http::parse_status status { http::parse_status::incomplete };
+		while(not ec and status == http::parse_status::incomplete) {
+			std::size_t const size { co_await connection.socket().async_read_some(buffer(input.data() + received, input.size() - received), ec) };
+			if(size == 0)
+				break;
+			received += size;
+			status = parser.parse(input.data(), received);
+		}
+		if(status != http::parse_status::complete) {
+			connection.fail();
+			continue;
+		}
+		if(not parser.get().keep_alive())
+			connection.discard();
+		count.answered ++;
+	}
+	if(-- count.running == 0)
+		pool.context().Stop();
+}
+
+int main() {
+	reactor_type reactor;
+	http::router routes;
+	routes.get("/ping", [](http::request const&, http::response& response) { response.body("pong"); });
+	http::server server { reactor, tcp::endpoint { tcp::v4(), 0 }, routes };
+	server.start();
+
+	pool_options options;
+	options.max_connections = Connections;
+	options.max_waiters = Clients;
+	connection_pool pool { reactor, options };
+	tcp::endpoint const backend { address_v4::loopback(), server.local_endpoint().port() };
+
+	counters count;
+	auto const begin { Clock::now() };
+	for(std::size_t index {}; index < Clients; index ++)
+		client(pool, backend, count);
+	reactor.Run();
+	double const seconds { std::chrono::duration<double>(Clock::now() - begin).count() };
+
+	pool_stats const stats { pool.stats(backend) };
+	std::printf("%zu requests (%zu refused) in %.2fs, %.0f requests/s over %zu pooled connections\n",
+		count.answered, count.refused, seconds, count.answered / seconds, stats.idle + stats.leased);
+	return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * Benchmark for the longest-prefix-match tables:
+ * 		builds an ACL of Rules IPv4 and Rules / 4 IPv6 networks with the
+ * 		prefix length mix of a routing table (mostly /24 and /48), then looks
+ * 		up Lookups random addresses in each family. Prints build time, memory
+ * 		and nanoseconds per lookup. Before that the v4 table is checked against a
+ * 		brute-force longest-prefix match while /25-/32 networks scattered over
+ * 		many /16s are inserted and erased
+ **/
+
+#include "../Src/Internet/prefix.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace conet::net::ip;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Rules 		{ 50000 };
+static constexpr std::size_t 	Lookups 	{ 1 << 22 };
+/* keeps the lookups from being optimized away */
+static volatile std::size_t 	Sink;
+
+static double elapsed(Clock::time_point begin) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+template <typename Table, typename Network, typename Address>
+static void run(char const* name, std::vector<std::pair<Network, unsigned>> const& rules, std::vector<Address> const& addresses) {
+	auto begin { Clock::now() };
+	Table const table { rules };
+	double const build { elapsed(begin) };
+
+	std::size_t matched {};
+	begin = Clock::now();
+	for(Address const& address: addresses)
+		if(unsigned const* value { table.lookup(address) })
+			matched += * value;
+	Sink = matched;
+	double const lookup { elapsed(begin) * 1e6 / addresses.size() };
+	std::printf("%s: %zu networks built in %.1f ms, %.1f MiB, %.1f ns per lookup\n",
+		name, table.size(), build, table.memory_usage() / 1048576.0, lookup);
+}
+
+/* the value of the longest rule containing address, by scanning every rule */
+static unsigned const* brute_force(std::map<std::pair<int, std::uint32_t>, unsigned> const& rules, std::uint32_t address) {
+	for(auto rule { rules.rbegin() }; rule != rules.rend(); rule ++)
+		if((address & conet::detail::mask_v4(rule->first.first)) == rule->first.second)
+			return &rule->second;
+	return nullptr;
+}
+
+/* random inserts and erases, mostly host routes and other long prefixes; false on the first mismatch */
+static bool check_v4(std::mt19937_64& random) {
+	prefix_table_v4<unsigned> table;
+	std::map<std::pair<int, std::uint32_t>, unsigned> rules;
+	auto probe = [&](std::uint32_t address) {
+		unsigned const* expected { brute_force(rules, address) };
+		unsigned const* found { table.lookup(address_v4{ address }) };
+		if((expected == nullptr) != (found == nullptr) or (expected and * expected != * found)) {
+			std::printf("v4 check: lookup of %08x gave %d, expected %d\n", address,
+				found ? static_cast<int>(* found) : -1, expected ? static_cast<int>(* expected) : -1);
+			return false;
+		}
+		return true;
+	};
+	std::vector<std::uint32_t> inserted;
+	for(unsigned step {}; step < 10000; step ++) {
+		/* 256 /16s, so that long prefixes keep adding second level chunks */
+		std::uint32_t const address { static_cast<std::uint32_t>(random() % 256) << 24 | (static_cast<std::uint32_t>(random()) & 0x00ffffff) };
+		if(random() % 4 == 0 and not inserted.empty()) {
+			std::uint32_t const target { inserted[random() % inserted.size()] };
+			/* the longest rule over target, so that its lookup falls back to a shorter one */
+			for(auto at { rules.rbegin() }; at != rules.rend(); at ++)
+				if(at->first.second == (target & conet::detail::mask_v4(at->first.first))) {
+					table.erase(network_v4{ address_v4{ at->first.second }, at->first.first });
+					rules.erase(std::next(at).base());
+					break;
+				}
+			if(not probe(target)) return false;
+			continue;
+		}
+		int const length { random() % 8 ? 25 + static_cast<int>(random() % 8) : 8 + static_cast<int>(random() % 17) };
+		std::uint32_t const network { address & conet::detail::mask_v4(length) };
+		table.insert(network_v4{ address_v4{ network }, length }, step);
+		rules[{ length, network }] = step;
+		inserted.push_back(address);
+		if(not probe(address) or not probe(address ^ 1) or not probe(static_cast<std::uint32_t>(random()))) return false;
+	}
+	for(std::uint32_t const address: inserted)
+		if(not probe(address)) return false;
+	std::printf("v4 check: %zu rules left, matches a brute-force scan\n", rules.size());
+	return true;
+}
+
+int main() {
+	std::mt19937_64 random { 42 };
+	if(not check_v4(random))
+		return 1;
+	std::discrete_distribution<int> v4_length { { 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 2, 3, 5, 6, 20, 8, 10, 15, 20, 25, 40, 40, 300, 1, 1, 1, 1, 1, 1, 1, 2 } };
+	std::vector<std::pair<network_v4, unsigned>> v4_rules;
+	for(unsigned rule {}; rule < Rules; rule ++)
+		v4_rules.emplace_back(network_v4{ address_v4{ static_cast<address_v4::uint_type>(random()) }, v4_length(random) }.canonical(), rule);
+	std::vector<address_v4> v4_addresses;
+	for(std::size_t index {}; index < Lookups; index ++)
+		v4_addresses.emplace_back(static_cast<address_v4::uint_type>(random()));
+
+	/* lengths from /19 to /64 around /32 and /48, in the few /16s most of the space is allocated from */
+	static constexpr std::uint64_t v6_blocks[] { 0x2001, 0x2400, 0x2401, 0x2402, 0x2403, 0x2404, 0x2405, 0x2406, 0x2407, 0x2600, 0x2601, 0x2602, 0x2603, 0x2604, 0x2605, 0x2606, 0x2607, 0x2800, 0x2801, 0x2803, 0x2804, 0x2a00, 0x2a01, 0x2a02, 0x2a03, 0x2a04, 0x2a05, 0x2a06, 0x2a07, 0x2a0a, 0x2a0b, 0x2a0c, 0x2a0d, 0x2a0e, 0x2a0f, 0x2a10, 0x2a11, 0x2a12, 0x2a13, 0x2a14, 0x2c0f };
+	auto v6_address = [&](std::uint64_t low) {
+		address_v6::bytes_type bytes;
+		std::uint64_t const high { v6_blocks[random() % std::size(v6_blocks)] << 48 | random() >> 16 };
+		for(int index {}; index < 8; index ++) {
+			bytes[index] = static_cast<unsigned char>(high >> (56 - 8 * index));
+			bytes[8 + index] = static_cast<unsigned char>(low >> (56 - 8 * index));
+		}
+		return address_v6{ bytes };
+	};
+	std::discrete_distribution<int> v6_length { { 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 20, 2, 2, 2, 5, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 40, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 5 } };
+	std::vector<std::pair<network_v6, unsigned>> v6_rules;
+	std::vector<address_v6> v6_addresses;
+	for(unsigned rule {}; rule < Rules / 4; rule ++)
+		v6_rules.emplace_back(network_v6{ v6_address(0), 19 + v6_length(random) }.canonical(), rule);
+	/* half of them inside a rule, as most traffic comes from announced space */
+	for(std::size_t index {}; index < Lookups; index ++) {
+		address_v6 address { v6_address(random()) };
+		if(index % 2) {
+			auto bytes { v6_rules[random() % v6_rules.size()].first.network().to_bytes() };
+			for(int byte { 4 }; byte < 16; byte ++)
+				bytes[byte] |= static_cast<unsigned char>(random()) & (byte < 8 ? 0 : 0xff);
+			address = address_v6{ bytes };
+		}
+		v6_addresses.push_back(address);
+	}
+
+	run<prefix_table_v4<unsigned>>("v4", v4_rules, v4_addresses);
+	run<prefix_table_v6<unsigned>>("v6", v6_rules, v6_addresses);
+	return 0;
+}
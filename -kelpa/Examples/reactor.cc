@@ -0,0 +1,181 @@
+/**
+ * Sample program for the select reactor (Windows, link with ws2_32):
+ * 		1. slots: a coroutine listened for READ on one end of a loopback
+ * 		   connection is resumed on the polling thread each time data
+ * 		   arrives, and is destroyed, its descriptor cleared, once it returns
+ * 		2. Post(): a coroutine posted from another thread while select is
+ * 		   blocked runs on the polling thread at once, not at the next poll
+ * 		3. except set: out-of-band data resumes a coroutine listened for
+ * 		   EXCEPT, and Cancel() retires it
+ **/
+
+#include <WinSock2.h>
+#include "../Src/IOSchedule/Reactor.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace Kelpa;
+using IOSchedule::Event;
+using Clock = std::chrono::steady_clock;
+
+/* what the coroutines report back; a coroutine counts itself parked only once it has suspended */
+struct Shared {
+	std::atomic<int> 				parked 		{};
+	std::atomic<int> 				bytes 		{};
+	std::atomic<bool> 				closed 		{};
+	std::atomic<bool> 				elsewhere 	{};
+	std::atomic<std::thread::id> 	poller 		{};
+	std::atomic<char> 				urgent 		{};
+	std::atomic<long long> 			latency 	{};
+	std::atomic<long long> 			posted 		{};
+};
+
+struct Park {
+	bool 	await_ready() 					const noexcept { 	return false; 		}
+	void 	await_suspend(std::coroutine_handle<>) 	const noexcept { 	shared.parked ++; 	}
+	void 	await_resume() 					const noexcept {}
+
+	Shared& shared;
+};
+
+/* the first resume names the polling thread, any other thread is noted */
+static void Note(Shared& shared) {
+	std::thread::id first {};
+	if(not shared.poller.compare_exchange_strong(first, std::this_thread::get_id()) && first != std::this_thread::get_id())
+		shared.elsewhere = true;
+}
+
+/* one resume per readiness: reads what is there, returns when the peer closes */
+static Coroutine::WeakFuture<> Receive(SOCKET socket, Shared& shared) {
+	char data[256];
+	while(true) {
+		Note(shared);
+		int length;
+		while((length = recv(socket, data, sizeof data, 0)) > 0)
+			shared.bytes += length;
+		if(length == 0) {
+			shared.closed = true;
+			co_return;
+		}
+		co_await Park { shared };
+	}
+}
+
+static Coroutine::WeakFuture<> Urgent(SOCKET socket, Shared& shared) {
+	while(true) {
+		Note(shared);
+		char byte {};
+		if(recv(socket, std::addressof(byte), 1, MSG_OOB) == 1)
+			shared.urgent = byte;
+		co_await Park { shared };
+	}
+}
+
+/* resumed only through Post(), never listened */
+static Coroutine::WeakFuture<> Posted(Shared& shared) {
+	while(true) {
+		Note(shared);
+		shared.latency = std::max<long long>(shared.latency.load(), Clock::now().time_since_epoch().count() - shared.posted.load());
+		co_await Park { shared };
+	}
+}
+
+static bool WaitFor(std::atomic<int> const& value, int target) {
+	for(auto const deadline { Clock::now() + std::chrono::seconds(3) }; Clock::now() < deadline; std::this_thread::sleep_for(std::chrono::milliseconds(1)))
+		if(value.load() >= target)
+			return true;
+	return false;
+}
+
+/* both ends of a loopback tcp connection, non-blocking */
+static bool Connect(SOCKET& client, SOCKET& server) {
+	SOCKET const listener { socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) };
+	struct sockaddr_in address;
+	std::memset(std::addressof(address), 0, sizeof address);
+	address.sin_family 		= AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	int length 				= sizeof address;
+	u_long nonblocking 		= 1;
+	bool const ok { listener != INVALID_SOCKET
+		&& bind(listener, reinterpret_cast<struct sockaddr *>(std::addressof(address)), sizeof address) != SOCKET_ERROR
+		&& listen(listener, 1) != SOCKET_ERROR
+		&& getsockname(listener, reinterpret_cast<struct sockaddr *>(std::addressof(address)), std::addressof(length)) != SOCKET_ERROR
+		&& (client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) != INVALID_SOCKET
+		&& connect(client, reinterpret_cast<struct sockaddr *>(std::addressof(address)), length) != SOCKET_ERROR
+		&& (server = accept(listener, nullptr, nullptr)) != INVALID_SOCKET
+		&& ioctlsocket(client, FIONBIO, std::addressof(nonblocking)) != SOCKET_ERROR
+		&& ioctlsocket(server, FIONBIO, std::addressof(nonblocking)) != SOCKET_ERROR };
+	if(listener != INVALID_SOCKET)
+		(void) closesocket(listener);
+	return ok;
+}
+
+int main() {
+	WSADATA data;
+	if(WSAStartup(MAKEWORD(2, 2), std::addressof(data)))
+		return 1;
+	int 				failed 	{};
+	IOSchedule::Reactor reactor;
+	Shared 				shared;
+
+	/* 1. the slot resume path */
+	SOCKET client {}, server {};
+	if(not Connect(client, server))
+		return 1;
+	reactor.Listen(Event::READ, static_cast<signed>(server), Receive(server, shared));
+	constexpr int Messages { 5 };
+	for(int index {}; index < Messages; index ++) {
+		(void) send(client, "ping", 4, 0);
+		failed += not WaitFor(shared.parked, index + 1);
+	}
+	(void) closesocket(client);
+	for(auto const deadline { Clock::now() + std::chrono::seconds(3) }; not shared.closed && Clock::now() < deadline; )
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	bool const cleared { reactor.LookUp(static_cast<signed>(server)) == Event::NOEVENT };
+	std::printf("slots:   %d bytes over %d resumes, %s, descriptor %s\n", shared.bytes.load(), shared.parked.load(),
+		shared.closed ? "returned on close" : "never returned", cleared ? "cleared" : "still listened");
+	failed += shared.bytes != 4 * Messages || not shared.closed || not cleared;
+	(void) closesocket(server);
+
+	/* 2. Post() while select is blocked: the reactor has nothing ready and no timer due for a while */
+	shared.parked = 0;
+	auto const 	posted 	{ Posted(shared) };
+	constexpr int Posts { 5 };
+	for(int index {}; index < Posts; index ++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		std::thread { [&] {
+			shared.posted = Clock::now().time_since_epoch().count();
+			(void) reactor.Post(posted);
+		} }.join();
+		failed += not WaitFor(shared.parked, index + 1);
+	}
+	double const slowest { std::chrono::duration<double, std::milli>(Clock::duration(shared.latency.load())).count() };
+	std::printf("post:    %d of %d resumed, slowest after %.2fms\n", shared.parked.load(), Posts, slowest);
+	failed += shared.parked != Posts || slowest > 50;
+	std::coroutine_handle<>(posted).destroy();
+
+	/* 3. the except set: urgent data */
+	shared.parked = 0;
+	if(not Connect(client, server))
+		return 1;
+	reactor.Listen(Event::EXCEPT, static_cast<signed>(server), Urgent(server, shared));
+	(void) send(client, "!", 1, MSG_OOB);
+	failed += not WaitFor(shared.parked, 1);
+	reactor.Cancel(static_cast<signed>(server));
+	std::printf("except:  urgent byte '%c', %s after Cancel()\n", shared.urgent.load() ? shared.urgent.load() : ' ',
+		reactor.LookUp(static_cast<signed>(server)) == Event::NOEVENT ? "cleared" : "still listened");
+	failed += shared.urgent != '!' || reactor.LookUp(static_cast<signed>(server)) != Event::NOEVENT;
+	(void) closesocket(client);
+	(void) closesocket(server);
+
+	std::printf("all coroutines on %s\n", shared.elsewhere ? "several threads" : "the polling thread");
+	failed += shared.elsewhere.load();
+	std::printf("%s\n", failed ? "FAILED" : "ok");
+	WSACleanup();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * Sample program for the M:N coroutine runtime:
+ * 		1. throughput: a million coroutines that each yield ten times, on one
+ * 		   worker and then on more, to show it scaling with cores
+ * 		2. imbalance: all work spawned from a single coroutine, so the other
+ * 		   workers only get any by stealing
+ * 		3. sleepers: a million coroutines parked on the timing wheel at once,
+ * 		   how long they took to park and how late they woke
+ * 		4. hopping: a coroutine spawned on one runtime moves onto another with
+ * 		   co_await ScheduleOn()
+ **/
+
+#include "../Src/Coroutine/Runtime.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace Kelpa::Coroutine;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t Tasks 	{ 1000000 };
+static constexpr std::size_t Yields { 10 };
+
+static double Seconds(Clock::time_point since) {
+	return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+static void Throughput(std::size_t workers) {
+	Runtime runtime { workers };
+	std::atomic<std::size_t> done {};
+	auto const start { Clock::now() };
+	for(std::size_t task {}; task < Tasks; task ++)
+		runtime.Spawn([&runtime, &done] () -> MainFuture<void> {
+			for(std::size_t yield {}; yield < Yields; yield ++)
+				co_await runtime.Schedule();
+			done.fetch_add(1, std::memory_order_relaxed);
+		});
+	runtime.Join();
+	double const elapsed { Seconds(start) };
+	std::printf("  %2zu workers: %zu tasks x %zu yields in %6.3fs, %6.2fM resumptions/s\n", workers, done.load(), Yields,
+		elapsed, static_cast<double>(Tasks * (Yields + 2)) / elapsed / 1e6);
+}
+
+static void Imbalance(std::size_t workers) {
+	Runtime runtime { workers };
+	std::atomic<std::size_t> 	done {}, checksum {};
+	std::mutex 					mutex;
+	std::set<std::thread::id> 	threads;
+	auto const start { Clock::now() };
+	runtime.Spawn([&] () -> MainFuture<void> {
+		for(std::size_t task {}; task < Tasks / 10; task ++)
+			runtime.Spawn([&, task] () -> MainFuture<void> {
+				std::uint64_t state { task };
+				for(std::size_t step {}; step < 2000; step ++)
+					state = state * 6364136223846793005ull + 1442695040888963407ull;
+				checksum.fetch_add(state, std::memory_order_relaxed);
+				if(done.fetch_add(1, std::memory_order_relaxed) % 1000 == 0) {
+					std::lock_guard guard { mutex };
+					threads.insert(std::this_thread::get_id());
+				}
+				co_return;
+			});
+		co_return;
+	});
+	runtime.Join();
+	std::printf("  %zu tasks spawned by one coroutine ran on %zu of %zu workers in %.3fs\n", done.load(), threads.size(), workers, Seconds(start));
+}
+
+static void Sleepers(std::size_t workers) {
+	Runtime runtime { workers };
+	std::atomic<long long> 		latest {};
+	auto const start 	{ Clock::now() };
+	auto const deadline { start + std::chrono::seconds(1) };
+	for(std::size_t task {}; task < Tasks; task ++)
+		runtime.Spawn([&] () -> MainFuture<void> {
+			co_await runtime.SleepUntil(deadline);
+			long long const late { std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count() };
+			for(long long seen { latest.load(std::memory_order_relaxed) }; late > seen && not latest.compare_exchange_weak(seen, late); );
+		});
+	double const parked { Seconds(start) };
+	runtime.Join();
+	std::printf("  %zu sleepers parked in %.3fs, all awake %.1fms after their deadline\n", Tasks, parked, static_cast<double>(latest.load()) / 1000);
+}
+
+static MainFuture<void> Hop(Runtime& from, Runtime& to) {
+	std::printf("  spawned on the first runtime: %s\n", Runtime::Current() == std::addressof(from) ? "yes" : "no");
+	co_await ScheduleOn(to);
+	std::printf("  resumed on the second one:    %s\n", Runtime::Current() == std::addressof(to) ? "yes" : "no");
+}
+
+int main() {
+	std::size_t const cores { std::max(std::thread::hardware_concurrency(), 1u) };
+
+	std::printf("throughput:\n");
+	for(std::size_t workers { 1 }; workers <= cores; workers <<= 1)
+		Throughput(workers);
+	if(cores & (cores - 1))
+		Throughput(cores);
+
+	std::printf("imbalance:\n");
+	Imbalance(cores);
+
+	std::printf("sleepers:\n");
+	Sleepers(cores);
+
+	std::printf("hopping:\n");
+SCOPE_BEGIN()
+	/* `to` goes first: the coroutine reports its completion to `from` from one of `to`'s workers */
+	Runtime from { 1 }, to { 1 };
+	from.Spawn(Hop, std::ref(from), std::ref(to));
+	from.Join();
+SCOPE_END()
+	return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Sample program for the copy-free socket paths:
+ * 		serves a 64 MiB file over loopback with a 4 KiB read()/write() loop (what
+ * 		the demo server does) and with sendfile(2), then receives the same amount
+ * 		into a file with recv()/write() and with splice(2). MSG_ZEROCOPY is also
+ * 		timed, though loopback makes the kernel copy anyway
+ **/
+
+#include "../Src/Internet/socket.hpp"
+#include "../Src/Coroutine/Detached.hpp"
+#include <fcntl.h>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+using namespace conet::net;
+using namespace conet::net::ip;
+using Kelpa::Coroutine::Detached;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t Size { std::size_t(64) << 20 };
+
+static Detached sink(tcp::socket& socket, bool& done) {
+	static char data[1 << 16];
+	for(std::size_t total {}; total < Size; )
+		total += co_await socket.async_read_some(buffer(data));
+	done = true;
+}
+static Detached source(tcp::socket& socket, bool& done) {
+	static std::string const data(1 << 16, 'x');
+	for(std::size_t total {}; total < Size; total += data.size())
+		co_await socket.async_write(buffer(data));
+	done = true;
+}
+
+/* runs `send` on one end of a connection and `receive` on the other, returns MiB/s */
+static double Transfer(std::function<Detached(tcp::socket&, bool&)> send, std::function<Detached(tcp::socket&, bool&)> receive) {
+	reactor_type reactor;
+	tcp::acceptor acceptor { reactor, tcp::endpoint { address_v4::loopback(), 0 } };
+	tcp::socket client { reactor }, server { reactor };
+	bool sent {}, received {}, connected {};
+	[] (tcp::acceptor& acceptor, tcp::socket& server, bool& connected) -> Detached {
+		server = co_await acceptor.async_accept();
+		connected = true;
+	} (acceptor, server, connected);
+	[] (tcp::socket& client, tcp::endpoint endpoint) -> Detached {
+		co_await client.async_connect(endpoint);
+	} (client, acceptor.local_endpoint());
+	while(not connected)
+		(void) reactor.RunOnce();
+
+	auto const begin { Clock::now() };
+	send(server, sent);
+	receive(client, received);
+	while(not sent or not received)
+		(void) reactor.RunOnce();
+	return Size / double(1 << 20) / std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+int main() {
+	char const* const path { "/tmp/kelpa-sendfile.bin" };
+	char const* const upload { "/tmp/kelpa-upload.bin" };
+	{
+		std::string const block(1 << 20, 'k');
+		FILE* const file { std::fopen(path, "wb") };
+		for(std::size_t written {}; written < Size; written += block.size())
+			(void) std::fwrite(block.data(), 1, block.size(), file);
+		(void) std::fclose(file);
+	}
+	signed const file { ::open(path, O_RDONLY) };
+	signed const output { ::open(upload, O_WRONLY | O_CREAT | O_TRUNC, 0600) };
+
+	std::printf("%-28s %10.0f MiB/s\n", "read() + write() 4 KiB", Transfer([file] (tcp::socket& socket, bool& done) -> Detached {
+		char data[4096];
+		for(off_t offset {}; offset < off_t(Size); ) {
+			ssize_t const length { ::pread(file, data, sizeof data, offset) };
+			co_await socket.async_write(buffer(data, length));
+			offset += length;
+		}
+		done = true;
+	}, sink));
+	std::printf("%-28s %10.0f MiB/s\n", "sendfile()", Transfer([file] (tcp::socket& socket, bool& done) -> Detached {
+		co_await socket.async_send_file(file, 0, Size);
+		done = true;
+	}, sink));
+	std::printf("%-28s %10.0f MiB/s\n", "MSG_ZEROCOPY 1 MiB chains", Transfer([] (tcp::socket& socket, bool& done) -> Detached {
+		auto const block { std::make_shared<std::string const>(1 << 20, 'z') };
+		for(std::size_t total {}; total < Size; total += block->size()) {
+			buffer_chain chain;
+			chain.append(buffer(* block), block);
+			co_await socket.async_write_zerocopy(chain);
+		}
+		done = true;
+	}, sink));
+	std::printf("%-28s %10.0f MiB/s\n", "recv() + write() 64 KiB", Transfer(source, [output] (tcp::socket& socket, bool& done) -> Detached {
+		static char data[1 << 16];
+		for(off_t offset {}; offset < off_t(Size); ) {
+			std::size_t const length { co_await socket.async_read_some(buffer(data)) };
+			(void) ::pwrite(output, data, length, offset);
+			offset += length;
+		}
+		done = true;
+	}));
+	std::printf("%-28s %10.0f MiB/s\n", "splice()", Transfer(source, [output] (tcp::socket& socket, bool& done) -> Detached {
+		co_await socket.async_receive_file(output, 0, Size);
+		done = true;
+	}));
+	(void) ::close(file);
+	(void) ::close(output);
+	(void) std::remove(path);
+	(void) std::remove(upload);
+	return 0;
+}
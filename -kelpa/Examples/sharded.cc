@@ -0,0 +1,78 @@
+/**
+ * Sample program for the thread-per-core mode:
+ * 		an echo server on one SO_REUSEPORT port served by N shards, each shard
+ * 		accepting, reading and answering its own connections. Every reply also
+ * 		posts a counter update to the next shard to exercise the SPSC lanes.
+ * 		Prints round trips per second and how connections spread over the shards
+ **/
+
+#include "../Src/IOSchedule/Sharded.hpp"
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Kelpa::IOSchedule;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t 	Clients 	{ 64 };
+static constexpr std::size_t 	Rounds 		{ 500 };
+
+int main() {
+	std::size_t const cores { std::max(std::thread::hardware_concurrency(), 1u) };
+	ShardedReactor server { cores };
+	std::vector<std::size_t> accepted(cores), forwarded(cores);
+
+	sockaddr_in address {};
+	address.sin_family 		= AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	signed const port { server.Serve(reinterpret_cast<sockaddr *>(&address), sizeof address, [&] (Shard& shard, signed fd) {
+		accepted[shard.Index()] ++;
+		shard.Reactor().Listen(Event::READ, fd, [&, fd] {
+			char buffer[256];
+			ssize_t const size { ::read(fd, buffer, sizeof buffer) };
+			if(size <= 0) {
+				shard.Drop(fd);
+				return;
+			}
+			(void) ::write(fd, buffer, size);
+			std::size_t const next { (shard.Index() + 1) % server.Size() };
+			server.Post(next, [&forwarded, next] { forwarded[next] ++; });
+		});
+	}) };
+	if(port < 0)
+		return std::perror("Serve"), 1;
+	server.Start();
+
+	address.sin_port = htons(port);
+	auto const begin { Clock::now() };
+	std::vector<std::thread> clients;
+	for(std::size_t client {}; client < Clients; client ++)
+		clients.emplace_back([&] {
+			signed const fd { ::socket(AF_INET, SOCK_STREAM, 0) };
+			if(::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof address))
+				return (void) ::close(fd);
+			char buffer[16] { "ping" };
+			for(std::size_t round {}; round < Rounds; round ++) {
+				(void) ::write(fd, buffer, 4);
+				for(ssize_t got {}; got < 4; ) {
+					ssize_t const size { ::read(fd, buffer + got, 4 - got) };
+					if(size <= 0)
+						return (void) ::close(fd);
+					got += size;
+				}
+			}
+			(void) ::close(fd);
+		});
+	for(auto& client: clients)
+		client.join();
+	double const seconds { std::chrono::duration<double>(Clock::now() - begin).count() };
+	server.Stop();
+
+	std::printf("%zu shards, %zu clients x %zu round trips: %.0f rt/s\n", cores, Clients, Rounds, Clients * Rounds / seconds);
+	for(std::size_t index {}; index < cores; index ++)
+		std::printf("  shard %zu: %zu connections accepted, %zu messages received\n", index, accepted[index], forwarded[index]);
+	return 0;
+}
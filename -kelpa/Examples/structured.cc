@@ -0,0 +1,108 @@
+/**
+ * Sample program for structured concurrency and cancellation:
+ * 		1. hedging: each request goes to a slow and a fast replica with
+ * 		   WhenAnyOf, the slow one is cancelled and reaped as soon as the fast
+ * 		   one answers, instead of sleeping out its full latency
+ * 		2. fan-out: a TaskGroup of shards where one fails early, the others
+ * 		   are cancelled and Join() rethrows the failure
+ * 		3. timeouts: WithTimeout around a slow request, and around a read
+ * 		   from an epoll reactor that never becomes readable
+ * 		The replicas count the frames alive, which must be back to zero
+ * 		before each step returns
+ **/
+
+#include "../Src/Coroutine/Structured.hpp"
+#include "../Src/IOSchedule/Epoll.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace Kelpa::Coroutine;
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+static std::atomic<std::size_t> Alive {};
+
+struct Census {
+	Census() noexcept 	{ 	Alive.fetch_add(1, std::memory_order_relaxed); 	}
+	~Census() noexcept 	{ 	Alive.fetch_sub(1, std::memory_order_relaxed); 	}
+};
+
+static double Milliseconds(Clock::time_point since) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+/* answers after latency, or with nothing as soon as it is cancelled */
+static MainFuture<int> Replica(Runtime& runtime, milliseconds latency, int answer) {
+	Census const census;
+	if(not co_await runtime.SleepFor(latency))
+		co_return -1;
+	co_return answer;
+}
+
+static MainFuture<void> Shard(Runtime& runtime, milliseconds latency, bool fails) {
+	Census const census;
+	(void) co_await runtime.SleepFor(latency);
+	if(fails)
+		throw std::runtime_error("shard unavailable");
+}
+
+static MainFuture<void> Hedging(Runtime& runtime) {
+	constexpr std::size_t Requests { 1000 };
+	std::size_t fast {};
+	auto const start { Clock::now() };
+	for(std::size_t request {}; request < Requests; request ++) {
+		auto const answer { co_await WhenAnyOf(Replica(runtime, milliseconds(1000), 1), Replica(runtime, milliseconds(1), 2)) };
+		fast += answer.index() == 1;
+	}
+	std::printf("  %zu hedged requests in %.0fms, %zu answered by the fast replica, %zu frames left\n",
+		Requests, Milliseconds(start), fast, Alive.load());
+}
+
+static MainFuture<void> FanOut(Runtime& runtime) {
+	TaskGroup group { runtime };
+	auto const start { Clock::now() };
+	for(std::size_t shard {}; shard < 64; shard ++)
+		co_await group.Spawn(Shard, std::ref(runtime), milliseconds(shard == 7 ? 5 : 1000), shard == 7);
+	try {
+		co_await group.Join();
+	} catch(std::exception const& exception) {
+		std::printf("  64 shards joined in %.0fms after \"%s\", %zu frames left\n", Milliseconds(start), exception.what(), Alive.load());
+	}
+}
+
+static MainFuture<void> Timeouts(Runtime& runtime, Kelpa::IOSchedule::EpollReactor& reactor, signed fd) {
+	auto start { Clock::now() };
+	auto const answer { co_await WithTimeout(Replica(runtime, milliseconds(1000), 1), milliseconds(50)) };
+	std::printf("  slow request:  %s after %.0fms, %zu frames left\n", answer ? "answered" : "timed out", Milliseconds(start), Alive.load());
+
+	start = Clock::now();
+	auto const events { co_await WithTimeout(reactor.Await(Kelpa::IOSchedule::Event::READ, fd), milliseconds(50)) };
+	std::printf("  silent pipe:   %s after %.0fms, still waited on: %s\n", events ? "readable" : "timed out", Milliseconds(start),
+		reactor.LookUp(fd) == Kelpa::IOSchedule::Event::NOEVENT ? "no" : "yes");
+}
+
+int main() {
+	Runtime runtime { 2 };
+	std::printf("hedging:\n");
+	runtime.Spawn(Hedging, std::ref(runtime));
+	runtime.Join();
+
+	std::printf("fan-out:\n");
+	runtime.Spawn(FanOut, std::ref(runtime));
+	runtime.Join();
+
+	std::printf("timeouts:\n");
+	Kelpa::IOSchedule::EpollReactor reactor;
+	(void) reactor.Start();
+	signed pipe[2];
+	(void) ::pipe(pipe);
+	runtime.Spawn(Timeouts, std::ref(runtime), std::ref(reactor), pipe[0]);
+	runtime.Join();
+	(void) reactor.Stop();
+	(void) ::close(pipe[0]);
+	(void) ::close(pipe[1]);
+	return 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * Sample program for the cancellable Intervalometer timers:
+ * 		one timer of each kind is scheduled and Update() runs them to the end,
+ * 			plain 		fires once after 50ms
+ * 			repeat 		fires three times, 20ms apart
+ * 			cancelled 	is cancelled before it is due and never fires
+ * 			earlier 	is rescheduled from 300ms down to 30ms
+ * 			extended 	is pushed from 40ms out to 120ms
+ * 			stale 		is cancelled through a handle whose timer already fired
+ **/
+
+#include "../Src/Thread/Timer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Thread;
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+int main() {
+	Intervalometer 	intervalometer;
+	auto const 		start 	{ Clock::now() };
+	std::vector<std::pair<char const*, long long>> fired;
+	auto record = [&] (char const* name) {
+		fired.emplace_back(name, std::chrono::duration_cast<milliseconds>(Clock::now() - start).count());
+	};
+	auto make = [&] (char const* name, milliseconds after, long long signed repeat) {
+		Timer timer;
+		timer.Build().SetDuration(after).SetRepeat(repeat).SetCallback(record, name);
+		return intervalometer.Schedule(std::move(timer));
+	};
+
+	TimerHandle const stale { make("stale", milliseconds(10), 1) };
+	(void) make("plain", milliseconds(50), 1);
+	(void) make("repeat", milliseconds(20), 3);
+	TimerHandle const cancelled { make("cancelled", milliseconds(60), 1) };
+	TimerHandle const earlier 	{ make("earlier", milliseconds(300), 1) };
+	TimerHandle const extended 	{ make("extended", milliseconds(40), 1) };
+
+	std::thread worker { [&] { intervalometer.Update(); } };
+	std::printf("cancel:     %s\n", intervalometer.Cancel(cancelled) ? "ok" : "failed");
+	std::printf("reschedule: %s\n", intervalometer.Reschedule(earlier, milliseconds(30)) ? "ok" : "failed");
+	std::printf("extend:     %s\n", intervalometer.Extend(extended, milliseconds(80)) ? "ok" : "failed");
+	std::this_thread::sleep_for(milliseconds(25));
+	std::printf("stale:      %s\n", intervalometer.Cancel(stale) ? "cancelled a fired timer" : "refused, as it should");
+	worker.join();
+
+	for(auto const& [name, at]: fired)
+		std::printf("  %-10s fired at %4lldms\n", name, at);
+	return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Sample program for the io_uring engine:
+ * 		an echo server (multishot accept, multishot receive into a provided buffer
+ * 		ring, send) and N clients doing request/response round trips over loopback,
+ * 		all coroutines on one UringEngine; prints requests per second and
+ * 		io_uring_enter calls per request with and without SQPOLL
+ **/
+
+#include "../Src/IOSchedule/Uring.hpp"
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::IOSchedule;
+using Kelpa::Coroutine::MainFuture;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int 				Clients 	{ 64 };
+static constexpr int 				Rounds 		{ 2000 };
+static constexpr unsigned short 	Group 		{ 0 };
+
+static int Listen(sockaddr_in& address) {
+	int const fd { ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+	int const one { 1 };
+	(void) ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+	address = sockaddr_in { .sin_family = AF_INET, .sin_port = 0, .sin_addr = { htonl(INADDR_LOOPBACK) }, .sin_zero = {} };
+	socklen_t length { sizeof address };
+	(void) ::bind(fd, reinterpret_cast<sockaddr *>(&address), length);
+	(void) ::listen(fd, 1024);
+	(void) ::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length);
+	return fd;
+}
+
+static MainFuture<void> Session(UringEngine& engine, int fd) {
+	UringEngine::Stream chunks { engine.RecvMultishot(fd, Group) };
+	for(;;) {
+		UringEngine::Stream::Item const item { co_await chunks.Next() };
+		if(item.result == -ENOBUFS)
+			continue;
+		if(item.result <= 0)
+			break;
+		char reply[256];
+		std::memcpy(reply, engine.BufferOf(Group, item.Buffer(), item.result).data(), item.result);
+		engine.Recycle(Group, item.Buffer());
+		(void) co_await engine.Send(fd, reply, item.result);
+	}
+	(void) co_await engine.Close(fd);
+}
+
+static MainFuture<void> Server(UringEngine& engine, int listener, std::vector<MainFuture<void>>& sessions) {
+	UringEngine::Stream connections { engine.AcceptMultishot(listener) };
+	for(int accepted {}; accepted < Clients; accepted ++) {
+		UringEngine::Stream::Item const item { co_await connections.Next() };
+		if(item.result < 0)
+			continue;
+		sessions.push_back(Session(engine, item.result));
+		sessions.back().Resume();
+	}
+}
+
+static MainFuture<void> Client(UringEngine& engine, sockaddr_in const& address, int& finished) {
+	int const fd { ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+	(void) co_await engine.Connect(fd, reinterpret_cast<sockaddr const *>(&address), sizeof address);
+	char request[32], response[32];
+	for(int round {}; round < Rounds; round ++) {
+		int const length { std::snprintf(request, sizeof request, "request %d", round) };
+		(void) co_await engine.Send(fd, request, length);
+		for(int received {}; received < length; ) {
+			int const size { co_await engine.Recv(fd, response + received, sizeof response - received) };
+			if(size <= 0)
+				co_return;
+			received += size;
+		}
+	}
+	(void) ::shutdown(fd, SHUT_WR);
+	(void) co_await engine.Recv(fd, response, 1);
+	(void) co_await engine.Close(fd);
+	finished ++;
+}
+
+static void Measure(char const* name, UringEngine::Options options) {
+	UringEngine engine { options };
+	(void) engine.RegisterBufferRing(Group, 256, 256);
+	sockaddr_in address;
+	int const listener { Listen(address) };
+	std::vector<MainFuture<void>> sessions, clients;
+	MainFuture<void> server { Server(engine, listener, sessions) };
+	server.Resume();
+
+	int finished {};
+	auto const begin 	{ Clock::now() };
+	std::size_t const before { engine.Syscalls() };
+	for(int index {}; index < Clients; index ++) {
+		clients.push_back(Client(engine, address, finished));
+		clients.back().Resume();
+	}
+	while(finished < Clients)
+		(void) engine.RunOnce();
+	double const seconds { std::chrono::duration<double>(Clock::now() - begin).count() };
+	double const requests { double(Clients) * Rounds };
+	std::printf("%-22s %12.0f req/s %10.3f enter/req\n", name, requests / seconds, (engine.Syscalls() - before) / requests);
+	(void) engine.Run();
+	(void) ::close(listener);
+}
+
+int main() {
+	if(not UringEngine::Supported()) {
+		std::puts("io_uring is not available");
+		return 0;
+	}
+	Measure("batched submission", UringEngine::Options {});
+	Measure("SQPOLL", UringEngine::Options { .sqpoll = true });
+	/* the poller thread needs a core of its own, spinning next to it on a single core only steals its time */
+	if(std::thread::hardware_concurrency() > 1)
+		Measure("SQPOLL + spinning", UringEngine::Options { .sqpoll = true, .spin = 1 << 14 });
+	return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * Sample program for the timing wheel:
+ * 		timers are scheduled just before, at and beyond one revolution of the
+ * 		root level and of the first upper level (the wheel runs at 100us per
+ * 		tick, so those are 25.6ms and 1.6384s), and each one's lateness is
+ * 		checked. The wheel is driven like an event loop drives it, so the
+ * 		number of wakeups and the CPU time they cost are reported as well
+ **/
+
+#include "../Src/Thread/TimingWheel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+using namespace Kelpa::Thread;
+using Clock = std::chrono::steady_clock;
+using std::chrono::microseconds;
+
+static constexpr microseconds 	Resolution 	{ 100 };
+static constexpr microseconds 	Tolerance 	{ 5000 };
+
+int main() {
+	TimingWheel 	wheel 	{ Resolution };
+	int 			failed 	{};
+
+	/*
+		the deadline of a timer one upper revolution out must not collapse onto
+		the current tick: with the cursor part way round the root level, aim at
+		the first upper slot the cursor sits on, 64 slots later
+	*/
+	{
+		auto const origin { Clock::now() };
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		wheel.Advance();
+		long long const tick 	{ std::chrono::duration_cast<microseconds>(Clock::now() - origin).count() / Resolution.count() };
+		long long const target 	{ (((tick >> 8) + 64) << 8) + (tick & 255) / 2 };
+		auto const handle { wheel.Schedule(Resolution * (target - tick), [] {}) };
+		auto const ahead { std::chrono::duration_cast<std::chrono::milliseconds>(wheel.NextDeadline() - Clock::now()) };
+		std::printf("next deadline for a timer %.4fs out: %lldms ahead\n", (target - tick) * 1e-4, static_cast<long long>(ahead.count()));
+		failed += ahead < std::chrono::milliseconds(1000);
+		wheel.Cancel(handle);
+	}
+
+	/* driven the way an event loop drives it: sleep until NextDeadline(), then Advance() */
+	static constexpr long long 	Delays[] 	{ 1000, 25500, 25600, 25700, 51200, 1638300, 1638400, 1638500, 1700000, 3276800 };
+	std::vector<Clock::time_point> 			due;
+	std::vector<long long> 					late(std::size(Delays), -1);
+	auto const start { Clock::now() };
+	for(std::size_t index {}; index < std::size(Delays); index ++) {
+		due.push_back(start + microseconds(Delays[index]));
+		wheel.Schedule(microseconds(Delays[index]), [&, index] {
+			late[index] = std::chrono::duration_cast<microseconds>(Clock::now() - due[index]).count();
+		});
+	}
+	std::clock_t const 	cpu 	{ std::clock() };
+	std::size_t 		wakeups {};
+	while(wheel.Size() && Clock::now() < start + std::chrono::seconds(5)) {
+		std::this_thread::sleep_until(std::min(wheel.NextDeadline(), start + std::chrono::seconds(5)));
+		wheel.Advance();
+		wakeups ++;
+	}
+	double const busy { static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC };
+	/* one per timer and one per cascade of an occupied upper slot, give or take */
+	std::printf("%zu wakeups and %.1fms of cpu over 3.3s for %zu timers\n", wakeups, busy * 1e3, std::size(Delays));
+	failed += wakeups > 4 * std::size(Delays) || busy > 0.05;
+
+	for(std::size_t index {}; index < std::size(Delays); index ++) {
+		long long const lateness { late[index] };
+		bool const 		ok 		 { lateness >= -Resolution.count() && lateness <= Tolerance.count() };
+		std::printf("  %9.1fms  fired %+8lldus late%s\n", Delays[index] / 1e3, lateness, ok ? "" : "  <- wrong");
+		failed += ! ok;
+	}
+	std::printf("%s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
@@ -1,7 +1,7 @@
 /** 
  * 		@Path 	Kelpa/Src/Compress/Huffman.hpp
  * 		@Brief	Using huffman algorithm to compress binary data
- * 		@Dependency		../Utility/ {Torrent.hpp, SelfWrap.hpp, Interfaces.hpp, Functions.hpp }
+ * 		@Dependency		../Utility/ {Torrent.hpp, SelfWrap.hpp, Interfaces.hpp, Functions.hpp, Hash.hpp }
  * 						
  *		@Since 	2024/04/25
  		@Version 1st
@@ -53,12 +53,16 @@
 }*/
 #include "../Utility/Functions.hpp"			/* imports. / { 
 	SetBitAt, 
-	GetBitAt 
+	GetBitAt,
+	Distance 
 }*/
 #include "../Utility/Interfaces.hpp"		/* imports ./ { 
 	struct Writer, 
 	struct Reader 
 }*/
+#include "../Utility/Hash.hpp"				/* imports ./ { 
+	HashWord 
+}*/
 namespace Kelpa {
 namespace Compress {
 namespace Detail {
@@ -303,7 +307,7 @@ auto Writer<InputIt, OutputIt>::Write(CodingSheet const& sheet) noexcept
 			Utility::SetBitAt(byte, index ++, 0x00);
 		* out ++ = byte;
 	}
-	return std::distance(out_, out);
+	return Utility::Distance(out_, out);
 }
 
 template <
@@ -386,7 +390,7 @@ auto Reader<InputIt, OutputIt>::Read() noexcept
 	if(Detail::Node::Dangling(* p)) 
 		* out ++ = (* p).character;
 		
-	return std::distance(out_, out);
+	return Utility::Distance(out_, out);
 }
 }	//namespace Huffman	
 }	//namespace Compress	
@@ -396,7 +400,7 @@ namespace std {
 
 template <> struct hash<typename Kelpa::Compress::Huffman::CodingSheet::code_type> {
 	std::size_t operator()(typename Kelpa::Compress::Huffman::CodingSheet::code_type const& code) const noexcept {
-		return std::hash<unsigned short>{} (code.bytes) | std::hash<unsigned char>{} (code.length);
+		return Kelpa::Utility::HashWord(static_cast<std::uint64_t>(code.bytes) << 8 | code.length);
 	}
 };
 
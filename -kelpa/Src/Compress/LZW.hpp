@@ -1,7 +1,7 @@
 /** 
  * 		@Path 	Kelpa/Src/Compress/LZW.hpp
  * 		@Brief	Using LZW algorithm to compress text data
- * 		@Dependency		../Utility/Interfaces.hpp
+ * 		@Dependency		../Utility/Interfaces.hpp, ../Utility/Functions.hpp
  * 						
  *		@Since 	2024/04/25
  		@Version 1st
@@ -39,6 +39,9 @@
 	struct Reader, 
 	struct Writer
 }*/
+#include "../Utility/Functions.hpp"	/* imports ./ { 
+	Distance()
+}*/
 namespace Kelpa 	{
 namespace Compress 	{
 namespace Detail {	
@@ -143,7 +146,7 @@ auto Writer<InputIt, OutputIt>::Write() noexcept
 		Pattern.erase(std::prev(Pattern.end()));
 		* out ++ = Dict.Container[Dict.WhereSeq[Pattern]].code;
 	}	 
-	return std::distance(out_, out);
+	return Utility::Distance(out_, out);
 }
 
 template <
@@ -201,7 +204,7 @@ auto Reader<InputIt, OutputIt>::Read() noexcept
 		for(auto Char: Current) 
 			* out ++ = Char;
 	}
-	return std::distance(out_, out);
+	return Utility::Distance(out_, out);
 }
 
 
@@ -2,7 +2,7 @@
  * 		@Path 	Kelpa/Src/Compress/Huffman.hpp
  * 		@Brief	This module compresses unsigned integers using 
  * 				protobuf's varint compression algorithm
- * 		@Dependency		None
+ * 		@Dependency		../Utility/Functions.hpp
  * 						
  *		@Since 	2024/04/25
  		@Version 1st
@@ -27,6 +27,9 @@
 		std::output_iterator
 	}
 }*/
+#include "../Utility/Functions.hpp"	/* imports ./ { 
+	Distance()
+}*/
 namespace Kelpa {
 namespace Compress {
 	
@@ -34,12 +37,13 @@ namespace Compress {
 template <std::unsigned_integral T>	std::vector<unsigned char> ToVarint(T value) noexcept {
 	std::vector<unsigned char> result;
 	
-	while(value) {
+	/* seven bits a byte, the high bit says more follow; zero is one byte */
+	do {
 		unsigned char byte = value & 0x7F;
-		value >>= 0x08;
+		value >>= 0x07;
 		if(value) byte |= 0x80;
 		result.emplace_back(byte);
-	}
+	} while(value);
 	return result;
 }
 template <std::unsigned_integral T, std::output_iterator<unsigned char> OutputIt> 
@@ -47,20 +51,21 @@ auto ToVarint(T value, OutputIt first, OutputIt last = OutputIt()) noexcept
 	-> typename std::iterator_traits<OutputIt>::difference_type {
 	
 	auto begin = first;
-	while(value && first != last) {
+	while(first != last) {
 		unsigned char byte = value & 0x7F;
-		value >>= 0x08;
+		value >>= 0x07;
 		if(value) byte |= 0x80;
 		* first ++ = byte;
+		if(! value) break;
 	}	
-	return std::distance(begin, first);
+	return Utility::Distance(begin, first);
 }	
 template <std::unsigned_integral T = unsigned int>	T FromVarint(std::vector<unsigned char> const& v) noexcept {
-	unsigned int 	result 	{};
+	T 				result 	{};
 	signed int 		shift 	{};
 	for(auto byte: v) {
-		result |= (byte & 0x7F) << shift;
-		shift += 0x08;
+		result |= static_cast<T>(byte & 0x7F) << shift;
+		shift += 0x07;
 		if(!(byte & 0x80)) break;
 	}
 	return result;
@@ -68,12 +73,12 @@ template <std::unsigned_integral T = unsigned int>	T FromVarint(std::vector<unsi
 template <std::unsigned_integral T = unsigned int, std::input_iterator InputIt> 
 	requires std::convertible_to<typename std::iterator_traits<InputIt>::value_type, unsigned char>
 T FromVarint(InputIt first, InputIt last = InputIt()) noexcept {
-	unsigned int 	result 	{};
+	T 				result 	{};
 	signed int 		shift 	{};
 	while(first != last) {
 		auto byte = * first ++;
-		result |= (byte & 0x7F) << shift;
-		shift += 0x08;
+		result |= static_cast<T>(byte & 0x7F) << shift;
+		shift += 0x07;
 		if(!(byte & 0x80)) break;
 	}
 	return result;	
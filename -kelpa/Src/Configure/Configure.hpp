@@ -3,6 +3,7 @@
  * 		@Brief	The configuration pool of configuration variables 
  * 				in the unified management system that supports CRUD operations
  * 		@Dependency		./ { Variable.hpp }
+ * 						../Thread/Snapshot.hpp
  * 						../CppJson/Node.hpp
  * 						../Utility/Error.h
  * 		@Since	2024/04/24
@@ -28,8 +29,11 @@
 	std::unordered_map 
 }*/
 #include <memory>					/* imports ./ { 
-	std::unique_ptr, 
-	std::make_unique 
+	std::shared_ptr, 
+	std::make_shared 
+}*/
+#include "../Thread/Snapshot.hpp"	/* imports ./ { 
+	struct Snapshot 
 }*/
 #include "../Journal/Journal.hpp"		/* imports ./ { 
 	#define Manager__(), 
@@ -59,8 +63,8 @@ struct 						Configure {
 		std::string const&		description
 	) 														noexcept;
 	
-	static std::size_t 	Size() noexcept { 		return variables.size();		}
-	static bool 		Empty() noexcept { 		return variables.empty();		}
+	static std::size_t 	Size() noexcept { 		return variables.Visit([] (Registry const& registry) { return registry.size(); });		}
+	static bool 		Empty() noexcept { 		return variables.Visit([] (Registry const& registry) { return registry.empty(); });		}
 	
 	template <typename T> static constexpr 
 	bool Remove(std::string const& identifier) 				noexcept;
@@ -71,9 +75,18 @@ struct 						Configure {
 	static constexpr void Load(CppJson::Node const& root) 	noexcept;
 
 private:
-	static std::unordered_map<std::string, std::unique_ptr<Detail::VariableBase>> 	variables;
+	typedef std::unordered_map<std::string, std::shared_ptr<Detail::VariableBase>> 	Registry;
+	/* looked up on every request, rewritten only when a variable is added or removed */
+	static Thread::Snapshot<Registry> 												variables;
+	
+	static std::shared_ptr<Detail::VariableBase> Find(std::string const& identifier) noexcept {
+		return variables.Visit([&] (Registry const& registry) -> std::shared_ptr<Detail::VariableBase> {
+			auto iterator = registry.find(identifier);
+			return iterator == registry.end() ? nullptr : iterator -> second;
+		});
+	}
 };
-std::unordered_map<std::string, std::unique_ptr<Detail::VariableBase>> 				Configure::variables {};
+Thread::Snapshot<Configure::Registry> 												Configure::variables {};
 
 
 
@@ -89,23 +102,27 @@ template <typename T> constexpr std::reference_wrapper<Variable<T>> Configure::E
 	
 	std::transform(identifier.begin(), identifier.end(), identifier.begin(), ::tolower);
 	
-	if(! variables.contains(identifier)) 
-		variables.emplace(identifier, std::unique_ptr<Detail::VariableBase>(new Variable<T>{ identifier, value, description }));
-	Assert__((* variables[identifier]).HashCode() == std::type_index(typeid(T)).hash_code(), "bad access") 
+	auto variable = Find(identifier);
+	if(! variable) 
+		variable = variables.Update([&] (Registry& registry) {
+			return registry.try_emplace(identifier, std::make_shared<Variable<T>>(identifier, value, description)).first -> second;
+		});
+	Assert__((* variable).HashCode() == std::type_index(typeid(T)).hash_code(), "bad access") 
 	
-	return std::ref(reinterpret_cast<Variable<T> &>(* variables[identifier]));		
+	return std::ref(reinterpret_cast<Variable<T> &>(* variable));		
 }
 
 template <typename T> constexpr bool Configure::Remove(std::string const& identifier) noexcept {
-	return static_cast<bool>(variables.erase(identifier));
+	return static_cast<bool>(variables.Update([&] (Registry& registry) { return registry.erase(identifier); }));
 }
 
 template <typename T> constexpr std::optional<std::reference_wrapper<Variable<T>>> Configure::LookUp(std::string identifier) noexcept {
 	std::transform(identifier.begin(), identifier.end(), identifier.begin(), ::tolower);
 	
-	if(! variables.contains(identifier) || (* variables[identifier]).HashCode() != std::type_index(typeid(T)).hash_code()) 	
+	auto variable = Find(identifier);
+	if(! variable || (* variable).HashCode() != std::type_index(typeid(T)).hash_code()) 	
 		return std::nullopt;
-	return std::ref(reinterpret_cast<Variable<T> &>(* variables[identifier])); 
+	return std::ref(reinterpret_cast<Variable<T> &>(* variable)); 
 }
 
 constexpr void Configure::Load(CppJson::Node const& root) noexcept {
@@ -144,7 +161,7 @@ struct LogConfigWatcher {
 	static Configure::Variable<CppJson::Array> const& 	Handle;
 	static std::size_t 									ListenID;
 
-	constexpr LogConfigWatcher() 	noexcept;
+	LogConfigWatcher() 			noexcept;
 };
 Configure::Variable<CppJson::Array> const& LogConfigWatcher::Handle = Configure::Configure::Emplace<CppJson::Array>(
 	"logs",
@@ -173,7 +190,7 @@ std::size_t LogConfigWatcher::ListenID = LogConfigWatcher::Handle.Listen(
 		std::puts("GlobalLogListen CallBack Function");
 	});	
 	
-constexpr LogConfigWatcher::LogConfigWatcher() noexcept {
+LogConfigWatcher::LogConfigWatcher() noexcept {
 	auto ParseAppender = [&] (CppJson::Object const& object) mutable -> Journal::Appender::shared_pointer {
 		Assert__(object.contains("type"), "CONFIG FILE CONTENT MISSING TYPE FILED"); 
 		Assert__(object.at("type").Holds<CppJson::Integer>(), "CONFIG FILE TYPE FIELD NOT INTEGER"); 
@@ -230,8 +247,10 @@ constexpr LogConfigWatcher::LogConfigWatcher() noexcept {
 		}
 		return logger;
 	};
-	for(auto const& object: Handle.value) 
-		GlobalManager__().Bind(ParseLogger(object.As<CppJson::Object>()));
+	Handle.Visit([&] (CppJson::Array const& objects) {
+		for(auto const& object: objects) 
+			GlobalManager__().Bind(ParseLogger(object.As<CppJson::Object>()));
+	});
 }	
 
 
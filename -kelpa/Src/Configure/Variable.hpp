@@ -1,7 +1,7 @@
 /** 
  * 		@Path 	Kelpa/Src/Configure/Varianble.hpp
  * 		@Brief	Defines the type of variable that describes the current configuration information
- * 		@Dependency		None
+ * 		@Dependency		../Thread/ { Snapshot.hpp, SeqLock.hpp }
  * 		@Since	2024/04/24
  * 		@Version 1st
  **/
@@ -23,6 +23,22 @@
 #include <utility>						/* imports ./ { 
 	std::exchange 
 }*/
+#include <unordered_map>				/* imports ./ { 
+	std::unordered_map 
+}*/
+#include <mutex>						/* imports ./ { 
+	std::mutex, 
+	std::lock_guard 
+}*/
+#include <type_traits>					/* imports ./ { 
+	std::is_trivially_copyable_v 
+}*/
+#include "../Thread/Snapshot.hpp"		/* imports ./ { 
+	struct Snapshot 
+}*/
+#include "../Thread/SeqLock.hpp"		/* imports ./ { 
+	struct SeqLock 
+}*/
 namespace Kelpa {
 namespace Configure {
 namespace Detail {
@@ -30,6 +46,16 @@ struct						 VariableBase {
 	virtual ~VariableBase() 		noexcept 		= default;
 	virtual std::size_t HashCode() 	const noexcept 	= 0;
 };
+
+/* 
+	values are read on every request and written almost never: small plain 
+	values sit behind a seqlock, everything else behind an RCU snapshot 
+*/
+template <typename T, bool = std::is_trivially_copyable_v<T> && sizeof(T) <= 64> 
+struct 						VariableStorageOf 			{ 	typedef Thread::Snapshot<T> 	type; 	};
+template <typename T> 
+struct 						VariableStorageOf<T, true> 	{ 	typedef Thread::SeqLock<T> 		type; 	};
+template <typename T> using VariableStorage = typename VariableStorageOf<T>::type;
 }
 	
 template <typename T> struct Variable: Detail::VariableBase {
@@ -45,38 +71,47 @@ template <typename T> struct Variable: Detail::VariableBase {
 		std::string const& 		__description
 	) noexcept: identifier(__identifier), value(__value), description(__description) {}
 	
-	template <typename U> T Exchange(U&& new_value) 
-	noexcept(
-	    std::is_nothrow_move_constructible_v<T> 
-	&&  std::is_nothrow_assignable_v<T&, U>
-	) {
+	template <typename U> requires std::constructible_from<T, U> T Exchange(U&& new_value) {
+		T 			next 		{ std::forward<U>(new_value) };
+		T const 	previous 	{ value.Exchange(next) };
+		std::lock_guard guard { mutex };
 		for(auto& [dummy, func]: callbacks) 
-			std::invoke(func, value, std::forward<U>(new_value));
-		return std::exchange(value, std::forward<U>(new_value));
+			std::invoke(func, previous, next);
+		return previous;
 	}
 	
+	/* copies the current value out */
+	T 						Load() const 	{ 	return value.Load(); 		}
+	/* runs `f` against the current value without copying it where possible */
+	template <typename F> requires std::invocable<F, T const&>
+	decltype(auto) 			Visit(F&& f) const 	
+	{ 	return value.Visit(std::forward<F>(f));		}
+	
 	virtual std::size_t 	HashCode() const noexcept override 
 	{  	return std::type_index(typeid(T)).hash_code();			}
 	
 	template <typename F> requires std::invocable<F, T const&, T const&>
-	constexpr std::size_t 	Listen(F&& f) const noexcept {
-		callbacks.emplace(count, [&] (T const& old_value, T const& new_value) { 
-			(void) std::invoke(std::forward<F>(f), old_value, new_value);
+	std::size_t 			Listen(F&& f) const noexcept {
+		std::lock_guard guard { mutex };
+		callbacks.emplace(count, [f = std::forward<F>(f)] (T const& old_value, T const& new_value) mutable { 
+			(void) std::invoke(f, old_value, new_value);
 		});
 		return std::exchange(count, count + 1);
 	} 
-	constexpr bool		 	Cancel(std::size_t indexer) const noexcept 
-	{ 	return static_cast<bool>(callbacks.erase(indexer));		}
+	bool		 			Cancel(std::size_t indexer) const noexcept {
+		std::lock_guard guard { mutex };
+		return static_cast<bool>(callbacks.erase(indexer));		
+	}
 
-	constexpr operator T const&() const noexcept 	{ return value;	}
-	constexpr operator T &() noexcept 				{ return value;	}
+	operator T() const 		{ 	return value.Load();	}
 	
+	mutable std::mutex 					mutex;
 	mutable std::size_t 				count {};
 	mutable std::unordered_map<std::size_t, std::function<void(T const&, T const&)>> 
 										callbacks;
 										
 	std::string 						identifier;	
-	T 									value;
+	Detail::VariableStorage<T> 			value;
 	std::string							description;
 };	
 	
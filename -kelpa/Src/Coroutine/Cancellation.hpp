@@ -0,0 +1,173 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Cancellation.hpp
+ * 		@Brief	Cooperative cancellation for coroutines: tokens carried by the
+ * 				promises and inherited by every coroutine they await, and the
+ * 				hooks that let a suspended wait give up when its token fires
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_CANCELLATION_HPP__
+#define __KELPA_COROUTINE_CANCELLATION_HPP__
+
+#include <coroutine>				/* imports ./ {
+	std::coroutine_handle
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <concepts>					/* imports ./ {
+	std::convertible_to,
+	std::invocable
+}*/
+#include <functional>				/* imports ./ {
+	std::function
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <stop_token>				/* imports ./ {
+	std::stop_source,
+	std::stop_token,
+	std::stop_callback
+}*/
+#include <utility>					/* imports ./ {
+	std::move,
+	std::forward
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	CancellationSource source;
+	task.Promise().token = source.Token();
+	...
+	source.Cancel();
+
+	Built on std::stop_source: Cancel() runs the registered callbacks on the
+	cancelling thread, and a callback that is deregistered while it runs
+	waits for it to return, which is what lets a wait hand its coroutine
+	over to the canceller without racing the wakeup it was waiting for.
+	Cancellation is a request: nothing is interrupted, the waits that see
+	the token give up early and report it, and code in between asks
+	Cancelled() when it wants to
+*/
+struct CancellationToken {
+	CancellationToken() noexcept = default;
+	explicit CancellationToken(std::stop_token token) noexcept: token(std::move(token)) {}
+
+	bool 	Cancelled() 	const noexcept 	{ 	return token.stop_requested(); 	}
+	/* false for the empty token, which nothing can cancel */
+	bool 	Cancellable() 	const noexcept 	{ 	return token.stop_possible(); 	}
+
+	std::stop_token const& Native() const noexcept { 	return token; 	}
+private:
+	std::stop_token 	token;
+};
+
+struct CancellationSource {
+	CancellationSource() 							= default;
+	/* cancelled along with parent */
+	explicit CancellationSource(CancellationToken const& parent): CancellationSource()
+	{	Link(parent);	}
+	CancellationSource(CancellationSource const&) 			= delete;
+	CancellationSource& operator=(CancellationSource const&) = delete;
+
+	/* true for the call that cancelled it */
+	bool 				Cancel() 			noexcept 	{ 	return source.request_stop(); 	}
+	bool 				Cancelled() const 	noexcept 	{ 	return source.stop_requested(); 	}
+	CancellationToken 	Token() 	const 	noexcept 	{ 	return CancellationToken { source.get_token() }; 	}
+
+	/* from now on also cancelled along with parent; a source follows one parent, linking again replaces it */
+	void 				Link(CancellationToken const& parent) {
+		link.reset();
+		if(parent.Cancellable())
+			(void) link.emplace(parent.Native(), Forward { source });
+	}
+private:
+	struct Forward {
+		void operator()() noexcept { 	(void) source.request_stop(); 	}
+		std::stop_source 	source;
+	};
+
+	std::stop_source 								source;
+	std::optional<std::stop_callback<Forward>> 		link;
+};
+
+/* the token of the promise behind a coroutine, empty for promises that carry none */
+struct Cancellable {
+	CancellationToken 	token 	{};
+};
+
+template <typename Promise>
+CancellationToken TokenOf(std::coroutine_handle<Promise> coroutine) noexcept {
+	if constexpr (requires { { coroutine.promise().token } -> std::convertible_to<CancellationToken>; })
+		return coroutine.promise().token;
+	else
+		return {};
+}
+
+/*
+	CancellationToken const token { co_await ThisToken() };
+	CancellationToken const outer { co_await BindToken(source.Token()) };
+
+	Read, or replace, the token of the awaiting coroutine without suspending
+	it; a replaced token is what the coroutine's later awaits inherit
+*/
+struct TokenAwaitable {
+	constexpr bool 	await_ready() 	const noexcept { 	return false; 	}
+	template <typename Promise>
+	bool 			await_suspend(std::coroutine_handle<Promise> coroutine) noexcept {
+		if constexpr (requires { coroutine.promise().token; }) {
+			previous = coroutine.promise().token;
+			if(replacement)
+				coroutine.promise().token = std::move(* replacement);
+		}
+		return false;
+	}
+	CancellationToken await_resume() noexcept 	{ 	return std::move(previous); 	}
+
+	std::optional<CancellationToken> 	replacement {};
+	CancellationToken 					previous 	{};
+};
+
+inline TokenAwaitable ThisToken() noexcept 							{ 	return {}; 	}
+inline TokenAwaitable BindToken(CancellationToken token) noexcept 	{ 	return { .replacement = std::move(token) }; 	}
+
+/*
+	struct State: CancellableWait { ... };
+	auto const state { std::make_shared<State>() };
+	...register the wakeup, which resumes only if state -> Claim()...
+	state -> Arm(token, [raw = state.get()] { if(raw -> Claim()) ...undo the wakeup, post the coroutine... });
+
+	The shared part of a wait that may end either by its event or by its
+	token. Whichever side Claim()s first resumes the coroutine and the other
+	does nothing. The wakeup keeps the state alive through a copy, the
+	cancellation through the awaitable, which is why the callback captures a
+	plain pointer: destroying the state deregisters it, waiting for it to
+	return if it is running. Arm() runs the callback at once when the token
+	has already fired, on the arming thread and inside await_suspend, so the
+	callback posts the coroutine rather than resuming it
+*/
+struct CancellableWait {
+	CancellableWait() 									= default;
+	CancellableWait(CancellableWait const&) 			= delete;
+	CancellableWait& operator=(CancellableWait const&) 	= delete;
+
+	/* true for the one caller that gets to resume the coroutine */
+	bool 	Claim() noexcept 	{ 	return not claimed.exchange(true, std::memory_order_acq_rel); 	}
+
+	template <typename F> requires std::invocable<F>
+	void 	Arm(CancellationToken const& token, F&& f)
+	{	(void) callback.emplace(token.Native(), std::function<void()> { std::forward<F>(f) });	}
+private:
+	std::atomic<bool> 										claimed 	{ false };
+	std::optional<std::stop_callback<std::function<void()>>> 	callback;
+};
+
+}
+}
+
+#endif
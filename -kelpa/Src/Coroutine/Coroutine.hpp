@@ -1,7 +1,8 @@
 /** 
  * 		@Path 	Kelpa/Src/Coroutine/Coroutine.hpp
  * 		@Brief	A variety of encapsulated Awaitable/Promise/Future objects with certain properties
- * 		@Dependency	../Utility/ { Ignore.hpp, VoidGuard.hpp, Deferrable.hpp }
+ * 		@Dependency	./ { Frame.hpp, Cancellation.hpp }
+ * 					../Utility/ { Ignore.hpp, VoidGuard.hpp, Deferrable.hpp }
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
@@ -22,6 +23,15 @@
 #include <map>						/* imports ./ { 
 	std::multimap 
 }*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <limits>					/* imports ./ {
+	std::numeric_limits
+}*/
+#include <span>						/* imports ./ {
+	std::span
+}*/
 #include <thread>					/* imports ./ { 
 	std::this_thread::sleep_xxx 
 }*/
@@ -40,9 +50,21 @@
 	concept Awaitable, 
 	concept Utility::Awaiter 
 }*/
+#include "./Frame.hpp"				/* imports ./ {
+	struct PooledFrame
+}*/
+#include "./Cancellation.hpp"		/* imports ./ {
+	struct Cancellable,
+	struct CancellationSource,
+	TokenOf
+}*/
 #include "./Generator.hpp"			/* imports ./ { 
 	struct Generator 
 }*/
+#include "./Synchronize.hpp"		/* imports ./ { 
+	struct AsyncSemaphore, 
+	struct AsyncLatch 
+}*/
 namespace Kelpa {
 namespace Coroutine {
 	
@@ -83,7 +105,7 @@ struct SleepAwaitable {
 /*
 	##Promises
 */
-template <typename T = void> struct MainPromise {
+template <typename T = void> struct MainPromise: PooledFrame, Cancellable {
 	constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
 	
 	constexpr FinalSwapinAwaitable final_suspend() const noexcept { return { coroutine }; }
@@ -101,7 +123,7 @@ template <typename T = void> struct MainPromise {
 	constexpr std::coroutine_handle<MainPromise<T>> get_return_object() noexcept {
 		return std::coroutine_handle<MainPromise<T>>::from_promise(*this);
 	}
-	constexpr decltype(auto) TryFetch() noexcept {
+	constexpr decltype(auto) TryFetch() {
 		if(exception) [[unlikely]] std::rethrow_exception(exception);
 		return value.Refer();
 	}
@@ -110,7 +132,7 @@ template <typename T = void> struct MainPromise {
 	std::exception_ptr 		exception {};
 	Utility::Deferrable<T>			value;
 };
-template <> struct MainPromise<void> {
+template <> struct MainPromise<void>: PooledFrame, Cancellable {
 	constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
 	
 	constexpr FinalSwapinAwaitable final_suspend() const noexcept { return { coroutine }; }
@@ -122,13 +144,16 @@ template <> struct MainPromise<void> {
 	std::coroutine_handle<MainPromise<void>> get_return_object() noexcept {
 		return std::coroutine_handle<MainPromise<void>>::from_promise(*this);
 	}
-	constexpr decltype(auto) TryFetch() const noexcept { return Utility::VoidGuard<void> {}; }
+	decltype(auto) TryFetch() const {
+		if(exception) [[unlikely]] std::rethrow_exception(exception);
+		return Utility::VoidGuard<void> {};
+	}
 	
 	std::coroutine_handle<> coroutine {}; 
 	std::exception_ptr 		exception {};
 };
 
-struct ReturnCatchPromise {
+struct ReturnCatchPromise: PooledFrame, Cancellable {
 	constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
 	
 	constexpr FinalSwapinAwaitable final_suspend() const noexcept { return { coroutine }; }
@@ -145,7 +170,7 @@ struct ReturnCatchPromise {
 	std::coroutine_handle<> coroutine;
 };
 
-template <typename T, typename = std::enable_if_t<!std::same_as<T, void>>> struct RecursiveYieldedPromise {
+template <typename T, typename = std::enable_if_t<!std::same_as<T, void>>> struct RecursiveYieldedPromise: PooledFrame {
 	constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
 	
 	constexpr FinalSwapinAwaitable final_suspend() const noexcept { return { coroutine }; }
@@ -193,10 +218,16 @@ template <typename T = void> struct MainFuture {
 	MainFuture(MainFuture const&) 					= delete;
 	MainFuture& operator=(MainFuture const&) 		= delete;
 	
-	constexpr MainFuture(MainFuture &&) 			noexcept = default;
-	constexpr MainFuture& operator=(MainFuture&&) 	noexcept = default;
+	constexpr MainFuture(MainFuture&& other) 		noexcept: coroutine(std::exchange(other.coroutine, {})) {}
+	constexpr MainFuture& operator=(MainFuture&& other) noexcept {
+		if(this != std::addressof(other)) {
+			if(coroutine) coroutine.destroy();
+			coroutine = std::exchange(other.coroutine, {});
+		}
+		return *this;
+	}
 	
-	~MainFuture() noexcept { if(not coroutine); return; coroutine.destroy(); }
+	~MainFuture() noexcept { if(coroutine) coroutine.destroy(); }
 
 	constexpr MainFuture const& operator()() const noexcept 
 	{ 	coroutine.operator()(); return *this; 	}
@@ -212,18 +243,23 @@ template <typename T = void> struct MainFuture {
 
 	constexpr bool Final() const noexcept { return coroutine.done();	}
 
-	constexpr decltype(auto) TryFetch() const noexcept 
+	constexpr decltype(auto) TryFetch() const 
 	{	return coroutine.promise().TryFetch();	}
 
-	constexpr decltype(auto) TryFetch() noexcept 
+	constexpr decltype(auto) TryFetch() 
 	{	return const_cast<T&>(std::as_const(*this).TryFetch());	}
 		
 	struct SelfAwaitable {
 		constexpr bool await_ready() const noexcept 
 		{ 	return false; 							}
-		constexpr std::coroutine_handle<> await_suspend(std::coroutine_handle<> __coroutine) noexcept 
-		{	coroutine.promise().coroutine = __coroutine; return coroutine;	}
-		constexpr decltype(auto) await_resume() const noexcept 
+		/* a coroutine started without a token of its own inherits the awaiting one's */
+		template <typename Promise>
+		constexpr std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> __coroutine) noexcept {
+			if(not coroutine.promise().token.Cancellable())
+				coroutine.promise().token = TokenOf(__coroutine);
+			coroutine.promise().coroutine = __coroutine; return coroutine;
+		}
+		constexpr decltype(auto) await_resume() const 
 		{	return coroutine.promise().TryFetch();	 }
 		std::coroutine_handle<MainPromise<T>> coroutine;
 	};
@@ -285,18 +321,23 @@ U> const&) noexcept;
 
 	constexpr bool Final() const noexcept { return coroutine.done();	}
 
-	constexpr decltype(auto) TryFetch() const noexcept 
+	constexpr decltype(auto) TryFetch() const 
 	{	return coroutine.promise().TryFetch();	}
 
-	constexpr decltype(auto) TryFetch() noexcept 
+	constexpr decltype(auto) TryFetch() 
 	{	return const_cast<T&>(std::as_const(*this).TryFetch());	}
 		
 	struct SelfAwaitable {
 		constexpr bool await_ready() const noexcept 
 		{ 	return false; 							}
-		constexpr std::coroutine_handle<> await_suspend(std::coroutine_handle<> __coroutine) noexcept 
-		{	coroutine.promise().coroutine = __coroutine; return coroutine;	}
-		constexpr decltype(auto) await_resume() const noexcept 
+		/* a coroutine started without a token of its own inherits the awaiting one's */
+		template <typename Promise>
+		constexpr std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> __coroutine) noexcept {
+			if(not coroutine.promise().token.Cancellable())
+				coroutine.promise().token = TokenOf(__coroutine);
+			coroutine.promise().coroutine = __coroutine; return coroutine;
+		}
+		constexpr decltype(auto) await_resume() const 
 		{	return coroutine.promise().TryFetch();	 }
 		std::coroutine_handle<MainPromise<T>> coroutine;
 	};
@@ -330,11 +371,16 @@ struct DirectedFuture {
 	DirectedFuture(DirectedFuture const&) 					= delete;
 	DirectedFuture& operator=(DirectedFuture const&) 		= delete;
 	
-	constexpr DirectedFuture(DirectedFuture &&) 			noexcept = default;
-	constexpr DirectedFuture& operator=(DirectedFuture&&) 	noexcept = default;
-	
+	constexpr DirectedFuture(DirectedFuture&& other) 		noexcept: coroutine(std::exchange(other.coroutine, {})) {}
+	constexpr DirectedFuture& operator=(DirectedFuture&& other) noexcept {
+		if(this != std::addressof(other)) {
+			if(coroutine) coroutine.destroy();
+			coroutine = std::exchange(other.coroutine, {});
+		}
+		return *this;
+	}
 
-	~DirectedFuture() noexcept { 	if(not coroutine); return; coroutine.destroy();	}
+	~DirectedFuture() noexcept { 	if(coroutine) coroutine.destroy();	}
 
 	void Direct() const noexcept { 	coroutine.operator()();	}
 
@@ -408,43 +454,87 @@ MainFuture<void> AwaitableSleepFor(std::chrono::duration<Rep,Period> const& dura
 {	co_return (void) (co_await SleepAwaitable { std::chrono::high_resolution_clock::now() + duration });	}
 
 
+/*
+	auto [user, orders] = co_await WhenAllOf(FetchUser(id), FetchOrders(id));
+	auto const fastest  = co_await WhenAnyOf(Query(primary), Query(replica));
+
+	Every awaitable runs in a sub-fiber of its own, under a token linked to
+	the awaiting coroutine's. WhenAllOf resumes the caller once all of them
+	have finished; the first exception cancels the others and is rethrown.
+	WhenAnyOf settles on the first one to finish, with a value or an
+	exception, cancels the others and still waits for them to return, so
+	that their frames, and the awaitables moved into it, are released before
+	the caller resumes instead of staying suspended on a timer or a socket.
+	How soon a loser returns depends on what it waits for: the waits of
+	Runtime and the reactors give up when cancelled, plain computation runs
+	to its end. Awaitables passed as lvalues are awaited in place and must
+	outlive the call, rvalues are moved in
+*/
 struct ControlBlock {
-	std::size_t 			index { std::numeric_limits<std::size_t>::max() };
-	std::exception_ptr		exception {};
-	std::coroutine_handle<> coroutine {};
+	explicit ControlBlock(CancellationToken const& parent, std::size_t count): remaining(count), source(parent) {}
+
+	std::atomic<std::size_t> 	remaining;
+	std::atomic<std::size_t> 	index 		{ std::numeric_limits<std::size_t>::max() };
+	std::exception_ptr			exception 	{};
+	std::coroutine_handle<> 	coroutine 	{};
+	CancellationSource 			source;
 };
 
-template <std::size_t...Indices, typename...Awaitables> 
-constexpr MainFuture<std::tuple<	Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type>...	> > 
-AuxWhenAllOf(std::index_sequence<Indices ...>, Awaitables&&... awaitables) noexcept;
+/* 
+	A sub-fiber's last stop, never resumed: it is counted out only once suspended, 
+	so the caller that the last one resumes may destroy every sub-fiber at once
+*/
+struct LeaveAwaitable {
+	constexpr bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<>) const noexcept {
+		ControlBlock& control { ControlRefer.get() };
+		return control.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 ? control.coroutine : std::noop_coroutine();
+	}
+	constexpr void await_resume() const noexcept {}
+	std::reference_wrapper<ControlBlock> 	ControlRefer;
+};
+
+template <typename T>
+using AwaitedType = Utility::VoidGuardType<typename AwaitableTraits<std::remove_cvref_t<T>>::type>;
+
+template <typename...Awaitables, std::size_t...Indices> 
+MainFuture<std::tuple<	AwaitedType<Awaitables>...	> > 
+AuxWhenAllOf(std::index_sequence<Indices ...>, Awaitables... awaitables);
 
 template <Utility::Awaitable... Awaitables> requires ((bool) sizeof...(Awaitables)) 
-constexpr decltype(auto) WhenAllOf(Awaitables... awaitables) noexcept 
-{	return AuxWhenAllOf(std::make_index_sequence<sizeof...(Awaitables)>(), std::forward<Awaitables>(awaitables) ...);	}
+decltype(auto) WhenAllOf(Awaitables&&... awaitables) 
+{	return AuxWhenAllOf<Awaitables...>(std::index_sequence_for<Awaitables...>(), std::forward<Awaitables>(awaitables) ...);	}
 
-template<typename Ret> constexpr DirectedFuture CoawaitOneForAll(auto const& awaitable, ControlBlock& controlRefer, Utility::Deferrable<Ret>& result) noexcept;
 struct WhenAllOrAnyAwaitable;
 
-template <std::size_t...Indices, typename...Awaitables> 
-constexpr MainFuture<std::tuple<	Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type>...		> > 
-AuxWhenAllOf(std::index_sequence<Indices ...>, Awaitables&&... awaitables) noexcept {
-	ControlBlock Control { .index = sizeof...(Awaitables) };
+template<typename Ret, typename Awaitable> DirectedFuture CoawaitOneForAll(Awaitable awaitable, ControlBlock& controlRefer, Utility::Deferrable<Ret>& result) {
+	try { 	
+		if constexpr (std::same_as<typename AwaitableTraits<std::remove_cvref_t<Awaitable>>::type, void>) 
+			co_await std::forward<Awaitable>(awaitable), (void) result.Emplace(std::ignore);
+		else 
+			(void) result.Emplace(co_await std::forward<Awaitable>(awaitable));
+	} catch(...) {
+		/* the first failure cancels the rest */
+		if(std::size_t expected { std::numeric_limits<std::size_t>::max() }; controlRefer.index.compare_exchange_strong(expected, 0, std::memory_order_acq_rel))
+			controlRefer.exception = std::current_exception(), (void) controlRefer.source.Cancel();
+	}
+	co_await LeaveAwaitable { std::ref(controlRefer) };
+	co_return std::noop_coroutine();
+}
 
-	std::tuple<Utility::Deferrable<		Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type>	>...> ResultPack;
+template <typename...Awaitables, std::size_t...Indices> 
+MainFuture<std::tuple<	AwaitedType<Awaitables>...	> > 
+AuxWhenAllOf(std::index_sequence<Indices ...>, Awaitables... awaitables) {
+	CancellationToken const Parent { co_await ThisToken() };
+	ControlBlock Control { Parent, sizeof...(Awaitables) };
 
-	DirectedFuture SubFiberArray[] { CoawaitOneForAll(std::forward<Awaitables>(awaitables), Control, std::get<Indices>(ResultPack)) ...};
+	std::tuple<Utility::Deferrable<		AwaitedType<Awaitables>	>...> ResultPack;
 
-	co_await WhenAllOrAnyAwaitable {	.ControlRefer = std::ref(Control), .SubFiberSpan = SubFiberArray };
+	DirectedFuture SubFiberArray[] { CoawaitOneForAll<AwaitedType<Awaitables>, Awaitables>(std::forward<Awaitables>(awaitables), Control, std::get<Indices>(ResultPack)) ...};
 
-	co_return std::tuple<	Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type>...		> { std::get<Indices>(ResultPack).Move() ... };
-}
+	co_await WhenAllOrAnyAwaitable {	.ControlRefer = std::ref(Control), .SubFiberSpan = SubFiberArray };
 
-template<typename Ret> constexpr DirectedFuture CoawaitOneForAll(auto&& awaitable, ControlBlock& controlRefer, Utility::Deferrable<Ret>& result) noexcept {
-	try { 	result.Emplace(co_await std::forward<decltype(awaitable)>(awaitable));	} catch(...) {
-		controlRefer.exception = std::current_exception();
-		co_return controlRefer.coroutine;
-	}
-	co_return not controlRefer.index -- ?  controlRefer.coroutine : std::noop_coroutine();
+	co_return std::tuple<	AwaitedType<Awaitables>...		> { std::get<Indices>(ResultPack).Move() ... };
 }
 
 struct WhenAllOrAnyAwaitable {
@@ -452,13 +542,17 @@ struct WhenAllOrAnyAwaitable {
 	std::coroutine_handle<> await_suspend(std::coroutine_handle<> coroutine) const noexcept {
 		if(SubFiberSpan.empty()) return coroutine;
 
-		static_cast<ControlBlock &>(ControlRefer).coroutine = coroutine;
+		ControlBlock& control { ControlRefer.get() };
+		control.coroutine = coroutine;
+		for(auto const& fiber: SubFiberSpan) 
+			fiber.coroutine.promise().token = control.source.Token();
+		/* none resumes the caller before the last one has started */
 		for(auto const& fiber: SubFiberSpan.subspan(0, SubFiberSpan.size() - 1)) 
 			fiber.Direct(); 
 		
 		return SubFiberSpan.back().coroutine;
 	}
-	void await_resume() const noexcept {
+	void await_resume() const {
 		if(static_cast<ControlBlock &>(ControlRefer).exception) [[unlikely]]
 			std::rethrow_exception(static_cast<ControlBlock &>(ControlRefer).exception);
 	}
@@ -467,37 +561,47 @@ struct WhenAllOrAnyAwaitable {
 };
 
 
-template <std::size_t... Indices, typename... Awaitables> 
-constexpr MainFuture<std::variant<		Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type> ...	>> AuxWhenAnyOf(std::index_sequence<Indices ...>, Awaitables&&... awaitables) noexcept;
+template <typename... Awaitables, std::size_t... Indices> 
+MainFuture<std::variant<		AwaitedType<Awaitables> ...	>> AuxWhenAnyOf(std::index_sequence<Indices ...>, Awaitables... awaitables);
 
 template <Utility::Awaitable... Awaitables> requires ((bool) sizeof... (Awaitables))
-constexpr decltype(auto) WhenAnyOf(Awaitables&&... awaitables) noexcept 
-{	return AuxWhenAnyOf(std::make_index_sequence<sizeof...(Awaitables)>(), std::forward<Awaitables>(awaitables) ...);		}
-
-template<typename Ret> constexpr DirectedFuture CoawaitOneForAny(auto&& awaitable, ControlBlock& controlRefer, Utility::Deferrable<Ret>& result, std::size_t current_index) noexcept {
-	try { 	result.Emplace(co_await std::forward<decltype(awaitable)>(awaitable));	} catch(...) {
-		controlRefer.exception = std::current_exception();
-		co_return controlRefer.coroutine;
+decltype(auto) WhenAnyOf(Awaitables&&... awaitables) 
+{	return AuxWhenAnyOf<Awaitables...>(std::index_sequence_for<Awaitables...>(), std::forward<Awaitables>(awaitables) ...);		}
+
+template<typename Ret, typename Awaitable> DirectedFuture CoawaitOneForAny(Awaitable awaitable, ControlBlock& controlRefer, Utility::Deferrable<Ret>& result, std::size_t current_index) {
+	std::size_t expected { std::numeric_limits<std::size_t>::max() };
+	try { 	
+		if constexpr (std::same_as<typename AwaitableTraits<std::remove_cvref_t<Awaitable>>::type, void>) 
+			co_await std::forward<Awaitable>(awaitable), (void) result.Emplace(std::ignore);
+		else 
+			(void) result.Emplace(co_await std::forward<Awaitable>(awaitable));
+		/* the first to finish wins and cancels the rest */
+		if(controlRefer.index.compare_exchange_strong(expected, current_index, std::memory_order_acq_rel))
+			(void) controlRefer.source.Cancel();
+	} catch(...) {
+		if(controlRefer.index.compare_exchange_strong(expected, current_index, std::memory_order_acq_rel))
+			controlRefer.exception = std::current_exception(), (void) controlRefer.source.Cancel();
 	}
-	if(controlRefer.index != std::numeric_limits<std::size_t>::max()) 
-		co_return std::noop_coroutine();
-	controlRefer.index = current_index;
-	co_return controlRefer.coroutine;
+	/* the caller resumes once the losers have returned too */
+	co_await LeaveAwaitable { std::ref(controlRefer) };
+	co_return std::noop_coroutine();
 }
 
-template <std::size_t... Indices, typename... Awaitables> 
-constexpr MainFuture<std::variant<		Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type> ...	>> AuxWhenAnyOf(std::index_sequence<Indices ...>, Awaitables&&... awaitables) noexcept {
-	ControlBlock Control {};
+template <typename... Awaitables, std::size_t... Indices> 
+MainFuture<std::variant<		AwaitedType<Awaitables> ...	>> AuxWhenAnyOf(std::index_sequence<Indices ...>, Awaitables... awaitables) {
+	CancellationToken const Parent { co_await ThisToken() };
+	ControlBlock Control { Parent, sizeof...(Awaitables) };
 
-	std::tuple<Utility::Deferrable<		Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type>	>...> ResultPack;
+	std::tuple<Utility::Deferrable<		AwaitedType<Awaitables>	>...> ResultPack;
 
-	DirectedFuture SubFiberArray[] { CoawaitOneForAny(std::forward<Awaitables>(awaitables), Control, std::get<Indices>(ResultPack), Indices) ...};
+	DirectedFuture SubFiberArray[] { CoawaitOneForAny<AwaitedType<Awaitables>, Awaitables>(std::forward<Awaitables>(awaitables), Control, std::get<Indices>(ResultPack), Indices) ...};
 
 	co_await WhenAllOrAnyAwaitable {	.ControlRefer = std::ref(Control), .SubFiberSpan = SubFiberArray };
 
-	Utility::Deferrable<std::variant<		Utility::VoidGuardType<typename AwaitableTraits<Awaitables>::type> ...	>>	FirstResult;
+	Utility::Deferrable<std::variant<		AwaitedType<Awaitables> ...	>>	FirstResult;
 
-	(((Control.index == Indices) && (FirstResult.Emplace(std::in_place_index<Indices>, std::get<Indices>(ResultPack).Move()), false)), ...);	
+	std::size_t const winner { Control.index.load(std::memory_order_relaxed) };
+	(((winner == Indices) && (FirstResult.Emplace(std::in_place_index<Indices>, std::get<Indices>(ResultPack).Move()), false)), ...);	
 
 	co_return FirstResult.Move();
 }
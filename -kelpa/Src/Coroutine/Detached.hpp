@@ -0,0 +1,44 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Detached.hpp
+ * 		@Brief	Fire-and-forget coroutine type for sessions, listeners and the
+ * 				other loops nobody awaits
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_DETACHED_HPP__
+#define __KELPA_COROUTINE_DETACHED_HPP__
+
+#include <coroutine>				/* imports ./ {
+	std::suspend_never
+}*/
+#include <exception>				/* imports ./ {
+	std::terminate
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	Detached Session(Socket peer) { ... co_await peer.async_read_some(...); ... }
+	Session(std::move(peer));				// runs up to its first suspension and returns
+
+	Runs eagerly and frees itself when it returns; nothing can await it or
+	destroy it early, so whatever it refers to must outlive it. An exception
+	escaping it terminates the program
+*/
+struct Detached {
+	struct promise_type {
+		Detached 			get_return_object() 	const noexcept { 	return {}; 	}
+		std::suspend_never 	initial_suspend() 		const noexcept { 	return {}; 	}
+		std::suspend_never 	final_suspend() 		const noexcept { 	return {}; 	}
+		void 				return_void() 			const noexcept {}
+		void 				unhandled_exception() 	const noexcept { 	std::terminate(); 	}
+	};
+};
+
+}		//namespace Coroutine
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Frame.hpp
+ * 		@Brief	Coroutine frame allocation for the promise types: frames come from
+ * 				the thread's slab heap, or from an allocator passed as a coroutine
+ * 				argument after std::allocator_arg
+ * 		@Dependency	../Utility/ { Slab.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_FRAME_HPP__
+#define __KELPA_COROUTINE_FRAME_HPP__
+
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::byte
+}*/
+#include <memory>					/* imports ./ {
+	std::allocator_arg_t,
+	std::allocator_traits,
+	std::construct_at,
+	std::destroy_at
+}*/
+#include <new>						/* imports ./ {
+	__STDCPP_DEFAULT_NEW_ALIGNMENT__
+}*/
+#include <utility>					/* imports ./ {
+	std::move
+}*/
+#include "../Utility/Slab.hpp"		/* imports ./ {
+	struct Utility::Slab
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	struct MainPromise: PooledFrame { ... };
+
+	MainFuture<void> Handle(std::allocator_arg_t, std::pmr::polymorphic_allocator<> arena, Request request);
+	Handle(std::allocator_arg, & requestArena, request);
+
+	A promise type deriving from PooledFrame has its frames carved from
+	Utility::Slab: the thread's own size-class lists with no atomic operation
+	on the fast path, a frame resumed and destroyed on another thread is
+	handed back to the heap that made it. A coroutine whose parameters start
+	with std::allocator_arg and an allocator (after the object parameter, for
+	member coroutines) has its frame allocated by that allocator instead.
+
+	operator delete is only told the frame's size, so each frame carries a
+	trailer: one pointer saying how it is to be released and, for allocated
+	frames, a copy of the allocator, which must therefore be copyable and is
+	destroyed along with the frame
+*/
+struct PooledFrame {
+	static void* operator new(std::size_t size) {
+		void* const frame { Utility::Slab::Allocate(TrailerOf(size) + sizeof(release_type)) };
+		Release(frame, size) = nullptr;
+		return frame;
+	}
+
+	template <typename Allocator, typename... Args>
+	static void* operator new(std::size_t size, std::allocator_arg_t, Allocator const& allocator, Args const&...)
+	{	return AllocateWith(size, allocator);	}
+
+	template <typename Object, typename Allocator, typename... Args>
+	static void* operator new(std::size_t size, Object const&, std::allocator_arg_t, Allocator const& allocator, Args const&...)
+	{	return AllocateWith(size, allocator);	}
+
+	static void  operator delete(void* frame, std::size_t size) noexcept {
+		if(release_type const release { Release(frame, size) })
+			return release(frame, size);
+		Utility::Slab::Deallocate(frame, TrailerOf(size) + sizeof(release_type));
+	}
+private:
+	typedef void (* release_type)(void*, std::size_t) noexcept;
+
+	/* the unit allocators are rebound to, so that frames keep operator new's alignment */
+	struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Unit {
+		std::byte 	bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+	};
+
+	static constexpr std::size_t AlignUp(std::size_t size, std::size_t alignment) noexcept
+	{	return (size + alignment - 1) & ~(alignment - 1);	}
+	static constexpr std::size_t TrailerOf(std::size_t size) noexcept
+	{	return AlignUp(size, alignof(release_type));	}
+	static release_type& Release(void* frame, std::size_t size) noexcept
+	{	return * reinterpret_cast<release_type *>(static_cast<std::byte *>(frame) + TrailerOf(size));	}
+
+	template <typename Allocator>
+	using Rebound = typename std::allocator_traits<Allocator>::template rebind_alloc<Unit>;
+
+	template <typename Allocator>
+	static constexpr std::size_t StoreOf(std::size_t size) noexcept
+	{	return AlignUp(TrailerOf(size) + sizeof(release_type), alignof(Rebound<Allocator>));	}
+	template <typename Allocator>
+	static constexpr std::size_t UnitsOf(std::size_t size) noexcept
+	{	return (StoreOf<Allocator>(size) + sizeof(Rebound<Allocator>) + sizeof(Unit) - 1) / sizeof(Unit);	}
+
+	/*
+		kept out of line: once the allocator's operator new is inlined into the
+		coroutine ramp, GCC pairs it with our operator delete and warns
+	*/
+	template <typename Allocator>
+	[[gnu::noinline]] static void* AllocateWith(std::size_t size, Allocator const& allocator) {
+		static_assert(alignof(Rebound<Allocator>) <= alignof(Unit), "the allocator is stored in the frame and must not be over-aligned");
+		Rebound<Allocator> rebound { allocator };
+		void* const frame { std::allocator_traits<Rebound<Allocator>>::allocate(rebound, UnitsOf<Allocator>(size)) };
+		(void) std::construct_at(reinterpret_cast<Rebound<Allocator> *>(static_cast<std::byte *>(frame) + StoreOf<Allocator>(size)), std::move(rebound));
+		Release(frame, size) = &ReleaseWith<Allocator>;
+		return frame;
+	}
+
+	template <typename Allocator>
+	static void ReleaseWith(void* frame, std::size_t size) noexcept {
+		auto* const stored { reinterpret_cast<Rebound<Allocator> *>(static_cast<std::byte *>(frame) + StoreOf<Allocator>(size)) };
+		Rebound<Allocator> rebound { std::move(* stored) };
+		std::destroy_at(stored);
+		std::allocator_traits<Rebound<Allocator>>::deallocate(rebound, static_cast<Unit *>(frame), UnitsOf<Allocator>(size));
+	}
+};
+
+}
+}
+
+#endif
@@ -1,7 +1,7 @@
 /** 
  * 		@Path 	Kelpa/Src/Coroutine/Generator.hpp
  * 		@Brief	presents a view of the elements yielded by the evaluation of a coroutine.
- * 		@Dependency	./ {Coroutine.hpp}
+ * 		@Dependency	./ {Coroutine.hpp, Frame.hpp}
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
@@ -23,12 +23,15 @@
 #include <utility>						/* imports ./ { 
 	std::exchange 
 }*/
+#include "./Frame.hpp"					/* imports ./ {
+	struct PooledFrame
+}*/
 namespace Kelpa {
 namespace Coroutine {
 	
 template <typename Ref> requires std::negation_v<std::is_void<Ref>>
 struct Generator :public std::ranges::view_interface<Generator<Ref>> {
-struct promise_type {
+struct promise_type: PooledFrame {
 	typedef std::remove_cvref_t<Ref> 			value_type;
 	typedef std::add_lvalue_reference_t<Ref> 	reference;
 	typedef std::add_pointer_t<Ref>       		pointer;
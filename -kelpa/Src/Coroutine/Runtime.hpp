@@ -0,0 +1,460 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Runtime.hpp
+ * 		@Brief	M:N coroutine runtime: coroutines multiplexed over a fixed set of
+ * 				worker threads with per-worker run queues, work stealing, thread
+ * 				hopping by co_await and sleeping on a timing wheel
+ * 		@Dependency	./ { Coroutine.hpp }
+ * 					../Thread/ { TimingWheel.hpp }
+ * 					../Thread/Sync/ { StealingDeque.hpp }
+ * 					../Utility/ { Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_RUNTIME_HPP__
+#define __KELPA_COROUTINE_RUNTIME_HPP__
+
+#include <coroutine>				/* imports ./ {
+	std::coroutine_handle,
+	std::suspend_always,
+	std::suspend_never
+}*/
+#include <algorithm>				/* imports ./ {
+	std::min,
+	std::max
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic,
+	std::atomic_thread_fence
+}*/
+#include <chrono>					/* imports ./ {
+	std::chrono::duration,
+	std::chrono::time_point
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint32_t,
+	std::uint64_t
+}*/
+#include <deque>					/* imports ./ {
+	std::deque
+}*/
+#include <exception>				/* imports ./ {
+	std::terminate
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <memory>					/* imports ./ {
+	std::unique_ptr,
+	std::make_unique,
+	std::shared_ptr,
+	std::make_shared
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::lock_guard
+}*/
+#include <thread>					/* imports ./ {
+	std::thread
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange
+}*/
+#include <vector>					/* imports ./ {
+	std::vector
+}*/
+#include "./Coroutine.hpp"			/* imports ./ {
+	struct MainFuture,
+	struct WeakFuture,
+	struct MainPromise,
+	struct PooledFrame,
+	struct CancellableWait,
+	TokenOf
+}*/
+#include "../Thread/TimingWheel.hpp"	/* imports ./ {
+	struct Thread::TimingWheel
+}*/
+#include "../Thread/Sync/StealingDeque.hpp"	/* imports ./ {
+	struct Thread::Sync::StealingDeque
+}*/
+#include "../Utility/Interfaces.hpp"/* imports ./ {
+	struct noncopyable,
+	struct nonmoveable
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	Anything that can be handed a coroutine to resume later: a Runtime, or a
+	reactor's Post()
+*/
+template <typename S> concept Schedulable = requires(S& scheduler, std::coroutine_handle<> coroutine) {
+	(void) scheduler.Post(coroutine);
+};
+
+/*
+	co_await ScheduleOn(runtime);	// the rest of this coroutine runs on one of runtime's workers
+
+	Suspends the awaiting coroutine and posts it to the scheduler; awaited on
+	a worker of the same runtime it yields to the other ready coroutines
+*/
+template <typename S> struct ScheduleAwaitable {
+	constexpr bool 	await_ready() 	const noexcept { 	return false; 	}
+	void 			await_suspend(std::coroutine_handle<> coroutine) const noexcept
+	{ 	(void) (* scheduler).Post(coroutine);	}
+	constexpr void 	await_resume() 	const noexcept {}
+
+	S * scheduler;
+};
+
+template <Schedulable S>
+constexpr ScheduleAwaitable<S> ScheduleOn(S& scheduler) noexcept
+{	return { std::addressof(scheduler) };	}
+
+/*
+	Runtime runtime { std::thread::hardware_concurrency() };
+	runtime.Spawn([&runtime] (std::size_t id) -> MainFuture<void> {
+		co_await runtime.SleepFor(std::chrono::milliseconds(10));
+		...
+	}, 42);
+	runtime.Join();
+
+	Each worker owns a bounded Chase-Lev deque of ready coroutines. A
+	coroutine made ready on a worker (spawned, yielded, woken) is pushed onto
+	that worker's own deque and run from there newest first; a worker whose
+	deque is empty takes from the shared injection queue, which is where
+	other threads and the timing wheel post, and then steals the oldest
+	coroutine of a randomly chosen peer. A full deque spills half of itself
+	into the injection queue in one go, and every 61st turn a worker looks
+	at the injection queue first so that outside posts are not starved by a
+	worker that keeps feeding itself. Workers that find nothing park on a
+	futex-style wait and are woken one at a time as work is posted.
+
+	A suspended coroutine costs its frame and nothing else: it sits in no
+	queue until something posts it. SleepFor() and SleepUntil() park it in
+	the timing wheel, which posts it back on expiry, or at once when the
+	coroutine's cancellation token fires.
+
+	Spawn() detaches the coroutine: the runtime keeps the callable and its
+	arguments alive in a wrapper frame, so capturing lambdas are safe, and
+	destroys both frames when the coroutine completes; exceptions escaping it
+	are dropped. Join() blocks until every spawned coroutine has completed and
+	must not be called from a worker. A coroutine that moved to another
+	runtime still reports its completion to the one that spawned it, from the
+	other runtime's worker, so destroy that other runtime first. The
+	destructor stops the workers;
+	coroutines still queued or sleeping at that point are never resumed, so
+	Join() first
+*/
+struct Runtime : Utility::noncopyable, Utility::nonmoveable {
+	typedef std::coroutine_handle<> 					coroutine_type;
+	typedef Thread::TimingWheel::clock_type 			clock_type;
+
+	struct TimerAwaitable;
+
+	explicit Runtime(std::size_t workers = std::thread::hardware_concurrency(), std::size_t depth = 256);
+	~Runtime() noexcept;
+
+	/* runs coroutine on one of the workers, from any thread */
+	bool 			Post(coroutine_type coroutine) noexcept;
+
+	template <typename F, typename... Args> requires std::invocable<F, Args ...>
+	void 			Spawn(F&& f, Args&&... args);
+	template <typename T>
+	void 			Spawn(MainFuture<T>&& future);
+
+	void 			Join() 								const noexcept;
+	/* spawned and not yet completed */
+	std::size_t 	Pending() 							const noexcept
+	{	return pending.load(std::memory_order_acquire);	}
+	std::size_t 	Workers() 							const noexcept
+	{	return workers.size();	}
+
+	ScheduleAwaitable<Runtime> 	Schedule() 				noexcept
+	{	return ScheduleOn(* this);	}
+	template <typename Rep, typename Period>
+	TimerAwaitable 	SleepFor(std::chrono::duration<Rep, Period> const& duration) noexcept;
+	template <typename Duration>
+	TimerAwaitable 	SleepUntil(std::chrono::time_point<clock_type, Duration> const& deadline) noexcept;
+
+	/* the runtime whose worker is the calling thread */
+	static Runtime* Current() 							noexcept
+	{	return current ? std::addressof((* current).owner) : nullptr;	}
+private:
+	struct Worker {
+		Worker(Runtime& owner, std::size_t index, std::size_t depth): owner(owner), index(index), local(depth) {}
+
+		Runtime& 								owner;
+		std::size_t 							index;
+		Thread::Sync::StealingDeque<coroutine_type> local;
+		std::uint64_t 							seed;
+		std::thread 							thread;
+	};
+	struct Detached {
+		struct promise_type: PooledFrame {
+			std::coroutine_handle<promise_type> 	get_return_object() noexcept
+			{	return std::coroutine_handle<promise_type>::from_promise(* this);	}
+			constexpr std::suspend_always 	initial_suspend() 	const noexcept { 	return {}; 	}
+			constexpr std::suspend_never 	final_suspend() 	const noexcept { 	return {}; 	}
+			constexpr void 					return_void() 		const noexcept {}
+			[[noreturn]] void 				unhandled_exception() const noexcept { 	std::terminate(); 	}
+		};
+		Detached(std::coroutine_handle<promise_type> coroutine) noexcept: coroutine(coroutine) {}
+		std::coroutine_handle<promise_type> 	coroutine;
+	};
+
+	/* runs a MainFuture to completion without fetching its result, which would rethrow */
+	template <typename Promise> struct Completion {
+		constexpr bool 	await_ready() 	const noexcept { 	return false; 	}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+		{	return coroutine.promise().coroutine = awaiting, coroutine;	}
+		constexpr void 	await_resume() 	const noexcept {}
+
+		std::coroutine_handle<Promise> 	coroutine;
+	};
+
+	template <typename F, typename... Args>
+	static Detached 	Launch(Runtime& runtime, F f, Args... args);
+
+	void 				Run(Worker& self) 				noexcept;
+	coroutine_type 		Next(Worker& self, std::size_t turn) noexcept;
+	coroutine_type 		Inject(Worker& self) 			noexcept;
+	coroutine_type 		Steal(Worker& self) 			noexcept;
+	void 				Spill(Worker& self, coroutine_type coroutine) noexcept;
+	void 				Park() 							noexcept;
+	void 				Notify() 						noexcept;
+
+	std::vector<std::unique_ptr<Worker>> 	workers;
+	std::mutex 								mutex;
+	std::deque<coroutine_type> 				injected;
+	std::atomic<std::size_t> 				backlog 	{};
+	Thread::TimingWheel 					wheel;
+	alignas(64) std::atomic<std::size_t> 	pending 	{};
+	alignas(64) std::atomic<std::size_t> 	idle 		{};
+	std::atomic<std::uint32_t> 				signals 	{};
+	std::atomic<bool> 						exit 		{ false };
+
+	static inline thread_local Worker * 	current 	{ nullptr };
+};
+
+/*
+	if(not co_await runtime.SleepFor(timeout)) co_return;	// cancelled
+
+	Yields true once the delay has passed, false when the awaiting
+	coroutine's token was cancelled first, in which case the timer is
+	withdrawn and the coroutine posted back without waiting for it
+*/
+struct Runtime::TimerAwaitable {
+	bool 	await_ready() 	const noexcept { 	return delay <= Thread::TimingWheel::duration_type::zero(); 	}
+	template <typename Promise>
+	bool 	await_suspend(std::coroutine_handle<Promise> coroutine);
+	bool 	await_resume() 	const noexcept { 	return not state || not (* state).cancelled; 	}
+
+	struct State: CancellableWait {
+		std::coroutine_handle<> 	coroutine;
+		Thread::TimerHandle 		timer 		{};
+		bool 						cancelled 	{ false };
+	};
+
+	Runtime * 								runtime;
+	Thread::TimingWheel::duration_type 		delay;
+	/* only for waits that can be cancelled */
+	std::shared_ptr<State> 					state 	{};
+};
+
+template <typename Promise>
+inline bool Runtime::TimerAwaitable::await_suspend(std::coroutine_handle<Promise> coroutine) {
+	Runtime* const 				runtime_ 	{ runtime };
+	CancellationToken const 	token 		{ TokenOf(coroutine) };
+	if(not token.Cancellable())
+		return (void) (* runtime_).wheel.Schedule(delay, [runtime_, coroutine] { (void) (* runtime_).Post(coroutine); }), true;
+	if(token.Cancelled())
+		return state = std::make_shared<State>(), (* state).cancelled = true, false;
+
+	/* the timer may post the coroutine, and it may run past this awaitable, before Schedule() returns */
+	auto const wait { std::make_shared<State>() };
+	(* wait).coroutine 	= coroutine;
+	state 				= wait;
+	(* wait).timer 		= (* runtime_).wheel.Schedule(delay, [runtime_, wait] {
+		if((* wait).Claim())
+			(void) (* runtime_).Post((* wait).coroutine);
+	});
+	(* wait).Arm(token, [runtime_, raw = wait.get()] {
+		if(not (* raw).Claim())
+			return;
+		(void) (* runtime_).wheel.Cancel((* raw).timer);
+		(* raw).cancelled = true;
+		(void) (* runtime_).Post((* raw).coroutine);
+	});
+	return true;
+}
+
+inline Runtime::Runtime(std::size_t count, std::size_t depth) {
+	count = std::max<std::size_t>(count, 1);
+	workers.reserve(count);
+	for(std::size_t index {}; index < count; index ++) {
+		workers.push_back(std::make_unique<Worker>(* this, index, depth));
+		(* workers.back()).seed = (index + 1) * 0x9e3779b97f4a7c15ull;
+	}
+	(void) wheel.Start();
+	for(auto& worker: workers)
+		(* worker).thread = std::thread([this, &worker = * worker] { Run(worker); });
+}
+
+inline Runtime::~Runtime() noexcept {
+	(void) wheel.Stop();
+	exit.store(true, std::memory_order_seq_cst);
+	signals.fetch_add(1, std::memory_order_seq_cst);
+	signals.notify_all();
+	for(auto& worker: workers)
+		if((* worker).thread.joinable())
+			(* worker).thread.join();
+}
+
+inline bool Runtime::Post(coroutine_type coroutine) noexcept {
+	if(not coroutine)
+		return false;
+	if(current && std::addressof((* current).owner) == this) {
+		if(not (* current).local.TryPush(coroutine))
+			Spill(* current, coroutine);
+	} else {
+		std::lock_guard guard { mutex };
+		injected.push_back(coroutine);
+		backlog.store(injected.size(), std::memory_order_relaxed);
+	}
+	Notify();
+	return true;
+}
+
+template <typename F, typename... Args>
+Runtime::Detached Runtime::Launch(Runtime& runtime, F f, Args... args) {
+	auto future { std::invoke(std::move(f), std::move(args) ...) };
+	auto const coroutine { std::exchange(future.coroutine, {}) };
+	co_await Completion<typename decltype(future)::promise_type> { coroutine };
+	coroutine.destroy();
+	if(runtime.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		runtime.pending.notify_all();
+}
+
+template <typename F, typename... Args> requires std::invocable<F, Args ...>
+inline void Runtime::Spawn(F&& f, Args&&... args) {
+	pending.fetch_add(1, std::memory_order_relaxed);
+	(void) Post(Launch(* this, std::forward<F>(f), std::forward<Args>(args) ...).coroutine);
+}
+
+template <typename T>
+inline void Runtime::Spawn(MainFuture<T>&& future) {
+	Spawn([coroutine = std::exchange(future.coroutine, {})] { return MainFuture<T> { coroutine }; });
+}
+
+inline void Runtime::Join() const noexcept {
+	for(std::size_t count { pending.load(std::memory_order_acquire) }; count; count = pending.load(std::memory_order_acquire))
+		pending.wait(count, std::memory_order_acquire);
+}
+
+template <typename Rep, typename Period>
+inline Runtime::TimerAwaitable Runtime::SleepFor(std::chrono::duration<Rep, Period> const& duration) noexcept
+{	return { this, std::chrono::duration_cast<Thread::TimingWheel::duration_type>(duration) };	}
+
+template <typename Duration>
+inline Runtime::TimerAwaitable Runtime::SleepUntil(std::chrono::time_point<clock_type, Duration> const& deadline) noexcept
+{	return SleepFor(deadline - clock_type::now());	}
+
+inline void Runtime::Run(Worker& self) noexcept {
+	current = std::addressof(self);
+	for(std::size_t turn {}; not exit.load(std::memory_order_acquire); turn ++)
+		if(coroutine_type const coroutine { Next(self, turn) })
+			coroutine.resume();
+		else
+			Park();
+	current = nullptr;
+}
+
+inline Runtime::coroutine_type Runtime::Next(Worker& self, std::size_t turn) noexcept {
+	if(turn % 61 == 0)
+		if(coroutine_type const coroutine { Inject(self) })
+			return coroutine;
+	if(auto const coroutine { self.local.TryPop() })
+		return * coroutine;
+	if(coroutine_type const coroutine { Inject(self) })
+		return coroutine;
+	return Steal(self);
+}
+
+/* takes a fair share of the injection queue at once: one to run, the rest onto the local deque */
+inline Runtime::coroutine_type Runtime::Inject(Worker& self) noexcept {
+	if(not backlog.load(std::memory_order_relaxed))
+		return {};
+	std::lock_guard guard { mutex };
+	if(injected.empty())
+		return {};
+	coroutine_type const coroutine { injected.front() };
+	injected.pop_front();
+	std::size_t share { std::min(injected.size() / workers.size(), self.local.Capacity() / 2) };
+	for(; share && self.local.TryPush(injected.front()); share --)
+		injected.pop_front();
+	backlog.store(injected.size(), std::memory_order_relaxed);
+	return coroutine;
+}
+
+inline Runtime::coroutine_type Runtime::Steal(Worker& self) noexcept {
+	std::size_t const count { workers.size() };
+	if(count == 1)
+		return {};
+	/* xorshift: thieves starting from the same victim would only fight over its top */
+	self.seed ^= self.seed << 13;
+	self.seed ^= self.seed >> 7;
+	self.seed ^= self.seed << 17;
+	std::size_t const start { static_cast<std::size_t>(self.seed % count) };
+	for(std::size_t step {}; step < count; step ++) {
+		Worker& victim { * workers[(start + step) % count] };
+		if(std::addressof(victim) == std::addressof(self))
+			continue;
+		if(auto const coroutine { victim.local.TrySteal() })
+			return * coroutine;
+	}
+	return {};
+}
+
+/* the local deque is full: move its older half and coroutine to the injection queue under one lock */
+inline void Runtime::Spill(Worker& self, coroutine_type coroutine) noexcept {
+	std::vector<coroutine_type> spilled;
+	spilled.reserve(self.local.Capacity() / 2 + 1);
+	for(std::size_t count { self.local.Capacity() / 2 }; count; count --)
+		if(auto const older { self.local.TrySteal() })
+			spilled.push_back(* older);
+	spilled.push_back(coroutine);
+	std::lock_guard guard { mutex };
+	injected.insert(injected.end(), spilled.begin(), spilled.end());
+	backlog.store(injected.size(), std::memory_order_relaxed);
+}
+
+inline void Runtime::Park() noexcept {
+	std::uint32_t const seen { signals.load(std::memory_order_seq_cst) };
+	/* Dekker with Notify(): either the posted coroutine is found below or the poster sees idle and signals */
+	idle.fetch_add(1, std::memory_order_seq_cst);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	bool const ready { backlog.load(std::memory_order_seq_cst) || [&] {
+		for(auto const& worker: workers)
+			if(not (* worker).local.Empty())
+				return true;
+		return false;
+	} () };
+	if(not ready && not exit.load(std::memory_order_seq_cst))
+		signals.wait(seen, std::memory_order_seq_cst);
+	idle.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+inline void Runtime::Notify() noexcept {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(not idle.load(std::memory_order_seq_cst))
+		return;
+	signals.fetch_add(1, std::memory_order_seq_cst);
+	signals.notify_one();
+}
+
+}
+}
+
+#endif
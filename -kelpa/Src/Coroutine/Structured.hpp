@@ -0,0 +1,307 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Structured.hpp
+ * 		@Brief	Structured concurrency on top of the cancellation tokens: task groups
+ * 				that spawn children and join them, and timeouts on any awaitable
+ * 		@Dependency	./ { Coroutine.hpp, Runtime.hpp, Cancellation.hpp }
+ * 					../Thread/ { TimingWheel.hpp }
+ * 					../Utility/ { Interfaces.hpp, ScopeGuard.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_STRUCTURED_HPP__
+#define __KELPA_COROUTINE_STRUCTURED_HPP__
+
+#include <coroutine>				/* imports ./ {
+	std::coroutine_handle,
+	std::noop_coroutine,
+	std::suspend_always
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <chrono>					/* imports ./ {
+	std::chrono::duration,
+	std::chrono::duration_cast
+}*/
+#include <exception>				/* imports ./ {
+	std::exception_ptr,
+	std::rethrow_exception,
+	std::terminate
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <memory>					/* imports ./ {
+	std::make_shared
+}*/
+#include <optional>					/* imports ./ {
+	std::optional,
+	std::nullopt
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange,
+	std::forward
+}*/
+#include "./Coroutine.hpp"			/* imports ./ {
+	struct MainFuture,
+	struct PooledFrame,
+	AwaitedType
+}*/
+#include "./Runtime.hpp"			/* imports ./ {
+	concept Schedulable
+}*/
+#include "./Cancellation.hpp"		/* imports ./ {
+	struct Cancellable,
+	struct CancellationSource,
+	struct CancellationToken,
+	ThisToken,
+	BindToken
+}*/
+#include "../Thread/TimingWheel.hpp"	/* imports ./ {
+	struct Thread::TimingWheel
+}*/
+#include "../Utility/Interfaces.hpp"/* imports ./ {
+	struct noncopyable,
+	struct nonmoveable
+}*/
+#include "../Utility/ScopeGuard.hpp"/* imports ./ {
+	struct Utility::ScopeGuard
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	TaskGroup group { runtime };
+	for(auto const& replica: replicas)
+		co_await group.Spawn(Fetch, std::cref(replica));
+	co_await group.Join();			// rethrows the first failure
+
+	A scope for coroutines started at run time, however many. Spawn() starts
+	the child at once, on the group's scheduler when it has one and nested in
+	the spawning coroutine otherwise, and the spawner carries on. Children run
+	under the group's token, which the first Spawn() links to the spawning
+	coroutine's own, so cancelling either reaches every child and everything
+	they await. The first child to throw cancels its siblings; Join() waits
+	for all of them, rethrows that exception and leaves the group ready for
+	more, but a cancelled group stays cancelled.
+
+	Children are detached frames the group counts but does not own: each one
+	destroys itself as it finishes and the last resumes the joiner, so Join()
+	before the group goes out of scope. The callable and its arguments are
+	kept in the child's frame, as with Runtime::Spawn()
+*/
+struct TaskGroup : Utility::noncopyable, Utility::nonmoveable {
+	struct SpawnAwaitable;
+	struct JoinAwaitable;
+
+	TaskGroup() 								noexcept = default;
+	template <Schedulable S>
+	explicit TaskGroup(S& scheduler) 			noexcept
+		: scheduler(std::addressof(scheduler)), post([] (void* scheduler, std::coroutine_handle<> coroutine) noexcept {
+			(void) (* static_cast<S *>(scheduler)).Post(coroutine);
+		}) {}
+
+	template <typename F, typename... Args> requires std::invocable<F, Args ...>
+	SpawnAwaitable 		Spawn(F&& f, Args&&... args);
+	template <typename T>
+	SpawnAwaitable 		Spawn(MainFuture<T>&& future);
+
+	JoinAwaitable 		Join() 					noexcept;
+
+	bool 				Cancel() 				noexcept 	{ 	return source.Cancel(); 	}
+	CancellationToken 	Token() 		const 	noexcept 	{ 	return source.Token(); 		}
+	/* children spawned and not yet finished */
+	std::size_t 		Active() 		const 	noexcept 	{ 	return count.load(std::memory_order_acquire) - 1; 	}
+private:
+	struct Member {
+		struct promise_type;
+		Member(std::coroutine_handle<promise_type> coroutine) noexcept: coroutine(coroutine) {}
+		std::coroutine_handle<promise_type> 	coroutine;
+	};
+
+	template <typename F, typename... Args>
+	static Member 			Launch(TaskGroup& group, F f, Args... args);
+
+	void 					Fail(std::exception_ptr exception) 	noexcept;
+	std::coroutine_handle<> Leave() 							noexcept;
+
+	void * 										scheduler 	{ nullptr };
+	void (* 									post)(void*, std::coroutine_handle<>) noexcept { nullptr };
+	CancellationSource 							source;
+	std::atomic<bool> 							linked 		{ false };
+	std::atomic<bool> 							failed 		{ false };
+	std::exception_ptr 							exception 	{};
+	std::coroutine_handle<> 					joiner 		{};
+	/* the joiner holds one */
+	alignas(64) std::atomic<std::size_t> 		count 		{ 1 };
+};
+
+/* destroys its own frame on the way out and hands over to whatever co_return named */
+struct TaskGroup::Member::promise_type: PooledFrame, Cancellable {
+	struct ReapAwaitable {
+		constexpr bool 	await_ready() 	const noexcept { 	return false; 	}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> self) const noexcept {
+			std::coroutine_handle<> const next { this -> next };
+			self.destroy();
+			return next;
+		}
+		constexpr void 	await_resume() 	const noexcept {}
+
+		std::coroutine_handle<> 	next;
+	};
+
+	std::coroutine_handle<promise_type> get_return_object() noexcept
+	{	return std::coroutine_handle<promise_type>::from_promise(* this);	}
+	constexpr std::suspend_always 	initial_suspend() 	const noexcept { 	return {}; 	}
+	ReapAwaitable 					final_suspend() 	const noexcept { 	return { next }; 	}
+	void 							return_value(std::coroutine_handle<> coroutine) noexcept { 	next = coroutine; 	}
+	[[noreturn]] void 				unhandled_exception() const noexcept { 	std::terminate(); 	}
+
+	std::coroutine_handle<> 		next 	{};
+};
+
+struct TaskGroup::SpawnAwaitable {
+	SpawnAwaitable(TaskGroup& group, std::coroutine_handle<Member::promise_type> member) noexcept
+		: group(std::addressof(group)), member(member) {}
+	SpawnAwaitable(SpawnAwaitable&& other) noexcept
+		: group(other.group), member(std::exchange(other.member, {})) {}
+	SpawnAwaitable& operator=(SpawnAwaitable&&) = delete;
+	/* never awaited, never started */
+	~SpawnAwaitable() noexcept { 	if(member) member.destroy(); 	}
+
+	constexpr bool 	await_ready() 	const noexcept { 	return false; 	}
+	template <typename Promise>
+	bool 			await_suspend(std::coroutine_handle<Promise> coroutine) {
+		TaskGroup& group_ { * group };
+		if(not group_.linked.exchange(true, std::memory_order_acq_rel))
+			group_.source.Link(TokenOf(coroutine));
+		auto const member_ { std::exchange(member, {}) };
+		member_.promise().token = group_.source.Token();
+		group_.count.fetch_add(1, std::memory_order_relaxed);
+		if(group_.post)
+			group_.post(group_.scheduler, member_);
+		else
+			member_.resume();
+		return false;
+	}
+	constexpr void 	await_resume() 	const noexcept {}
+private:
+	TaskGroup * 								group;
+	std::coroutine_handle<Member::promise_type> member;
+};
+
+struct TaskGroup::JoinAwaitable {
+	bool 	await_ready() 	const noexcept { 	return (* group).count.load(std::memory_order_acquire) == 1; 	}
+	bool 	await_suspend(std::coroutine_handle<> coroutine) const noexcept {
+		(* group).joiner = coroutine;
+		return (* group).count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+	}
+	void 	await_resume() 	const {
+		(* group).count.store(1, std::memory_order_relaxed);
+		(* group).joiner = {};
+		if(std::exception_ptr const exception { std::exchange((* group).exception, {}) }) {
+			(* group).failed.store(false, std::memory_order_relaxed);
+			std::rethrow_exception(exception);
+		}
+	}
+
+	TaskGroup * 	group;
+};
+
+template <typename F, typename... Args>
+TaskGroup::Member TaskGroup::Launch(TaskGroup& group, F f, Args... args) {
+	try {
+		auto future { std::invoke(std::move(f), std::move(args) ...) };
+		(void) co_await future;
+	} catch(...) {
+		group.Fail(std::current_exception());
+	}
+	co_return group.Leave();
+}
+
+template <typename F, typename... Args> requires std::invocable<F, Args ...>
+inline TaskGroup::SpawnAwaitable TaskGroup::Spawn(F&& f, Args&&... args) {
+	return { * this, Launch(* this, std::forward<F>(f), std::forward<Args>(args) ...).coroutine };
+}
+
+template <typename T>
+inline TaskGroup::SpawnAwaitable TaskGroup::Spawn(MainFuture<T>&& future) {
+	return Spawn([coroutine = std::exchange(future.coroutine, {})] { return MainFuture<T> { coroutine }; });
+}
+
+inline TaskGroup::JoinAwaitable TaskGroup::Join() noexcept {
+	return { this };
+}
+
+inline void TaskGroup::Fail(std::exception_ptr exception_) noexcept {
+	if(not failed.exchange(true, std::memory_order_acq_rel))
+		exception = std::move(exception_);
+	(void) source.Cancel();
+}
+
+/* the last child out resumes the joiner, once it has destroyed its own frame */
+inline std::coroutine_handle<> TaskGroup::Leave() noexcept {
+	return count.fetch_sub(1, std::memory_order_acq_rel) == 1 ? joiner : std::noop_coroutine();
+}
+
+
+/* the wheel behind WithTimeout(), started on first use */
+inline Thread::TimingWheel& TimeoutWheel() noexcept {
+	static Thread::TimingWheel wheel;
+	static bool const started { ((void) wheel.Start(), true) };
+	return (void) started, wheel;
+}
+
+template <typename Awaitable>
+MainFuture<std::optional<AwaitedType<Awaitable>>> AuxWithTimeout(Awaitable awaitable, Thread::TimingWheel::duration_type timeout);
+
+/*
+	if(auto const reply { co_await WithTimeout(Fetch(url), std::chrono::milliseconds(50)) })
+		Use(* reply);
+	else
+		...	// timed out, Fetch() has given up and its frame is gone
+
+	Awaits the awaitable under a token cancelled when the timeout expires or
+	the caller's token is, and yields its result, or nullopt once the
+	timeout has expired. Nothing is interrupted: the awaitable returns early
+	as far as its waits honour cancellation, and WithTimeout() returns when it
+	does. Exceptions pass through. Lvalues are awaited in place, rvalues are
+	moved in
+*/
+template <Utility::Awaitable Awaitable, typename Rep, typename Period>
+decltype(auto) WithTimeout(Awaitable&& awaitable, std::chrono::duration<Rep, Period> const& timeout)
+{	return AuxWithTimeout<Awaitable>(std::forward<Awaitable>(awaitable), std::chrono::duration_cast<Thread::TimingWheel::duration_type>(timeout));	}
+
+template <typename Awaitable>
+MainFuture<std::optional<AwaitedType<Awaitable>>> AuxWithTimeout(Awaitable awaitable, Thread::TimingWheel::duration_type timeout) {
+	struct Deadline {
+		explicit Deadline(CancellationToken const& parent): source(parent) {}
+
+		CancellationSource 	source;
+		std::atomic<bool> 	expired 	{ false };
+	};
+	/* shared with the timer, which may fire after this frame is gone */
+	auto const deadline { std::make_shared<Deadline>(co_await ThisToken()) };
+	Thread::TimerHandle const timer { TimeoutWheel().Schedule(timeout, [deadline] {
+		(* deadline).expired.store(true, std::memory_order_release);
+		(void) (* deadline).source.Cancel();
+	}) };
+	Utility::ScopeGuard const withdraw { [timer] { (void) TimeoutWheel().Cancel(timer); } };
+	(void) co_await BindToken((* deadline).source.Token());
+
+	std::optional<AwaitedType<Awaitable>> result;
+	if constexpr (std::same_as<typename AwaitableTraits<std::remove_cvref_t<Awaitable>>::type, void>)
+		co_await std::forward<Awaitable>(awaitable), (void) result.emplace(std::ignore);
+	else
+		(void) result.emplace(co_await std::forward<Awaitable>(awaitable));
+	if((* deadline).expired.load(std::memory_order_acquire))
+		co_return std::nullopt;
+	co_return std::move(result);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * 		@Path 	Kelpa/Src/Coroutine/Synchronize.hpp
+ * 		@Brief	Awaitable semaphore and latch: a coroutine that cannot proceed is
+ * 				suspended and queued instead of blocking its OS thread
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_COROUTINE_SYNCHRONIZE_HPP__
+#define __KELPA_COROUTINE_SYNCHRONIZE_HPP__
+
+#include <coroutine>				/* imports ./ {
+	std::coroutine_handle
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::lock_guard
+}*/
+#include <cstddef>					/* imports ./ {
+	std::ptrdiff_t
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange
+}*/
+
+namespace Kelpa {
+namespace Coroutine {
+
+/*
+	MainFuture<void> Handle(AsyncSemaphore& permits) {
+		co_await permits.Acquire();
+		...
+		permits.Release();
+	}
+	Release() resumes the oldest waiter inline on the releasing thread
+*/
+struct AsyncSemaphore {
+	struct Awaiter {
+		bool await_ready() const noexcept
+		{	return owner.TryAcquire();			}
+		bool await_suspend(std::coroutine_handle<> __coroutine) noexcept {
+			coroutine = __coroutine;
+			return owner.Enqueue(this);
+		}
+		constexpr void await_resume() const noexcept {}
+
+		AsyncSemaphore& 			owner;
+		std::coroutine_handle<> 	coroutine 	{};
+		Awaiter * 					next 		{ nullptr };
+	};
+
+	AsyncSemaphore(AsyncSemaphore const&) 				= delete;
+	AsyncSemaphore& operator=(AsyncSemaphore const&) 	= delete;
+
+	constexpr explicit AsyncSemaphore(std::ptrdiff_t initial = {}) noexcept: count(initial) {}
+
+	bool TryAcquire() noexcept {
+		std::ptrdiff_t value { count.load(std::memory_order_relaxed) };
+		while(value > 0)
+			if(count.compare_exchange_weak(value, value - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+
+	constexpr Awaiter Acquire() noexcept
+	{	return Awaiter { .owner = *this };		}
+
+	void Release(std::ptrdiff_t update = 1) noexcept {
+		while(update --) {
+			Awaiter* awaiter { nullptr };
+		{
+			std::lock_guard guard { mutex };
+			if(! (awaiter = head)) {
+				count.fetch_add(1, std::memory_order_release);
+				continue;
+			}
+			if(! (head = (* awaiter).next))
+				tail = nullptr;
+		}
+			(* awaiter).coroutine.resume();
+		}
+	}
+
+	std::ptrdiff_t GetValue() const noexcept
+	{	return count.load(std::memory_order_relaxed);	}
+private:
+	/* re-checks the count under the lock so a concurrent Release() is never missed */
+	bool Enqueue(Awaiter* awaiter) noexcept {
+		std::lock_guard guard { mutex };
+		if(TryAcquire())
+			return false;
+		if(tail) (* tail).next = awaiter;
+		else 	 head = awaiter;
+		tail = awaiter;
+		return true;
+	}
+
+	std::atomic<std::ptrdiff_t> 		count;
+	std::mutex 							mutex;
+	Awaiter * 							head 	{ nullptr };
+	Awaiter * 							tail 	{ nullptr };
+};
+
+struct AsyncLatch {
+	struct Awaiter {
+		bool await_ready() const noexcept
+		{	return ! owner.count.load(std::memory_order_acquire);		}
+		bool await_suspend(std::coroutine_handle<> __coroutine) noexcept {
+			coroutine = __coroutine;
+			std::lock_guard guard { owner.mutex };
+			if(! owner.count.load(std::memory_order_acquire))
+				return false;
+			next = std::exchange(owner.head, this);
+			return true;
+		}
+		constexpr void await_resume() const noexcept {}
+
+		AsyncLatch& 				owner;
+		std::coroutine_handle<> 	coroutine 	{};
+		Awaiter * 					next 		{ nullptr };
+	};
+
+	AsyncLatch(AsyncLatch const&) 				= delete;
+	AsyncLatch& operator=(AsyncLatch const&) 	= delete;
+
+	constexpr explicit AsyncLatch(std::ptrdiff_t expected) noexcept: count(expected) {}
+
+	constexpr Awaiter Wait() noexcept
+	{	return Awaiter { .owner = *this };		}
+
+	/* the final count-down resumes every waiter inline */
+	void CountDown(std::ptrdiff_t update = 1) noexcept {
+		Awaiter* awaiter { nullptr };
+	{
+		std::lock_guard guard { mutex };
+		if(count.fetch_sub(update, std::memory_order_acq_rel) != update)
+			return;
+		awaiter = std::exchange(head, nullptr);
+	}
+		while(awaiter) {
+			Awaiter* next { (* awaiter).next };
+			(* awaiter).coroutine.resume();
+			awaiter = next;
+		}
+	}
+
+	bool TryWait() const noexcept
+	{	return ! count.load(std::memory_order_acquire);		}
+private:
+	std::atomic<std::ptrdiff_t> 		count;
+	std::mutex 							mutex;
+	Awaiter * 							head 	{ nullptr };
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,572 @@
+/**
+ * 		@Path 	Kelpa/Src/IOSchedule/Epoll.hpp
+ * 		@Brief	Linux reactor on epoll: a slot per file descriptor, level- or edge-triggered
+ * 				callbacks, one-shot coroutine resumption, and a loop sleeping until the next timer
+ * 		@Dependency	./ { Event.hpp }
+ * 					../Thread/ { TimingWheel.hpp }
+ * 					../Coroutine/ { Coroutine.hpp }
+ * 					../Utility/ { Macros.h, Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_IOSCHEDULE_EPOLL_HPP__
+#define __KELPA_IOSCHEDULE_EPOLL_HPP__
+
+#if defined(__linux__)
+
+#include <sys/epoll.h>					/* imports ./ {
+	epoll_create1,
+	epoll_ctl,
+	epoll_wait
+}*/
+#include <sys/eventfd.h>				/* imports ./ {
+	eventfd
+}*/
+#include <unistd.h>						/* imports ./ {
+	read,
+	write,
+	close
+}*/
+#include <cerrno>						/* imports ./ {
+	errno
+}*/
+#include <cstdio>						/* imports ./ {
+	std::perror
+}*/
+#include <cstdlib>						/* imports ./ {
+	std::quick_exit
+}*/
+#include <cstdint>						/* imports ./ {
+	std::uint32_t,
+	std::uint64_t
+}*/
+#include <climits>						/* imports ./ {
+	INT_MAX
+}*/
+#include <coroutine>					/* imports ./ {
+	std::coroutine_handle<>
+}*/
+#include <functional>					/* imports ./ {
+	std::function,
+	std::bind
+}*/
+#include <memory>						/* imports ./ {
+	std::shared_ptr,
+	std::make_shared
+}*/
+#include <vector>						/* imports ./ {
+	std::vector
+}*/
+#include <mutex>						/* imports ./ {
+	std::mutex,
+	std::unique_lock
+}*/
+#include <thread>						/* imports ./ {
+	std::thread
+}*/
+#include <atomic>						/* imports ./ {
+	std::atomic
+}*/
+#include <utility>						/* imports ./ {
+	std::exchange
+}*/
+#include "./Event.hpp"					/* imports ./ {
+	enum class Event,
+	HasEvent
+}*/
+#include "../Thread/TimingWheel.hpp"	/* imports ./ {
+	struct TimingWheel,
+	struct TimerHandle
+}*/
+#include "../Coroutine/Coroutine.hpp"	/* imports ./ {
+	struct WeakFuture,
+	struct CancellableWait,
+	TokenOf
+}*/
+#include "../Utility/Macros.h"			/* imports ./ {
+	#define __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(STRUCT)
+}*/
+#include "../Utility/Interfaces.hpp"	/* imports ./ {
+	struct nonXXXable
+}*/
+
+namespace Kelpa {
+namespace IOSchedule {
+
+/*
+	Each file descriptor owns one slot, indexed by the descriptor itself, holding
+	at most one callback and one waiting coroutine per direction; listening again
+	replaces the previous listener. A wakeup touches the slots of the descriptors
+	epoll reported and nothing else.
+
+	Callbacks stay armed until cancelled and are level-triggered unless listened
+	with Trigger::EDGE. A coroutine is resumed once: while nothing but coroutines
+	waits on a descriptor it is armed with EPOLLONESHOT, so the kernel disarms it
+	on delivery and the reactor re-arms only what is still waited for.
+
+	epoll_wait sleeps until the nearest deadline of the reactor's timing wheel;
+	timers scheduled from other threads wake it through an eventfd. Listen,
+	Cancel, LookUp and Schedule are safe from any thread, callbacks, timers and
+	coroutines run on the thread inside Run()/RunOnce() and should not block
+*/
+struct EpollReactor : Utility::noncopyable {
+__KELPA_DEFINES_STRUCT_MEMBER_TYPES__(EpollReactor)
+
+	typedef signed int 							file_discriptor_type;
+	typedef std::coroutine_handle<> 			coroutine_type;
+	typedef IOSchedule::Event 					Event;
+	typedef Thread::TimingWheel::clock_type 	clock_type;
+	typedef Thread::TimingWheel::time_point_type time_point_type;
+
+	enum class Trigger: unsigned char { 	LEVEL = 0x00, EDGE = 0x01 	};
+
+	struct EventAwaitable;
+
+	EpollReactor& 	Listen(Event event, signed fd, Coroutine::WeakFuture<> const& future) 	noexcept;
+
+	template <typename F, typename... Args> requires std::invocable<F, Args ...> && (!std::convertible_to<std::decay_t<F>, coroutine_type>)
+	EpollReactor& 	Listen(Event event, signed fd, F&& f, Args&&... args) 					noexcept
+	{	return Listen(Trigger::LEVEL, event, fd, std::forward<F>(f), std::forward<Args>(args) ...);	}
+
+	template <typename F, typename... Args> requires std::invocable<F, Args ...> && (!std::convertible_to<std::decay_t<F>, coroutine_type>)
+	EpollReactor& 	Listen(Trigger trigger, Event event, signed fd, F&& f, Args&&... args) 	noexcept;
+
+	/* co_await reactor.Await(Event::READ, fd) yields the events that fired, EXCEPT on error or hang-up, NOEVENT if cancelled */
+	EventAwaitable 	Await(Event event, signed fd) 			noexcept;
+
+	EpollReactor& 	Cancel(signed fd, Event event = static_cast<Event>((unsigned char) 0x07)) noexcept;
+
+	Event 			LookUp(signed fd) 			const noexcept;
+
+	EpollReactor&   Clear()						noexcept;
+
+	/* number of descriptors currently registered with epoll */
+	std::size_t 	Size() 						const noexcept 	{ 	return active.load(std::memory_order_relaxed); 	}
+
+	template <typename Rep, typename Period, typename F, typename... Args> requires std::invocable<F, Args ...>
+	Thread::TimerHandle Schedule(std::chrono::duration<Rep, Period> const& delay, F&& f, Args&&... args) noexcept {
+		Thread::TimerHandle const handle { wheel.Schedule(delay, std::forward<F>(f), std::forward<Args>(args) ...) };
+		if(polling.load(std::memory_order_seq_cst))
+			(void) Wake();
+		return handle;
+	}
+	template <typename Rep, typename Period, typename IRep, typename IPeriod, typename F, typename... Args> requires std::invocable<F, Args ...>
+	Thread::TimerHandle Schedule(std::chrono::duration<Rep, Period> const& delay, std::chrono::duration<IRep, IPeriod> const& interval,
+								 long long signed repeat, F&& f, Args&&... args) noexcept {
+		Thread::TimerHandle const handle { wheel.Schedule(delay, interval, repeat, std::forward<F>(f), std::forward<Args>(args) ...) };
+		if(polling.load(std::memory_order_seq_cst))
+			(void) Wake();
+		return handle;
+	}
+	bool 			Cancel(Thread::TimerHandle handle) 		noexcept 	{ 	return wheel.Cancel(handle); 	}
+
+	/* waits once, until an event, the next timer or Wake(), only polls if not wait; returns the number of events and timers handled */
+	std::size_t 	RunOnce(bool wait = true) 	noexcept;
+	/* loops on the calling thread until Stop() */
+	EpollReactor& 	Run() 						noexcept;
+	/* loops on a thread owned by the reactor */
+	EpollReactor& 	Start() 					noexcept;
+	EpollReactor& 	Stop() 						noexcept;
+	EpollReactor& 	Wake() 						noexcept;
+
+	explicit EpollReactor(std::size_t batch = 1024) noexcept;
+	~EpollReactor() noexcept;
+private:
+	static constexpr std::uint32_t Interests[3] { EPOLLIN | EPOLLRDHUP, EPOLLOUT, EPOLLPRI };
+
+	struct Slot {
+		std::function<void()> 	callbacks[3] 	{};
+		coroutine_type 			fibers[3] 		{};
+		Event * 				results[3] 		{};
+		Event 					persistent 		{ Event::NOEVENT };
+		bool 					edge 			{ false };
+		bool 					added 			{ false };
+		std::uint32_t 			armed 			{};
+		std::uint32_t 			generation 		{};
+	};
+
+	static constexpr Event 	DirectionOf(std::size_t index) noexcept
+	{	return static_cast<Event>(static_cast<unsigned char>(1u << index));	}
+	static constexpr bool 	Includes(Event events, std::size_t index) noexcept
+	{	return (events & DirectionOf(index)) != Event::NOEVENT;		}
+	static constexpr Event 	Translate(std::uint32_t bits) noexcept {
+		Event fired { Event::NOEVENT };
+		if(bits & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+			fired |= Event::READ;
+		if(bits & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+			fired |= Event::WRITE;
+		if(bits & (EPOLLPRI | EPOLLERR))
+			fired |= Event::EXCEPT;
+		return fired;
+	}
+	static int 		TimeoutOf(time_point_type deadline) noexcept;
+
+	Slot& 			SlotOf(signed fd);
+	bool 			Arm(signed fd, Slot& slot) 					noexcept;
+	bool 			Park(Event event, signed fd, coroutine_type coroutine, Event* result) noexcept;
+	bool 			Unpark(Event event, signed fd, coroutine_type coroutine, Event* result) noexcept;
+	std::size_t 	Dispatch(epoll_event const& ready) 			noexcept;
+
+	signed 								epoll 		{ -1 };
+	signed 								wakeup 		{ -1 };
+	std::vector<epoll_event> 			events;
+	std::vector<Slot> 					slots;
+	mutable std::mutex 					mutex;
+	Thread::TimingWheel 				wheel;
+	std::atomic<bool> 					polling 	{ false };
+	std::atomic<bool> 					running 	{ false };
+	std::atomic<bool> 					exit 		{ false };
+	std::atomic<std::size_t> 			active 		{};
+	std::thread 						thread;
+};
+
+/* Linux hosts get the epoll backend under the portable name */
+typedef EpollReactor 	Reactor;
+
+/*
+	A wait whose coroutine carries a cancellation token parks its result in a
+	shared state instead of the awaitable: cancelling takes the coroutine out
+	of its slot by that address, which no later wait of the same coroutine on
+	the same descriptor can share, and resumes it on the reactor's thread
+*/
+struct EpollReactor::EventAwaitable {
+	constexpr bool await_ready() const noexcept { return false; }
+
+	template <typename Promise>
+	bool await_suspend(std::coroutine_handle<Promise> coroutine) noexcept {
+		Coroutine::CancellationToken const token { Coroutine::TokenOf(coroutine) };
+		if(not token.Cancellable()) {
+			if((* reactor).Park(event, fd, coroutine, std::addressof(fired)))
+				return true;
+			fired = Event::EXCEPT;
+			return false;
+		}
+		if(token.Cancelled())
+			return fired = Event::NOEVENT, false;
+
+		auto const wait { std::make_shared<State>() };
+		state = wait;
+		EpollReactor* const reactor_ { reactor };
+		Event const 		event_ 	 { event };
+		signed const 		fd_ 	 { fd };
+		if(not (* reactor_).Park(event_, fd_, coroutine, std::addressof((* wait).fired))) {
+			state.reset();
+			fired = Event::EXCEPT;
+			return false;
+		}
+		/* from here on the coroutine may already be running again on the reactor's thread */
+		(* wait).Arm(token, [reactor_, event_, fd_, coroutine = coroutine_type { coroutine }, result = std::addressof((* wait).fired)] {
+			if((* reactor_).Unpark(event_, fd_, coroutine, result))
+				(void) (* reactor_).Schedule(std::chrono::milliseconds(0), [coroutine] { coroutine.resume(); });
+		});
+		return true;
+	}
+	Event await_resume() const noexcept { return state ? (* state).fired : fired; }
+
+	struct State: Coroutine::CancellableWait {
+		Event 		fired 	{ Event::NOEVENT };
+	};
+
+	EpollReactor * 			reactor;
+	Event 					event;
+	signed 					fd;
+	Event 					fired 	{ Event::NOEVENT };
+	/* only for waits that can be cancelled */
+	std::shared_ptr<State> 	state 	{};
+};
+
+inline EpollReactor::EpollReactor(std::size_t batch) noexcept: events(std::max<std::size_t>(batch, 1)) {
+	if(!~(epoll = ::epoll_create1(EPOLL_CLOEXEC)) || !~(wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) {
+		std::perror("epoll");
+		std::quick_exit(EXIT_FAILURE);
+	}
+	epoll_event event { .events = EPOLLIN, .data = { .fd = wakeup } };
+	(void) ::epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, std::addressof(event));
+}
+
+inline EpollReactor::~EpollReactor() noexcept {
+	(void) Stop();
+	(void) ::close(wakeup);
+	(void) ::close(epoll);
+}
+
+inline auto EpollReactor::SlotOf(signed fd) -> Slot& {
+	if(static_cast<std::size_t>(fd) >= slots.size()) [[unlikely]]
+		slots.resize(std::max({ static_cast<std::size_t>(fd) + 1, slots.size() * 2, std::size_t(64) }));
+	return slots[fd];
+}
+
+/* brings the kernel's interest set in line with the slot, called with the mutex held */
+inline bool EpollReactor::Arm(signed fd, Slot& slot) noexcept {
+	std::uint32_t want {};
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(slot.persistent, index) || slot.fibers[index])
+			want |= Interests[index];
+	if(! want) {
+		if(slot.added) {
+			(void) ::epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+			active.fetch_sub(1, std::memory_order_relaxed);
+		}
+		slot.added = false;
+		slot.armed = 0;
+		return true;
+	}
+	want |= slot.persistent == Event::NOEVENT ? std::uint32_t(EPOLLONESHOT) : slot.edge ? std::uint32_t(EPOLLET) : 0;
+	if(slot.added && want == slot.armed)
+		return true;
+
+	epoll_event event { .events = want, .data = { .fd = fd } };
+	signed result { ::epoll_ctl(epoll, slot.added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, std::addressof(event)) };
+	/* the descriptor was closed and its number reused behind the reactor's back */
+	if(!~result && (errno == ENOENT || errno == EEXIST))
+		result = ::epoll_ctl(epoll, errno == ENOENT ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, std::addressof(event));
+	if(!~result) {
+		if(slot.added)
+			active.fetch_sub(1, std::memory_order_relaxed);
+		slot.added = false;
+		slot.armed = 0;
+		return false;
+	}
+	if(! slot.added)
+		active.fetch_add(1, std::memory_order_relaxed);
+	slot.added = true;
+	slot.armed = want;
+	return true;
+}
+
+inline bool EpollReactor::Park(Event event, signed fd, coroutine_type coroutine, Event* result) noexcept {
+	if(fd < 0 || event == Event::NOEVENT || not HasEvent(event) || not coroutine)
+		return false;
+	std::unique_lock lock { mutex };
+	Slot& slot { SlotOf(fd) };
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(event, index)) {
+			slot.fibers[index] 	= coroutine;
+			slot.results[index] = result;
+		}
+	if(Arm(fd, slot))
+		return true;
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(event, index))
+			slot.fibers[index] = nullptr, slot.results[index] = nullptr;
+	return false;
+}
+
+/* withdraws the wait that Park() registered with the same coroutine and result, if it has not been dispatched yet */
+inline bool EpollReactor::Unpark(Event event, signed fd, coroutine_type coroutine, Event* result) noexcept {
+	std::unique_lock lock { mutex };
+	if(fd < 0 || static_cast<std::size_t>(fd) >= slots.size())
+		return false;
+	Slot& slot { slots[fd] };
+	bool found { false };
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(event, index) && slot.fibers[index] == coroutine && slot.results[index] == result) {
+			slot.fibers[index] = nullptr, slot.results[index] = nullptr;
+			found = true;
+		}
+	if(found)
+		(void) Arm(fd, slot);
+	return found;
+}
+
+inline EpollReactor& EpollReactor::Listen(Event event, signed fd, Coroutine::WeakFuture<> const& future) noexcept {
+	return (void) Park(event, fd, future.operator std::coroutine_handle<>(), nullptr), *this;
+}
+
+template <typename F, typename... Args> requires std::invocable<F, Args ...> && (!std::convertible_to<std::decay_t<F>, EpollReactor::coroutine_type>)
+EpollReactor& EpollReactor::Listen(Trigger trigger, Event event, signed fd, F&& f, Args&&... args) noexcept {
+	if(fd < 0 || event == Event::NOEVENT || not HasEvent(event))
+		return *this;
+	std::function<void()> callback { std::bind(std::forward<F>(f), std::forward<Args>(args) ...) };
+
+	std::unique_lock lock { mutex };
+	Slot& slot { SlotOf(fd) };
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(event, index))
+			slot.callbacks[index] = callback;
+	slot.persistent |= event;
+	slot.edge 		= trigger == Trigger::EDGE;
+	if(not Arm(fd, slot)) {
+		for(std::size_t index {}; index < 3; index ++)
+			if(Includes(event, index))
+				slot.callbacks[index] = nullptr;
+		slot.persistent &= static_cast<Event>(static_cast<unsigned char>(~static_cast<unsigned char>(event)));
+	}
+	return *this;
+}
+
+inline auto EpollReactor::Await(Event event, signed fd) noexcept -> EventAwaitable {
+	return EventAwaitable { .reactor = this, .event = event, .fd = fd };
+}
+
+inline EpollReactor& EpollReactor::Cancel(signed fd, Event event) noexcept {
+	std::unique_lock lock { mutex };
+	if(fd < 0 || static_cast<std::size_t>(fd) >= slots.size())
+		return *this;
+	Slot& slot { slots[fd] };
+	for(std::size_t index {}; index < 3; index ++)
+		if(Includes(event, index)) {
+			slot.callbacks[index] 	= nullptr;
+			slot.fibers[index] 		= nullptr;
+			slot.results[index] 	= nullptr;
+		}
+	slot.persistent &= static_cast<Event>(static_cast<unsigned char>(~static_cast<unsigned char>(event)));
+	if(slot.persistent == Event::NOEVENT)
+		slot.edge = false;
+	slot.generation ++;
+	(void) Arm(fd, slot);
+	return *this;
+}
+
+inline auto EpollReactor::LookUp(signed fd) const noexcept -> Event {
+	std::unique_lock lock { mutex };
+	if(fd < 0 || static_cast<std::size_t>(fd) >= slots.size())
+		return Event::NOEVENT;
+	Slot const& slot { slots[fd] };
+	Event result { slot.persistent };
+	for(std::size_t index {}; index < 3; index ++)
+		if(slot.fibers[index])
+			result |= DirectionOf(index);
+	return result;
+}
+
+inline EpollReactor& EpollReactor::Clear() noexcept {
+	std::unique_lock lock { mutex };
+	for(std::size_t fd {}; fd < slots.size(); fd ++) {
+		if(slots[fd].added)
+			(void) ::epoll_ctl(epoll, EPOLL_CTL_DEL, static_cast<signed>(fd), nullptr);
+		slots[fd] = Slot { .generation = slots[fd].generation + 1 };
+	}
+	active.store(0, std::memory_order_relaxed);
+	return *this;
+}
+
+/*
+	Waiters are taken out of the slot under the mutex, run outside it, and a
+	callback is put back afterwards unless it was cancelled or replaced meanwhile
+*/
+inline std::size_t EpollReactor::Dispatch(epoll_event const& ready) noexcept {
+	signed const fd { ready.data.fd };
+	if(fd == wakeup) {
+		std::uint64_t value;
+		(void) ::read(wakeup, std::addressof(value), sizeof value);
+		return 0;
+	}
+	Event const 			fired 	{ Translate(ready.events) };
+	std::function<void()> 	callbacks[3] 	{};
+	coroutine_type 			fibers[3] 		{};
+	Event * 				results[3] 		{};
+	std::uint32_t 			generation;
+	{
+		std::unique_lock lock { mutex };
+		if(static_cast<std::size_t>(fd) >= slots.size())
+			return 0;
+		Slot& slot { slots[fd] };
+		if(slot.armed & EPOLLONESHOT)
+			slot.armed = 0;
+		generation = slot.generation;
+		for(std::size_t index {}; index < 3; index ++) {
+			if(not Includes(fired, index))
+				continue;
+			if(coroutine_type const fiber { slot.fibers[index] }) {
+				fibers[index] 	= fiber;
+				results[index] 	= slot.results[index];
+				/* a coroutine waiting on several directions is resumed once */
+				for(std::size_t other {}; other < 3; other ++)
+					if(slot.fibers[other] == fiber)
+						slot.fibers[other] = nullptr, slot.results[other] = nullptr;
+			}
+			if(slot.callbacks[index])
+				callbacks[index] = std::exchange(slot.callbacks[index], nullptr);
+		}
+		(void) Arm(fd, slot);
+	}
+	std::size_t handled {};
+	for(std::size_t index {}; index < 3; index ++)
+		if(fibers[index]) {
+			if(results[index])
+				* results[index] = fired;
+			fibers[index].resume();
+			handled ++;
+		}
+	for(std::size_t index {}; index < 3; index ++)
+		if(callbacks[index]) {
+			callbacks[index]();
+			handled ++;
+		}
+	if(! (callbacks[0] || callbacks[1] || callbacks[2]))
+		return handled;
+
+	std::unique_lock lock { mutex };
+	if(static_cast<std::size_t>(fd) >= slots.size() || slots[fd].generation != generation)
+		return handled;
+	Slot& slot { slots[fd] };
+	for(std::size_t index {}; index < 3; index ++)
+		if(callbacks[index] && ! slot.callbacks[index] && Includes(slot.persistent, index))
+			slot.callbacks[index] = std::move(callbacks[index]);
+	return handled;
+}
+
+inline int EpollReactor::TimeoutOf(time_point_type deadline) noexcept {
+	if(deadline == time_point_type::max())
+		return -1;
+	auto const now { clock_type::now() };
+	if(deadline <= now)
+		return 0;
+	auto const wait { std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count() };
+	return wait > INT_MAX ? INT_MAX : static_cast<int>(wait);
+}
+
+inline std::size_t EpollReactor::RunOnce(bool wait) noexcept {
+	/* published before the deadline is read, pairs with the check in Schedule() */
+	polling.store(true, std::memory_order_seq_cst);
+	signed const count { ::epoll_wait(epoll, events.data(), static_cast<int>(events.size()), wait ? TimeoutOf(wheel.NextDeadline()) : 0) };
+	polling.store(false, std::memory_order_relaxed);
+	if(!~count && errno != EINTR) {
+		std::perror("epoll_wait");
+		std::quick_exit(EXIT_FAILURE);
+	}
+	std::size_t handled {};
+	for(signed index {}; index < count; index ++)
+		handled += Dispatch(events[index]);
+	return handled + wheel.Advance();
+}
+
+inline EpollReactor& EpollReactor::Run() noexcept {
+	running.store(true, std::memory_order_seq_cst);
+	while(! exit.load(std::memory_order_acquire))
+		(void) RunOnce();
+	running.store(false, std::memory_order_seq_cst);
+	exit.store(false, std::memory_order_release);
+	return *this;
+}
+
+inline EpollReactor& EpollReactor::Start() noexcept {
+	if(not thread.joinable())
+		thread = std::thread([this] { (void) Run(); });
+	return *this;
+}
+
+inline EpollReactor& EpollReactor::Stop() noexcept {
+	if(thread.joinable() || running.load(std::memory_order_seq_cst)) {
+		exit.store(true, std::memory_order_release);
+		(void) Wake();
+	}
+	if(thread.joinable() && thread.get_id() != std::this_thread::get_id())
+		thread.join();
+	return *this;
+}
+
+inline EpollReactor& EpollReactor::Wake() noexcept {
+	std::uint64_t const one { 1 };
+	(void) ::write(wakeup, std::addressof(one), sizeof one);
+	return *this;
+}
+
+}		//namespace IOSchedule
+}		//namespace Kelpa
+
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * 		@Path 	Kelpa/Src/IOSchedule/Event.hpp
+ * 		@Brief	Readiness events shared by every reactor backend
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_IOSCHEDULE_EVENT_HPP__
+#define __KELPA_IOSCHEDULE_EVENT_HPP__
+
+#include <string>						/* imports ./ {
+	std::string
+}*/
+#include <ostream>						/* imports ./ {
+	std::ostream
+}*/
+#include <format>						/* imports ./ {
+	std::formatter
+}*/
+#include <type_traits>					/* imports ./ {
+	std::underlying_type_t
+}*/
+
+namespace Kelpa {
+namespace IOSchedule {
+
+enum class Event: unsigned char { 		NOEVENT = 0X00, READ = 0x01, WRITE = 0x02, EXCEPT = 0x04 		};
+
+constexpr Event operator|(Event a, Event b) noexcept {
+    typedef std::underlying_type_t<Event> T;
+    return static_cast<Event>(static_cast<T>(a) | static_cast<T>(b));
+}
+constexpr Event operator&(Event a, Event b) noexcept {
+    using T = std::underlying_type_t<Event>;
+    return static_cast<Event>(static_cast<T>(a) & static_cast<T>(b));
+}
+constexpr Event& operator|=(Event& a, Event b) noexcept {
+    return (a = a | b);
+}
+constexpr Event& operator&=(Event& a, Event b) noexcept {
+    return (a = a & b);
+}
+
+constexpr bool HasEvent(Event event) noexcept {
+	return 	event == Event::NOEVENT
+	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::READ))	)
+	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::WRITE))	)
+	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT))	);
+}
+
+constexpr std::string NameOfEvent(Event event) noexcept {
+	if(not HasEvent(event))
+		return "NOEVENT";
+
+	std::string name;
+	if(static_cast<std::underlying_type_t<Event>>((event & Event::READ)))
+		name += "READ |";
+	if(static_cast<std::underlying_type_t<Event>>((event & Event::WRITE)))
+		name += "WRITE |";
+	if(static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT)))
+		name += "EXCEPT |";
+	if(name.empty())
+		return "UNKNOWN";
+	return name.erase(name.length() - 1);
+}
+
+inline std::ostream& operator<<(std::ostream& Os, Event event) noexcept {
+	return (Os << NameOfEvent(event));
+}
+
+}
+}
+
+namespace std {
+
+
+template<>  struct formatter<Kelpa::IOSchedule::Event> {
+    constexpr auto parse(std::format_parse_context& context) 					const noexcept
+	{  	return context.begin(); 							}
+	auto format(Kelpa::IOSchedule::Event const& t, std::format_context& context) 	const
+	{  	return std::format_to(context.out(), "{}", Kelpa::IOSchedule::NameOfEvent(t));  	}
+};
+
+
+
+}
+
+#endif
@@ -9,7 +9,14 @@
 #ifndef __KELPA_IOSCHEDULE_IOSCHEDULE_HPP__
 #define __KELPA_IOSCHEDULE_IOSCHEDULE_HPP__
 
+#include "./Event.hpp"
+#if defined(_WIN32)
 #include "./Reactor.hpp"
+#elif defined(__linux__)
+#include "./Epoll.hpp"
+#include "./Uring.hpp"
+#include "./Sharded.hpp"
+#endif
 
 
 #endif
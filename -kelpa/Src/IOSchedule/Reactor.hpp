@@ -2,8 +2,9 @@
  * 		@Path 	Kelpa/IOSchedule/Reactor.hpp
  * 		@Brief	The asynchronous scheduler listening file descriptors for associated events
  * 		@Dependency ../Coroutine 	{ Coroutine.hpp,  }
- * 					../Thread 		{ Executor.hpp, Timer.hpp 	}
+ * 					../Thread 		{ Executor.hpp, Timer.hpp, Sync/RingQueue.hpp 	}
  * 					../Utility      { Macros.h, Interfaces.hpp, UniqueAny.hpp }
+ * 					./ 				{ Event.hpp }
  *		@Since  2024/04/25
  		@Version 1st
  **/
@@ -14,7 +15,8 @@
 	fd_set, 
 	#define 
 	FD_XXX, 
-	select 
+	select,
+	socket, bind, connect, send, recv, ...
 }*/
 #include <coroutine>					/* imports ./ { 
 	std::coroutine_handle<> 
@@ -30,6 +32,9 @@
 	struct Timer, 
 	struct Intervalometer 
 }*/
+#include "../Thread/Sync/RingQueue.hpp"	/* imports ./ { 
+	struct RingQueue 
+}*/
 #include "../Utility/Macros.h"			/* imports ./ {
 	#define __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(STRUCT)
 }}*/
@@ -42,6 +47,10 @@
 #include "../Utility/UniqueAny.hpp"		/* imports ./ { 
 	struct UniqueAny 
 }*/
+#include "./Event.hpp"					/* imports ./ {
+	enum class Event,
+	NameOfEvent
+}*/
 
 namespace Kelpa {
 namespace IOSchedule {
@@ -62,17 +71,33 @@ namespace IOSchedule {
 typedef Utility::UniqueAny<std::coroutine_handle<>, decltype([](auto&& coroutine) {
 	if(coroutine.operator bool()) coroutine.destroy();
 })> CoUnique;	
+/*
+	Callbacks are handed to the executor, coroutines are not: each descriptor
+	owns one slot, indexed by the descriptor, holding the coroutine waiting in
+	each direction. The polling thread notes what select found ready while it
+	holds the lock, then resumes those coroutines itself once it has let go,
+	so a coroutine may Listen or Cancel as it runs. Nothing is allocated,
+	wrapped or submitted per event.
+
+	The reactor owns the coroutines it is given: they stay listened, and are
+	resumed on every poll that finds their descriptor ready, until they finish
+	or are cancelled, and are destroyed then. Listening a second coroutine on
+	the same descriptor and direction replaces the first. Post() resumes a
+	coroutine it does not own on the polling thread, from any thread: a UDP
+	socket connected to itself sits in the read set, and Post() sends it a
+	byte so a select blocked on the other descriptors returns at once
+*/
 struct Reactor : Utility::noncopyable {
 __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Reactor)	
 
 	typedef signed int 					file_discriptor_type;
 	typedef std::coroutine_handle<> 	coroutine_type;
 
-	enum class Event: unsigned char { 		NOEVENT = 0X00, READ = 0x01, WRITE = 0x02, EXCEPT = 0x04 		};
+	typedef IOSchedule::Event 			Event;
 
 	Reactor& 	Listen(Event event, signed fd, Coroutine::WeakFuture<> const& future) 	noexcept;
 
-	template <typename F, typename... Args> requires std::invocable<F, Args ...>
+	template <typename F, typename... Args> requires std::invocable<F, Args ...> && (!std::convertible_to<std::decay_t<F>, coroutine_type>)
 	Reactor& 	Listen(Event event, signed fd, F&&f, Args&&... args) 					noexcept;
 
 	Reactor& 	Cancel(signed fd, Event event = static_cast<Event>((unsigned char) 0x07)) noexcept;
@@ -81,19 +106,68 @@ __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Reactor)
 
 	Reactor&    Clear()						noexcept;
 
+	/* 
+		resumes the coroutine on the polling thread, from any thread and without the lock, 
+		waking the select if it is blocked; false if the ready queue is full 
+	*/
+	bool 		Post(coroutine_type coroutine) 	noexcept;
+
+/*
+	Puts `limiter` (see Thread/Admission.hpp) in front of the executor that runs
+	the callbacks. A readiness callback it refuses is dropped, not queued: select
+	is level-triggered, so the descriptor is simply reported again on a later poll 
+	and pending connections wait in the kernel's backlog instead of the executor's
+	queue. Call it before the first Listen()
+*/
+	template <typename Limiter>
+	Reactor& 	SetAdmission(Limiter& limiter) noexcept {
+		(void) (* executor).Spawn().SetRejectionPolicy(Thread::RejectionPolicy::DISCARD).SetAdmission(limiter);
+		return *this;
+	}
+
+	template <typename Rep, typename Period>
+	Reactor& 	SetPollingInterval(std::chrono::duration<Rep, Period> const& interval) noexcept 
+	{	return (void) lometer.Reschedule(polling, interval), *this;		}
+
 	Reactor() 	noexcept;
-	~Reactor() 	noexcept { 	exit.store(true, std::memory_order_seq_cst);	}
+	~Reactor() 	noexcept;
 	
 	Thread::Intervalometer				lometer;
 private:
+	struct Slot {
+		coroutine_type 					fibers[3] 	{};
+	};
+	/* the self-connected socket Post() writes to; one byte is in flight at most */
+	struct Wakeup {
+		Wakeup() 	noexcept;
+		~Wakeup() 	noexcept;
+		void 		Signal() 	noexcept;
+		void 		Drain() 	noexcept;
+
+		SOCKET 							descriptor 	{ INVALID_SOCKET };
+		std::atomic<bool> 				signalled 	{ false };
+		bool 							started 	{ false };
+	};
+	static constexpr Event 	DirectionOf(std::size_t index) noexcept
+	{	return static_cast<Event>(static_cast<unsigned char>(1u << index));	}
+
+	Slot& 		SlotOf(signed fd);
+	void 		Retire(coroutine_type fiber) 			noexcept;
+	void 		Resume() 								noexcept;
+
+	Thread::TimerHandle 				polling;
 	std::unordered_multimap<signed, std::function<void()>> 		ReadCallbacks;
-	std::unordered_multimap<signed, CoUnique>	ReadFibers;
-	
 	std::unordered_multimap<signed, std::function<void()>>  	WriteCallbacks;
-	std::unordered_multimap<signed, CoUnique>	WriteFibers;
-	
 	std::unordered_multimap<signed, std::function<void()>>  	ExceptCallbacks;
-	std::unordered_multimap<signed, CoUnique>	ExceptFibers;
+
+	std::vector<Slot> 					slots;
+	/* what the last select found ready, (fd, direction), kept from round to round so it stops allocating */
+	std::vector<std::pair<signed, std::size_t>> 	runnable;
+	Thread::Sync::RingQueue<coroutine_type> 		ready 		{ 1024 };
+	Wakeup 								wakeup;
+	/* the coroutine the polling thread is running, which Retire() must not destroy under it */
+	void * 								resuming 	{ nullptr };
+	bool 								abandoned 	{ false };
 	
 	std::atomic<bool>					exit 		{ false };
 	std::atomic<signed>					throttle 	= 0;
@@ -107,68 +181,67 @@ private:
 	
 	std::shared_mutex					mutex;
 };	
-typedef typename Reactor::Event 		Event;
- 
-constexpr Event operator|(Event a, Event b) noexcept {  
-    typedef std::underlying_type_t<Event> T;  
-    return static_cast<Event>(static_cast<T>(a) | static_cast<T>(b));  
-}  
-constexpr Event operator&(Event a, Event b) noexcept {  
-    using T = std::underlying_type_t<Event>;  
-    return static_cast<Event>(static_cast<T>(a) & static_cast<T>(b));  
-}
-constexpr Event operator|=(Event a, Event b) noexcept {  
-    typedef std::underlying_type_t<Event> T;  
-    return (a = static_cast<Event>(static_cast<T>(a) | static_cast<T>(b)));  
-}  
-constexpr Event operator&=(Event a, Event b) noexcept {  
-    using T = std::underlying_type_t<Event>;  
-    return (a = static_cast<Event>(static_cast<T>(a) & static_cast<T>(b)));  
-} 
- 
-constexpr bool HasEvent(Event event) noexcept {
-	return 	event == Event::NOEVENT 
-	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::READ))	)
-	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::WRITE))	)
-	|| (	static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT))	);
-} 
- 
 Reactor::Reactor() noexcept {
 	FD_ZERO(std::addressof(ReadSet));
 	FD_ZERO(std::addressof(WriteSet));
 	FD_ZERO(std::addressof(ExceptSet));
+	if(wakeup.descriptor != INVALID_SOCKET) {
+		FD_SET(wakeup.descriptor, std::addressof(ReadSet));
+		throttle.store(static_cast<signed>(wakeup.descriptor), std::memory_order_seq_cst);
+	}
 	
-	lometer.Schedule(Thread::Timer()
+	polling = lometer.Schedule(Thread::Timer()
 	.Build()
 	.SetDuration(std::chrono::milliseconds(500))
 	.SetRepeat(Thread::Timer::infinite)
 	.SetCallback([this] {
-		std::shared_lock 	lock 			{mutex};	//locking op might as well be removed
+		/* select returns as soon as anything is ready or posted; keep selecting until the next timer is due, 
+		   or the thread would sleep in the intervalometer for the rest of the period without watching */
+		do {
+			std::shared_lock 	lock 			{mutex};
+			/* the destructor is closing the wakeup socket */
+			if(exit.load(std::memory_order_seq_cst))
+				return;
 	
-		fd_set 				tempReadSet 	= ReadSet;
-		fd_set 				tempWriteSet 	= WriteSet;
-		fd_set				tempExceptSet   = ExceptSet;
+			fd_set 				tempReadSet 	= ReadSet;
+			fd_set 				tempWriteSet 	= WriteSet;
+			fd_set				tempExceptSet   = ExceptSet;
 	
-		struct timeval tVal;
-		std::memset(std::addressof(tVal), 0, sizeof tVal);
-		tVal.tv_usec = (lometer.WhenNextComes.load(std::memory_order_seq_cst) - Utility::Now<>()).count();
+			struct timeval tVal;
+			std::memset(std::addressof(tVal), 0, sizeof tVal);
+			auto const 	wait = not ready.Empty() ? std::chrono::milliseconds::zero() : std::clamp<std::chrono::milliseconds>(
+				lometer.WhenNextComes.load(std::memory_order_seq_cst) - Utility::SteadyNow<typename std::chrono::milliseconds::rep>(), 
+				std::chrono::milliseconds::zero(), std::chrono::seconds(1));
+			tVal.tv_sec  = static_cast<long>(std::chrono::duration_cast<std::chrono::seconds>(wait).count());
+			tVal.tv_usec = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(wait % std::chrono::seconds(1)).count());
 		
 
-		if(!~select(throttle + 1, std::addressof(tempReadSet), std::addressof(tempWriteSet), nullptr, std::addressof(tVal))) {
-			std::perror("select");
-			std::quick_exit(EXIT_FAILURE);		
-		}
-		for(signed int fd {}; fd < throttle + 1; fd ++) {
-			if(FD_ISSET(fd, std::addressof(tempReadSet))) 
-				for(auto it { ReadCallbacks.equal_range(fd).first }; it != ReadCallbacks.equal_range(fd).second; it ++)
-					handle.Submit(Thread::Priority::STANDARD, ( *it).second);
-			if(FD_ISSET(fd, std::addressof(tempWriteSet))) 
-				for(auto it { WriteCallbacks.equal_range(fd).first }; it != WriteCallbacks.equal_range(fd).second; it ++)
-					handle.Submit(Thread::Priority::STANDARD, (* it).second);
-			if(FD_ISSET(fd, std::addressof(tempExceptSet))) 
-				for(auto it { ExceptCallbacks.equal_range(fd).first }; it != ExceptCallbacks.equal_range(fd).second; it ++)
-					handle.Submit(Thread::Priority::URGENT, (* it).second);
-		}
+			if(!~select(throttle + 1, std::addressof(tempReadSet), std::addressof(tempWriteSet), std::addressof(tempExceptSet), std::addressof(tVal))) {
+				std::perror("select");
+				std::quick_exit(EXIT_FAILURE);		
+			}
+			if(wakeup.descriptor != INVALID_SOCKET && FD_ISSET(wakeup.descriptor, std::addressof(tempReadSet)))
+				wakeup.Drain();
+			for(signed int fd {}; fd < throttle + 1; fd ++) {
+				if(FD_ISSET(fd, std::addressof(tempReadSet))) 
+					for(auto it { ReadCallbacks.equal_range(fd).first }; it != ReadCallbacks.equal_range(fd).second; it ++)
+						handle.Submit(Thread::Priority::STANDARD, ( *it).second);
+				if(FD_ISSET(fd, std::addressof(tempWriteSet))) 
+					for(auto it { WriteCallbacks.equal_range(fd).first }; it != WriteCallbacks.equal_range(fd).second; it ++)
+						handle.Submit(Thread::Priority::STANDARD, (* it).second);
+				if(FD_ISSET(fd, std::addressof(tempExceptSet))) 
+					for(auto it { ExceptCallbacks.equal_range(fd).first }; it != ExceptCallbacks.equal_range(fd).second; it ++)
+						handle.Submit(Thread::Priority::URGENT, (* it).second);
+				if(static_cast<std::size_t>(fd) >= slots.size())
+					continue;
+				fd_set const* const sets[3] { std::addressof(tempReadSet), std::addressof(tempWriteSet), std::addressof(tempExceptSet) };
+				for(std::size_t index {}; index < 3; index ++)
+					if(slots[fd].fibers[index] && FD_ISSET(fd, sets[index]))
+						runnable.emplace_back(fd, index);
+			}
+			lock.unlock();
+			Resume();
+		} while(not exit.load(std::memory_order_seq_cst) && Utility::SteadyNow<typename std::chrono::milliseconds::rep>() < lometer.WhenNextComes.load(std::memory_order_seq_cst));
 	}).Continue());
 	handle.Submit(Thread::Priority::HARSH, [this] {	
 		while(!exit.load(std::memory_order_seq_cst)) 
@@ -177,67 +250,32 @@ Reactor::Reactor() noexcept {
 	});
 }
 
-constexpr std::string NameOfEvent(Event event) noexcept {
-	if(not HasEvent(event)) 
-		return "NOEVENT";
-	
-	std::string name;
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::READ))) 	
-		name += "READ |";
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::WRITE))) 		
-		name += "WRITE |";
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT))) 
-		name += "EXCEPT |";
-	if(name.empty()) 
-		return "UNKNOWN";
-	return name.erase(name.length() - 1);
-}
-
-std::ostream& operator<<(std::ostream& Os, Event event) noexcept {
-	return (Os << NameOfEvent(event));
-}
-
-
 Reactor& Reactor::Listen(Event event, signed fd, Coroutine::WeakFuture<> const& future) 	noexcept {	
 	if(not HasEvent(event)) 
 		return *this;
 	
 	throttle.store(std::max(throttle.load(std::memory_order_seq_cst), fd), std::memory_order_seq_cst);
 	
-	std::unique_lock lock {mutex};
+	coroutine_type const 	coroutine 	{ future.operator std::coroutine_handle<>() };
+	fd_set * const 			sets[3] 	{ std::addressof(ReadSet), std::addressof(WriteSet), std::addressof(ExceptSet) };
+	if(fd < 0 || not coroutine)
+		return *this;
 	
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::READ))) 	{
-		if(!FD_ISSET(fd, std::addressof(ReadSet)))
-			FD_SET(fd, std::addressof(ReadSet));
-		ReadFibers.emplace(fd, future.operator std::coroutine_handle<>());
-		ReadCallbacks.emplace(fd, [coroutine = future.operator std::coroutine_handle<>()]{
-			std::puts("resume");
-			coroutine.resume();
-		});
+	std::unique_lock lock {mutex};
+	Slot& slot { SlotOf(fd) };
+	for(std::size_t index {}; index < 3; index ++) {
+		if(static_cast<std::underlying_type_t<Event>>(event & DirectionOf(index)) == 0)
+			continue;
+		if(!FD_ISSET(fd, sets[index]))
+			FD_SET(fd, sets[index]);
+		if(coroutine_type const previous { std::exchange(slot.fibers[index], coroutine) }; previous && previous != coroutine 
+		&& std::ranges::find(slot.fibers, previous) == std::ranges::end(slot.fibers))
+			Retire(previous);
 	}
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::WRITE))) 	{
-		if(!FD_ISSET(fd, std::addressof(WriteSet)))
-			FD_SET(fd, std::addressof(WriteSet));
-		WriteFibers.emplace(fd, future.operator std::coroutine_handle<>());
-		WriteCallbacks.emplace(fd, [coroutine = future.operator std::coroutine_handle<>()]{
-			std::puts("resume");
-			coroutine.resume();
-		});
-	}	
-	if(static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT))) 	{
-		if(!FD_ISSET(fd, std::addressof(ExceptSet)))
-			FD_SET(fd, std::addressof(ExceptSet));
-		ExceptFibers.emplace(fd, future.operator std::coroutine_handle<>());
-		ExceptCallbacks.emplace(fd, [coroutine = future.operator std::coroutine_handle<>()]{
-			std::puts("resume");
-			coroutine.resume();
-		});
-	}	
-	
 	return *this;	
 }
 
-template <typename F, typename... Args> requires std::invocable<F, Args ...>
+template <typename F, typename... Args> requires std::invocable<F, Args ...> && (!std::convertible_to<std::decay_t<F>, Reactor::coroutine_type>)
 Reactor& Reactor::Listen(Event event, signed fd, F&&f, Args&&... args) noexcept {
 	if(not HasEvent(event)) 
 		return *this;
@@ -270,17 +308,24 @@ Reactor& Reactor::Cancel(signed fd, Event event) 			noexcept {
 	if(static_cast<std::underlying_type_t<Event>>((event & Event::READ))) 	{
 		FD_CLR(fd, std::addressof(ReadSet));
 		ReadCallbacks.erase(fd);
-		ReadFibers.erase(fd);
 	}
 	if(static_cast<std::underlying_type_t<Event>>((event & Event::WRITE))) 	{
 		FD_CLR(fd, std::addressof(WriteSet));
 		WriteCallbacks.erase(fd);
-		WriteFibers.erase(fd);		
 	}	
 	if(static_cast<std::underlying_type_t<Event>>((event & Event::EXCEPT))) 	{
 		FD_CLR(fd, std::addressof(ExceptSet));
 		ExceptCallbacks.erase(fd);
-		ExceptFibers.erase(fd);		
+	}
+	if(fd < 0 || static_cast<std::size_t>(fd) >= slots.size())
+		return *this;
+	Slot& slot { slots[fd] };
+	for(std::size_t index {}; index < 3; index ++) {
+		if(static_cast<std::underlying_type_t<Event>>(event & DirectionOf(index)) == 0)
+			continue;
+		if(coroutine_type const fiber { std::exchange(slot.fibers[index], nullptr) }; fiber 
+		&& std::ranges::find(slot.fibers, fiber) == std::ranges::end(slot.fibers))
+			Retire(fiber);
 	}
 	return *this;
 }
@@ -298,35 +343,138 @@ Reactor&    Reactor::Clear()				noexcept {
 	FD_ZERO(std::addressof(ReadSet));
 	FD_ZERO(std::addressof(WriteSet));	
 	FD_ZERO(std::addressof(ExceptSet));
+	if(wakeup.descriptor != INVALID_SOCKET)
+		FD_SET(wakeup.descriptor, std::addressof(ReadSet));
 
 	std::decay_t<decltype(ReadCallbacks)>().swap(ReadCallbacks);
 	std::decay_t<decltype(ReadCallbacks)>().swap(WriteCallbacks);
 	std::decay_t<decltype(ReadCallbacks)>().swap(ExceptCallbacks);
 
-	std::decay_t<decltype(ReadFibers)>().swap(ReadFibers);
-	std::decay_t<decltype(WriteFibers)>().swap(WriteFibers);
-	std::decay_t<decltype(ExceptFibers)>().swap(ExceptFibers);
+	std::unique_lock lock {mutex};
+	for(Slot& slot: slots) 
+		for(std::size_t index {}; index < 3; index ++)
+			if(coroutine_type const fiber { std::exchange(slot.fibers[index], nullptr) }; fiber 
+			&& std::ranges::find(slot.fibers, fiber) == std::ranges::end(slot.fibers))
+				Retire(fiber);
+	return *this;	
+}
 
+bool 		Reactor::Post(coroutine_type coroutine) 	noexcept {
+	if(not ready.TryPush(coroutine))
+		return false;
+	wakeup.Signal();
+	return true;
+}
 
-	return *this;	
+Reactor::~Reactor() noexcept {
+	exit.store(true, std::memory_order_seq_cst);
+	(void) lometer.Cancel(polling);
+	/* cut the current select short and wait it out: no poll selects on the wakeup socket after this */
+	wakeup.Signal();
+	{ 	std::unique_lock lock {mutex}; 	}
+	(void) Clear();
 }
 
+Reactor::Slot& Reactor::SlotOf(signed fd) {
+	if(static_cast<std::size_t>(fd) >= slots.size()) [[unlikely]]
+		slots.resize(std::max({ static_cast<std::size_t>(fd) + 1, slots.size() * 2, std::size_t(64) }));
+	return slots[fd];
+}
 
+/* 
+	bound to an ephemeral loopback port and connected to it, so what it sends 
+	comes back to it; without one, Post() still works, a poll later 
+*/
+Reactor::Wakeup::Wakeup() noexcept {
+	WSADATA data;
+	if(not (started = WSAStartup(MAKEWORD(2, 2), std::addressof(data)) == 0))
+		return;
+	if((descriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == INVALID_SOCKET)
+		return;
+	struct sockaddr_in address;
+	std::memset(std::addressof(address), 0, sizeof address);
+	address.sin_family 		= AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	int length 				= sizeof address;
+	u_long nonblocking 		= 1;
+	if(bind(descriptor, reinterpret_cast<struct sockaddr *>(std::addressof(address)), sizeof address) == SOCKET_ERROR
+	|| getsockname(descriptor, reinterpret_cast<struct sockaddr *>(std::addressof(address)), std::addressof(length)) == SOCKET_ERROR
+	|| connect(descriptor, reinterpret_cast<struct sockaddr *>(std::addressof(address)), length) == SOCKET_ERROR
+	|| ioctlsocket(descriptor, FIONBIO, std::addressof(nonblocking)) == SOCKET_ERROR) {
+		(void) closesocket(descriptor);
+		descriptor = INVALID_SOCKET;
+	}
 }
+Reactor::Wakeup::~Wakeup() noexcept {
+	if(descriptor != INVALID_SOCKET)
+		(void) closesocket(descriptor);
+	if(started)
+		(void) WSACleanup();
+}
+/* only the first Signal() since the last Drain() sends */
+void Reactor::Wakeup::Signal() noexcept {
+	char const byte {};
+	if(descriptor != INVALID_SOCKET && not signalled.exchange(true, std::memory_order_seq_cst))
+		(void) send(descriptor, std::addressof(byte), 1, 0);
+}
+/* 
+	on the polling thread, before the ready queue is drained: a Post() that 
+	finds the flag still set has pushed in time to be popped this round 
+*/
+void Reactor::Wakeup::Drain() noexcept {
+	char bytes[16];
+	signalled.store(false, std::memory_order_seq_cst);
+	while(recv(descriptor, bytes, sizeof bytes, 0) > 0);
 }
 
-namespace std {
+/* called with the mutex held, once the fiber is in no slot any more */
+void Reactor::Retire(coroutine_type fiber) noexcept {
+	if(fiber.address() == resuming) 
+		abandoned = true;
+	else 
+		fiber.destroy();
+}
 
-	
-template<>  struct formatter<Kelpa::IOSchedule::Event> {  
-    constexpr auto parse(std::format_parse_context& context) 					const noexcept 
-	{  	return context.begin(); 							}  
-	auto format(Kelpa::IOSchedule::Event const& t, std::format_context& context) 	const 
-	{  	return std::format_to(context.out(), "{}", Kelpa::IOSchedule::NameOfEvent(t));  	}  
-}; 
+/* runs on the polling thread without the lock, so the coroutines are free to Listen and Cancel */
+void Reactor::Resume() noexcept {
+	std::pair<signed, coroutine_type> previous { -1, nullptr };
+	for(auto const& [fd, index]: runnable) {
+		coroutine_type fiber;
+		{
+			std::unique_lock lock {mutex};
+			fiber = static_cast<std::size_t>(fd) < slots.size() ? slots[fd].fibers[index] : nullptr;
+			/* gone since the poll, or the same coroutine already resumed for another direction */
+			if(not fiber || previous == std::pair { fd, fiber })
+				continue;
+			resuming = fiber.address();
+		}
+		previous = { fd, fiber };
+		fiber.resume();
 
+		std::unique_lock lock {mutex};
+		resuming = nullptr;
+		if(std::exchange(abandoned, false)) 
+			fiber.destroy();
+		else if(fiber.done()) {
+			Slot& slot { slots[fd] };
+			fd_set * const sets[3] { std::addressof(ReadSet), std::addressof(WriteSet), std::addressof(ExceptSet) };
+			decltype(ReadCallbacks) const* const callbacks[3] { std::addressof(ReadCallbacks), std::addressof(WriteCallbacks), std::addressof(ExceptCallbacks) };
+			for(std::size_t other {}; other < 3; other ++)
+				if(slot.fibers[other] == fiber) {
+					slot.fibers[other] = nullptr;
+					if(not (* callbacks[other]).contains(fd))
+						FD_CLR(fd, sets[other]);
+				}
+			fiber.destroy();
+		}
+	}
+	runnable.clear();
+	while(std::optional<coroutine_type> const posted { ready.TryPop() })
+		(* posted).resume();
+}
 
-	
+
+}
 }
 
 #endif
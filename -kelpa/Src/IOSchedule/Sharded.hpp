@@ -0,0 +1,408 @@
+/**
+ * 		@Path 	Kelpa/Src/IOSchedule/Sharded.hpp
+ * 		@Brief	Shared-nothing thread-per-core mode: one pinned epoll reactor per core,
+ * 				SO_REUSEPORT listeners and SPSC queues between the cores
+ * 		@Dependency	./ { Epoll.hpp }
+ * 					../Thread/Sync/ { SPSCQueue.hpp }
+ * 					../Utility/ { Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_IOSCHEDULE_SHARDED_HPP__
+#define __KELPA_IOSCHEDULE_SHARDED_HPP__
+
+#if defined(__linux__)
+
+#include <sys/socket.h>					/* imports ./ {
+	socket,
+	bind,
+	listen,
+	accept4,
+	setsockopt,
+	struct linger
+}*/
+#include <netinet/in.h>					/* imports ./ {
+	struct sockaddr_in,
+	struct sockaddr_in6,
+	ntohs
+}*/
+#include <pthread.h>					/* imports ./ {
+	pthread_setaffinity_np
+}*/
+#include <sched.h>						/* imports ./ {
+	cpu_set_t,
+	CPU_SET
+}*/
+#include <fcntl.h>						/* imports ./ {
+	open,
+	O_RDONLY,
+	O_CLOEXEC
+}*/
+#include <unistd.h>						/* imports ./ {
+	close
+}*/
+#include <cerrno>						/* imports ./ {
+	errno,
+	EMFILE,
+	ENFILE
+}*/
+#include <chrono>						/* imports ./ {
+	std::chrono::milliseconds
+}*/
+#include <cstring>						/* imports ./ {
+	std::memcpy
+}*/
+#include <algorithm>					/* imports ./ {
+	std::min,
+	std::max
+}*/
+#include <optional>						/* imports ./ {
+	std::optional
+}*/
+#include <any>							/* imports ./ {
+	std::any,
+	std::any_cast
+}*/
+#include <atomic>						/* imports ./ {
+	std::atomic
+}*/
+#include <functional>					/* imports ./ {
+	std::function
+}*/
+#include <memory>						/* imports ./ {
+	std::unique_ptr
+}*/
+#include <mutex>						/* imports ./ {
+	std::mutex,
+	std::unique_lock
+}*/
+#include <thread>						/* imports ./ {
+	std::thread
+}*/
+#include <unordered_map>				/* imports ./ {
+	std::unordered_map
+}*/
+#include <vector>						/* imports ./ {
+	std::vector
+}*/
+#include "./Epoll.hpp"					/* imports ./ {
+	struct EpollReactor
+}*/
+#include "../Thread/Sync/SPSCQueue.hpp"	/* imports ./ {
+	struct SPSCQueue
+}*/
+#include "../Utility/Interfaces.hpp"	/* imports ./ {
+	struct nonXXXable
+}*/
+
+namespace Kelpa {
+namespace IOSchedule {
+
+struct ShardedReactor;
+
+/*
+	One core's share of the server: its own event loop and timers, the
+	connections it accepted, and one inbound queue per other shard. Everything
+	but Post() is meant to be called on the shard's own thread only
+*/
+struct Shard : Utility::noncopyable, Utility::nonmoveable {
+	typedef std::function<void()> 							message_type;
+	typedef Thread::Sync::SPSCQueue<message_type> 			queue_type;
+
+	std::size_t 		Index() 		const noexcept 	{ 	return index; 		}
+	EpollReactor& 		Reactor() 			  noexcept 	{ 	return reactor; 	}
+
+	/* the shard whose thread is calling, nullptr outside every shard */
+	static Shard* 		Current() 			  noexcept 	{ 	return current; 	}
+
+	/* the connection table: a descriptor owned by this shard and the state attached to it */
+	Shard& 				Adopt(signed fd, std::any state = {});
+	template <typename T>
+	T* 					Find(signed fd) 	  noexcept;
+	/* stops listening on the descriptor, closes it and forgets its state */
+	Shard& 				Drop(signed fd) 	  noexcept;
+	std::size_t 		Connections() 	const noexcept 	{ 	return connections.size(); 	}
+
+	Shard(ShardedReactor& owner, std::size_t index, std::size_t lanes);
+	~Shard() noexcept;
+private:
+	friend struct ShardedReactor;
+
+	void 				Loop() 				  noexcept;
+	std::size_t 		Drain() 			  noexcept;
+	bool 				Idle() 			const noexcept;
+
+	ShardedReactor& 						owner;
+	std::size_t 							index;
+	EpollReactor 							reactor;
+	/* inbox[i] is written by shard i only, the last lane by threads outside the shards under `outside` */
+	std::vector<std::unique_ptr<queue_type>> inbox;
+	std::mutex 								outside;
+	std::atomic<bool> 						parked 		{ false };
+	std::unordered_map<signed, std::any> 	connections;
+	/* a descriptor held back for when the process runs out of them, see ShardedReactor::Accept() */
+	signed 									spare;
+	std::thread 							thread;
+
+	static inline thread_local Shard * 		current 	{ nullptr };
+};
+
+/*
+	ShardedReactor server { std::thread::hardware_concurrency() };
+	server.Serve(address, length, [] (Shard& shard, signed fd) {
+		shard.Reactor().Listen(Event::READ, fd, [&shard, fd] { ... shard.Drop(fd); });
+	});
+	server.Start();
+
+	Serve() binds one listening socket per shard with SO_REUSEPORT, so the kernel
+	spreads incoming connections over the shards and each connection is
+	accepted, read, handled and answered by the core that accepted it, with no
+	lock and no handoff. Work that has to cross cores goes through Post(), which
+	appends to the target's SPSC queue and wakes its loop only if it is asleep.
+
+	SetAdmission() puts a check in front of accept: a peer it refuses is reset
+	at once, before the connection costs any state, and the check sees the
+	peer's address, so a Thread::KeyedLimiter can hold each client to its share
+
+	Out of descriptors (EMFILE, ENFILE), a shard gives up its spare one to
+	accept the waiting connections and reset them, so the level-triggered
+	listener does not fire again at once; with no spare left it stops
+	listening for `backoff`
+*/
+struct ShardedReactor : Utility::noncopyable, Utility::nonmoveable {
+	typedef std::function<void(Shard&, signed)> 	accept_type;
+	typedef std::function<bool(Shard&, sockaddr const*, socklen_t)> 	admit_type;
+
+	explicit ShardedReactor(std::size_t count = std::thread::hardware_concurrency(), bool pin = true);
+	~ShardedReactor() noexcept;
+
+	/* returns the bound port, or -1 with errno set; port 0 picks one port shared by every shard */
+	signed 				Serve(sockaddr const* address, socklen_t length, accept_type accept, signed backlog = SOMAXCONN);
+
+	/* called on the accepting shard's thread; set it before Start() */
+	ShardedReactor& 	SetAdmission(admit_type admit) 	  noexcept 	{ 	return admission = std::move(admit), *this; 	}
+
+	/* runs f on shard `target`, from a shard or from any other thread */
+	template <typename F> requires std::invocable<F>
+	void 				Post(std::size_t target, F&& f);
+
+	ShardedReactor& 	Start();
+	ShardedReactor& 	Stop() 				  noexcept;
+
+	Shard& 				operator[](std::size_t index) noexcept 	{ 	return * shards[index]; 	}
+	std::size_t 		Size() 			const noexcept 			{ 	return shards.size(); 		}
+private:
+	friend struct Shard;
+
+	static constexpr std::chrono::milliseconds 	backoff 	{ 100 };
+
+	void 				Watch(Shard& shard, signed fd, accept_type accept);
+	void 				Accept(Shard& shard, signed fd, accept_type const& accept);
+	static void 		Refuse(signed client) 	noexcept;
+
+	std::vector<std::unique_ptr<Shard>> 	shards;
+	std::vector<signed> 					listeners;
+	admit_type 								admission;
+	std::mutex 								mutex;
+	std::atomic<bool> 						exit 		{ false };
+	bool 									pin;
+};
+
+inline Shard::Shard(ShardedReactor& owner, std::size_t index, std::size_t lanes): owner(owner), index(index), spare(::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
+	inbox.reserve(lanes + 1);
+	for(std::size_t lane {}; lane <= lanes; lane ++)
+		inbox.push_back(std::make_unique<queue_type>());
+}
+
+inline Shard::~Shard() noexcept {
+	if(~spare)
+		(void) ::close(spare);
+}
+
+inline Shard& Shard::Adopt(signed fd, std::any state) {
+	connections.insert_or_assign(fd, std::move(state));
+	return *this;
+}
+
+template <typename T>
+inline T* Shard::Find(signed fd) noexcept {
+	auto const iterator { connections.find(fd) };
+	return iterator == connections.end() ? nullptr : std::any_cast<T>(std::addressof(iterator -> second));
+}
+
+inline Shard& Shard::Drop(signed fd) noexcept {
+	(void) reactor.Cancel(fd);
+	if(connections.erase(fd))
+		(void) ::close(fd);
+	return *this;
+}
+
+inline bool Shard::Idle() const noexcept {
+	for(auto const& queue: inbox)
+		if(not (* queue).Empty())
+			return false;
+	return true;
+}
+
+inline std::size_t Shard::Drain() noexcept {
+	std::size_t handled {};
+	for(auto& queue: inbox)
+		while(std::optional<message_type> message { (* queue).TryPop() }) {
+			(* message)();
+			handled ++;
+		}
+	return handled;
+}
+
+inline void Shard::Loop() noexcept {
+	current = this;
+	while(not owner.exit.load(std::memory_order_acquire)) {
+		/* Dekker with Post(): either the message is seen here or the poster sees parked and wakes the reactor */
+		parked.store(true, std::memory_order_seq_cst);
+		(void) reactor.RunOnce(Idle());
+		parked.store(false, std::memory_order_relaxed);
+		(void) Drain();
+	}
+	for(auto const& [fd, state]: connections) {
+		(void) reactor.Cancel(fd);
+		(void) ::close(fd);
+	}
+	connections.clear();
+	current = nullptr;
+}
+
+inline ShardedReactor::ShardedReactor(std::size_t count, bool pin): pin(pin) {
+	count = std::max<std::size_t>(count, 1);
+	shards.reserve(count);
+	for(std::size_t index {}; index < count; index ++)
+		shards.push_back(std::make_unique<Shard>(* this, index, count));
+}
+
+inline ShardedReactor::~ShardedReactor() noexcept {
+	(void) Stop();
+	for(signed fd: listeners)
+		(void) ::close(fd);
+}
+
+inline signed ShardedReactor::Serve(sockaddr const* address, socklen_t length, accept_type accept, signed backlog) {
+	sockaddr_storage bound {};
+	std::memcpy(std::addressof(bound), address, std::min<std::size_t>(length, sizeof bound));
+	std::vector<signed> opened;
+	for(std::size_t index {}; index < shards.size(); index ++) {
+		signed const fd { ::socket(address -> sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) };
+		signed const one { 1 };
+		if(!~fd || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one) || ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof one)
+		|| ::bind(fd, reinterpret_cast<sockaddr const *>(std::addressof(bound)), length) || ::listen(fd, backlog)) {
+			signed const error { errno };
+			if(~fd)
+				(void) ::close(fd);
+			for(signed other: opened)
+				(void) ::close(other);
+			errno = error;
+			return -1;
+		}
+		/* the first bind resolves port 0, the other shards join the same port */
+		socklen_t size { sizeof bound };
+		(void) ::getsockname(fd, reinterpret_cast<sockaddr *>(std::addressof(bound)), &size);
+		opened.push_back(fd);
+	}
+	for(std::size_t index {}; index < shards.size(); index ++)
+		Watch(* shards[index], opened[index], accept);
+	std::unique_lock lock { mutex };
+	listeners.insert(listeners.end(), opened.begin(), opened.end());
+	return bound.ss_family == AF_INET6 ? ntohs(reinterpret_cast<sockaddr_in6 const *>(std::addressof(bound)) -> sin6_port)
+									   : ntohs(reinterpret_cast<sockaddr_in const *>(std::addressof(bound)) -> sin_port);
+}
+
+inline void ShardedReactor::Watch(Shard& shard, signed fd, accept_type accept) {
+	if(!~shard.spare)
+		shard.spare = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+	(void) shard.reactor.Listen(Event::READ, fd, [this, &shard, fd, accept] { 	Accept(shard, fd, accept); 	});
+}
+
+inline void ShardedReactor::Accept(Shard& shard, signed fd, accept_type const& accept) {
+	sockaddr_storage peer;
+	for(socklen_t size { sizeof peer }; ; size = sizeof peer) {
+		signed const client { ::accept4(fd, reinterpret_cast<sockaddr *>(std::addressof(peer)), &size, SOCK_NONBLOCK | SOCK_CLOEXEC) };
+		if(!~client) {
+			if(errno != EMFILE && errno != ENFILE)
+				break;
+			/* the backlog stays readable, so free the spare for one accept and turn the connection away */
+			if(~shard.spare) {
+				(void) ::close(shard.spare);
+				signed const shed { ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC) };
+				if(~shed)
+					Refuse(shed);
+				shard.spare = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+				if(~shed)
+					continue;
+			}
+			/* no spare to give, or another thread took it: stop listening for a while instead of spinning */
+			(void) shard.reactor.Cancel(fd, Event::READ);
+			(void) shard.reactor.Schedule(backoff, [this, &shard, fd, accept] { 	Watch(shard, fd, accept); 	});
+			break;
+		}
+		if(admission && not admission(shard, reinterpret_cast<sockaddr const *>(std::addressof(peer)), size)) {
+			Refuse(client);
+			continue;
+		}
+		(void) shard.Adopt(client);
+		accept(shard, client);
+	}
+}
+
+inline void ShardedReactor::Refuse(signed client) noexcept {
+	/* a zero linger makes close() send a reset: the peer fails fast and no TIME_WAIT is left behind */
+	linger const reset { 1, 0 };
+	(void) ::setsockopt(client, SOL_SOCKET, SO_LINGER, &reset, sizeof reset);
+	(void) ::close(client);
+}
+
+template <typename F> requires std::invocable<F>
+inline void ShardedReactor::Post(std::size_t target, F&& f) {
+	Shard& shard { * shards[target] };
+	Shard* const from { Shard::Current() };
+	if(from && std::addressof((* from).owner) == this)
+		(* shard.inbox[(* from).index]).Emplace(std::forward<F>(f));
+	else {
+		std::unique_lock lock { shard.outside };
+		(* shard.inbox.back()).Emplace(std::forward<F>(f));
+	}
+	if(shard.parked.load(std::memory_order_seq_cst))
+		(void) shard.reactor.Wake();
+}
+
+inline ShardedReactor& ShardedReactor::Start() {
+	unsigned const cores { std::max(std::thread::hardware_concurrency(), 1u) };
+	for(auto& shard: shards) {
+		if((* shard).thread.joinable())
+			continue;
+		(* shard).thread = std::thread([&shard = * shard] { shard.Loop(); });
+		if(pin) {
+			cpu_set_t set;
+			CPU_ZERO(std::addressof(set));
+			CPU_SET((* shard).index % cores, std::addressof(set));
+			(void) ::pthread_setaffinity_np((* shard).thread.native_handle(), sizeof set, std::addressof(set));
+		}
+	}
+	return *this;
+}
+
+inline ShardedReactor& ShardedReactor::Stop() noexcept {
+	exit.store(true, std::memory_order_release);
+	for(auto& shard: shards)
+		(void) (* shard).reactor.Wake();
+	for(auto& shard: shards)
+		if((* shard).thread.joinable())
+			(* shard).thread.join();
+	exit.store(false, std::memory_order_release);
+	return *this;
+}
+
+}		//namespace IOSchedule
+}		//namespace Kelpa
+
+#endif
+
+#endif
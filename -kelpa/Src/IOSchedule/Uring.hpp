@@ -0,0 +1,703 @@
+/**
+ * 		@Path 	Kelpa/Src/IOSchedule/Uring.hpp
+ * 		@Brief	Completion-based I/O on io_uring: operations are awaitables whose
+ * 				SQEs are submitted in batches and whose coroutines resume on their CQE
+ * 		@Dependency	../Coroutine/ { Coroutine.hpp }
+ * 					../Thread/ { Futex.hpp }
+ * 					../Utility/ { Macros.h, Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_IOSCHEDULE_URING_HPP__
+#define __KELPA_IOSCHEDULE_URING_HPP__
+
+#if defined(__linux__)
+
+#include <linux/io_uring.h>				/* imports ./ {
+	struct io_uring_params,
+	struct io_uring_sqe,
+	struct io_uring_cqe,
+	struct io_uring_buf_ring,
+	#define IORING_XXX
+}*/
+#include <linux/time_types.h>			/* imports ./ {
+	struct __kernel_timespec
+}*/
+#include <sys/syscall.h>				/* imports ./ {
+	__NR_io_uring_setup,
+	__NR_io_uring_enter,
+	__NR_io_uring_register
+}*/
+#include <sys/mman.h>					/* imports ./ {
+	mmap,
+	munmap
+}*/
+#include <sys/socket.h>					/* imports ./ {
+	struct sockaddr,
+	socklen_t
+}*/
+#include <sys/uio.h>					/* imports ./ {
+	struct iovec
+}*/
+#include <unistd.h>						/* imports ./ {
+	syscall,
+	close
+}*/
+#include <cerrno>						/* imports ./ {
+	errno
+}*/
+#include <cstdio>						/* imports ./ {
+	std::perror
+}*/
+#include <cstdlib>						/* imports ./ {
+	std::quick_exit
+}*/
+#include <cstring>						/* imports ./ {
+	std::memset
+}*/
+#include <cstdint>						/* imports ./ {
+	std::uint64_t,
+	std::uintptr_t
+}*/
+#include <cstddef>						/* imports ./ {
+	std::byte,
+	std::size_t
+}*/
+#include <atomic>						/* imports ./ {
+	std::atomic_ref
+}*/
+#include <chrono>						/* imports ./ {
+	std::chrono::duration
+}*/
+#include <coroutine>					/* imports ./ {
+	std::coroutine_handle<>
+}*/
+#include <deque>						/* imports ./ {
+	std::deque
+}*/
+#include <memory>						/* imports ./ {
+	std::unique_ptr
+}*/
+#include <span>							/* imports ./ {
+	std::span
+}*/
+#include <vector>						/* imports ./ {
+	std::vector
+}*/
+#include "../Coroutine/Coroutine.hpp"	/* imports ./ {
+	struct MainFuture
+}*/
+#include "../Thread/Futex.hpp"			/* imports ./ {
+	Detail::CpuRelax
+}*/
+#include "../Utility/Macros.h"			/* imports ./ {
+	#define __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(STRUCT)
+}*/
+#include "../Utility/Interfaces.hpp"	/* imports ./ {
+	struct nonXXXable
+}*/
+
+namespace Kelpa {
+namespace IOSchedule {
+
+/*
+	MainFuture<void> Echo(UringEngine& engine, signed fd) {
+		char buffer[4096];
+		for(signed size; (size = co_await engine.Recv(fd, buffer, sizeof buffer)) > 0; )
+			(void) co_await engine.Send(fd, buffer, size);
+		(void) co_await engine.Close(fd);
+	}
+
+	Awaiting an operation only fills an SQE; every SQE queued while the
+	coroutines of one wakeup run is handed to the kernel by a single
+	io_uring_enter, which also waits for the next completions. With SQPOLL a
+	kernel thread consumes the ring, and as long as completions keep arriving
+	the engine never enters the kernel at all.
+
+	An operation completes with the CQE result: a non-negative value on success,
+	-errno otherwise. Not thread-safe: one engine per thread, operations are
+	awaited and resumed on the thread inside Run()/RunOnce(). A coroutine must
+	stay alive until the operation it awaits has completed
+*/
+struct UringEngine : Utility::noncopyable {
+__KELPA_DEFINES_STRUCT_MEMBER_TYPES__(UringEngine)
+
+	typedef std::coroutine_handle<> 		coroutine_type;
+
+	struct Options {
+		unsigned 		entries 	{ 256 };
+		bool 			sqpoll 		{ false };
+		unsigned 		idle 		{ 1000 };		/* milliseconds the SQPOLL thread spins before sleeping */
+		unsigned 		spin 		{ 0 };			/* polls of an empty completion queue before waiting in the kernel */
+	};
+	/* an index into the table given to RegisterFiles() */
+	struct FixedFile {
+		unsigned 		index;
+	};
+	/* a plain descriptor or a registered one */
+	struct File {
+		constexpr File(signed fd) noexcept: fd(fd) {}
+		constexpr File(FixedFile file) noexcept: fd(static_cast<signed>(file.index)), fixed(true) {}
+		signed 			fd;
+		bool 			fixed 		{ false };
+	};
+
+	struct Operation;
+	template <typename Prepare> struct Awaitable;
+	struct SleepAwaitable;
+	struct Stream;
+
+	auto 			Accept(File listener, sockaddr* address = nullptr, socklen_t* length = nullptr, signed flags = SOCK_CLOEXEC) noexcept;
+	auto 			Connect(File socket, sockaddr const* address, socklen_t length) 				noexcept;
+	auto 			Recv(File socket, void* buffer, std::size_t size, signed flags = 0) 			noexcept;
+	auto 			Send(File socket, void const* buffer, std::size_t size, signed flags = MSG_NOSIGNAL) noexcept;
+	auto 			Read(File file, void* buffer, unsigned size, std::uint64_t offset = -1) 		noexcept;
+	auto 			Write(File file, void const* buffer, unsigned size, std::uint64_t offset = -1) 	noexcept;
+	/* buffer is an index into the table given to RegisterBuffers(), data must lie inside that buffer */
+	auto 			ReadFixed(File file, void* data, unsigned size, std::uint64_t offset, unsigned short buffer) 		noexcept;
+	auto 			WriteFixed(File file, void const* data, unsigned size, std::uint64_t offset, unsigned short buffer) noexcept;
+	auto 			Close(signed fd) 																noexcept;
+	/* cancels every operation on the descriptor, completes with the number cancelled */
+	auto 			Cancel(File file) 																noexcept;
+	/* completes with -ETIME once the duration has passed */
+	template <typename Rep, typename Period>
+	SleepAwaitable 	Sleep(std::chrono::duration<Rep, Period> const& duration) 						noexcept;
+
+	/* multishot: one SQE, a completion per accepted connection */
+	Stream 			AcceptMultishot(File listener) 		noexcept;
+	/* multishot: one SQE, a completion per received chunk written into a buffer of the group */
+	Stream 			RecvMultishot(File socket, unsigned short group) noexcept;
+
+	bool 			RegisterFiles(std::span<signed const> fds) 			noexcept;
+	bool 			RegisterBuffers(std::span<iovec const> buffers) 	noexcept;
+	/* provides count (a power of two) buffers of size bytes to the kernel as buffer group `group` */
+	bool 			RegisterBufferRing(unsigned short group, unsigned count, unsigned size) noexcept;
+	/* the bytes a multishot receive delivered into buffer `id` */
+	std::span<std::byte> 	BufferOf(unsigned short group, unsigned short id, std::size_t length) const noexcept;
+	/* hands buffer `id` back to the kernel once its bytes are consumed */
+	void 			Recycle(unsigned short group, unsigned short id) 	noexcept;
+
+	/* submits what is queued, waits for one completion if wait and any is outstanding, resumes every completion */
+	std::size_t 	RunOnce(bool wait = true) 			noexcept;
+	/* loops until Stop() or until no operation is outstanding */
+	UringEngine& 	Run() 								noexcept;
+	UringEngine& 	Stop() 								noexcept 	{ 	return exit = true, *this; 	}
+
+	std::size_t 	InFlight() 					const 	noexcept 	{ 	return inflight; 	}
+	std::size_t 	Syscalls() 					const 	noexcept 	{ 	return syscalls; 	}
+	static bool 	Supported() 						noexcept;
+
+	UringEngine() noexcept: UringEngine(Options {}) {}
+	explicit UringEngine(Options options) noexcept;
+	~UringEngine() noexcept;
+private:
+	struct BufferRing {
+		io_uring_buf_ring * 	ring 		{ nullptr };
+		std::byte * 			memory 		{ nullptr };
+		unsigned 				count 		{};
+		unsigned 				size 		{};
+		unsigned short 			tail 		{};
+	};
+
+	template <typename Prepare>
+	Awaitable<Prepare> 	Make(Prepare&& prepare) noexcept;
+	io_uring_sqe& 	Acquire(Operation& operation) 		noexcept;
+	void 			Submit(bool wait) 					noexcept;
+	static void 	Target(io_uring_sqe& sqe, File file) noexcept {
+		sqe.fd = file.fd;
+		if(file.fixed)
+			sqe.flags |= IOSQE_FIXED_FILE;
+	}
+	template <typename T> static std::atomic_ref<T> Shared(T* pointer) noexcept
+	{	return std::atomic_ref<T> { * pointer };	}
+
+	signed 					ring 		{ -1 };
+	bool 					sqpoll 		{ false };
+	bool 					exit 		{ false };
+	unsigned 				spin 		{};
+	void * 					sqMemory 	{ MAP_FAILED };
+	void * 					cqMemory 	{ MAP_FAILED };
+	std::size_t 			sqBytes 	{};
+	std::size_t 			cqBytes 	{};
+	io_uring_sqe * 			sqes 		{ nullptr };
+	std::size_t 			sqesBytes 	{};
+	unsigned * 				sqHead 		{};
+	unsigned * 				sqTailShared{};
+	unsigned * 				sqFlags 	{};
+	unsigned 				sqMask 		{};
+	unsigned 				sqEntries 	{};
+	unsigned 				sqTail 		{};
+	unsigned 				queued 		{};
+	unsigned * 				cqHead 		{};
+	unsigned * 				cqTail 		{};
+	unsigned 				cqMask 		{};
+	io_uring_cqe * 			cqes 		{ nullptr };
+	std::size_t 			inflight 	{};
+	std::size_t 			syscalls 	{};
+	std::vector<BufferRing> rings;
+};
+
+struct UringEngine::Operation {
+	static void Resume(Operation& operation, signed result, unsigned flags) noexcept {
+		operation.result 	= result;
+		operation.flags 	= flags;
+		operation.coroutine.resume();
+	}
+	static void Discard(Operation&, signed, unsigned) noexcept {}
+
+	void 			(* complete)(Operation&, signed, unsigned) noexcept 	{ &Resume };
+	coroutine_type 	coroutine 	{};
+	signed 			result 		{};
+	unsigned 		flags 		{};
+};
+
+template <typename Prepare> struct UringEngine::Awaitable: Operation {
+	constexpr bool await_ready() const noexcept { return false; }
+
+	void await_suspend(coroutine_type __coroutine) noexcept {
+		coroutine = __coroutine;
+		prepare(engine.Acquire(* this));
+	}
+	constexpr signed await_resume() const noexcept { return result; }
+
+	UringEngine& 	engine;
+	Prepare 		prepare;
+};
+
+struct UringEngine::SleepAwaitable: Operation {
+	constexpr bool await_ready() const noexcept { return false; }
+
+	void await_suspend(coroutine_type __coroutine) noexcept {
+		coroutine = __coroutine;
+		io_uring_sqe& sqe { engine.Acquire(* this) };
+		sqe.opcode 	= IORING_OP_TIMEOUT;
+		sqe.fd 		= -1;
+		sqe.addr 	= reinterpret_cast<std::uintptr_t>(std::addressof(timeout));
+		sqe.len 	= 1;
+	}
+	constexpr signed await_resume() const noexcept { return result; }
+
+	UringEngine& 		engine;
+	__kernel_timespec 	timeout;
+};
+
+/*
+	The state of a multishot operation lives on the heap: dropping the stream
+	while the kernel still holds the SQE cancels it, and the state frees itself
+	on the final completion
+*/
+struct UringEngine::Stream {
+	struct Item {
+		signed 			result;
+		unsigned 		flags;
+
+		/* the buffer a multishot receive filled */
+		constexpr unsigned short Buffer() const noexcept { 	return static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT); 	}
+		constexpr bool HasBuffer() const noexcept { 	return flags & IORING_CQE_F_BUFFER; 	}
+	};
+	struct NextAwaitable;
+
+	/* the next completion, re-arming the operation if the kernel ended it */
+	NextAwaitable 	Next() noexcept;
+
+	Stream(Stream&&) 					noexcept = default;
+	Stream& operator=(Stream&&) 		noexcept = delete;
+	~Stream() noexcept;
+private:
+	friend struct UringEngine;
+	enum class Kind: unsigned char { ACCEPT, RECV };
+	struct State: Operation {
+		State(UringEngine& engine, Kind kind, File file, unsigned short group) noexcept
+			: Operation { .complete = &Deliver }, engine(engine), kind(kind), file(file), group(group) {}
+
+		static void Deliver(Operation& operation, signed result, unsigned flags) noexcept;
+		void Arm() noexcept;
+
+		UringEngine& 		engine;
+		Kind 				kind;
+		File 				file;
+		unsigned short 		group;
+		std::deque<Item> 	ready 		{};
+		bool 				armed 		{ false };
+		bool 				orphaned 	{ false };
+	};
+	explicit Stream(std::unique_ptr<State> state) noexcept: state(std::move(state)) {}
+
+	std::unique_ptr<State> 	state;
+};
+
+struct UringEngine::Stream::NextAwaitable {
+	bool await_ready() const noexcept { 	return not state.ready.empty(); 	}
+	void await_suspend(coroutine_type coroutine) noexcept {
+		state.coroutine = coroutine;
+		if(not state.armed)
+			state.Arm();
+	}
+	Item await_resume() const noexcept {
+		Item const item { state.ready.front() };
+		state.ready.pop_front();
+		return item;
+	}
+	State& 	state;
+};
+
+inline void UringEngine::Stream::State::Arm() noexcept {
+	io_uring_sqe& sqe { engine.Acquire(* this) };
+	Target(sqe, file);
+	if(kind == Kind::ACCEPT) {
+		sqe.opcode 			= IORING_OP_ACCEPT;
+		sqe.ioprio 			= IORING_ACCEPT_MULTISHOT;
+		sqe.accept_flags 	= SOCK_CLOEXEC;
+	} else {
+		sqe.opcode 			= IORING_OP_RECV;
+		sqe.ioprio 			= IORING_RECV_MULTISHOT;
+		sqe.flags 			|= IOSQE_BUFFER_SELECT;
+		sqe.buf_group 		= group;
+	}
+	armed = true;
+}
+
+inline void UringEngine::Stream::State::Deliver(Operation& operation, signed result, unsigned flags) noexcept {
+	State& state { static_cast<State &>(operation) };
+	if(not (flags & IORING_CQE_F_MORE))
+		state.armed = false;
+	if(state.orphaned) {
+		if(flags & IORING_CQE_F_BUFFER)
+			state.engine.Recycle(state.group, static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT));
+		else if(state.kind == Kind::ACCEPT && result >= 0)
+			(void) ::close(result);
+		if(not state.armed)
+			delete std::addressof(state);
+		return;
+	}
+	state.ready.push_back(Item { result, flags });
+	if(coroutine_type const coroutine { std::exchange(state.coroutine, nullptr) })
+		coroutine.resume();
+}
+
+inline auto UringEngine::Stream::Next() noexcept -> NextAwaitable {
+	return NextAwaitable { * state };
+}
+
+inline UringEngine::Stream::~Stream() noexcept {
+	if(not state)
+		return;
+	for(Item const& item: (* state).ready)
+		if(item.HasBuffer())
+			(* state).engine.Recycle((* state).group, item.Buffer());
+	if(not (* state).armed)
+		return;
+	static Operation discard { .complete = &Operation::Discard };
+	io_uring_sqe& sqe { (* state).engine.Acquire(discard) };
+	sqe.opcode 	= IORING_OP_ASYNC_CANCEL;
+	sqe.fd 		= -1;
+	sqe.addr 	= reinterpret_cast<std::uintptr_t>(static_cast<Operation *>(state.get()));
+	(* state).orphaned = true;
+	(void) state.release();
+}
+
+template <typename Prepare>
+inline auto UringEngine::Make(Prepare&& prepare) noexcept -> Awaitable<Prepare> {
+	return Awaitable<Prepare> { {}, * this, std::forward<Prepare>(prepare) };
+}
+
+inline auto UringEngine::Accept(File listener, sockaddr* address, socklen_t* length, signed flags) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 			= IORING_OP_ACCEPT;
+		Target(sqe, listener);
+		sqe.addr 			= reinterpret_cast<std::uintptr_t>(address);
+		sqe.addr2 			= reinterpret_cast<std::uintptr_t>(length);
+		sqe.accept_flags 	= static_cast<unsigned>(flags);
+	});
+}
+inline auto UringEngine::Connect(File socket, sockaddr const* address, socklen_t length) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 	= IORING_OP_CONNECT;
+		Target(sqe, socket);
+		sqe.addr 	= reinterpret_cast<std::uintptr_t>(address);
+		sqe.off 	= length;
+	});
+}
+inline auto UringEngine::Recv(File socket, void* buffer, std::size_t size, signed flags) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 		= IORING_OP_RECV;
+		Target(sqe, socket);
+		sqe.addr 		= reinterpret_cast<std::uintptr_t>(buffer);
+		sqe.len 		= static_cast<unsigned>(size);
+		sqe.msg_flags 	= static_cast<unsigned>(flags);
+	});
+}
+inline auto UringEngine::Send(File socket, void const* buffer, std::size_t size, signed flags) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 		= IORING_OP_SEND;
+		Target(sqe, socket);
+		sqe.addr 		= reinterpret_cast<std::uintptr_t>(buffer);
+		sqe.len 		= static_cast<unsigned>(size);
+		sqe.msg_flags 	= static_cast<unsigned>(flags);
+	});
+}
+inline auto UringEngine::Read(File file, void* buffer, unsigned size, std::uint64_t offset) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 	= IORING_OP_READ;
+		Target(sqe, file);
+		sqe.addr 	= reinterpret_cast<std::uintptr_t>(buffer);
+		sqe.len 	= size;
+		sqe.off 	= offset;
+	});
+}
+inline auto UringEngine::Write(File file, void const* buffer, unsigned size, std::uint64_t offset) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 	= IORING_OP_WRITE;
+		Target(sqe, file);
+		sqe.addr 	= reinterpret_cast<std::uintptr_t>(buffer);
+		sqe.len 	= size;
+		sqe.off 	= offset;
+	});
+}
+inline auto UringEngine::ReadFixed(File file, void* data, unsigned size, std::uint64_t offset, unsigned short buffer) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 		= IORING_OP_READ_FIXED;
+		Target(sqe, file);
+		sqe.addr 		= reinterpret_cast<std::uintptr_t>(data);
+		sqe.len 		= size;
+		sqe.off 		= offset;
+		sqe.buf_index 	= buffer;
+	});
+}
+inline auto UringEngine::WriteFixed(File file, void const* data, unsigned size, std::uint64_t offset, unsigned short buffer) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 		= IORING_OP_WRITE_FIXED;
+		Target(sqe, file);
+		sqe.addr 		= reinterpret_cast<std::uintptr_t>(data);
+		sqe.len 		= size;
+		sqe.off 		= offset;
+		sqe.buf_index 	= buffer;
+	});
+}
+inline auto UringEngine::Close(signed fd) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 	= IORING_OP_CLOSE;
+		sqe.fd 		= fd;
+	});
+}
+inline auto UringEngine::Cancel(File file) noexcept {
+	return Make([=] (io_uring_sqe& sqe) noexcept {
+		sqe.opcode 			= IORING_OP_ASYNC_CANCEL;
+		sqe.fd 				= file.fd;
+		sqe.cancel_flags 	= IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL | (file.fixed ? IORING_ASYNC_CANCEL_FD_FIXED : 0);
+	});
+}
+
+template <typename Rep, typename Period>
+inline auto UringEngine::Sleep(std::chrono::duration<Rep, Period> const& duration) noexcept -> SleepAwaitable {
+	auto const nanoseconds { std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() };
+	return SleepAwaitable { {}, * this, __kernel_timespec { .tv_sec = nanoseconds / 1000000000, .tv_nsec = nanoseconds % 1000000000 } };
+}
+
+inline auto UringEngine::AcceptMultishot(File listener) noexcept -> Stream {
+	return Stream { std::make_unique<Stream::State>(* this, Stream::Kind::ACCEPT, listener, 0) };
+}
+inline auto UringEngine::RecvMultishot(File socket, unsigned short group) noexcept -> Stream {
+	return Stream { std::make_unique<Stream::State>(* this, Stream::Kind::RECV, socket, group) };
+}
+
+inline bool UringEngine::Supported() noexcept {
+	io_uring_params params {};
+	signed const fd { static_cast<signed>(::syscall(__NR_io_uring_setup, 1, std::addressof(params))) };
+	if(!~fd)
+		return false;
+	return (void) ::close(fd), true;
+}
+
+inline UringEngine::UringEngine(Options options) noexcept: sqpoll(options.sqpoll), spin(options.spin) {
+	io_uring_params params {};
+	params.flags = options.sqpoll ? IORING_SETUP_SQPOLL : IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+	params.sq_thread_idle = options.idle;
+	ring = static_cast<signed>(::syscall(__NR_io_uring_setup, options.entries, std::addressof(params)));
+	if(!~ring && errno == EINVAL && not options.sqpoll) {
+		/* kernels before 6.0 know neither flag */
+		params = io_uring_params {};
+		ring = static_cast<signed>(::syscall(__NR_io_uring_setup, options.entries, std::addressof(params)));
+	}
+	if(!~ring) {
+		std::perror("io_uring_setup");
+		std::quick_exit(EXIT_FAILURE);
+	}
+	sqBytes 	= params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqBytes 	= params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sqesBytes 	= params.sq_entries * sizeof(io_uring_sqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+		sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+	sqMemory = ::mmap(nullptr, sqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+	cqMemory = params.features & IORING_FEAT_SINGLE_MMAP ? sqMemory
+			 : ::mmap(nullptr, cqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+	void* const entries { ::mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES) };
+	if(sqMemory == MAP_FAILED || cqMemory == MAP_FAILED || entries == MAP_FAILED) {
+		std::perror("io_uring mmap");
+		std::quick_exit(EXIT_FAILURE);
+	}
+	std::byte* const sq { static_cast<std::byte *>(sqMemory) };
+	std::byte* const cq { static_cast<std::byte *>(cqMemory) };
+	sqes 			= static_cast<io_uring_sqe *>(entries);
+	sqHead 			= reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+	sqTailShared 	= reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+	sqFlags 		= reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+	sqMask 			= * reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+	sqEntries 		= * reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+	sqTail 			= * sqTailShared;
+	cqHead 			= reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+	cqTail 			= reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+	cqMask 			= * reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+	cqes 			= reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+	/* the indirection array is the identity, SQE i always sits in slot i */
+	unsigned* const array { reinterpret_cast<unsigned *>(sq + params.sq_off.array) };
+	for(unsigned index {}; index < sqEntries; index ++)
+		array[index] = index;
+}
+
+inline UringEngine::~UringEngine() noexcept {
+	if(sqes)
+		(void) ::munmap(sqes, sqesBytes);
+	if(cqMemory != MAP_FAILED && cqMemory != sqMemory)
+		(void) ::munmap(cqMemory, cqBytes);
+	if(sqMemory != MAP_FAILED)
+		(void) ::munmap(sqMemory, sqBytes);
+	if(~ring)
+		(void) ::close(ring);
+	for(BufferRing& buffers: rings) {
+		if(buffers.ring)
+			(void) ::munmap(buffers.ring, buffers.count * sizeof(io_uring_buf));
+		::operator delete(buffers.memory);
+	}
+}
+
+inline io_uring_sqe& UringEngine::Acquire(Operation& operation) noexcept {
+	while(sqTail - Shared(sqHead).load(std::memory_order_acquire) >= sqEntries) [[unlikely]] {
+		Submit(false);
+		if(sqpoll)
+			(void) ::syscall(__NR_io_uring_enter, ring, 0, 0, IORING_ENTER_SQ_WAIT, nullptr, 0), syscalls ++;
+	}
+	io_uring_sqe& sqe { sqes[sqTail & sqMask] };
+	std::memset(std::addressof(sqe), 0, sizeof sqe);
+	sqe.user_data = reinterpret_cast<std::uintptr_t>(std::addressof(operation));
+	sqTail ++;
+	queued ++;
+	inflight ++;
+	return sqe;
+}
+
+inline void UringEngine::Submit(bool wait) noexcept {
+	/* pairs with the kernel's read of the tail; seq_cst also orders it before the SQPOLL flag check below */
+	Shared(sqTailShared).store(sqTail, std::memory_order_seq_cst);
+	unsigned flags { wait ? IORING_ENTER_GETEVENTS : 0u };
+	unsigned submit { queued };
+	if(sqpoll) {
+		submit = 0;
+		queued = 0;
+		if(Shared(sqFlags).load(std::memory_order_seq_cst) & IORING_SQ_NEED_WAKEUP)
+			flags |= IORING_ENTER_SQ_WAKEUP;
+		else if(not wait)
+			return;
+	} else if(not submit && not wait)
+		return;
+	signed const submitted { static_cast<signed>(::syscall(__NR_io_uring_enter, ring, submit, wait ? 1 : 0, flags, nullptr, 0)) };
+	syscalls ++;
+	if(!~submitted) {
+		if(errno == EINTR || errno == EBUSY || errno == EAGAIN)
+			return;
+		std::perror("io_uring_enter");
+		std::quick_exit(EXIT_FAILURE);
+	}
+	if(not sqpoll)
+		queued -= static_cast<unsigned>(submitted);
+}
+
+inline std::size_t UringEngine::RunOnce(bool wait) noexcept {
+	bool empty { * cqHead == Shared(cqTail).load(std::memory_order_acquire) };
+	if(empty && wait && sqpoll && inflight) {
+		/* with SQPOLL the completions can be awaited without entering the kernel */
+		Submit(false);
+		for(unsigned round {}; empty && round < spin; round ++) {
+			Thread::Detail::CpuRelax();
+			empty = * cqHead == Shared(cqTail).load(std::memory_order_acquire);
+		}
+	}
+	Submit(wait && empty && inflight);
+	std::size_t handled {};
+	for(unsigned head { * cqHead }; head != Shared(cqTail).load(std::memory_order_acquire); ) {
+		io_uring_cqe const cqe { cqes[head & cqMask] };
+		Shared(cqHead).store(++ head, std::memory_order_release);
+		if(not (cqe.flags & IORING_CQE_F_MORE))
+			inflight --;
+		Operation& operation { * reinterpret_cast<Operation *>(static_cast<std::uintptr_t>(cqe.user_data)) };
+		operation.complete(operation, cqe.res, cqe.flags);
+		handled ++;
+	}
+	return handled;
+}
+
+inline UringEngine& UringEngine::Run() noexcept {
+	while(not exit && (inflight || queued))
+		(void) RunOnce();
+	exit = false;
+	return *this;
+}
+
+inline bool UringEngine::RegisterFiles(std::span<signed const> fds) noexcept {
+	syscalls ++;
+	return ::syscall(__NR_io_uring_register, ring, IORING_REGISTER_FILES, fds.data(), static_cast<unsigned>(fds.size())) == 0;
+}
+
+inline bool UringEngine::RegisterBuffers(std::span<iovec const> buffers) noexcept {
+	syscalls ++;
+	return ::syscall(__NR_io_uring_register, ring, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size())) == 0;
+}
+
+inline bool UringEngine::RegisterBufferRing(unsigned short group, unsigned count, unsigned size) noexcept {
+	if(not count || (count & (count - 1)) || count > 32768)
+		return false;
+	if(group >= rings.size())
+		rings.resize(group + 1);
+	BufferRing& buffers { rings[group] };
+	if(buffers.ring)
+		return false;
+	void* const memory { ::mmap(nullptr, count * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0) };
+	if(memory == MAP_FAILED)
+		return false;
+	io_uring_buf_reg registration {};
+	registration.ring_addr 		= reinterpret_cast<std::uintptr_t>(memory);
+	registration.ring_entries 	= count;
+	registration.bgid 			= group;
+	syscalls ++;
+	if(::syscall(__NR_io_uring_register, ring, IORING_REGISTER_PBUF_RING, std::addressof(registration), 1) != 0) {
+		(void) ::munmap(memory, count * sizeof(io_uring_buf));
+		return false;
+	}
+	buffers = BufferRing { static_cast<io_uring_buf_ring *>(memory), static_cast<std::byte *>(::operator new(std::size_t(count) * size)), count, size, 0 };
+	for(unsigned id {}; id < count; id ++)
+		Recycle(group, static_cast<unsigned short>(id));
+	return true;
+}
+
+inline std::span<std::byte> UringEngine::BufferOf(unsigned short group, unsigned short id, std::size_t length) const noexcept {
+	BufferRing const& buffers { rings[group] };
+	return { buffers.memory + std::size_t(id) * buffers.size, std::min<std::size_t>(length, buffers.size) };
+}
+
+inline void UringEngine::Recycle(unsigned short group, unsigned short id) noexcept {
+	BufferRing& buffers { rings[group] };
+	/* not (* ring).bufs: in C++ the empty struct ahead of that flexible array shifts it by 8 bytes */
+	io_uring_buf& buffer { reinterpret_cast<io_uring_buf *>(buffers.ring)[buffers.tail & (buffers.count - 1)] };
+	buffer.addr = reinterpret_cast<std::uintptr_t>(buffers.memory + std::size_t(id) * buffers.size);
+	buffer.len 	= buffers.size;
+	buffer.bid 	= id;
+	Shared(std::addressof((* buffers.ring).tail)).store(++ buffers.tail, std::memory_order_release);
+}
+
+}		//namespace IOSchedule
+}		//namespace Kelpa
+
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef __CONET_BUFFER_INCLUDED
+#define __CONET_BUFFER_INCLUDED
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <sys/uio.h>
+#include "../Utility/IOBuf.hpp"
+
+namespace conet __attribute__((__visibility__("default"))) {
+namespace net __attribute__((__visibility__("default"))) {
+
+	struct mutable_buffer {
+		constexpr mutable_buffer() noexcept = default;
+		constexpr mutable_buffer(void* __data, std::size_t __size) noexcept: M_data(__data), M_size(__size) {}
+		[[nodiscard]] constexpr void* data() const noexcept { return M_data; }
+		[[nodiscard]] constexpr std::size_t size() const noexcept { return M_size; }
+	private:
+		void* 			M_data = nullptr;
+		std::size_t 	M_size = 0;
+	};
+	struct const_buffer {
+		constexpr const_buffer() noexcept = default;
+		constexpr const_buffer(void const* __data, std::size_t __size) noexcept: M_data(__data), M_size(__size) {}
+		constexpr const_buffer(mutable_buffer const& __b) noexcept: M_data(__b.data()), M_size(__b.size()) {}
+		[[nodiscard]] constexpr void const* data() const noexcept { return M_data; }
+		[[nodiscard]] constexpr std::size_t size() const noexcept { return M_size; }
+	private:
+		void const* 	M_data = nullptr;
+		std::size_t 	M_size = 0;
+	};
+
+	[[nodiscard]] constexpr mutable_buffer buffer(void* __data, std::size_t __size) noexcept { return {__data, __size}; }
+	[[nodiscard]] constexpr const_buffer buffer(void const* __data, std::size_t __size) noexcept { return {__data, __size}; }
+	template <std::ranges::contiguous_range R> requires std::ranges::sized_range<R> and std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+	[[nodiscard]] constexpr auto buffer(R&& __range) noexcept {
+		return buffer(std::ranges::data(__range), std::ranges::size(__range) * sizeof(std::ranges::range_value_t<R>));
+	}
+	template <std::ranges::contiguous_range R> requires std::ranges::sized_range<R> and std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+	[[nodiscard]] constexpr auto buffer(R&& __range, std::size_t __size) noexcept {
+		return buffer(std::ranges::data(__range), std::min(__size, std::ranges::size(__range) * sizeof(std::ranges::range_value_t<R>)));
+	}
+
+	/*
+		A sequence of byte ranges sent as one, e.g. response headers, a cached
+		body and a trailer, without copying them into a single buffer. The chain
+		is a Kelpa::Utility::IOBuf: each segment holds a reference on the block
+		or on whatever owns its bytes, so copies of a chain share the bytes and
+		they live until the last chain (and the last zero-copy send) lets go of them:
+
+			net::buffer_chain chain;
+			chain.append(std::move(headers));					// takes the string over
+			chain.append(net::buffer(* body), body);			// shares a std::shared_ptr<std::string const>
+			chain.append(net::buffer(crlf, 2));					// static storage, not owned
+			chain.append(std::move(encoded));					// an IOBuf filled by Serde or Compress
+			co_await socket.async_write(chain);
+
+		Reading the other way, prepare() hands out the chain's tailroom and
+		commit() makes what was received part of it, so the bytes land in pooled
+		memory once and are parsed, split off and forwarded from there
+	*/
+	struct buffer_chain {
+		typedef std::shared_ptr<void const> 	owner_type;
+		typedef Kelpa::Utility::IOBuf 		storage_type;
+
+		buffer_chain() noexcept = default;
+		buffer_chain(storage_type __bytes) noexcept: M_bytes(std::move(__bytes)) {}
+
+		/* the caller keeps the bytes alive */
+		buffer_chain& append(const_buffer const& __view) { return append(__view, nullptr); }
+		buffer_chain& append(const_buffer const& __view, owner_type __owner) {
+			(void) M_bytes.Append(storage_type::Wrap(__view.data(), __view.size(), std::move(__owner)));
+			return *this;
+		}
+		/* moves __bytes into shared storage owned by the chain */
+		template <std::ranges::contiguous_range R> requires std::ranges::sized_range<R> and (not std::is_lvalue_reference_v<R>)
+			and std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+		buffer_chain& append(R&& __bytes) {
+			(void) M_bytes.Append(storage_type::Take(std::move(__bytes)));
+			return *this;
+		}
+		buffer_chain& append(buffer_chain const& __other) {
+			(void) M_bytes.Append(__other.M_bytes);
+			return *this;
+		}
+		buffer_chain& append(storage_type __bytes) {
+			(void) M_bytes.Append(std::move(__bytes));
+			return *this;
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept { return M_bytes.Size(); }
+		[[nodiscard]] bool empty() const noexcept { return M_bytes.Empty(); }
+		[[nodiscard]] std::size_t segments() const noexcept { return M_bytes.Slices(); }
+		[[nodiscard]] storage_type& bytes() noexcept { return M_bytes; }
+		[[nodiscard]] storage_type const& bytes() const noexcept { return M_bytes; }
+
+		/* at least __size writable bytes at the end of the chain, commit() what was filled in */
+		[[nodiscard]] mutable_buffer prepare(std::size_t __size) {
+			std::span<std::byte> const __room = M_bytes.Reserve(__size);
+			return mutable_buffer{__room.data(), __room.size()};
+		}
+		void commit(std::size_t __count) noexcept { (void) M_bytes.Commit(__count); }
+
+		/* drops the first __count bytes, releasing segments that are used up */
+		void consume(std::size_t __count) noexcept { (void) M_bytes.Consume(__count); }
+		/* detaches the first __count bytes, e.g. one parsed message */
+		[[nodiscard]] buffer_chain split(std::size_t __count) { return buffer_chain{M_bytes.Split(__count)}; }
+		void clear() noexcept { M_bytes.Clear(); }
+
+		/* describes the leading segments for writev/sendmsg, returns how many entries were filled */
+		std::size_t to_iovec(std::span<iovec> __out) const noexcept { return M_bytes.ToIovec(__out); }
+		/* shares the leading __bytes, what a zero-copy send must keep alive */
+		[[nodiscard]] storage_type share(std::size_t __bytes) const { return M_bytes.Clone(__bytes); }
+
+	private:
+		storage_type 	M_bytes;
+	};
+
+} // namespace conet::net
+} // namespace conet
+
+#endif // #ifndef __CONET_BUFFER_INCLUDED
@@ -0,0 +1,1107 @@
+#ifndef __CONET_HTTP_INCLUDED
+#define __CONET_HTTP_INCLUDED
+
+#if defined(__linux__)
+
+#include <ctime>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <array>
+#include <string>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include "./socket.hpp"
+#include "../Coroutine/Detached.hpp"
+
+/*
+	HTTP/1.1 on the coroutine sockets:
+
+		http::router routes;
+		routes.get("/users/:id", [](http::request const& __request, http::response& __response) {
+			__response.header("Content-Type", "text/plain").body(__request.param("id"));
+		});
+		http::server server { reactor, tcp::endpoint { tcp::v4(), 8080 }, routes };
+		server.start();
+		reactor.Run();
+
+	Each connection reads into one buffer of its own and the parser hands out
+	string_views into it, so a request is never copied. Every complete request
+	in the buffer is answered before the connection reads again, and the
+	answers to a pipelined batch go out together in one sendmsg. Handlers run
+	on the reactor thread and must not block; one server per reactor, with
+	reuse_port set, spreads the connections over as many threads
+*/
+
+namespace conet __attribute__((__visibility__("default"))) {
+namespace net __attribute__((__visibility__("default"))) {
+namespace http __attribute__((__visibility__("default"))) {
+
+	enum class method: unsigned char { get, head, post, put, delete_, connect, options, trace, patch, unknown };
+	inline constexpr std::size_t method_count = static_cast<std::size_t>(method::unknown);
+
+	[[nodiscard]] constexpr method to_method(std::string_view __name) noexcept {
+		constexpr std::string_view __names[method_count] { "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH" };
+		for(std::size_t __index = 0; __index < method_count; __index ++)
+			if(__names[__index] == __name)
+				return static_cast<method>(__index);
+		return method::unknown;
+	}
+	[[nodiscard]] constexpr std::string_view reason(unsigned __status) noexcept {
+		switch(__status) {
+			case 100: return "Continue";
+			case 101: return "Switching Protocols";
+			case 200: return "OK";
+			case 201: return "Created";
+			case 202: return "Accepted";
+			case 204: return "No Content";
+			case 206: return "Partial Content";
+			case 301: return "Moved Permanently";
+			case 302: return "Found";
+			case 303: return "See Other";
+			case 304: return "Not Modified";
+			case 307: return "Temporary Redirect";
+			case 308: return "Permanent Redirect";
+			case 400: return "Bad Request";
+			case 401: return "Unauthorized";
+			case 403: return "Forbidden";
+			case 404: return "Not Found";
+			case 405: return "Method Not Allowed";
+			case 408: return "Request Timeout";
+			case 409: return "Conflict";
+			case 411: return "Length Required";
+			case 413: return "Content Too Large";
+			case 414: return "URI Too Long";
+			case 415: return "Unsupported Media Type";
+			case 429: return "Too Many Requests";
+			case 431: return "Request Header Fields Too Large";
+			case 500: return "Internal Server Error";
+			case 501: return "Not Implemented";
+			case 502: return "Bad Gateway";
+			case 503: return "Service Unavailable";
+			case 504: return "Gateway Timeout";
+			case 505: return "HTTP Version Not Supported";
+			default:  return "Unknown";
+		}
+	}
+
+	/* a header field or a route parameter, both views into the connection's buffer or the route table */
+	struct field {
+		std::string_view name;
+		std::string_view value;
+	};
+
+	enum class parse_status: unsigned char { incomplete, complete, error };
+
+namespace detail {
+	[[nodiscard]] constexpr char lower(char __c) noexcept { return __c >= 'A' and __c <= 'Z' ? static_cast<char>(__c | 0x20) : __c; }
+	[[nodiscard]] constexpr bool iequals(std::string_view __a, std::string_view __b) noexcept {
+		if(__a.size() != __b.size())
+			return false;
+		for(std::size_t __index = 0; __index < __a.size(); __index ++)
+			if(lower(__a[__index]) != lower(__b[__index]))
+				return false;
+		return true;
+	}
+	/* tchar of RFC 9110 */
+	[[nodiscard]] constexpr bool is_token(char __c) noexcept {
+		constexpr std::string_view __specials = "!#$%&'*+-.^_`|~";
+		return (__c >= '0' and __c <= '9') or (__c >= 'a' and __c <= 'z') or (__c >= 'A' and __c <= 'Z') or __specials.find(__c) != std::string_view::npos;
+	}
+	[[nodiscard]] constexpr std::string_view trim(std::string_view __text) noexcept {
+		while(not __text.empty() and (__text.front() == ' ' or __text.front() == '\t'))
+			__text.remove_prefix(1);
+		while(not __text.empty() and (__text.back() == ' ' or __text.back() == '\t'))
+			__text.remove_suffix(1);
+		return __text;
+	}
+	/* whether the comma-separated list holds __token, e.g. Connection: keep-alive, Upgrade */
+	[[nodiscard]] constexpr bool has_token(std::string_view __list, std::string_view __token) noexcept {
+		while(not __list.empty()) {
+			std::size_t const __comma = __list.find(',');
+			if(iequals(trim(__list.substr(0, __comma)), __token))
+				return true;
+			__list = __comma == std::string_view::npos ? std::string_view{} : __list.substr(__comma + 1);
+		}
+		return false;
+	}
+	/* the last element of the list, the coding applied last for Transfer-Encoding */
+	[[nodiscard]] constexpr std::string_view last_token(std::string_view __list) noexcept {
+		std::size_t const __comma = __list.rfind(',');
+		return trim(__comma == std::string_view::npos ? __list : __list.substr(__comma + 1));
+	}
+	[[nodiscard]] inline bool to_size(std::string_view __text, std::size_t& __value, int __base = 10) noexcept {
+		if(__text.empty())
+			return false;
+		auto const [__end, __error] = std::from_chars(__text.data(), __text.data() + __text.size(), __value, __base);
+		return __error == std::errc{} and __end == __text.data() + __text.size();
+	}
+	[[nodiscard]] inline char const* find_crlf(char const* __first, char const* __last) noexcept {
+		for(char const* __cr; __first < __last and (__cr = static_cast<char const *>(std::memchr(__first, '\r', __last - __first))); __first = __cr + 1)
+			if(__cr + 1 < __last and __cr[1] == '\n')
+				return __cr;
+		return nullptr;
+	}
+
+	/* "Date: <IMF-fixdate>\r\n", formatted at most once a second per thread */
+	[[nodiscard]] inline std::string_view date_line() noexcept {
+		thread_local std::time_t 	__cached = -1;
+		thread_local char 			__line[64];
+		thread_local std::size_t 	__length = 0;
+		std::time_t const __now = std::time(nullptr);
+		if(__now != __cached) {
+			std::tm __time;
+			(void) ::gmtime_r(std::addressof(__now), std::addressof(__time));
+			__length = std::strftime(__line, sizeof __line, "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", std::addressof(__time));
+			__cached = __now;
+		}
+		return {__line, __length};
+	}
+
+	/*
+		Framing shared by requests and responses: the start line and fields are
+		parsed in one pass once the blank line has arrived, the body is then
+		delimited by Content-Length or decoded from chunks in place. Positions
+		are kept as offsets from the start of the message, so the caller may
+		move or grow its buffer between calls as long as it keeps the bytes
+	*/
+	struct message_parser {
+		struct limits {
+			std::size_t header_size = 64 * 1024;
+			std::size_t body_size = 8 * 1024 * 1024;
+			std::size_t fields = 64;
+		};
+
+		explicit message_parser(bool __response, limits const& __limits) noexcept: M_response(__response), M_limits(__limits) {}
+
+		parse_status parse(char* __data, std::size_t __size) noexcept {
+			M_base = __data;
+			for(;;)
+				switch(M_state) {
+					case state::head:
+						if(not head(__size))
+							return M_state == state::failed ? parse_status::error : parse_status::incomplete;
+						continue;
+					case state::length:
+						if(__size - M_body < M_remaining)
+							return parse_status::incomplete;
+						M_consumed = M_body + M_remaining;
+						M_state = state::done;
+						continue;
+					case state::until_close:
+						return parse_status::incomplete;
+					case state::chunk_size: {
+						char const* const __crlf = find_crlf(__data + M_cursor, __data + __size);
+						if(not __crlf)
+							return __size - M_cursor > 1024 ? fail(400) : parse_status::incomplete;
+						std::string_view __line{__data + M_cursor, static_cast<std::size_t>(__crlf - __data - M_cursor)};
+						__line = trim(__line.substr(0, __line.find(';')));
+						std::size_t __length;
+						if(not to_size(__line, __length, 16))
+							return fail(400);
+						if(__length > M_limits.body_size - (M_write - M_body))
+							return fail(413);
+						M_cursor = __crlf + 2 - __data;
+						M_remaining = __length;
+						M_state = __length ? state::chunk_data : state::trailers;
+						continue;
+					}
+					case state::chunk_data: {
+						std::size_t const __available = std::min(M_remaining, __size - M_cursor);
+						if(M_write != M_cursor)
+							std::memmove(__data + M_write, __data + M_cursor, __available);
+						M_write += __available;
+						M_cursor += __available;
+						M_remaining -= __available;
+						if(M_remaining)
+							return parse_status::incomplete;
+						M_state = state::chunk_end;
+						continue;
+					}
+					case state::chunk_end:
+						if(__size - M_cursor < 2)
+							return parse_status::incomplete;
+						if(__data[M_cursor] != '\r' or __data[M_cursor + 1] != '\n')
+							return fail(400);
+						M_cursor += 2;
+						M_state = state::chunk_size;
+						continue;
+					case state::trailers: {
+						/* trailer fields are skipped, the body ends at the blank line */
+						char const* const __crlf = find_crlf(__data + M_cursor, __data + __size);
+						if(not __crlf)
+							return __size - M_cursor > M_limits.header_size ? fail(431) : parse_status::incomplete;
+						std::size_t const __line = __crlf - __data - M_cursor;
+						M_cursor += __line + 2;
+						if(__line)
+							continue;
+						M_remaining = M_write - M_body;
+						M_consumed = M_cursor;
+						M_state = state::done;
+						continue;
+					}
+					case state::done:
+						return parse_status::complete;
+					case state::failed:
+						return parse_status::error;
+				}
+		}
+		/* a response delimited by the end of the connection is complete once the peer has closed */
+		parse_status finish(std::size_t __size) noexcept {
+			if(M_state != state::until_close)
+				return M_state == state::done ? parse_status::complete : fail(400);
+			M_remaining = __size - M_body;
+			M_consumed = __size;
+			M_state = state::done;
+			return parse_status::complete;
+		}
+		void reset() noexcept {
+			M_state = state::head;
+			M_scan = M_start = M_consumed = M_body = M_cursor = M_write = M_remaining = 0;
+			M_field_count = 0;
+			M_error = 0;
+			M_keep_alive = true;
+			M_continue = false;
+			M_chunked = false;
+		}
+
+		/* bytes taken by the complete message, the next one starts right after */
+		[[nodiscard]] std::size_t consumed() const noexcept { return M_consumed; }
+		/* the status to answer with once parse() returned error */
+		[[nodiscard]] unsigned error() const noexcept { return M_error; }
+		[[nodiscard]] bool headers_complete() const noexcept { return M_state != state::head and M_state != state::failed; }
+
+	protected:
+		enum class state: unsigned char { head, length, until_close, chunk_size, chunk_data, chunk_end, trailers, done, failed };
+		struct range {
+			std::size_t M_offset;
+			std::size_t M_size;
+		};
+
+		parse_status fail(unsigned __status) noexcept {
+			M_error = __status;
+			M_state = state::failed;
+			return parse_status::error;
+		}
+		[[nodiscard]] std::string_view view(range const& __range) const noexcept { return {M_base + __range.M_offset, __range.M_size}; }
+		[[nodiscard]] range make_range(char const* __first, char const* __last) const noexcept {
+			return {static_cast<std::size_t>(__first - M_base), static_cast<std::size_t>(__last - __first)};
+		}
+
+		/* waits for the blank line, then parses the start line and the fields in one go */
+		bool head(std::size_t __size) noexcept {
+			/* empty lines before a request are tolerated */
+			while(M_start + 1 < __size and M_base[M_start] == '\r' and M_base[M_start + 1] == '\n' and M_scan == M_start)
+				M_scan = M_start += 2;
+			char const* __end = nullptr;
+			for(char const* __first = M_base + std::max(M_scan, M_start + 2) - 2, * __last = M_base + __size; not __end; ) {
+				char const* const __crlf = find_crlf(__first, __last);
+				if(not __crlf)
+					break;
+				if(__crlf + 3 < __last and __crlf[2] == '\r' and __crlf[3] == '\n')
+					__end = __crlf;
+				else
+					__first = __crlf + 2;
+			}
+			if(not __end) {
+				M_scan = __size > 3 ? __size - 3 : 0;
+				if(__size - M_start > M_limits.header_size)
+					(void) fail(431);
+				return false;
+			}
+			if(static_cast<std::size_t>(__end - M_base) - M_start > M_limits.header_size)
+				return fail(431), false;
+
+			char const* __line = M_base + M_start;
+			char const* __eol = find_crlf(__line, __end + 2);
+			if(not (M_response ? status_line(__line, __eol) : request_line(__line, __eol)))
+				return false;
+
+			std::string_view __connection, __length, __coding;
+			bool __lengths = false;
+			for(__line = __eol + 2; __line < __end + 2; __line = __eol + 2) {
+				__eol = find_crlf(__line, __end + 2);
+				if(__line == __eol or __line[0] == ' ' or __line[0] == '\t')
+					return fail(400), false;
+				char const* const __colon = static_cast<char const *>(std::memchr(__line, ':', __eol - __line));
+				if(not __colon or __colon == __line or not std::all_of(__line, __colon, is_token))
+					return fail(400), false;
+				if(M_field_count == M_fields.size() or M_field_count == M_limits.fields)
+					return fail(431), false;
+				std::string_view const __value = trim({__colon + 1, static_cast<std::size_t>(__eol - __colon - 1)});
+				M_fields[M_field_count ++] = {make_range(__line, __colon), make_range(__value.data(), __value.data() + __value.size())};
+				std::string_view const __name{__line, static_cast<std::size_t>(__colon - __line)};
+				if(iequals(__name, "content-length")) {
+					if(__lengths and __value != __length)
+						return fail(400), false;
+					__length = __value;
+					__lengths = true;
+				}
+				else if(iequals(__name, "transfer-encoding"))
+					__coding = __value;
+				else if(iequals(__name, "connection"))
+					__connection = __value;
+				else if(iequals(__name, "expect"))
+					M_continue = iequals(__value, "100-continue");
+			}
+
+			M_keep_alive = M_minor ? not has_token(__connection, "close") : has_token(__connection, "keep-alive");
+			M_body = M_cursor = M_write = __end + 4 - M_base;
+			M_remaining = 0;
+			if(not __coding.empty()) {
+				/* both framings at once is how requests get smuggled */
+				if(__lengths or not M_minor)
+					return fail(400), false;
+				if(not iequals(last_token(__coding), "chunked"))
+					return M_response ? (M_state = state::until_close, M_keep_alive = false, true) : (fail(501), false);
+				M_chunked = true;
+				M_state = state::chunk_size;
+				return true;
+			}
+			if(__lengths) {
+				if(not to_size(__length, M_remaining))
+					return fail(400), false;
+				if(M_remaining > M_limits.body_size)
+					return fail(413), false;
+				M_state = state::length;
+				return true;
+			}
+			/* a response without framing runs until the connection closes, unless it cannot have a body */
+			if(M_response and not (M_status / 100 == 1 or M_status == 204 or M_status == 304 or M_no_body)) {
+				M_keep_alive = false;
+				M_state = state::until_close;
+				return true;
+			}
+			M_state = state::length;
+			return true;
+		}
+		bool request_line(char const* __line, char const* __eol) noexcept {
+			char const* const __space = static_cast<char const *>(std::memchr(__line, ' ', __eol - __line));
+			if(not __space or __space == __line or not std::all_of(__line, __space, is_token))
+				return fail(400), false;
+			char const* const __target = __space + 1;
+			char const* const __gap = static_cast<char const *>(std::memchr(__target, ' ', __eol - __target));
+			if(not __gap or __gap == __target or std::any_of(__target, __gap, [](char __c) { return static_cast<unsigned char>(__c) <= 0x20 or __c == 0x7f; }))
+				return fail(400), false;
+			M_method = make_range(__line, __space);
+			M_target = make_range(__target, __gap);
+			return version(__gap + 1, __eol);
+		}
+		bool status_line(char const* __line, char const* __eol) noexcept {
+			if(__eol - __line < 12 or __line[8] != ' ')
+				return fail(400), false;
+			if(not version(__line, __line + 8))
+				return false;
+			std::size_t __status;
+			if(not to_size({__line + 9, 3}, __status) or __status < 100 or __status > 999 or (__eol - __line > 12 and __line[12] != ' '))
+				return fail(400), false;
+			M_status = static_cast<unsigned>(__status);
+			M_reason = __eol - __line > 12 ? make_range(__line + 13, __eol) : range{};
+			return true;
+		}
+		bool version(char const* __first, char const* __last) noexcept {
+			if(__last - __first != 8 or std::memcmp(__first, "HTTP/", 5) or __first[6] != '.' or __first[5] < '0' or __first[5] > '9' or __first[7] < '0' or __first[7] > '9')
+				return fail(400), false;
+			if(__first[5] != '1')
+				return fail(505), false;
+			M_minor = __first[7] - '0';
+			return true;
+		}
+
+		bool 						M_response;
+		limits 						M_limits;
+		state 						M_state = state::head;
+		char* 						M_base = nullptr;
+		/* where the search for the blank line resumes, and where the message starts after leading empty lines */
+		std::size_t 				M_scan = 0;
+		std::size_t 				M_start = 0;
+		std::size_t 				M_consumed = 0;
+		/* the body starts at M_body; chunked bodies are read at M_cursor and compacted to end at M_write */
+		std::size_t 				M_body = 0;
+		std::size_t 				M_cursor = 0;
+		std::size_t 				M_write = 0;
+		std::size_t 				M_remaining = 0;
+		range 						M_method {}, M_target {}, M_reason {};
+		unsigned 					M_minor = 1;
+		unsigned 					M_status = 0;
+		unsigned 					M_error = 0;
+		bool 						M_keep_alive = true;
+		bool 						M_continue = false;
+		bool 						M_chunked = false;
+		/* set for the answer to a HEAD request, which has no body whatever its fields say */
+		bool 						M_no_body = false;
+		std::array<std::pair<range, range>, 128> M_fields {};
+		std::size_t 				M_field_count = 0;
+	};
+
+	/* answers run eagerly and free themselves once they return */
+	typedef Kelpa::Coroutine::Detached detached;
+} // namespace conet::net::http::detail
+
+	/* a parsed message; every view points into the buffer the parser was given */
+	struct message {
+		[[nodiscard]] std::span<field const> fields() const noexcept { return {M_fields.data(), M_field_count}; }
+		/* the value of the first field named __name, compared case-insensitively, empty when absent */
+		[[nodiscard]] std::string_view header(std::string_view __name) const noexcept {
+			for(field const& __field: fields())
+				if(detail::iequals(__field.name, __name))
+					return __field.value;
+			return {};
+		}
+		[[nodiscard]] std::string_view body() const noexcept { return M_body; }
+		/* 10 for HTTP/1.0, 11 for HTTP/1.1 */
+		[[nodiscard]] unsigned version() const noexcept { return M_version; }
+		[[nodiscard]] bool keep_alive() const noexcept { return M_keep_alive; }
+		[[nodiscard]] bool chunked() const noexcept { return M_chunked; }
+
+	protected:
+		template <typename> friend struct basic_parser;
+		std::array<field, 128> 	M_fields;
+		std::size_t 			M_field_count = 0;
+		std::string_view 		M_body;
+		unsigned 				M_version = 11;
+		bool 					M_keep_alive = true;
+		bool 					M_chunked = false;
+	};
+
+	struct request: message {
+		static constexpr std::size_t max_params = 8;
+
+		[[nodiscard]] http::method method() const noexcept { return M_method; }
+		[[nodiscard]] std::string_view method_name() const noexcept { return M_method_name; }
+		/* the request target as sent, its path and its query without the '?' */
+		[[nodiscard]] std::string_view target() const noexcept { return M_target; }
+		[[nodiscard]] std::string_view path() const noexcept { return M_target.substr(0, M_target.find('?')); }
+		[[nodiscard]] std::string_view query() const noexcept {
+			std::size_t const __mark = M_target.find('?');
+			return __mark == std::string_view::npos ? std::string_view{} : M_target.substr(__mark + 1);
+		}
+		/* what the route's :name or *name segment matched, raw and not percent-decoded */
+		[[nodiscard]] std::span<field const> params() const noexcept { return {M_params.data(), M_param_count}; }
+		[[nodiscard]] std::string_view param(std::string_view __name) const noexcept {
+			for(field const& __param: params())
+				if(__param.name == __name)
+					return __param.value;
+			return {};
+		}
+
+	private:
+		template <typename> friend struct basic_parser;
+		friend struct router;
+		http::method 						M_method = method::unknown;
+		std::string_view 					M_method_name;
+		std::string_view 					M_target;
+		std::array<field, max_params> 		M_params;
+		std::size_t 						M_param_count = 0;
+	};
+
+	struct response_head: message {
+		[[nodiscard]] unsigned status() const noexcept { return M_status; }
+		[[nodiscard]] std::string_view reason() const noexcept { return M_reason; }
+
+	private:
+		template <typename> friend struct basic_parser;
+		unsigned 			M_status = 0;
+		std::string_view 	M_reason;
+	};
+
+	/*
+		Incremental parser: feed it the bytes received so far, from the first
+		byte of the message, as often as needed. It resumes where it stopped
+		instead of starting over, and once complete the message's views point
+		into the bytes passed to the last call. Chunked bodies are decoded in
+		place, which is why the bytes are not const
+	*/
+	template <typename Message> struct basic_parser: private detail::message_parser {
+		typedef detail::message_parser::limits limits;
+		static constexpr bool is_response = std::is_same_v<Message, response_head>;
+
+		basic_parser() noexcept: basic_parser(limits{}) {}
+		explicit basic_parser(limits const& __limits) noexcept: detail::message_parser(is_response, __limits) {}
+
+		parse_status parse(char* __data, std::size_t __size) noexcept {
+			parse_status const __status = detail::message_parser::parse(__data, __size);
+			if(__status == parse_status::complete)
+				fill();
+			return __status;
+		}
+		/* for a response read until the connection closed, call once the peer has closed */
+		parse_status finish(char* __data, std::size_t __size) noexcept {
+			M_base = __data;
+			parse_status const __status = detail::message_parser::finish(__size);
+			if(__status == parse_status::complete)
+				fill();
+			return __status;
+		}
+		/* a response to HEAD carries no body whatever Content-Length says */
+		void expect_no_body(bool __none = true) noexcept { M_no_body = __none; }
+		/* the request sent "Expect: 100-continue", known once the header is complete */
+		[[nodiscard]] bool expects_continue() const noexcept { return M_continue; }
+		void reset() noexcept {
+			detail::message_parser::reset();
+			M_no_body = false;
+		}
+
+		[[nodiscard]] Message& get() noexcept { return M_message; }
+		[[nodiscard]] Message const& get() const noexcept { return M_message; }
+		using detail::message_parser::consumed;
+		using detail::message_parser::error;
+		using detail::message_parser::headers_complete;
+
+	private:
+		void fill() noexcept {
+			M_message.M_field_count = std::min(M_field_count, M_message.M_fields.size());
+			for(std::size_t __index = 0; __index < M_message.M_field_count; __index ++)
+				M_message.M_fields[__index] = {view(M_fields[__index].first), view(M_fields[__index].second)};
+			M_message.M_body = {M_base + M_body, M_remaining};
+			M_message.M_version = 10 + M_minor;
+			M_message.M_keep_alive = M_keep_alive;
+			M_message.M_chunked = M_chunked;
+			if constexpr (is_response) {
+				M_message.M_status = M_status;
+				M_message.M_reason = view(M_reason);
+			}
+			else {
+				M_message.M_method_name = view(M_method);
+				M_message.M_method = to_method(M_message.M_method_name);
+				M_message.M_target = view(M_target);
+				M_message.M_param_count = 0;
+			}
+		}
+		Message M_message;
+	};
+	typedef basic_parser<request> 		request_parser;
+	typedef basic_parser<response_head> response_parser;
+
+	/*
+		What a handler fills in. Field lines are kept in a string the connection
+		reuses; a text body is copied once into pooled blocks, a buffer_chain or
+		an owned view is sent as it is. Nothing goes out before the handler
+		returns: write() only selects chunked framing for HTTP/1.1 peers in
+		place of one Content-Length
+	*/
+	struct response {
+		response& status(unsigned __status) noexcept {
+			M_status = __status;
+			return *this;
+		}
+		[[nodiscard]] unsigned status() const noexcept { return M_status; }
+		/* Content-Length, Transfer-Encoding, Date and Connection are written by the server */
+		response& header(std::string_view __name, std::string_view __value) {
+			M_fields.append(__name).append(": ", 2).append(__value).append("\r\n", 2);
+			return *this;
+		}
+		response& body(std::string_view __text) {
+			(void) M_body.bytes().Append(__text.data(), __text.size());
+			return *this;
+		}
+		/* no copy: __owner keeps the bytes alive until they are sent (none: the caller does) */
+		response& body(const_buffer const& __view, buffer_chain::owner_type __owner) {
+			(void) M_body.append(__view, std::move(__owner));
+			return *this;
+		}
+		response& body(buffer_chain __chain) {
+			(void) M_body.append(std::move(__chain.bytes()));
+			return *this;
+		}
+		/* appends to the buffered body like body() and frames all of it as one chunk for HTTP/1.1 peers */
+		response& write(std::string_view __chunk) {
+			M_streaming = true;
+			return body(__chunk);
+		}
+		/* closes the connection once this response is out */
+		response& close() noexcept {
+			M_close = true;
+			return *this;
+		}
+
+		[[nodiscard]] buffer_chain& content() noexcept { return M_body; }
+
+		void clear() noexcept {
+			M_status = 200;
+			M_fields.clear();
+			M_body.clear();
+			M_streaming = false;
+			M_close = false;
+		}
+
+		/*
+			Writes the status line, the fields and the framing into __out and
+			moves the body after them; nothing but the field lines is copied
+		*/
+		void serialize(buffer_chain& __out, unsigned __version, bool __keep_alive, bool __head) {
+			Kelpa::Utility::IOBuf& __bytes = __out.bytes();
+			char __line[32] = "HTTP/1.1 ";
+			(void) std::to_chars(__line + 9, __line + 12, std::clamp(M_status, 100u, 999u));
+			__line[12] = ' ';
+			(void) __bytes.Append(__line, 13);
+			std::string_view const __reason = reason(M_status);
+			(void) __bytes.Append(__reason.data(), __reason.size());
+			(void) __bytes.Append("\r\n", 2);
+			std::string_view const __date = detail::date_line();
+			(void) __bytes.Append(__date.data(), __date.size());
+			bool const __bodiless = M_status / 100 == 1 or M_status == 204 or M_status == 304;
+			bool const __chunked = M_streaming and __version >= 11 and not __bodiless;
+			if(__chunked)
+				(void) __bytes.Append("Transfer-Encoding: chunked\r\n", 28);
+			else if(not __bodiless) {
+				char __length[48] = "Content-Length: ";
+				char* const __end = std::to_chars(__length + 16, __length + 40, M_body.size()).ptr;
+				std::memcpy(__end, "\r\n", 2);
+				(void) __bytes.Append(__length, __end + 2 - __length);
+			}
+			if(not __keep_alive or M_close)
+				(void) __bytes.Append("Connection: close\r\n", 19);
+			else if(__version < 11)
+				(void) __bytes.Append("Connection: keep-alive\r\n", 24);
+			(void) __bytes.Append(M_fields.data(), M_fields.size());
+			(void) __bytes.Append("\r\n", 2);
+			if(__head or __bodiless) {
+				M_body.clear();
+				return;
+			}
+			if(__chunked) {
+				if(not M_body.empty()) {
+					char __size[24];
+					char* const __end = std::to_chars(__size, __size + 16, M_body.size(), 16).ptr;
+					std::memcpy(__end, "\r\n", 2);
+					(void) __bytes.Append(__size, __end + 2 - __size);
+					(void) __bytes.Append(std::move(M_body.bytes()));
+					(void) __bytes.Append("\r\n", 2);
+				}
+				(void) __bytes.Append("0\r\n\r\n", 5);
+				return;
+			}
+			(void) __bytes.Append(std::move(M_body.bytes()));
+		}
+		[[nodiscard]] bool closes() const noexcept { return M_close; }
+
+	private:
+		unsigned 		M_status = 200;
+		std::string 	M_fields;
+		buffer_chain 	M_body;
+		bool 			M_streaming = false;
+		bool 			M_close = false;
+	};
+
+	/*
+		Routes are added as patterns like "/users/:id/posts", where :id takes
+		one segment and a last segment *name takes the rest of the path, then compiled into a flat trie: one node per distinct prefix, the
+		literal children of a node laid out together and sorted, the segment
+		text pooled in one string. A lookup walks the path once, trying a
+		literal segment first, then a :parameter and last a *wildcard, and
+		allocates nothing
+	*/
+	struct router {
+		typedef std::function<void(request const&, response&)> handler_type;
+
+		router& add(method __method, std::string_view __pattern, handler_type __handler) {
+			if(__method == method::unknown or __pattern.empty() or __pattern.front() != '/')
+				throw std::invalid_argument("http::router: a route is a known method and a path starting with '/'");
+			std::size_t __node = 0;
+			std::size_t __params = 0;
+			if(M_building.empty())
+				M_building.emplace_back();
+			for(std::string_view __rest = __pattern.substr(1);; ) {
+				std::size_t const __slash = __rest.find('/');
+				std::string_view const __segment = __rest.substr(0, __slash);
+				if(not __segment.empty() and (__segment.front() == ':' or __segment.front() == '*')) {
+					bool const __wildcard = __segment.front() == '*';
+					if((__wildcard and __slash != std::string_view::npos) or ++ __params > request::max_params)
+						throw std::invalid_argument("http::router: a wildcard ends the pattern, at most 8 parameters");
+					std::size_t& __child = __wildcard ? M_building[__node].M_wildcard : M_building[__node].M_param;
+					std::string_view const __name = __segment.substr(1);
+					if(__child == npos) {
+						__node = __child = M_building.size();
+						M_building.emplace_back().M_name = __name;
+					}
+					else if(M_building[__child].M_name != __name)
+						throw std::invalid_argument("http::router: parameters at the same place must have the same name");
+					else
+						__node = __child;
+				}
+				else {
+					auto& __children = M_building[__node].M_children;
+					auto __child = std::find_if(__children.begin(), __children.end(), [&](auto const& __entry) { return __entry.first == __segment; });
+					if(__child == __children.end()) {
+						__children.emplace_back(std::string{__segment}, M_building.size());
+						__node = M_building.size();
+						M_building.emplace_back();
+					}
+					else
+						__node = __child->second;
+				}
+				if(__slash == std::string_view::npos)
+					break;
+				__rest = __rest.substr(__slash + 1);
+			}
+			M_building[__node].M_handlers[static_cast<std::size_t>(__method)] = M_handlers.size();
+			M_handlers.push_back(std::move(__handler));
+			M_compiled = false;
+			return *this;
+		}
+		router& get(std::string_view __pattern, handler_type __handler) { return add(method::get, __pattern, std::move(__handler)); }
+		router& post(std::string_view __pattern, handler_type __handler) { return add(method::post, __pattern, std::move(__handler)); }
+		router& put(std::string_view __pattern, handler_type __handler) { return add(method::put, __pattern, std::move(__handler)); }
+		router& delete_(std::string_view __pattern, handler_type __handler) { return add(method::delete_, __pattern, std::move(__handler)); }
+		router& patch(std::string_view __pattern, handler_type __handler) { return add(method::patch, __pattern, std::move(__handler)); }
+
+		/*
+			lays the trie out for lookups, done by the server when not done yet;
+			compile first when servers on several threads share one router
+		*/
+		router& compile() {
+			M_nodes.assign(M_building.size(), node{});
+			M_edges.clear();
+			M_labels.clear();
+			M_names.clear();
+			for(std::size_t __index = 0; __index < M_building.size(); __index ++) {
+				building const& __from = M_building[__index];
+				node& __to = M_nodes[__index];
+				std::vector<std::pair<std::string, std::size_t>> __children = __from.M_children;
+				std::sort(__children.begin(), __children.end());
+				__to.M_first = static_cast<std::uint32_t>(M_edges.size());
+				__to.M_count = static_cast<std::uint32_t>(__children.size());
+				for(auto const& [__label, __target]: __children) {
+					M_edges.push_back(edge{static_cast<std::uint32_t>(M_labels.size()), static_cast<std::uint32_t>(__label.size()), static_cast<std::uint32_t>(__target)});
+					M_labels += __label;
+				}
+				__to.M_param = __from.M_param == npos ? none : static_cast<std::uint32_t>(__from.M_param);
+				__to.M_wildcard = __from.M_wildcard == npos ? none : static_cast<std::uint32_t>(__from.M_wildcard);
+				__to.M_name = static_cast<std::uint32_t>(M_names.size());
+				__to.M_name_size = static_cast<std::uint32_t>(__from.M_name.size());
+				M_names += __from.M_name;
+				for(std::size_t __method = 0; __method < method_count; __method ++)
+					__to.M_handlers[__method] = __from.M_handlers[__method] == npos ? none : static_cast<std::uint32_t>(__from.M_handlers[__method]);
+			}
+			M_compiled = true;
+			return *this;
+		}
+
+		[[nodiscard]] bool compiled() const noexcept { return M_compiled; }
+
+		struct match_result {
+			handler_type const* 	M_handler = nullptr;
+			/* 404 when nothing matched the path, 405 when it matched for other methods */
+			unsigned 				M_status = 404;
+		};
+		/* fills the request's parameters on success */
+		[[nodiscard]] match_result match(request& __request) const noexcept {
+			match_result __result;
+			__request.M_param_count = 0;
+			std::string_view const __path = __request.path();
+			if(not M_compiled or M_nodes.empty() or __path.empty() or __path.front() != '/')
+				return __result;
+			(void) walk(0, __path.substr(1), __request, static_cast<std::size_t>(__request.method()), __result);
+			return __result;
+		}
+
+	private:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+		static constexpr std::uint32_t none = static_cast<std::uint32_t>(-1);
+
+		struct building {
+			building() { M_handlers.fill(npos); }
+			std::vector<std::pair<std::string, std::size_t>> 	M_children;
+			std::size_t 										M_param = npos;
+			std::size_t 										M_wildcard = npos;
+			/* the name of the parameter or wildcard that leads to this node */
+			std::string 										M_name;
+			std::array<std::size_t, method_count> 				M_handlers;
+		};
+		struct edge {
+			std::uint32_t M_label;
+			std::uint32_t M_size;
+			std::uint32_t M_target;
+		};
+		struct node {
+			std::uint32_t 							M_first = 0;
+			std::uint32_t 							M_count = 0;
+			std::uint32_t 							M_param = none;
+			std::uint32_t 							M_wildcard = none;
+			std::uint32_t 							M_name = 0;
+			std::uint32_t 							M_name_size = 0;
+			std::array<std::uint32_t, method_count> M_handlers{};
+		};
+
+		[[nodiscard]] std::string_view label(edge const& __edge) const noexcept { return {M_labels.data() + __edge.M_label, __edge.M_size}; }
+		[[nodiscard]] std::string_view name(node const& __node) const noexcept { return {M_names.data() + __node.M_name, __node.M_name_size}; }
+
+		bool accept(node const& __node, std::size_t __method, match_result& __result) const noexcept {
+			if(__method < method_count and __node.M_handlers[__method] != none) {
+				__result = {std::addressof(M_handlers[__node.M_handlers[__method]]), 200};
+				return true;
+			}
+			/* HEAD falls back to GET, the body is dropped when sending */
+			if(__method == static_cast<std::size_t>(method::head) and __node.M_handlers[0] != none) {
+				__result = {std::addressof(M_handlers[__node.M_handlers[0]]), 200};
+				return true;
+			}
+			if(std::any_of(__node.M_handlers.begin(), __node.M_handlers.end(), [](std::uint32_t __handler) { return __handler != none; }))
+				__result.M_status = 405;
+			return false;
+		}
+		bool walk(std::size_t __index, std::string_view __rest, request& __request, std::size_t __method, match_result& __result) const noexcept {
+			node const& __node = M_nodes[__index];
+			std::size_t const __slash = __rest.find('/');
+			std::string_view const __segment = __rest.substr(0, __slash);
+			std::string_view const __next = __slash == std::string_view::npos ? std::string_view{} : __rest.substr(__slash + 1);
+			bool const __last = __slash == std::string_view::npos;
+
+			edge const* const __first = M_edges.data() + __node.M_first;
+			edge const* const __end = __first + __node.M_count;
+			edge const* const __edge = std::lower_bound(__first, __end, __segment, [this](edge const& __e, std::string_view __s) { return label(__e) < __s; });
+			if(__edge != __end and label(* __edge) == __segment) {
+				node const& __child = M_nodes[__edge->M_target];
+				if(__last ? accept(__child, __method, __result) : walk(__edge->M_target, __next, __request, __method, __result))
+					return true;
+			}
+			if(__node.M_param != none and not __segment.empty()) {
+				std::size_t const __mark = __request.M_param_count;
+				__request.M_params[__request.M_param_count ++] = {name(M_nodes[__node.M_param]), __segment};
+				if(__last ? accept(M_nodes[__node.M_param], __method, __result) : walk(__node.M_param, __next, __request, __method, __result))
+					return true;
+				__request.M_param_count = __mark;
+			}
+			if(__node.M_wildcard != none) {
+				__request.M_params[__request.M_param_count ++] = {name(M_nodes[__node.M_wildcard]), __rest};
+				if(accept(M_nodes[__node.M_wildcard], __method, __result))
+					return true;
+				__request.M_param_count --;
+			}
+			return false;
+		}
+
+		std::vector<building> 		M_building;
+		std::vector<handler_type> 	M_handlers;
+		std::vector<node> 			M_nodes;
+		std::vector<edge> 			M_edges;
+		std::string 				M_labels;
+		std::string 				M_names;
+		bool 						M_compiled = false;
+	};
+
+	struct server_options {
+		/* what a connection reads into at first, grown up to the header and body limits for large requests */
+		std::size_t buffer_size = 16 * 1024;
+		std::size_t max_header_size = 64 * 1024;
+		std::size_t max_body_size = 8 * 1024 * 1024;
+		int 		backlog = SOMAXCONN;
+		/* lets one server per thread listen on the same port */
+		bool 		reuse_port = false;
+		bool 		no_delay = true;
+		/* connections served at once, 0 for no limit */
+		std::size_t max_connections = 0;
+		/*
+			asked about every accepted peer, typically a per-address limiter:
+				server_options.admission = [&limiter](ip::tcp::endpoint const& __peer) { return limiter.TryAcquire(__peer.address()); };
+			a peer refused here or over max_connections is answered 503 and closed
+			before a coroutine or buffer is spent on it
+		*/
+		std::function<bool(ip::tcp::endpoint const&)> admission;
+	};
+
+	/*
+		Accepts on its reactor and runs one coroutine per connection. stop()
+		closes the listener and every open connection; the server must outlive
+		the reactor's last turn only if it was not stopped
+	*/
+	struct server {
+		server(reactor_type& __reactor, ip::tcp::endpoint const& __endpoint, router& __router, server_options const& __options = {})
+		: M_router(std::addressof(__router)), M_options(__options), M_acceptor(__reactor) {
+			M_acceptor.open(__endpoint.protocol());
+			M_acceptor.set_option(SOL_SOCKET, SO_REUSEADDR, 1);
+			if(M_options.reuse_port)
+				M_acceptor.set_option(SOL_SOCKET, SO_REUSEPORT, 1);
+			M_acceptor.bind(__endpoint);
+			M_acceptor.listen(M_options.backlog);
+			if(not M_router->compiled())
+				(void) M_router->compile();
+		}
+		server(server const&) = delete;
+		server& operator=(server const&) = delete;
+		~server() noexcept { stop(); }
+
+		void start() { (void) listen(); }
+		void stop() noexcept {
+			M_acceptor.close();
+			/* closing resumes the session's pending read or write, which then ends and unlinks itself */
+			for(session* __session = M_sessions, * __next; __session; __session = __next) {
+				__next = __session->M_next;
+				__session->M_socket.close();
+			}
+		}
+
+		[[nodiscard]] ip::tcp::endpoint local_endpoint() const { return M_acceptor.local_endpoint(); }
+		[[nodiscard]] std::size_t connections() const noexcept { return M_connections; }
+		[[nodiscard]] std::uint64_t requests() const noexcept { return M_requests; }
+
+	private:
+		/* the per-connection state, linked into the server so stop() can reach it */
+		struct session {
+			session(server& __server, ip::tcp::socket __socket): M_server(__server), M_socket(std::move(__socket)) {
+				M_next = std::exchange(M_server.M_sessions, this);
+				if(M_next)
+					M_next->M_previous = this;
+				M_server.M_connections ++;
+			}
+			~session() noexcept {
+				(M_previous ? M_previous->M_next : M_server.M_sessions) = M_next;
+				if(M_next)
+					M_next->M_previous = M_previous;
+				M_server.M_connections --;
+			}
+			server& 			M_server;
+			ip::tcp::socket 	M_socket;
+			session* 			M_previous = nullptr;
+			session* 			M_next = nullptr;
+		};
+
+		detail::detached listen() {
+			for(;;) {
+				std::error_code __ec;
+				ip::tcp::socket __peer = co_await M_acceptor.async_accept(__ec);
+				if(__ec == std::errc::operation_canceled or __ec == std::errc::bad_file_descriptor or not M_acceptor.is_open())
+					co_return;
+				if(__ec)
+					continue;
+				if(M_options.max_connections and M_connections >= M_options.max_connections) {
+					shed(__peer);
+					continue;
+				}
+				if(M_options.admission) {
+					ip::tcp::endpoint const __remote = __peer.remote_endpoint(__ec);
+					if(__ec or not M_options.admission(__remote)) {
+						shed(__peer);
+						continue;
+					}
+				}
+				if(M_options.no_delay)
+					__peer.set_option(IPPROTO_TCP, TCP_NODELAY, 1, __ec);
+				(void) serve(std::move(__peer));
+			}
+		}
+
+		/* turns a connection away without reading from it; the send is best effort and never waits */
+		static void shed(ip::tcp::socket& __peer) noexcept {
+			static constexpr std::string_view __refusal = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nRetry-After: 1\r\nConnection: close\r\n\r\n";
+			(void) ::send(__peer.native_handle(), __refusal.data(), __refusal.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+			__peer.close();
+		}
+
+		/* answers the error the parser ran into and gives up on the connection */
+		static void refuse(buffer_chain& __out, unsigned __status) {
+			response __response;
+			__response.status(__status).header("Content-Type", "text/plain").body(reason(__status));
+			__response.serialize(__out, 11, false, false);
+		}
+
+		detail::detached serve(ip::tcp::socket __peer) {
+			session __session{* this, std::move(__peer)};
+			ip::tcp::socket& __socket = __session.M_socket;
+			request_parser __parser{{M_options.max_header_size, M_options.max_body_size}};
+			std::size_t __capacity = M_options.buffer_size;
+			std::unique_ptr<char[]> __buffer{new char[__capacity]};
+			std::size_t __begin = 0, __end = 0;
+			buffer_chain __out;
+			response __response;
+			bool __open = true, __continued = false;
+			std::error_code __ec;
+
+			while(__open) {
+				/* answer every complete request already buffered, pipelined ones included */
+				for(;;) {
+					parse_status const __status = __parser.parse(__buffer.get() + __begin, __end - __begin);
+					if(__status == parse_status::incomplete)
+						break;
+					if(__status == parse_status::error) {
+						refuse(__out, __parser.error());
+						__open = false;
+						break;
+					}
+					request& __request = __parser.get();
+					__response.clear();
+					router::match_result const __match = M_router->match(__request);
+					if(__match.M_handler)
+						try {
+							(* __match.M_handler)(__request, __response);
+						} catch(...) {
+							__response.clear();
+							__response.status(500).close();
+						}
+					else
+						__response.status(__match.M_status);
+					bool const __keep = __request.keep_alive() and not __response.closes();
+					__response.serialize(__out, __request.version(), __keep, __request.method() == method::head);
+					M_requests ++;
+					__begin += __parser.consumed();
+					__parser.reset();
+					__continued = false;
+					if(not __keep) {
+						__open = false;
+						break;
+					}
+				}
+				if(__open and __parser.headers_complete() and __parser.expects_continue() and not __continued) {
+					(void) __out.bytes().Append("HTTP/1.1 100 Continue\r\n\r\n", 25);
+					__continued = true;
+				}
+				if(not __out.empty()) {
+					co_await __socket.async_write(__out, __ec);
+					if(__ec)
+						co_return;
+				}
+				if(not __open)
+					break;
+
+				/* keep the partial request, at the front of a buffer large enough for it */
+				if(__begin == __end)
+					__begin = __end = 0;
+				else if(__capacity - __end < M_options.buffer_size / 4) {
+					std::size_t const __pending = __end - __begin;
+					if(__pending > __capacity / 2) {
+						std::size_t const __limit = M_options.max_header_size + M_options.max_body_size + 4096;
+						if(__capacity >= __limit)
+							co_return;
+						std::size_t const __grown = std::min(__capacity * 2, __limit);
+						std::unique_ptr<char[]> __larger{new char[__grown]};
+						std::memcpy(__larger.get(), __buffer.get() + __begin, __pending);
+						__buffer = std::move(__larger);
+						__capacity = __grown;
+					}
+					else
+						std::memmove(__buffer.get(), __buffer.get() + __begin, __pending);
+					__begin = 0;
+					__end = __pending;
+				}
+				std::size_t const __received = co_await __socket.async_read_some(buffer(__buffer.get() + __end, __capacity - __end), __ec);
+				if(__ec or not __received)
+					co_return;
+				__end += __received;
+			}
+			__socket.shutdown(SHUT_WR, __ec);
+		}
+
+		router* 			M_router;
+		server_options 		M_options;
+		ip::tcp::acceptor 	M_acceptor;
+		session* 			M_sessions = nullptr;
+		std::size_t 		M_connections = 0;
+		std::uint64_t 		M_requests = 0;
+	};
+
+} // namespace conet::net::http
+} // namespace conet::net
+} // namespace conet
+
+#endif // #if defined(__linux__)
+
+#endif // #ifndef __CONET_HTTP_INCLUDED
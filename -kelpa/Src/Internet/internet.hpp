@@ -12,6 +12,15 @@
 #include <format>
 #include <variant>
 #include <ranges>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <stdexcept>
+#if defined(__SSSE3__)
+	#include <tmmintrin.h>
+#endif
+#include "../Utility/Hash.hpp"
 
 namespace conet __attribute__((__visibility__("default"))) {
 namespace detail __attribute__((__visibility__("hidden"))) {
@@ -69,160 +78,266 @@ template <typename Alloc> using string_with =
 		return std::bit_cast<T>(value_representation);
 	}
 	
-	[[nodiscard]] static int inet_pton4(const char *src, unsigned char *dst) noexcept {
-		static constexpr std::size_t v4_size = 4;
-		bool 			saw_digit = false;
-		int 			octets = 0;
-		int 			character = 0;
-		unsigned char 	temporary[v4_size], *pointer;
-		* (pointer = temporary) = 0;
-		while ((character = *src ++)) {
-			if (std::isdigit(character)) {
-				unsigned int _new = (* pointer) * 10 + character - '0';
-				if ((saw_digit and * pointer == 0) or _new > 255)
-					return (0);
-				*pointer = _new;
-				if (not saw_digit) {
-					if (++ octets > 4)
-						return (0);
-					saw_digit = true;
+	/*
+		Text to address and back, without locale calls, snprintf or a
+		terminating NUL. Parsers take [first, last) and return where the
+		address ended, nullptr if there is none; formatters write at most 15
+		(v4) or 45 (v6) characters and return the end. With SSSE3 a dotted
+		quad that has 16 readable bytes behind it is validated and converted in
+		a few vector instructions; elsewhere a branch-per-digit scalar loop does
+	*/
+	[[nodiscard]] constexpr bool is_digit(char c) noexcept { return static_cast<unsigned char>(c - '0') < 10; }
+
+	/* hex digit values, 0xff for anything else */
+	inline constexpr std::array<unsigned char, 256> hex_values = [] {
+		std::array<unsigned char, 256> values {};
+		values.fill(0xff);
+		for(int i = 0; i < 10; i ++) values['0' + i] = static_cast<unsigned char>(i);
+		for(int i = 0; i < 6; i ++) values['a' + i] = values['A' + i] = static_cast<unsigned char>(10 + i);
+		return values;
+	}();
+	inline constexpr char hex_digits[] = "0123456789abcdef";
+
+	/* "0" to "255", the length in the last byte */
+	inline constexpr std::array<std::array<char, 4>, 256> octet_texts = [] {
+		std::array<std::array<char, 4>, 256> texts {};
+		for(int i = 0; i < 256; i ++) {
+			int length = 0;
+			if(i >= 100) texts[i][length ++] = static_cast<char>('0' + i / 100);
+			if(i >= 10) texts[i][length ++] = static_cast<char>('0' + i / 10 % 10);
+			texts[i][length ++] = static_cast<char>('0' + i % 10);
+			texts[i][3] = static_cast<char>(length);
+		}
+		return texts;
+	}();
+
+	/* an address is a run of digits and dots; any left over after the fourth octet makes it invalid */
+	[[nodiscard]] constexpr char const* parse_v4_scalar(char const* first, char const* last, std::uint32_t& value) noexcept {
+		std::uint32_t result = 0;
+		for(int octet = 0; octet < 4; octet ++) {
+			if(octet) {
+				if(first == last or * first != '.') return nullptr;
+				++ first;
+			}
+			if(first == last or not is_digit(* first)) return nullptr;
+			unsigned number = static_cast<unsigned>(* first ++ - '0');
+			if(first != last and is_digit(* first)) {
+				if(number == 0) return nullptr;
+				number = number * 10 + static_cast<unsigned>(* first ++ - '0');
+				if(first != last and is_digit(* first)) {
+					number = number * 10 + static_cast<unsigned>(* first ++ - '0');
+					if(number > 255) return nullptr;
 				}
-			} else if (character == '.' && saw_digit) {
-				if (octets == 4)
-					return (0);
-				* ++pointer = 0;
-				saw_digit = false;
-			} else
-				return (0);
-		}
-		if (octets < 4)
-			return (0);
-		std::memcpy(dst, temporary, v4_size);
-		return (1);
+			}
+			result = result << 8 | number;
+		}
+		if(first != last and (is_digit(* first) or * first == '.')) return nullptr;
+		value = result;
+		return first;
 	}
-	
-	[[nodiscard]] static int inet_pton6(const char *src, unsigned char *dst) noexcept {
-		static constexpr std::size_t 	v6_size = 16;
-		static constexpr std::size_t 	v4_size = 4;
-		static constexpr std::size_t 	uint_size = 2;
-	
-		unsigned char 		tempory[v6_size] = {0};
-		unsigned char 		*pointer = nullptr;
-		unsigned char 		*endp = nullptr;
-		unsigned char 		*colonp = nullptr;
-		const char  		*curtok = nullptr;
-		int 				character = 0;
-		int 				seen_xdigits = 0;
-		unsigned int 		value = 0;
-	
-		std::memset((pointer = tempory), '\0', v6_size);
-		endp = pointer + v6_size;
-	
-		if (* src == ':') if (* ++src != ':') return (0);
-		curtok = src;
-		while ((character = *src ++)) {
-			if (std::isxdigit(character)) {
-				(value <<= 4) |= (std::isdigit(character) ? character - '0' : std::tolower(character) - 'a' + 10);
-				if (++ seen_xdigits > 4) return (0);
-				continue;
+#if defined(__SSSE3__)
+	/*
+		For each of the 81 combinations of octet lengths: where each digit goes
+		so that octet i lands right-aligned in bytes 4i..4i+2, and the smallest
+		value of each length, below which the octet had a leading zero
+	*/
+	struct v4_layouts {
+		alignas(16) std::array<std::array<std::int8_t, 16>, 81> 	shuffles {};
+		alignas(16) std::array<std::array<std::int32_t, 4>, 81> 	minima {};
+		constexpr v4_layouts() noexcept {
+			for(int index = 0; index < 81; index ++) {
+				int const lengths[4] = { index / 27 + 1, index / 9 % 3 + 1, index / 3 % 3 + 1, index % 3 + 1 };
+				for(int octet = 0, start = 0; octet < 4; start += lengths[octet ++] + 1) {
+					for(int k = 0; k < 4; k ++) shuffles[index][octet * 4 + k] = -1;
+					for(int k = 0; k < lengths[octet]; k ++) shuffles[index][octet * 4 + 3 - lengths[octet] + k] = static_cast<std::int8_t>(start + k);
+					minima[index][octet] = lengths[octet] == 1 ? 0 : lengths[octet] == 2 ? 10 : 100;
+				}
 			}
-			if (character == ':') {
-				curtok = src;
-				if (not seen_xdigits) {
-					if (colonp) return (0);
-					colonp = pointer;
-					continue;
-				} else if (not *src) return (0);
-				if (pointer + uint_size > endp) return (0);
-				*pointer ++ = (unsigned char) (value >> 8) & 0xff;
-				*pointer ++ = (unsigned char) value & 0xff;
-				seen_xdigits = 0; value = 0;
-				continue;
+		}
+	};
+	inline constexpr v4_layouts layouts {};
+
+	/* reads 16 bytes from first */
+	[[nodiscard]] inline char const* parse_v4_ssse3(char const* first, std::uint32_t& value) noexcept {
+		__m128i const input = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first));
+		__m128i const digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+		unsigned const digit_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits)));
+		unsigned const dot_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(input, _mm_set1_epi8('.'))));
+		unsigned const end = static_cast<unsigned>(std::countr_zero(~(digit_mask | dot_mask)));
+		if(end >= 16) return nullptr;
+		unsigned const dots = dot_mask & ((1u << end) - 1);
+		if(std::popcount(dots) != 3) return nullptr;
+		unsigned const first_dot = std::countr_zero(dots), second_dot = std::countr_zero(dots & (dots - 1)), third_dot = 31 - std::countl_zero(dots);
+		/* octet lengths less one, out of range (wrapped) for empty octets */
+		unsigned const l0 = first_dot - 1, l1 = second_dot - first_dot - 2, l2 = third_dot - second_dot - 2, l3 = end - third_dot - 2;
+		if((l0 > 2) | (l1 > 2) | (l2 > 2) | (l3 > 2)) return nullptr;
+		unsigned const index = l0 * 27 + l1 * 9 + l2 * 3 + l3;
+		__m128i const aligned = _mm_shuffle_epi8(digits, _mm_load_si128(reinterpret_cast<__m128i const *>(layouts.shuffles[index].data())));
+		__m128i const pairs = _mm_maddubs_epi16(aligned, _mm_setr_epi8(100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0));
+		__m128i const octets = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+		__m128i const leading_zero = _mm_cmplt_epi32(octets, _mm_load_si128(reinterpret_cast<__m128i const *>(layouts.minima[index].data())));
+		if(_mm_movemask_epi8(_mm_or_si128(leading_zero, _mm_cmpgt_epi32(octets, _mm_set1_epi32(255))))) return nullptr;
+		__m128i const bytes = _mm_packus_epi16(_mm_packs_epi32(octets, octets), octets);
+		value = bswap32(static_cast<std::uint32_t>(_mm_cvtsi128_si32(bytes)));
+		return first + end;
+	}
+#endif
+	[[nodiscard]] constexpr char const* parse_v4(char const* first, char const* last, std::uint32_t& value) noexcept {
+#if defined(__SSSE3__)
+		if(not std::is_constant_evaluated() and last - first >= 16)
+			return parse_v4_ssse3(first, value);
+#endif
+		return parse_v4_scalar(first, last, value);
+	}
+
+	/* RFC 4291 text: up to eight groups of one to four hex digits, one "::" and a dotted quad at the end */
+	[[nodiscard]] constexpr char const* parse_v6(char const* first, char const* last, unsigned char* bytes) noexcept {
+		std::uint16_t 	words[8] = {};
+		int 			count = 0;
+		int 			gap = -1;
+		if(first != last and * first == ':') {
+			if(last - first < 2 or first[1] != ':') return nullptr;
+			first += 2;
+			gap = 0;
+		}
+		while(first != last and hex_values[static_cast<unsigned char>(* first)] != 0xff) {
+			char const* const group = first;
+			unsigned word = 0;
+			for(int digits = 0; digits < 4 and first != last and hex_values[static_cast<unsigned char>(* first)] != 0xff; digits ++)
+				word = word << 4 | hex_values[static_cast<unsigned char>(* first ++)];
+			if(first != last and * first == '.') {
+				std::uint32_t quad = 0;
+				if(count > 6 or not (first = parse_v4_scalar(group, last, quad))) return nullptr;
+				words[count ++] = static_cast<std::uint16_t>(quad >> 16);
+				words[count ++] = static_cast<std::uint16_t>(quad);
+				break;
 			}
-			if (character == '.' and ((pointer + v4_size) <= endp) and inet_pton4(curtok, pointer) > 0) {
-				pointer += v4_size;
-				seen_xdigits = 0;
-				break;  
+			if(count == 8 or (first != last and hex_values[static_cast<unsigned char>(* first)] != 0xff)) return nullptr;
+			words[count ++] = static_cast<std::uint16_t>(word);
+			if(first == last or * first != ':') break;
+			if(++ first != last and * first == ':') {
+				if(gap >= 0) return nullptr;
+				gap = count;
+				++ first;
 			}
-			return (0);
+			else if(first == last or hex_values[static_cast<unsigned char>(* first)] == 0xff) return nullptr;
 		}
-		if (seen_xdigits) {
-			if (pointer + uint_size > endp) return (0);
-			*pointer ++ = (unsigned char) (value >> 8) & 0xff;
-			*pointer ++ = (unsigned char) (value & 0xff);
+		if(gap < 0 ? count != 8 : count == 8) return nullptr;
+		for(int i = 0, shift = 8 - count; i < 8; i ++) {
+			std::uint16_t const word = gap < 0 or i < gap ? words[i] : i < gap + shift ? 0 : words[i - shift];
+			bytes[2 * i] = static_cast<unsigned char>(word >> 8);
+			bytes[2 * i + 1] = static_cast<unsigned char>(word);
 		}
-		if (colonp) {
-			const int distance = pointer - colonp;
-			if (pointer == endp) return (0);
-			for (int i = 1; i <= distance; i ++) 
-				endp[0 - i] = std::exchange(colonp[distance - i], 0);
-			pointer = endp;
+		return first;
+	}
+
+	constexpr char* format_v4(std::uint32_t value, char* out) noexcept {
+		for(int shift = 24; shift >= 0; shift -= 8) {
+			auto const& text = octet_texts[(value >> shift) & 0xff];
+			for(int i = 0; i < text[3]; i ++) * out ++ = text[i];
+			if(shift) * out ++ = '.';
+		}
+		return out;
+	}
+	/* RFC 5952: lowercase, no leading zeros, the longest run of two or more zero groups as "::"; v4-mapped and v4-compatible tails dotted */
+	constexpr char* format_v6(unsigned char const* bytes, char* out) noexcept {
+		unsigned words[8] = {};
+		for(int i = 0; i < 8; i ++) words[i] = static_cast<unsigned>(bytes[2 * i]) << 8 | bytes[2 * i + 1];
+		int best = -1, best_length = 0;
+		for(int i = 0; i < 8; ) {
+			if(words[i]) { i ++; continue; }
+			int j = i;
+			while(j < 8 and not words[j]) j ++;
+			if(j - i > best_length) { best = i; best_length = j - i; }
+			i = j;
+		}
+		if(best_length < 2) best = -1;
+		for(int i = 0; i < 8; i ++) {
+			if(i == best) {
+				* out ++ = ':';
+				if(i == 0) * out ++ = ':';
+				i += best_length - 1;
+				continue;
+			}
+			if(i == 6 and best == 0 and (best_length == 6 or (best_length == 7 and words[7] != 0x0001) or (best_length == 5 and words[5] == 0xffff)))
+				return format_v4(static_cast<std::uint32_t>(words[6] << 16 | words[7]), out);
+			for(int shift = words[i] > 0xfff ? 12 : words[i] > 0xff ? 8 : words[i] > 0xf ? 4 : 0; shift >= 0; shift -= 4)
+				* out ++ = hex_digits[(words[i] >> shift) & 0xf];
+			if(i != 7) * out ++ = ':';
 		}
-		if (pointer != endp) return (0);
-		std::memcpy(dst, tempory, v6_size);
+		return out;
+	}
+
+	[[nodiscard]] inline int inet_pton4(const char *src, unsigned char *dst) noexcept {
+		char const* const last = src + std::strlen(src);
+		std::uint32_t value = 0;
+		if(parse_v4(src, last, value) != last)
+			return (0);
+		for(int i = 0; i < 4; i ++) dst[i] = static_cast<unsigned char>(value >> (24 - 8 * i));
+		return (1);
+	}
+	[[nodiscard]] inline int inet_pton6(const char *src, unsigned char *dst) noexcept {
+		char const* const last = src + std::strlen(src);
+		unsigned char bytes[16];
+		if(parse_v6(src, last, bytes) != last)
+			return (0);
+		std::memcpy(dst, bytes, sizeof bytes);
 		return (1);
 	}
-	[[nodiscard]] static char *inet_ntop4(unsigned char const *src, char *dst, std::size_t size) noexcept {
-		static constexpr char 	format[] = "%u.%u.%u.%u";
-		char 					temporary[sizeof "255.255.255.255"] = {0};
-		int length = std::snprintf(temporary, sizeof(temporary), format, src[0], src[1], src[2], src[3]);
-		if (length <= 0 or (std::size_t) length >= size)
+	[[nodiscard]] inline char *inet_ntop4(unsigned char const *src, char *dst, std::size_t size) noexcept {
+		char text[16];
+		std::size_t const length = format_v4(static_cast<std::uint32_t>(src[0]) << 24 | src[1] << 16 | src[2] << 8 | src[3], text) - text;
+		if(length >= size)
 			return (nullptr);
-		std::strncpy(dst, temporary, size);
+		std::memcpy(dst, text, length);
+		dst[length] = '\0';
 		return (dst);
 	}
+	[[nodiscard]] inline char *inet_ntop6(unsigned char const *src, char *dst, std::size_t size) noexcept {
+		char text[46];
+		std::size_t const length = format_v6(src, text) - text;
+		if(length >= size)
+			return (nullptr);
+		std::memcpy(dst, text, length);
+		dst[length] = '\0';
+		return (dst);
+	}
+	/* network_v6 and the v6 prefix table do their arithmetic on the address as one integer */
+	__extension__ typedef unsigned __int128 uint128_type;
 	
-	[[nodiscard]] static char *inet_ntop6(unsigned char const *src, char *dst, std::size_t size) noexcept {
-		char 	temporary[sizeof "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255"] = {0};
-		char* 	pointer = nullptr;
-		struct {
-			int 	base = -1;
-			int 	length = 0;
-		} best {}, 	current {};
-		static constexpr std::size_t 	v6_size   = 16;
-		static constexpr std::size_t 	short_size  = 2;
-		unsigned int 					words[v6_size / short_size] = {0};
-	
-		std::memset(words, '\0', sizeof words);
-		for (std::size_t i {}; i < v6_size; i ++)
-			words[i / 2] |= (src[i] << ((1 - (i % 2)) << 3));
-		
-		for (std::size_t i {}; i < (v6_size / short_size); i++) {
-			if (0 == words[i]) {
-				if (-1 == current.base)
-				{ current.base = i; current.length = 1; }
-				else current.length ++;
-			} else {
-				if (current.base != -1) {
-					if (-1 == best.base or current.length > best.length) best = current;
-					current.base = -1;
-				}
-			}
-		}
-		if (current.base != -1 and (-1 == best.base or current.length > best.length))  best = current;
-		if (best.base != -1 and best.length < 2) best.base = -1;
-			
-		pointer = temporary;
-		for (std::size_t i {}; i < (v6_size / short_size); i++) {
-			if (best.base != -1 and static_cast<int>(i) >= best.base and static_cast<int>(i) < (best.base + best.length)) {
-				if (static_cast<int>(i) == best.base)
-					*pointer ++ = ':';
-				continue;
-			}
-			if (not (0 == i)) *pointer ++ = ':';
-			if (6 == i and 0 == best.base and (6 == best.length or (7 == best.length and words[7] != 0x0001) or (5 == best.length and 0xffff == words[5]))	) {
-				if (not inet_ntop4(src + 12, pointer, sizeof temporary - (pointer - temporary))) return (nullptr);
-				pointer += std::strlen(pointer);
-				break;
-			}
-			pointer += std::sprintf(pointer, "%x", words[i]);
+	[[nodiscard]] constexpr uint128_type load_v6(unsigned char const* bytes) noexcept {
+		uint128_type value = 0;
+		for(int i = 0; i < 16; i ++) value = value << 8 | bytes[i];
+		return value;
+	}
+	constexpr void store_v6(uint128_type value, unsigned char* bytes) noexcept {
+		for(int i = 15; i >= 0; i --, value >>= 8) bytes[i] = static_cast<unsigned char>(value);
+	}
+	[[nodiscard]] constexpr std::uint32_t mask_v4(int length) noexcept {
+		return length ? ~std::uint32_t{} << (32 - length) : 0;
+	}
+	[[nodiscard]] constexpr uint128_type mask_v6(int length) noexcept {
+		return length ? ~uint128_type{} << (128 - length) : 0;
+	}
+	constexpr char* format_prefix(int length, char* out) noexcept {
+		* out ++ = '/';
+		if(length >= 100) * out ++ = static_cast<char>('0' + length / 100);
+		if(length >= 10) * out ++ = static_cast<char>('0' + length / 10 % 10);
+		* out ++ = static_cast<char>('0' + length % 10);
+		return out;
+	}
+	/* the "/length" after a network address, at most max */
+	[[nodiscard]] constexpr char const* parse_prefix(char const* first, char const* last, int max, int& length) noexcept {
+		if(first == last or * first ++ != '/' or first == last or not is_digit(* first))
+			return nullptr;
+		int value = 0;
+		for(char const* const start = first; first != last and is_digit(* first); first ++) {
+			value = value * 10 + (* first - '0');
+			if(value > max or first - start == 3)
+				return nullptr;
 		}
-		if (best.base != -1 and (best.base + best.length) == (v6_size / short_size)) *pointer ++ = ':';
-		*pointer++ = '\0';
-	
-		if ((std::size_t)(pointer - temporary) > size) return (nullptr);
-		std::strcpy(dst, temporary);
-		return (dst);
+		length = value;
+		return first;
 	}
 } // namespace conet::detail	
 
@@ -278,12 +393,8 @@ namespace ip __attribute__((__visibility__("default"))) {
 		[[nodiscard]] constexpr bytes_type to_bytes() const noexcept { return std::bit_cast<bytes_type>(M_address); }
 		template <typename Alloc = std::allocator<char>>
 		[[nodiscard]] constexpr detail::string_with<Alloc> to_string(Alloc const& alloc = Alloc()) const noexcept(std::is_default_constructible_v<Alloc>) {
-			auto __address = to_uint();
-			return {(std::ostringstream() << ((__address >> 24) & 0xFF) << "."  
-			        << ((__address >> 16) & 0xFF) << "."  
-			        << ((__address >> 8)  & 0xFF) << "."  
-			        << (__address & 0xFF)).view().data(), 
-				alloc	};
+			char __text[ipv4_address_strlen];
+			return {__text, detail::format_v4(to_uint(), __text), alloc};
 		}
 		
 		[[nodiscard]] static constexpr address_v4 any() noexcept { return address_v4{}; }
@@ -341,32 +452,43 @@ namespace ip __attribute__((__visibility__("default"))) {
 	
 	[[nodiscard]] constexpr address_v4 make_address_v4(address_v4::bytes_type const& bytes) noexcept { return address_v4{bytes}; }
 	[[nodiscard]] constexpr address_v4 make_address_v4(address_v4::uint_type value) noexcept { return address_v4{value}; }
-	[[nodiscard]] inline address_v4 make_address_v4(char const* s, std::error_code& ec) noexcept {
-		address_v4 address;
-		const int result = inet_pton(ipv4_address, s, reinterpret_cast<void *>(std::addressof(address.M_address)));
-		if(result > 0) {
-			ec.clear();
-			return address;
-		}
-		if(result == 0) 
-			ec = std::make_error_code(std::errc::invalid_argument);
-		else 
-			ec.assign(errno, std::generic_category());
-		return {};
+	/*
+		Parses the address at the start of [first, last), to_chars style: ptr is
+		where it ended, ec is invalid_argument and ptr first when there is none.
+		No terminator is needed and nothing is copied
+	*/
+	[[nodiscard]] constexpr std::from_chars_result from_chars(char const* first, char const* last, address_v4& __address) noexcept {
+		std::uint32_t __value = 0;
+		char const* const __end = detail::parse_v4(first, last, __value);
+		if(not __end)
+			return {first, std::errc::invalid_argument};
+		__address = address_v4{__value};
+		return {__end, std::errc{}};
 	}
-	[[nodiscard]] inline address_v4 make_address_v4(std::string const& s, std::error_code& e) noexcept {
-		return make_address_v4(s.c_str(), e);
+	/* writes the dotted quad, at most 15 characters and no terminator */
+	[[nodiscard]] constexpr std::to_chars_result to_chars(char* first, char* last, address_v4 const& __address) noexcept {
+		char __text[ipv4_address_strlen];
+		std::size_t const __length = detail::format_v4(__address.to_uint(), __text) - __text;
+		if(static_cast<std::size_t>(last - first) < __length)
+			return {last, std::errc::value_too_large};
+		return {std::copy_n(__text, __length, first), std::errc{}};
 	}
-	[[nodiscard]] inline address_v4 make_address_v4(std::string_view s, std::error_code& e) noexcept {
-		char buffer[16] = {0};
-		auto length = s.copy(buffer, std::size(buffer));
-		if(length == std::size(buffer)) {
-			e = std::make_error_code(std::errc::invalid_argument);
+
+	[[nodiscard]] inline address_v4 make_address_v4(std::string_view s, std::error_code& ec) noexcept {
+		address_v4 __address;
+		auto const [__end, __error] = from_chars(s.data(), s.data() + s.size(), __address);
+		if(__error != std::errc{} or __end != s.data() + s.size()) {
+			ec = std::make_error_code(std::errc::invalid_argument);
 			return {};
 		}
-		e.clear();
-		buffer[length] = '\0';
-		return make_address_v4(buffer, e);
+		ec.clear();
+		return __address;
+	}
+	[[nodiscard]] inline address_v4 make_address_v4(char const* s, std::error_code& ec) noexcept {
+		return make_address_v4(std::string_view{s}, ec);
+	}
+	[[nodiscard]] inline address_v4 make_address_v4(std::string const& s, std::error_code& e) noexcept {
+		return make_address_v4(std::string_view{s}, e);
 	}
 	template<typename CharT, typename Traits> 
 	inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, address_v4 const& __a) noexcept
@@ -404,7 +526,7 @@ namespace ip __attribute__((__visibility__("default"))) {
 		[[nodiscard]] constexpr bool is_site_local() const noexcept { return (0x00fe == M_bytes.front()) and (0xc0 == (0xc0 & M_bytes[1])); }
 		[[nodiscard]] constexpr bool is_unique_local() const noexcept { return (0xfc == (M_bytes.front() & 0xfe)) ; }
 		[[nodiscard]] constexpr bool is_v4_mapped() const noexcept {
-			return (std::all_of(M_bytes.cbegin(), M_bytes.cbegin() + 9, [](auto&& value) { return (0x0000 == value); }) and (0x00ff == M_bytes[10]) && (0x00ff == M_bytes[11])); 
+			return (std::all_of(M_bytes.cbegin(), M_bytes.cbegin() + 10, [](auto&& value) { return (0x0000 == value); }) and (0x00ff == M_bytes[10]) && (0x00ff == M_bytes[11])); 
 		}
 		[[nodiscard]] constexpr bool is_multicast_node_local() const noexcept { return (is_multicast() and (0x01 == (M_bytes[1] & 0x0f))); }	
 		[[nodiscard]] constexpr bool is_multicast_link_local() const noexcept { return (is_multicast() and (0x02 == (M_bytes[1] & 0x0f))); }
@@ -416,15 +538,8 @@ namespace ip __attribute__((__visibility__("default"))) {
 		constexpr bytes_type to_bytes() const noexcept { return M_bytes; }
 		template <typename Alloc = std::allocator<char>>
 		[[nodiscard]] constexpr detail::string_with<Alloc> to_string(Alloc const& alloc = Alloc()) const noexcept(std::is_default_constructible_v<Alloc>) {
-			detail::string_with<Alloc> s(alloc);
-			s.resize(ipv6_address_strlen + (not (0 == M_scope_id) ? 11 : 0));
-			char *const pointer = std::addressof(s.front());
-			if(inet_ntop(ipv6_address, std::addressof(M_bytes), pointer, s.size())) {
-				auto sentinel = s.find('\0');
-				if(not (0 == M_scope_id)) 
-					s.erase(sentinel + std::sprintf(pointer + sentinel, "%%%lu", (long unsigned int)M_scope_id));
-				return s;	
-			} else return {};
+			char __text[ipv6_address_strlen + 11];
+			return {__text, format(__text), alloc};
 		}
 		
 		[[nodiscard]] static constexpr address_v6 any() noexcept { return {}; }
@@ -438,10 +553,21 @@ namespace ip __attribute__((__visibility__("default"))) {
 	private:
 		template <typename Protocol> friend struct basic_endpoint;
 		template <typename> friend struct basic_address_iterator;
+		friend constexpr std::to_chars_result to_chars(char*, char*, address_v6 const&) noexcept;
 	    friend constexpr bool operator==(address_v6 const&, address_v6 const&) noexcept;
 	    friend constexpr bool operator< (address_v6 const&, address_v6 const&) noexcept;
 		template<typename> friend struct std::hash;
 		
+		/* the text with its scope, at most 56 characters */
+		constexpr char* format(char* __out) const noexcept {
+			__out = detail::format_v6(M_bytes.data(), __out);
+			if(M_scope_id) {
+				* __out ++ = '%';
+				__out = std::to_chars(__out, __out + 10, M_scope_id).ptr;
+			}
+			return __out;
+		}
+
 		bytes_type 		M_bytes 	{};
 		scope_id_type 	M_scope_id 	{};
 	};    
@@ -465,50 +591,62 @@ namespace ip __attribute__((__visibility__("default"))) {
 
 	[[nodiscard]] constexpr address_v6 make_address_v6(address_v6::bytes_type const& bytes, scope_id_type scope_id) noexcept 
 	{ 	return address_v6{bytes, scope_id}; }
-	[[nodiscard]] inline address_v6 make_address_v6(char const* address, char const *scope, std::error_code& ec) noexcept {
-		address_v6::bytes_type bytes;
-		const int result = inet_pton(ipv6_address, address, reinterpret_cast<void *>(std::addressof(bytes)));
-		if(result > 0) {
-			ec.clear();
-			if(nullptr == scope) 
-				return { bytes };
-			char *sentinel = nullptr;	
-			unsigned long value = std::strtoul(scope, std::addressof(sentinel), 10);	
-			if(sentinel != scope and ! *sentinel and value < std::numeric_limits<scope_id_type>::max())
-				return { bytes, static_cast<scope_id_type>(value) };
-			ec = std::make_error_code(std::errc::invalid_argument);	
-		} else if(0 == result) ec = std::make_error_code(std::errc::invalid_argument);
-		else ec.assign(errno, std::generic_category());	
-		return {};
+	/* as for address_v4, followed by an optional %scope of decimal digits */
+	[[nodiscard]] constexpr std::from_chars_result from_chars(char const* first, char const* last, address_v6& __address) noexcept {
+		address_v6::bytes_type __bytes;
+		char const* __end = detail::parse_v6(first, last, __bytes.data());
+		if(not __end)
+			return {first, std::errc::invalid_argument};
+		scope_id_type __scope = 0;
+		if(__end != last and * __end == '%') {
+			auto const [__scope_end, __error] = std::from_chars(__end + 1, last, __scope);
+			if(__error != std::errc{})
+				return {first, std::errc::invalid_argument};
+			__end = __scope_end;
+		}
+		__address = address_v6{__bytes, __scope};
+		return {__end, std::errc{}};
 	}
-	[[nodiscard]] inline address_v6 make_address_v6(char const* s, std::error_code& ec) noexcept {
-		auto 	scope_position = std::strchr(s, '%');
-		if(nullptr == scope_position) return make_address_v6(s, nullptr, ec);
-		char 	buffer[64] = {0};
-		char 	*output = buffer;
-		bool 	skip_leading_zero = true;
-		while(s < scope_position && output < std::end(buffer)) {
-			if(not skip_leading_zero or '0' != *s) {
-				if(':' == * s or '.' == * s)  skip_leading_zero = true;
-				else { skip_leading_zero = false; * output ++ = * s; }
-				s ++;
-			}
+	/* writes the RFC 5952 text and the %scope if any, at most 56 characters and no terminator */
+	[[nodiscard]] constexpr std::to_chars_result to_chars(char* first, char* last, address_v6 const& __address) noexcept {
+		char __text[ipv6_address_strlen + 11];
+		std::size_t const __length = __address.format(__text) - __text;
+		if(static_cast<std::size_t>(last - first) < __length)
+			return {last, std::errc::value_too_large};
+		return {std::copy_n(__text, __length, first), std::errc{}};
+	}
+
+	[[nodiscard]] inline address_v6 make_address_v6(std::string_view s, std::error_code& ec) noexcept {
+		address_v6 __address;
+		auto const [__end, __error] = from_chars(s.data(), s.data() + s.size(), __address);
+		if(__error != std::errc{} or __end != s.data() + s.size()) {
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return {};
 		}
-		if(output == std::end(buffer)) {
+		ec.clear();
+		return __address;
+	}
+	[[nodiscard]] inline address_v6 make_address_v6(char const* address, char const *scope, std::error_code& ec) noexcept {
+		address_v6 __address = make_address_v6(std::string_view{address}, ec);
+		if(ec or nullptr == scope)
+			return __address;
+		std::string_view const __scope = * scope == '%' ? scope + 1 : scope;
+		scope_id_type __value = 0;
+		auto const [__end, __error] = std::from_chars(__scope.data(), __scope.data() + __scope.size(), __value);
+		if(__error != std::errc{} or __end != __scope.data() + __scope.size() or __address.scope_id()) {
 			ec = std::make_error_code(std::errc::invalid_argument);
 			return {};
-		} else {
-			* output = '\0';
-			return make_address_v6(buffer, scope_position, ec);
-		}	
+		}
+		__address.scope_id(__value);
+		return __address;
+	}
+	[[nodiscard]] inline address_v6 make_address_v6(char const* s, std::error_code& ec) noexcept {
+		return make_address_v6(std::string_view{s}, ec);
 	}
 	[[nodiscard]] inline address_v6 make_address_v6(std::string const& s, std::error_code& ec) noexcept {
-		return make_address_v6(s.data(), ec);
+		return make_address_v6(std::string_view{s}, ec);
 	}
-	[[nodiscard]] inline address_v6 make_address_v6(std::string_view s, std::error_code& ec) noexcept {
-		return make_address_v6(s.data(), ec);
-	}	
-	
+
 	template <typename CharT, typename Traits> 
 	[[nodiscard]] inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, address_v6 const& __a) noexcept 
 	{	return (__os << __a.to_string());		}
@@ -566,13 +704,13 @@ namespace ip __attribute__((__visibility__("default"))) {
 		to_string(const Alloc& __a = Alloc()) const noexcept {
 			return is_v4() ? 
 				std::get<address_v4>(M_address).to_string(__a) : 
-				std::get<address_v4>(M_address).to_string(__a);
+				std::get<address_v6>(M_address).to_string(__a);
 		}	
 		
     	[[nodiscard]] friend constexpr std::weak_ordering operator<=>(address const& __a, address const& __b) noexcept {
 			if (__a.is_v4())
-			  	return __b.is_v4() ? std::compare_three_way{}(std::get<address_v4>(__a.M_address), std::get<address_v4>(__a.M_address)) : std::weak_ordering::less;
-			return __b.is_v4() ? std::weak_ordering::greater : std::compare_three_way{}(std::get<address_v4>(__a.M_address), std::get<address_v4>(__a.M_address));			
+			  	return __b.is_v4() ? std::compare_three_way{}(std::get<address_v4>(__a.M_address), std::get<address_v4>(__b.M_address)) : std::weak_ordering::less;
+			return __b.is_v4() ? std::weak_ordering::greater : std::compare_three_way{}(std::get<address_v6>(__a.M_address), std::get<address_v6>(__b.M_address));			
 		}
 		
 	private:
@@ -584,15 +722,15 @@ namespace ip __attribute__((__visibility__("default"))) {
 	};
 	[[nodiscard]] constexpr bool operator==(address const& __a, address const& __b) noexcept {
 		if (__a.is_v4())
-		  	return __b.is_v4() ? std::get<address_v4>(__a.M_address) == std::get<address_v4>(__a.M_address) : false;
-		return __b.is_v4() ? false : std::get<address_v6>(__a.M_address) == std::get<address_v6>(__a.M_address);
+		  	return __b.is_v4() ? std::get<address_v4>(__a.M_address) == std::get<address_v4>(__b.M_address) : false;
+		return __b.is_v4() ? false : std::get<address_v6>(__a.M_address) == std::get<address_v6>(__b.M_address);
 	}	
 	[[nodiscard]] constexpr bool operator!=(address const& __a, address const& __b) noexcept
 	{ 	return not (__a == __b); }	
 	[[nodiscard]] constexpr bool operator< (address const& __a, address const& __b) noexcept {
 		if (__a.is_v4())
-		  	return __b.is_v4() ? std::get<address_v4>(__a.M_address) < std::get<address_v4>(__a.M_address) : true;
-		return __b.is_v4() ? false : std::get<address_v6>(__a.M_address) < std::get<address_v6>(__a.M_address);
+		  	return __b.is_v4() ? std::get<address_v4>(__a.M_address) < std::get<address_v4>(__b.M_address) : true;
+		return __b.is_v4() ? false : std::get<address_v6>(__a.M_address) < std::get<address_v6>(__b.M_address);
 	}	
 	[[nodiscard]] constexpr bool operator> (address const& __a, address const& __b) noexcept
 	{ 	return __b < __a; }
@@ -603,26 +741,39 @@ namespace ip __attribute__((__visibility__("default"))) {
 	[[nodiscard]] constexpr bool operator>=(address const& __a, address const& __b) noexcept
 	{ 	return not (__a < __b); }		
 	
-	[[nodiscard]] inline address make_address(const char* __str, std::error_code& __ec) noexcept {
+	/* a dotted quad, else IPv6 text */
+	[[nodiscard]] constexpr std::from_chars_result from_chars(char const* first, char const* last, address& __address) noexcept {
+		address_v4 __v4;
+		if (auto const __result = from_chars(first, last, __v4); __result.ec == std::errc{}) {
+			__address = __v4;
+			return __result;
+		}
+		address_v6 __v6;
+		auto const __result = from_chars(first, last, __v6);
+		if (__result.ec == std::errc{})
+			__address = __v6;
+		return __result;
+	}
+	[[nodiscard]] constexpr std::to_chars_result to_chars(char* first, char* last, address const& __address) noexcept {
+		return __address.is_v4() ? to_chars(first, last, __address.to_v4()) : to_chars(first, last, __address.to_v6());
+	}
+
+	[[nodiscard]] inline address make_address(std::string_view __str, std::error_code& __ec) noexcept {
 		if (address_v4 __v4a = make_address_v4(__str, __ec); not __ec) return {__v4a};
 		if (address_v6 __v6a = make_address_v6(__str, __ec); not __ec) return {__v6a};
 		return {};
 	}
+	[[nodiscard]] inline address make_address(const char* __str, std::error_code& __ec) noexcept
+	{ 	return make_address(std::string_view{__str}, __ec); }
 
 	[[nodiscard]] inline address make_address(const std::string& __str, std::error_code& __ec) noexcept
-	{ 	return make_address(__str.c_str(), __ec); }
-	
-	[[nodiscard]] inline address make_address(std::string_view __str, std::error_code& __ec) noexcept {
-		if (__str.rfind('\0') != std::string_view::npos)
-		  	return make_address(__str.data(), __ec);
-		return make_address(std::string{__str}, __ec); 
-	}
+	{ 	return make_address(std::string_view{__str}, __ec); }
 	
 	template<typename CharT, typename Traits> 
 	inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, address const& __a) noexcept
     { 	return (__os << __a.to_string()); }	
 
- 	template <typename> struct basic_address_iterator { static_assert(std::bool_constant<false>::value, "not defined"); };
+ 	template <typename Address> struct basic_address_iterator { static_assert(not std::is_same_v<Address, Address>, "not defined"); };
  	
  	template <> struct basic_address_iterator<address_v4> {
 		typedef address_v4 				value_type;
@@ -730,7 +881,7 @@ namespace ip __attribute__((__visibility__("default"))) {
 	typedef basic_address_iterator<address_v4> address_v4_iterator;
 	typedef basic_address_iterator<address_v6> address_v6_iterator;
 	
-	template <typename> struct basic_address_range { static_assert(std::bool_constant<false>::value, "not defined"); };
+	template <typename Address> struct basic_address_range { static_assert(not std::is_same_v<Address, Address>, "not defined"); };
 	
 	template <> struct basic_address_range<address_v4> : public std::ranges::view_interface<basic_address_range<address_v4>> {
 		typedef basic_address_iterator<address_v4> 						iterator;
@@ -780,10 +931,284 @@ namespace ip __attribute__((__visibility__("default"))) {
 	typedef basic_address_range<address_v4> address_v4_range;
 	typedef basic_address_range<address_v6> address_v6_range;
 	
-	/* 	todos:
-	struct network_v4
-	struct network_v6
+	template <typename Network> struct basic_subnet_iterator {
+		typedef Network 				value_type;
+		typedef std::ptrdiff_t 			difference_type;
+		typedef Network const* 			pointer;
+		typedef Network 				reference;
+		typedef std::input_iterator_tag iterator_category;
+		
+		constexpr basic_subnet_iterator() noexcept = default;
+		constexpr basic_subnet_iterator(Network const& __first, std::uint64_t __index) noexcept: M_first(__first), M_index(__index) {}
+		
+		constexpr reference operator*() const noexcept { return M_first.nth(M_index); }
+		
+		constexpr basic_subnet_iterator& operator++() noexcept {
+			M_index ++;
+			return *this;
+		}
+		constexpr basic_subnet_iterator operator++(int) noexcept {
+		  	auto __tmp = *this;
+		  	(void) operator++();
+		  	return __tmp;
+		}
+		constexpr bool operator==(const basic_subnet_iterator& __rhs) const noexcept
+		{ 	return M_index == __rhs.M_index; 	}
+		constexpr bool operator!=(const basic_subnet_iterator& __rhs) const noexcept
+		{ 	return M_index != __rhs.M_index; 	}
+		
+	private:
+		Network 		M_first = {};
+		std::uint64_t 	M_index = {};
+	};
+	template <typename Network> struct basic_subnet_range : public std::ranges::view_interface<basic_subnet_range<Network>> {
+		typedef basic_subnet_iterator<Network> 	iterator;
+		typedef Network 						value_type;
+		
+		constexpr basic_subnet_range() noexcept = default;
+		constexpr basic_subnet_range(Network const& __first, std::uint64_t __size) noexcept: M_first(__first), M_size(__size) {}
+		constexpr iterator begin() const noexcept { return {M_first, 0}; }
+		constexpr iterator end() const noexcept { return {M_first, M_size}; }
+		constexpr std::uint64_t size() const noexcept { return M_size; }
+		
+	private:
+		Network 		M_first = {};
+		std::uint64_t 	M_size = {};
+	};
+	
+	/*
+		An address and a prefix length, as in the Networking TS. address() keeps
+		the host bits it was made with, canonical() clears them; contains() and
+		is_subnet_of() only look at the prefix
 	*/
+	struct [[nodiscard("network_v4")]] network_v4 {
+		constexpr network_v4() noexcept = default;
+		constexpr network_v4(network_v4 const&) noexcept = default;
+		constexpr network_v4& operator=(network_v4 const&) noexcept = default;
+		constexpr network_v4(network_v4 &&) noexcept = default;
+		constexpr network_v4& operator=(network_v4 &&) noexcept = default;
+		
+		constexpr network_v4(address_v4 const& __address, int __prefix_length): M_address(__address), M_prefix_length(__prefix_length) {
+			if(__prefix_length < 0 or __prefix_length > 32)
+				throw std::out_of_range("network_v4: prefix length");
+		}
+		constexpr network_v4(address_v4 const& __address, address_v4 const& __mask): M_address(__address), M_prefix_length(std::popcount(__mask.to_uint())) {
+			if(__mask.to_uint() != detail::mask_v4(M_prefix_length))
+				throw std::invalid_argument("network_v4: non-contiguous netmask");
+		}
+		
+		[[nodiscard]] constexpr address_v4 address() const noexcept { return M_address; }
+		[[nodiscard]] constexpr int prefix_length() const noexcept { return M_prefix_length; }
+		[[nodiscard]] constexpr address_v4 netmask() const noexcept { return address_v4{detail::mask_v4(M_prefix_length)}; }
+		[[nodiscard]] constexpr address_v4 network() const noexcept { return address_v4{M_address.to_uint() & detail::mask_v4(M_prefix_length)}; }
+		[[nodiscard]] constexpr address_v4 broadcast() const noexcept { return address_v4{M_address.to_uint() | ~detail::mask_v4(M_prefix_length)}; }
+		/* all but the network and broadcast addresses, every address of a /31 or /32 */
+		[[nodiscard]] constexpr address_v4_range hosts() const noexcept {
+			if(M_prefix_length >= 31)
+				return {network(), address_v4{broadcast().to_uint() + 1}};
+			return {address_v4{network().to_uint() + 1}, broadcast()};
+		}
+		[[nodiscard]] constexpr network_v4 canonical() const noexcept { return {network(), M_prefix_length}; }
+		[[nodiscard]] constexpr bool is_host() const noexcept { return (32 == M_prefix_length); }
+		
+		[[nodiscard]] constexpr bool contains(address_v4 const& __address) const noexcept {
+			return 0 == ((__address.to_uint() ^ M_address.to_uint()) & detail::mask_v4(M_prefix_length));
+		}
+		/* strictly inside __other */
+		[[nodiscard]] constexpr bool is_subnet_of(network_v4 const& __other) const noexcept {
+			return __other.M_prefix_length < M_prefix_length and __other.contains(M_address);
+		}
+		/* the networks of __length that make up this one, in address order */
+		[[nodiscard]] constexpr basic_subnet_range<network_v4> subnets(int __length) const {
+			if(__length < M_prefix_length or __length > 32)
+				throw std::out_of_range("network_v4: subnet length");
+			return {network_v4{network(), __length}, std::uint64_t{1} << (__length - M_prefix_length)};
+		}
+		
+		template <typename Alloc = std::allocator<char>>
+		[[nodiscard]] constexpr detail::string_with<Alloc> to_string(Alloc const& alloc = Alloc()) const noexcept(std::is_default_constructible_v<Alloc>) {
+			char __text[ipv4_address_strlen + 3];
+			return {__text, format(__text), alloc};
+		}
+		
+	private:
+		template <typename> friend struct basic_subnet_iterator;
+		friend constexpr std::to_chars_result to_chars(char*, char*, network_v4 const&) noexcept;
+		
+		constexpr network_v4 nth(std::uint64_t __index) const noexcept {
+			return {address_v4{static_cast<std::uint32_t>(M_address.to_uint() + (__index << (32 - M_prefix_length)))}, M_prefix_length};
+		}
+		constexpr char* format(char* __out) const noexcept {
+			__out = detail::format_v4(M_address.to_uint(), __out);
+			return detail::format_prefix(M_prefix_length, __out);
+		}
+		
+		address_v4 	M_address 		= {};
+		int 		M_prefix_length = {};
+	};
+	
+	[[nodiscard]] constexpr bool operator==(network_v4 const& __a, network_v4 const& __b) noexcept
+	{ 	return __a.address() == __b.address() and __a.prefix_length() == __b.prefix_length(); }
+	
+	[[nodiscard]] constexpr bool operator!=(network_v4 const& __a, network_v4 const& __b) noexcept
+	{ 	return not (__a == __b); }
+	
+	/* an address_v4 followed by "/length" */
+	[[nodiscard]] constexpr std::from_chars_result from_chars(char const* first, char const* last, network_v4& __network) noexcept {
+		address_v4 __address;
+		int __length = 0;
+		auto const [__end, __error] = from_chars(first, last, __address);
+		char const* const __prefix_end = __error == std::errc{} ? detail::parse_prefix(__end, last, 32, __length) : nullptr;
+		if(not __prefix_end)
+			return {first, std::errc::invalid_argument};
+		__network = network_v4{__address, __length};
+		return {__prefix_end, std::errc{}};
+	}
+	[[nodiscard]] constexpr std::to_chars_result to_chars(char* first, char* last, network_v4 const& __network) noexcept {
+		char __text[ipv4_address_strlen + 3];
+		std::size_t const __length = __network.format(__text) - __text;
+		if(static_cast<std::size_t>(last - first) < __length)
+			return {last, std::errc::value_too_large};
+		return {std::copy_n(__text, __length, first), std::errc{}};
+	}
+	
+	[[nodiscard]] inline network_v4 make_network_v4(std::string_view s, std::error_code& ec) noexcept {
+		network_v4 __network;
+		auto const [__end, __error] = from_chars(s.data(), s.data() + s.size(), __network);
+		if(__error != std::errc{} or __end != s.data() + s.size()) {
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return {};
+		}
+		ec.clear();
+		return __network;
+	}
+	[[nodiscard]] inline network_v4 make_network_v4(char const* s, std::error_code& ec) noexcept {
+		return make_network_v4(std::string_view{s}, ec);
+	}
+	[[nodiscard]] inline network_v4 make_network_v4(std::string const& s, std::error_code& ec) noexcept {
+		return make_network_v4(std::string_view{s}, ec);
+	}
+	template<typename CharT, typename Traits> 
+	inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, network_v4 const& __n) noexcept
+    { 	return (__os << __n.to_string()); }
+	
+	/* as network_v4; the scope of the address is kept by address() and dropped by network() */
+	struct [[nodiscard("network_v6")]] network_v6 {
+		constexpr network_v6() noexcept = default;
+		constexpr network_v6(network_v6 const&) noexcept = default;
+		constexpr network_v6& operator=(network_v6 const&) noexcept = default;
+		constexpr network_v6(network_v6 &&) noexcept = default;
+		constexpr network_v6& operator=(network_v6 &&) noexcept = default;
+		
+		constexpr network_v6(address_v6 const& __address, int __prefix_length): M_address(__address), M_prefix_length(__prefix_length) {
+			if(__prefix_length < 0 or __prefix_length > 128)
+				throw std::out_of_range("network_v6: prefix length");
+		}
+		
+		[[nodiscard]] constexpr address_v6 address() const noexcept { return M_address; }
+		[[nodiscard]] constexpr int prefix_length() const noexcept { return M_prefix_length; }
+		[[nodiscard]] constexpr address_v6 network() const noexcept { return make(bits() & detail::mask_v6(M_prefix_length)); }
+		/* every address, an empty range for ::/0 whose end wraps around to its beginning */
+		[[nodiscard]] constexpr address_v6_range hosts() const noexcept {
+			return {network(), make((bits() | ~detail::mask_v6(M_prefix_length)) + 1)};
+		}
+		[[nodiscard]] constexpr network_v6 canonical() const noexcept { return {network(), M_prefix_length}; }
+		[[nodiscard]] constexpr bool is_host() const noexcept { return (128 == M_prefix_length); }
+		
+		[[nodiscard]] constexpr bool contains(address_v6 const& __address) const noexcept {
+			auto const __bytes = __address.to_bytes();
+			return 0 == ((detail::load_v6(__bytes.data()) ^ bits()) & detail::mask_v6(M_prefix_length));
+		}
+		[[nodiscard]] constexpr bool is_subnet_of(network_v6 const& __other) const noexcept {
+			return __other.M_prefix_length < M_prefix_length and __other.contains(M_address);
+		}
+		/* as network_v4, at most 2^63 of them */
+		[[nodiscard]] constexpr basic_subnet_range<network_v6> subnets(int __length) const {
+			if(__length < M_prefix_length or __length > 128 or __length - M_prefix_length > 63)
+				throw std::out_of_range("network_v6: subnet length");
+			return {network_v6{network(), __length}, std::uint64_t{1} << (__length - M_prefix_length)};
+		}
+		
+		template <typename Alloc = std::allocator<char>>
+		[[nodiscard]] constexpr detail::string_with<Alloc> to_string(Alloc const& alloc = Alloc()) const noexcept(std::is_default_constructible_v<Alloc>) {
+			char __text[ipv6_address_strlen + 15];
+			return {__text, format(__text), alloc};
+		}
+		
+	private:
+		template <typename> friend struct basic_subnet_iterator;
+		friend constexpr std::to_chars_result to_chars(char*, char*, network_v6 const&) noexcept;
+		
+		constexpr detail::uint128_type bits() const noexcept {
+			auto const __bytes = M_address.to_bytes();
+			return detail::load_v6(__bytes.data());
+		}
+		static constexpr address_v6 make(detail::uint128_type __bits) noexcept {
+			address_v6::bytes_type __bytes;
+			detail::store_v6(__bits, __bytes.data());
+			return address_v6{__bytes};
+		}
+		constexpr network_v6 nth(std::uint64_t __index) const noexcept {
+			if(0 == __index)
+				return * this;
+			return {make(bits() + (detail::uint128_type{__index} << (128 - M_prefix_length))), M_prefix_length};
+		}
+		constexpr char* format(char* __out) const noexcept {
+			__out = to_chars(__out, __out + ipv6_address_strlen + 11, M_address).ptr;
+			return detail::format_prefix(M_prefix_length, __out);
+		}
+		
+		address_v6 	M_address 		= {};
+		int 		M_prefix_length = {};
+	};
+	
+	[[nodiscard]] constexpr bool operator==(network_v6 const& __a, network_v6 const& __b) noexcept
+	{ 	return __a.address() == __b.address() and __a.prefix_length() == __b.prefix_length(); }
+	
+	[[nodiscard]] constexpr bool operator!=(network_v6 const& __a, network_v6 const& __b) noexcept
+	{ 	return not (__a == __b); }
+	
+	/* an address_v6, with its scope if any, followed by "/length" */
+	[[nodiscard]] constexpr std::from_chars_result from_chars(char const* first, char const* last, network_v6& __network) noexcept {
+		address_v6 __address;
+		int __length = 0;
+		auto const [__end, __error] = from_chars(first, last, __address);
+		char const* const __prefix_end = __error == std::errc{} ? detail::parse_prefix(__end, last, 128, __length) : nullptr;
+		if(not __prefix_end)
+			return {first, std::errc::invalid_argument};
+		__network = network_v6{__address, __length};
+		return {__prefix_end, std::errc{}};
+	}
+	[[nodiscard]] constexpr std::to_chars_result to_chars(char* first, char* last, network_v6 const& __network) noexcept {
+		char __text[ipv6_address_strlen + 15];
+		std::size_t const __length = __network.format(__text) - __text;
+		if(static_cast<std::size_t>(last - first) < __length)
+			return {last, std::errc::value_too_large};
+		return {std::copy_n(__text, __length, first), std::errc{}};
+	}
+	
+	[[nodiscard]] inline network_v6 make_network_v6(std::string_view s, std::error_code& ec) noexcept {
+		network_v6 __network;
+		auto const [__end, __error] = from_chars(s.data(), s.data() + s.size(), __network);
+		if(__error != std::errc{} or __end != s.data() + s.size()) {
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return {};
+		}
+		ec.clear();
+		return __network;
+	}
+	[[nodiscard]] inline network_v6 make_network_v6(char const* s, std::error_code& ec) noexcept {
+		return make_network_v6(std::string_view{s}, ec);
+	}
+	[[nodiscard]] inline network_v6 make_network_v6(std::string const& s, std::error_code& ec) noexcept {
+		return make_network_v6(std::string_view{s}, ec);
+	}
+	template<typename CharT, typename Traits> 
+	inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, network_v6 const& __n) noexcept
+    { 	return (__os << __n.to_string()); }
+	
+	typedef basic_subnet_range<network_v4> network_v4_range;
+	typedef basic_subnet_range<network_v6> network_v6_range;
 	
 	template <typename Protocol> struct [[nodiscard("basic_endpoint")]] basic_endpoint {
 		typedef Protocol protocal_type;
@@ -792,10 +1217,11 @@ namespace ip __attribute__((__visibility__("default"))) {
 		constexpr basic_endpoint& operator=(basic_endpoint const&) noexcept = default;
 		constexpr basic_endpoint(basic_endpoint &&) noexcept = default;
 		constexpr basic_endpoint& operator=(basic_endpoint &&) noexcept = default;
-		constexpr basic_endpoint(address const& __address, port_type __port = port_type()) noexcept: M_address(__address), M_port(__port) {}
-		template <typename OProtocol> constexpr basic_endpoint(OProtocol const& __proto, port_type __port = port_type()) noexcept: M_port(address_v4::hton_16(__port)) {
+		constexpr basic_endpoint(conet::net::ip::address const& __address, port_type __port = port_type()) noexcept: M_port(__port), M_address(__address) {}
+		template <typename OProtocol> requires requires (OProtocol const& __proto) { __proto.family(); }
+		constexpr basic_endpoint(OProtocol const& __proto, port_type __port = port_type()) noexcept: M_port(__port) {
 			if(__proto.family() == ipv6_address) 
-				M_address = address_v4();
+				M_address = address_v6();
 		} 		
 		
 		[[nodiscard]] constexpr protocal_type protocol() const noexcept { return M_address.is_v4() ? protocal_type::v4() : protocal_type::v6() ;}
@@ -844,16 +1270,21 @@ namespace ip __attribute__((__visibility__("default"))) {
 	template<typename Protocol, typename CharT, typename Traits> 
 	inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& __os, basic_endpoint<Protocol> const& __p) noexcept	{
 		if(__p.protocol().family() == ipv6_address) 
-			return (__os << "[" << __p.address() << "]");
+			return (__os << "[" << __p.address() << "]:" << __p.port());
 		return (__os << __p.address() << ":" << __p.port());	
 	}
 	
+	/* defined in socket.hpp */
+	template <typename Protocol> struct basic_socket_acceptor;
+	template <typename Protocol> struct basic_stream_socket;
+	template <typename Protocol> struct basic_datagram_socket;
+	
 	struct [[nodiscard("tcp")]] tcp {
 		typedef basic_endpoint<tcp> endpoint;
-		/*
-		typedef basic_socket_iostream<tcp> iostream;
 		typedef basic_socket_acceptor<tcp> acceptor;
 		typedef basic_stream_socket<tcp> socket;
+		/*
+		typedef basic_socket_iostream<tcp> iostream;
 		*/
 		constexpr tcp() = delete;
 		[[nodiscard]] static constexpr tcp v4() noexcept { return tcp(ipv4_address); }
@@ -875,10 +1306,9 @@ namespace ip __attribute__((__visibility__("default"))) {
 	
 	struct [[nodiscard("upd")]] upd {
 		typedef basic_endpoint<upd> endpoint;
+		typedef basic_datagram_socket<upd> socket;
 		/*
 		typedef basic_socket_iostream<upd> iostream;
-		typedef basic_socket_acceptor<upd> acceptor;
-		typedef basic_datagram_socket<upd> socket;
 		*/
 		constexpr upd() = delete;
 		[[nodiscard]] static constexpr upd v4() noexcept { return upd(ipv4_address); }
@@ -904,32 +1334,35 @@ namespace ip __attribute__((__visibility__("default"))) {
 
 namespace std {
 	
+	/* keyed, see Utility/Hash.hpp: peers pick their addresses and ports, so they must not pick the buckets */
   	template<> struct hash<conet::net::ip::address_v4> {
       	std::size_t operator()(conet::net::ip::address_v4 const& address) const noexcept
-      	{ return std::hash<std::uint_least32_t>{}(address.to_uint()); }
+      	{ return Kelpa::Utility::HashWord(address.to_uint()); }
     };	
 	template<>  struct formatter<conet::net::ip::address_v4> {  
 	    constexpr auto parse(std::format_parse_context& context) const noexcept 
 		{  	return context.begin(); 								}  
 	
-		auto format(conet::net::ip::address_v4 const& t, std::format_context& context) const noexcept
-		{  	return std::format_to(context.out(), "{}", t.to_string());  	}  
+		auto format(conet::net::ip::address_v4 const& t, std::format_context& context) const noexcept {
+			char text[64];
+			return std::ranges::copy(text, conet::net::ip::to_chars(text, text + sizeof text, t).ptr, context.out()).out;
+		}
 	};
 	
   	template<> struct hash<conet::net::ip::address_v6> {
       	std::size_t operator()(conet::net::ip::address_v6 const& address) const noexcept {
-	  		std::size_t result = {};
-			std::ranges::for_each(address.M_bytes, [&result](auto&& value) { result |= std::hash<unsigned char>{}(value); });
-			result |= std::hash<conet::net::ip::scope_id_type>{}(address.M_scope_id);
-			return result;     
+	  		std::uint64_t const result = Kelpa::Utility::HashBytes(address.M_bytes.data(), address.M_bytes.size());
+			return address.M_scope_id ? Kelpa::Utility::HashCombine(result, address.M_scope_id) : result;
 		}
     };	
 	template<>  struct formatter<conet::net::ip::address_v6> {  
 	    constexpr auto parse(std::format_parse_context& context) const noexcept 
 		{  	return context.begin(); 								}  
 	
-		auto format(conet::net::ip::address_v6 const& t, std::format_context& context) const noexcept
-		{  	return std::format_to(context.out(), "{}", t.to_string());  	}  
+		auto format(conet::net::ip::address_v6 const& t, std::format_context& context) const noexcept {
+			char text[64];
+			return std::ranges::copy(text, conet::net::ip::to_chars(text, text + sizeof text, t).ptr, context.out()).out;
+		}
 	};	
   
   	template<> struct hash<conet::net::ip::address> {
@@ -942,22 +1375,62 @@ namespace std {
 	    constexpr auto parse(std::format_parse_context& context) const noexcept 
 		{  	return context.begin(); 								}  
 	
-		auto format(conet::net::ip::address const& t, std::format_context& context) const noexcept
-		{  	return std::format_to(context.out(), "{}", t.to_string());  	}  
+		auto format(conet::net::ip::address const& t, std::format_context& context) const noexcept {
+			char text[64];
+			return std::ranges::copy(text, conet::net::ip::to_chars(text, text + sizeof text, t).ptr, context.out()).out;
+		}
 	};	
 	
   	template<typename Protocol> struct hash<conet::net::ip::basic_endpoint<Protocol>> {
       	std::size_t operator()(conet::net::ip::basic_endpoint<Protocol> const& __endpoint) const noexcept {
-      		return std::hash<conet::net::ip::address>{}(__endpoint.address()) | std::hash<conet::net::ip::port_type>{}(__endpoint.port());
+			conet::net::ip::address const __address = __endpoint.address();
+			if(__address.is_v4())
+				return Kelpa::Utility::HashWord(std::uint64_t{__address.to_v4().to_uint()} << 16 | __endpoint.port());
+      		return Kelpa::Utility::HashCombine(std::hash<conet::net::ip::address>{}(__address), __endpoint.port());
 		}
     };	
 	template<typename Protocol>  struct formatter<conet::net::ip::basic_endpoint<Protocol>> {  
 	    constexpr auto parse(std::format_parse_context& context) const noexcept 
 		{  	return context.begin(); 								}  
 	
-		auto format(conet::net::ip::basic_endpoint<Protocol> const& t, std::format_context& context) const noexcept
-		{  	return std::format_to(context.out(), "{}", (std::stringstream{} << t).str());  	}  
-	};		      
+		auto format(conet::net::ip::basic_endpoint<Protocol> const& t, std::format_context& context) const noexcept {
+			char text[72];
+			char* end = text;
+			bool const v6 = t.address().is_v6();
+			if(v6) * end ++ = '[';
+			end = conet::net::ip::to_chars(end, text + 64, t.address()).ptr;
+			if(v6) * end ++ = ']';
+			* end ++ = ':';
+			end = std::to_chars(end, text + sizeof text, t.port()).ptr;
+			return std::ranges::copy(text, end, context.out()).out;
+		}
+	};	
+  	template<> struct hash<conet::net::ip::network_v4> {
+      	std::size_t operator()(conet::net::ip::network_v4 const& __network) const noexcept
+      	{ return Kelpa::Utility::HashWord(std::uint64_t{__network.address().to_uint()} << 8 | static_cast<std::uint64_t>(__network.prefix_length())); }
+    };
+	template<>  struct formatter<conet::net::ip::network_v4> {  
+	    constexpr auto parse(std::format_parse_context& context) const noexcept 
+		{  	return context.begin(); 								}  
+	
+		auto format(conet::net::ip::network_v4 const& t, std::format_context& context) const noexcept {
+			char text[64];
+			return std::ranges::copy(text, conet::net::ip::to_chars(text, text + sizeof text, t).ptr, context.out()).out;
+		}
+	};
+  	template<> struct hash<conet::net::ip::network_v6> {
+      	std::size_t operator()(conet::net::ip::network_v6 const& __network) const noexcept
+      	{ return Kelpa::Utility::HashCombine(std::hash<conet::net::ip::address_v6>{}(__network.address()), static_cast<std::uint64_t>(__network.prefix_length())); }
+    };
+	template<>  struct formatter<conet::net::ip::network_v6> {  
+	    constexpr auto parse(std::format_parse_context& context) const noexcept 
+		{  	return context.begin(); 								}  
+	
+		auto format(conet::net::ip::network_v6 const& t, std::format_context& context) const noexcept {
+			char text[72];
+			return std::ranges::copy(text, conet::net::ip::to_chars(text, text + sizeof text, t).ptr, context.out()).out;
+		}
+	};
 } // namespace std
 
 #ifdef bswap16
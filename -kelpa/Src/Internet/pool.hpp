@@ -0,0 +1,437 @@
+#ifndef __CONET_POOL_INCLUDED
+#define __CONET_POOL_INCLUDED
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./socket.hpp"
+#include "../Coroutine/Detached.hpp"
+
+/*
+	Outbound TCP connections, pooled per endpoint:
+
+		net::connection_pool pool { reactor, { .max_connections = 32 } };
+		...
+		net::pooled_connection connection = co_await pool.acquire(backend, ec);
+		if(ec) ...											// timed out, ejected or too many waiting
+		co_await connection.socket().async_write(request, ec);
+		...
+		if(ec)
+			connection.fail();								// closed and counted against the backend
+		// going out of scope hands the connection back, warm for the next acquire
+
+	acquire() takes the most recently returned idle connection; otherwise it
+	queues and, below max_connections, has a connection opened for the queue.
+	max_connections bounds what is in flight per endpoint, max_waiters bounds
+	the queue: past it acquire fails right away with resource_unavailable_try_again,
+	so callers shed load instead of buffering it. Connects and waits in the queue
+	time out on the reactor's timers, idle connections are closed after
+	idle_timeout, and an endpoint that fails eject_after times in a row is
+	ejected: acquires fail with host_unreachable until the ejection runs out,
+	after which one more failure ejects it again for twice as long.
+
+	A pool belongs to its reactor's thread, like the sockets it hands out
+*/
+
+namespace conet __attribute__((__visibility__("default"))) {
+namespace net __attribute__((__visibility__("default"))) {
+
+	struct pool_options {
+		/* connections per endpoint, idle, leased and being opened together */
+		std::size_t 					max_connections = 64;
+		/* acquires queued per endpoint beyond which acquire fails at once */
+		std::size_t 					max_waiters = 1024;
+		/* idle connections kept per endpoint */
+		std::size_t 					max_idle = 16;
+		std::chrono::milliseconds 		connect_timeout { 1000 };
+		/* how long an acquire may wait in the queue, zero for no limit */
+		std::chrono::milliseconds 		acquire_timeout { 1000 };
+		std::chrono::milliseconds 		idle_timeout { 30000 };
+		/* consecutive failures that eject an endpoint, zero never ejects */
+		unsigned 						eject_after = 5;
+		std::chrono::milliseconds 		eject_duration { 1000 };
+		std::chrono::milliseconds 		max_eject_duration { 60000 };
+		bool 							no_delay = true;
+	};
+
+	struct pool_stats {
+		std::size_t idle = 0;
+		std::size_t leased = 0;
+		std::size_t connecting = 0;
+		std::size_t waiting = 0;
+		bool 		ejected = false;
+	};
+
+	struct connection_pool;
+
+namespace detail {
+	typedef std::chrono::steady_clock pool_clock;
+
+	struct pool_waiter;
+
+	/* the state of one endpoint; leases and connects hold it, so it outlives the pool if need be */
+	struct pool_host {
+		struct idle_connection {
+			ip::tcp::socket 		M_socket;
+			pool_clock::time_point 	M_since;
+		};
+
+		pool_host(connection_pool* __pool, ip::tcp::endpoint const& __endpoint) noexcept: M_pool(__pool), M_endpoint(__endpoint) {}
+
+		[[nodiscard]] std::size_t open() const noexcept { return M_idle.size() + M_leased + M_connecting; }
+		[[nodiscard]] bool ejected(pool_clock::time_point __now) const noexcept { return __now < M_ejected_until; }
+
+		connection_pool* 				M_pool;
+		ip::tcp::endpoint 				M_endpoint;
+		/* the most recently returned connection is at the back */
+		std::deque<idle_connection> 	M_idle;
+		pool_waiter* 					M_head = nullptr;
+		pool_waiter* 					M_tail = nullptr;
+		std::size_t 					M_waiting = 0;
+		std::size_t 					M_leased = 0;
+		std::size_t 					M_connecting = 0;
+		/* sockets being connected, closed when the pool goes away */
+		std::vector<ip::tcp::socket *> 	M_dialing;
+		unsigned 						M_failures = 0;
+		unsigned 						M_ejections = 0;
+		pool_clock::time_point 			M_ejected_until {};
+	};
+
+	/* an acquire suspended in its endpoint's queue */
+	struct pool_waiter {
+		void complete(std::error_code const& __error) noexcept {
+			M_error = __error;
+			M_done = true;
+			if(M_coroutine)
+				std::exchange(M_coroutine, nullptr).resume();
+		}
+		std::coroutine_handle<> 			M_coroutine = {};
+		std::error_code 					M_error = {};
+		std::optional<ip::tcp::socket> 		M_socket;
+		Kelpa::Thread::TimerHandle 			M_timer {};
+		pool_waiter* 						M_previous = nullptr;
+		pool_waiter* 						M_next = nullptr;
+		bool 								M_done = false;
+	};
+
+	/* connects run eagerly and free themselves once they return */
+	typedef Kelpa::Coroutine::Detached detached;
+} // namespace conet::net::detail
+
+	/*
+		A connection leased from the pool. Dropping it (or release()) returns
+		it for reuse; after fail() it is closed and counted against its
+		endpoint's health, after discard() it is closed without blame, e.g.
+		when the server answered with Connection: close
+	*/
+	struct pooled_connection {
+		pooled_connection() noexcept = default;
+		pooled_connection(pooled_connection const&) = delete;
+		pooled_connection& operator=(pooled_connection const&) = delete;
+		pooled_connection(pooled_connection&& __other) noexcept
+		: M_host(std::move(__other.M_host)), M_socket(std::move(__other.M_socket)), M_failed(__other.M_failed), M_discarded(__other.M_discarded) {
+			__other.M_socket.reset();
+		}
+		pooled_connection& operator=(pooled_connection&& __other) noexcept {
+			if(this != std::addressof(__other)) {
+				release();
+				M_host = std::move(__other.M_host);
+				M_socket = std::move(__other.M_socket);
+				__other.M_socket.reset();
+				M_failed = __other.M_failed;
+				M_discarded = __other.M_discarded;
+			}
+			return *this;
+		}
+		~pooled_connection() noexcept { release(); }
+
+		[[nodiscard]] explicit operator bool() const noexcept { return M_socket.has_value(); }
+		[[nodiscard]] ip::tcp::socket& socket() noexcept { return * M_socket; }
+		[[nodiscard]] ip::tcp::endpoint const& endpoint() const noexcept { return M_host->M_endpoint; }
+
+		void fail() noexcept { M_failed = true; }
+		void discard() noexcept { M_discarded = true; }
+		/* hands the connection back now */
+		inline void release() noexcept;
+
+	private:
+		friend struct connection_pool;
+		pooled_connection(std::shared_ptr<detail::pool_host> __host, ip::tcp::socket __socket) noexcept
+		: M_host(std::move(__host)), M_socket(std::move(__socket)) {}
+
+		std::shared_ptr<detail::pool_host> 	M_host;
+		std::optional<ip::tcp::socket> 		M_socket;
+		bool 								M_failed = false;
+		bool 								M_discarded = false;
+	};
+
+	struct connection_pool {
+		explicit connection_pool(reactor_type& __reactor, pool_options const& __options = {})
+		: M_reactor(std::addressof(__reactor)), M_options(__options) {
+			auto const __period = std::max(M_options.idle_timeout / 4, std::chrono::milliseconds { 10 });
+			M_sweeper = M_reactor->Schedule(__period, __period, -1, [this] { sweep(); });
+		}
+		connection_pool(connection_pool const&) = delete;
+		connection_pool& operator=(connection_pool const&) = delete;
+		/* fails what is queued with operation_canceled and closes idle and connecting sockets; leases stay valid */
+		~connection_pool() noexcept {
+			(void) M_reactor->Cancel(M_sweeper);
+			for(auto& [__endpoint, __host]: std::exchange(M_hosts, {})) {
+				__host->M_pool = nullptr;
+				__host->M_idle.clear();
+				for(ip::tcp::socket* __socket: std::exchange(__host->M_dialing, {}))
+					__socket->close();
+				fail_waiters(* __host, std::make_error_code(std::errc::operation_canceled));
+			}
+		}
+
+		struct [[nodiscard("acquire_awaitable")]] acquire_awaitable: detail::pool_waiter {
+			acquire_awaitable(connection_pool& __pool, ip::tcp::endpoint const& __endpoint, std::error_code* __report) noexcept
+			: M_pool(std::addressof(__pool)), M_endpoint(__endpoint), M_report(__report) {}
+
+			bool await_ready() {
+				M_host = M_pool->host(M_endpoint);
+				return M_pool->try_acquire(* this);
+			}
+			bool await_suspend(std::coroutine_handle<> __coroutine) noexcept {
+				M_pool->enqueue(* this);
+				if(M_done)
+					return false;
+				M_coroutine = __coroutine;
+				return true;
+			}
+			pooled_connection await_resume() {
+				if(M_report)
+					* M_report = M_error;
+				else
+					ip::detail::throw_if(M_error, "acquire");
+				if(M_error or not M_socket)
+					return {};
+				return pooled_connection(std::move(M_host), std::move(* M_socket));
+			}
+
+		private:
+			friend struct connection_pool;
+			connection_pool* 					M_pool;
+			ip::tcp::endpoint 					M_endpoint;
+			std::error_code* 					M_report;
+			std::shared_ptr<detail::pool_host> 	M_host;
+		};
+
+		/* yields a connection to __endpoint, see above for when it fails */
+		[[nodiscard]] acquire_awaitable acquire(ip::tcp::endpoint const& __endpoint) noexcept { return {* this, __endpoint, nullptr}; }
+		[[nodiscard]] acquire_awaitable acquire(ip::tcp::endpoint const& __endpoint, std::error_code& __ec) noexcept { return {* this, __endpoint, std::addressof(__ec)}; }
+
+		[[nodiscard]] pool_stats stats(ip::tcp::endpoint const& __endpoint) const noexcept {
+			auto const __found = M_hosts.find(__endpoint);
+			if(__found == M_hosts.end())
+				return {};
+			detail::pool_host const& __host = * __found->second;
+			return {__host.M_idle.size(), __host.M_leased, __host.M_connecting, __host.M_waiting, __host.ejected(detail::pool_clock::now())};
+		}
+		[[nodiscard]] reactor_type& context() const noexcept { return * M_reactor; }
+		[[nodiscard]] pool_options const& options() const noexcept { return M_options; }
+
+	private:
+		friend struct pooled_connection;
+		typedef detail::pool_host host_type;
+		typedef std::shared_ptr<host_type> host_pointer;
+
+		host_pointer const& host(ip::tcp::endpoint const& __endpoint) {
+			host_pointer& __host = M_hosts[__endpoint];
+			if(not __host)
+				__host = std::make_shared<host_type>(this, __endpoint);
+			return __host;
+		}
+
+		/* an idle connection still usable has neither pending bytes nor a shut-down peer */
+		static bool usable(ip::tcp::socket const& __socket) noexcept {
+			char __byte;
+			ssize_t const __result = ::recv(__socket.native_handle(), std::addressof(__byte), 1, MSG_PEEK | MSG_DONTWAIT);
+			return __result < 0 and (errno == EAGAIN or errno == EWOULDBLOCK);
+		}
+
+		bool try_acquire(acquire_awaitable& __waiter) {
+			host_type& __host = * __waiter.M_host;
+			if(__host.ejected(detail::pool_clock::now())) {
+				__waiter.M_error = std::make_error_code(std::errc::host_unreachable);
+				return true;
+			}
+			while(not __host.M_idle.empty()) {
+				ip::tcp::socket __socket = std::move(__host.M_idle.back().M_socket);
+				__host.M_idle.pop_back();
+				if(not usable(__socket))
+					continue;
+				__host.M_leased ++;
+				__waiter.M_socket.emplace(std::move(__socket));
+				return true;
+			}
+			if(__host.M_waiting >= M_options.max_waiters) {
+				__waiter.M_error = std::make_error_code(std::errc::resource_unavailable_try_again);
+				return true;
+			}
+			return false;
+		}
+
+		void enqueue(acquire_awaitable& __waiter) noexcept {
+			host_type& __host = * __waiter.M_host;
+			__waiter.M_previous = __host.M_tail;
+			(__host.M_tail ? __host.M_tail->M_next : __host.M_head) = std::addressof(__waiter);
+			__host.M_tail = std::addressof(__waiter);
+			__host.M_waiting ++;
+			if(M_options.acquire_timeout.count() > 0)
+				__waiter.M_timer = M_reactor->Schedule(M_options.acquire_timeout, [this, __waiter = std::addressof(__waiter)] {
+					__waiter->M_timer = {};
+					unlink(* static_cast<acquire_awaitable *>(__waiter)->M_host, * __waiter);
+					__waiter->complete(std::make_error_code(std::errc::timed_out));
+				});
+			dial(__waiter.M_host);
+		}
+		static void unlink(host_type& __host, detail::pool_waiter& __waiter) noexcept {
+			(__waiter.M_previous ? __waiter.M_previous->M_next : __host.M_head) = __waiter.M_next;
+			(__waiter.M_next ? __waiter.M_next->M_previous : __host.M_tail) = __waiter.M_previous;
+			__waiter.M_previous = __waiter.M_next = nullptr;
+			__host.M_waiting --;
+		}
+		/* takes the oldest waiter off the queue, with its timer disarmed */
+		detail::pool_waiter* pop(host_type& __host) noexcept {
+			detail::pool_waiter* const __waiter = __host.M_head;
+			if(__waiter) {
+				unlink(__host, * __waiter);
+				if(__waiter->M_timer)
+					(void) M_reactor->Cancel(std::exchange(__waiter->M_timer, {}));
+			}
+			return __waiter;
+		}
+		void fail_waiters(host_type& __host, std::error_code const& __error) noexcept {
+			while(detail::pool_waiter* const __waiter = pop(__host))
+				__waiter->complete(__error);
+		}
+
+		/* opens connections for the waiters no connect is under way for yet */
+		void dial(host_pointer const& __host) {
+			while(__host->M_waiting > __host->M_connecting and __host->open() < M_options.max_connections and not __host->ejected(detail::pool_clock::now())) {
+				__host->M_connecting ++;
+				(void) connect(__host, * M_reactor, M_options.connect_timeout, M_options.no_delay);
+			}
+		}
+		static detail::detached connect(host_pointer __host, reactor_type& __reactor, std::chrono::milliseconds __timeout, bool __no_delay) {
+			ip::tcp::socket __socket { __reactor };
+			bool __expired = false;
+			__host->M_dialing.push_back(std::addressof(__socket));
+			Kelpa::Thread::TimerHandle const __timer = __reactor.Schedule(__timeout, [&__socket, &__expired] {
+				__expired = true;
+				__socket.cancel();
+			});
+			std::error_code __ec;
+			co_await __socket.async_connect(__host->M_endpoint, __ec);
+			if(not __expired)
+				(void) __reactor.Cancel(__timer);
+			std::erase(__host->M_dialing, std::addressof(__socket));
+			if(not __host->M_pool)
+				co_return;
+			__host->M_connecting --;
+			if(__expired and __ec)
+				__ec = std::make_error_code(std::errc::timed_out);
+			if(not __ec and __no_delay)
+				__socket.set_option(IPPROTO_TCP, TCP_NODELAY, 1, __ec);
+			if(__ec) {
+				/* the waiter this connect was for learns why, even when the failure ejects the endpoint */
+				detail::pool_waiter* const __waiter = __host->M_pool->pop(* __host);
+				__host->M_pool->failed(__host);
+				if(__waiter)
+					__waiter->complete(__ec);
+				/* the waiter may have let go of the pool */
+				if(__host->M_pool)
+					__host->M_pool->dial(__host);
+				co_return;
+			}
+			__host->M_failures = 0;
+			__host->M_ejections = 0;
+			__host->M_pool->give(* __host, std::move(__socket));
+		}
+
+		/* the socket goes to the oldest waiter, or else to the idle stack */
+		void give(host_type& __host, ip::tcp::socket __socket) {
+			if(detail::pool_waiter* const __waiter = pop(__host)) {
+				__host.M_leased ++;
+				__waiter->M_socket.emplace(std::move(__socket));
+				return __waiter->complete({});
+			}
+			__host.M_idle.push_back({std::move(__socket), detail::pool_clock::now()});
+			if(__host.M_idle.size() > M_options.max_idle)
+				__host.M_idle.pop_front();
+		}
+
+		/* counts a failure against the endpoint, ejecting it once they add up */
+		void failed(host_pointer const& __host) noexcept {
+			if(not M_options.eject_after or ++ __host->M_failures < M_options.eject_after)
+				return;
+			auto const __now = detail::pool_clock::now();
+			if(__host->ejected(__now))
+				return;
+			unsigned const __shift = std::min(__host->M_ejections ++, 16u);
+			__host->M_ejected_until = __now + std::min<std::chrono::milliseconds>(M_options.eject_duration * (1ll << __shift), M_options.max_eject_duration);
+			/* once the ejection runs out, the next failure ejects again */
+			__host->M_failures = M_options.eject_after - 1;
+			__host->M_idle.clear();
+			fail_waiters(* __host, std::make_error_code(std::errc::host_unreachable));
+		}
+
+		void release(host_pointer const& __host, ip::tcp::socket __socket, bool __failed, bool __discarded) {
+			__host->M_leased --;
+			if(__failed)
+				failed(__host);
+			else
+				__host->M_failures = 0;
+			if(__failed or __discarded or not __socket.is_open())
+				return dial(__host);
+			give(* __host, std::move(__socket));
+		}
+
+		void sweep() noexcept {
+			auto const __deadline = detail::pool_clock::now() - M_options.idle_timeout;
+			for(auto __entry = M_hosts.begin(); __entry != M_hosts.end(); ) {
+				host_type& __host = * __entry->second;
+				while(not __host.M_idle.empty() and __host.M_idle.front().M_since <= __deadline)
+					__host.M_idle.pop_front();
+				/* forgets endpoints nothing refers to anymore */
+				if(__entry->second.use_count() == 1 and not __host.open() and not __host.M_waiting and not __host.ejected(detail::pool_clock::now()))
+					__entry = M_hosts.erase(__entry);
+				else
+					++ __entry;
+			}
+		}
+
+		reactor_type* 										M_reactor;
+		pool_options 										M_options;
+		std::unordered_map<ip::tcp::endpoint, host_pointer> M_hosts;
+		Kelpa::Thread::TimerHandle 							M_sweeper {};
+	};
+
+	inline void pooled_connection::release() noexcept {
+		if(not M_socket)
+			return;
+		ip::tcp::socket __socket = std::move(* M_socket);
+		M_socket.reset();
+		std::shared_ptr<detail::pool_host> const __host = std::move(M_host);
+		if(__host->M_pool)
+			__host->M_pool->release(__host, std::move(__socket), M_failed, M_discarded);
+		M_failed = M_discarded = false;
+	}
+
+} // namespace conet::net
+} // namespace conet
+
+#endif // #if defined(__linux__)
+
+#endif // #ifndef __CONET_POOL_INCLUDED
@@ -0,0 +1,509 @@
+#ifndef __CONET_PREFIX_INCLUDED
+#define __CONET_PREFIX_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./internet.hpp"
+
+/*
+	Longest-prefix match over sets of networks, for ACLs and routes:
+
+		ip::prefix_table<action> acl;
+		acl.insert(ip::make_network_v4("10.0.0.0/8", ec), action::allow);
+		acl.insert(ip::make_network_v4("10.6.0.0/16", ec), action::deny);
+		...
+		if(action const* found = acl.lookup(peer.address()); found and * found == action::deny)
+			...													// the most specific network wins
+
+	prefix_table_v4 is a DIR-24-8 style table with strides of 16, 8 and 8 bits:
+	a lookup is one load from a 65536 entry root and at most two more from
+	256 entry chunks, whatever the number of prefixes. The root costs 256 KiB,
+	each chunk 1 KiB, and chunks are only made below prefixes longer than 16.
+	prefix_table_v6 is a path-compressed binary trie, one node per prefix plus
+	one per branching point, under a 65536 entry index of the first 16 bits
+	(512 KiB) that skips the top of the trie: a lookup visits at most as many
+	nodes as there are prefixes longer than 16 along the path to its address.
+
+	Building from a range inserts the shortest prefixes first, which keeps
+	every slot written about once; insert() and erase() may come in any order
+	after that. erase() leaves behind the v4 chunks it emptied; assign() the
+	whole set again after heavy churn to drop them. Lookups are const and may run on several
+	threads as long as nothing modifies the table meanwhile
+*/
+
+namespace conet __attribute__((__visibility__("default"))) {
+namespace net __attribute__((__visibility__("default"))) {
+namespace ip __attribute__((__visibility__("default"))) {
+namespace detail {
+	/* values by slot, slots of erased values are reused */
+	template <typename T> struct prefix_values {
+		std::uint32_t emplace(T&& __value) {
+			if(not M_free.empty()) {
+				std::uint32_t const __slot = M_free.back();
+				M_free.pop_back();
+				M_values[__slot - 1].emplace(std::move(__value));
+				return __slot;
+			}
+			M_values.emplace_back(std::in_place, std::move(__value));
+			return static_cast<std::uint32_t>(M_values.size());
+		}
+		void erase(std::uint32_t __slot) {
+			M_values[__slot - 1].reset();
+			M_free.push_back(__slot);
+		}
+		T& operator[](std::uint32_t __slot) noexcept { return * M_values[__slot - 1]; }
+		T const& operator[](std::uint32_t __slot) const noexcept { return * M_values[__slot - 1]; }
+		std::size_t size() const noexcept { return M_values.size() - M_free.size(); }
+		std::size_t capacity() const noexcept { return M_values.size(); }
+		void clear() noexcept {
+			M_values.clear();
+			M_free.clear();
+		}
+		std::size_t memory_usage() const noexcept {
+			return M_values.capacity() * sizeof(std::optional<T>) + M_free.capacity() * sizeof(std::uint32_t);
+		}
+
+	private:
+		std::vector<std::optional<T>> 	M_values;
+		std::vector<std::uint32_t> 		M_free;
+	};
+
+	/* the rules of a range, shortest prefix first, later duplicates winning */
+	template <typename Network, typename T, typename R>
+	std::vector<std::pair<Network, T>> sorted_rules(R&& __rules) {
+		std::vector<std::pair<Network, T>> __sorted;
+		for(auto&& [__network, __value]: __rules)
+			__sorted.emplace_back(__network, __value);
+		std::ranges::stable_sort(__sorted, {}, [](auto const& __rule) { return __rule.first.prefix_length(); });
+		return __sorted;
+	}
+} // namespace conet::net::ip::detail
+
+	template <typename T> struct prefix_table_v4 {
+		typedef T 			value_type;
+		typedef network_v4 	key_type;
+
+		prefix_table_v4(): M_root(std::size_t{1} << 16, 0) {}
+		/* a range of (network_v4, T) pairs */
+		template <std::ranges::input_range R> explicit prefix_table_v4(R&& __rules): prefix_table_v4() {
+			assign(std::forward<R>(__rules));
+		}
+
+		template <std::ranges::input_range R> void assign(R&& __rules) {
+			auto __sorted = detail::sorted_rules<network_v4, T>(std::forward<R>(__rules));
+			clear();
+			for(auto& [__network, __value]: __sorted)
+				insert(__network, std::move(__value));
+		}
+		/* true when the network is new, otherwise its value is replaced */
+		bool insert(network_v4 const& __network, T __value) {
+			std::uint32_t const __prefix = __network.network().to_uint();
+			int const __length = __network.prefix_length();
+			if(auto const __found = M_rules.find(key(__prefix, __length)); __found != M_rules.end()) {
+				M_values[__found->second] = std::move(__value);
+				return false;
+			}
+			if(M_values.size() == slot_mask)
+				throw std::length_error("prefix_table_v4: too many prefixes");
+			std::uint32_t const __slot = M_values.emplace(std::move(__value));
+			M_rules.emplace(key(__prefix, __length), __slot);
+			std::uint32_t const __entry = leaf(__slot, __length);
+			paint(__prefix, __length, [__entry, __length](std::uint32_t& __e) {
+				if(0 == __e or (__e >> length_shift) <= static_cast<std::uint32_t>(__length))
+					__e = __entry;
+			});
+			return true;
+		}
+		/* the addresses it covered fall back to the longest network left around them */
+		bool erase(network_v4 const& __network) {
+			std::uint32_t const __prefix = __network.network().to_uint();
+			int const __length = __network.prefix_length();
+			auto const __found = M_rules.find(key(__prefix, __length));
+			if(__found == M_rules.end())
+				return false;
+			std::uint32_t const __slot = __found->second;
+			M_rules.erase(__found);
+			std::uint32_t __parent = 0;
+			for(int __shorter = __length - 1; __shorter >= 0 and 0 == __parent; __shorter --)
+				if(auto const __p = M_rules.find(key(__prefix & conet::detail::mask_v4(__shorter), __shorter)); __p != M_rules.end())
+					__parent = leaf(__p->second, __shorter);
+			paint(__prefix, __length, [__slot, __parent](std::uint32_t& __e) {
+				if((__e & slot_mask) == __slot)
+					__e = __parent;
+			});
+			M_values.erase(__slot);
+			return true;
+		}
+		void clear() {
+			std::ranges::fill(M_root, 0);
+			M_chunks.clear();
+			M_rules.clear();
+			M_values.clear();
+		}
+
+		/* the value of the longest network containing __address, null if none does */
+		[[nodiscard]] T const* lookup(address_v4 const& __address) const noexcept {
+			std::uint32_t const __a = __address.to_uint();
+			std::uint32_t __e = M_root[__a >> 16];
+			if(__e & chunk_flag) {
+				__e = M_chunks[(__e & ~chunk_flag) << 8 | (__a >> 8 & 0xff)];
+				if(__e & chunk_flag)
+					__e = M_chunks[(__e & ~chunk_flag) << 8 | (__a & 0xff)];
+			}
+			return (__e & slot_mask) ? std::addressof(M_values[__e & slot_mask]) : nullptr;
+		}
+		/* the value of exactly this network */
+		[[nodiscard]] T const* find(network_v4 const& __network) const noexcept {
+			auto const __found = M_rules.find(key(__network.network().to_uint(), __network.prefix_length()));
+			return __found == M_rules.end() ? nullptr : std::addressof(M_values[__found->second]);
+		}
+		[[nodiscard]] bool contains(address_v4 const& __address) const noexcept { return nullptr != lookup(__address); }
+		[[nodiscard]] std::size_t size() const noexcept { return M_rules.size(); }
+		[[nodiscard]] bool empty() const noexcept { return M_rules.empty(); }
+		/* bytes held by the table, its rules and values */
+		[[nodiscard]] std::size_t memory_usage() const noexcept {
+			return (M_root.capacity() + M_chunks.capacity()) * sizeof(std::uint32_t)
+				+ M_rules.size() * (sizeof(typename decltype(M_rules)::value_type) + 2 * sizeof(void*))
+				+ M_values.memory_usage();
+		}
+
+	private:
+		/*
+			An entry is a chunk number with chunk_flag set, or else a leaf: the
+			value slot (zero for no match) under the length of the prefix that
+			wrote it, so that shorter prefixes never overwrite longer ones
+		*/
+		static constexpr std::uint32_t chunk_flag 	= std::uint32_t{1} << 31;
+		static constexpr int 		   length_shift = 24;
+		static constexpr std::uint32_t slot_mask 	= (std::uint32_t{1} << length_shift) - 1;
+
+		static constexpr std::uint64_t key(std::uint32_t __prefix, int __length) noexcept {
+			return std::uint64_t{__prefix} << 8 | static_cast<std::uint64_t>(__length);
+		}
+		static constexpr std::uint32_t leaf(std::uint32_t __slot, int __length) noexcept {
+			return static_cast<std::uint32_t>(__length) << length_shift | __slot;
+		}
+		/*
+			the chunk below __table[__index], made from the leaf it replaces;
+			taken by index since __table may be M_chunks, which the resize moves
+		*/
+		std::uint32_t expand(std::vector<std::uint32_t>& __table, std::size_t __index) {
+			std::uint32_t const __leaf = __table[__index];
+			if(__leaf & chunk_flag)
+				return __leaf & ~chunk_flag;
+			std::uint32_t const __chunk = static_cast<std::uint32_t>(M_chunks.size() >> 8);
+			M_chunks.resize(M_chunks.size() + 256, __leaf);
+			__table[__index] = __chunk | chunk_flag;
+			return __chunk;
+		}
+		/* applies f to every leaf under the prefix, descending into the chunks below it */
+		template <typename F> void paint(std::uint32_t __prefix, int __length, F&& __f) {
+			std::uint32_t* __first = nullptr;
+			std::size_t __count = 0;
+			if(__length <= 16) {
+				__first = M_root.data() + (__prefix >> 16);
+				__count = std::size_t{1} << (16 - __length);
+			}
+			else {
+				std::uint32_t __chunk = expand(M_root, __prefix >> 16);
+				if(__length <= 24) {
+					__first = M_chunks.data() + (std::size_t{__chunk} << 8 | (__prefix >> 8 & 0xff));
+					__count = std::size_t{1} << (24 - __length);
+				}
+				else {
+					__chunk = expand(M_chunks, std::size_t{__chunk} << 8 | (__prefix >> 8 & 0xff));
+					__first = M_chunks.data() + (std::size_t{__chunk} << 8 | (__prefix & 0xff));
+					__count = std::size_t{1} << (32 - __length);
+				}
+			}
+			visit(__first, __count, __f);
+		}
+		template <typename F> void visit(std::uint32_t* __first, std::size_t __count, F& __f) {
+			for(std::uint32_t* __e = __first; __e != __first + __count; __e ++) {
+				if(* __e & chunk_flag)
+					visit(M_chunks.data() + (std::size_t{* __e & ~chunk_flag} << 8), 256, __f);
+				else
+					__f(* __e);
+			}
+		}
+
+		std::vector<std::uint32_t> 						M_root;
+		std::vector<std::uint32_t> 						M_chunks;
+		std::unordered_map<std::uint64_t, std::uint32_t> M_rules;
+		detail::prefix_values<T> 						M_values;
+	};
+
+	template <typename T> struct prefix_table_v6 {
+		typedef T 			value_type;
+		typedef network_v6 	key_type;
+
+		prefix_table_v6(): M_nodes(1), M_parents(1), M_index(std::size_t{1} << 16, bucket{none, 0}) {}
+		/* a range of (network_v6, T) pairs */
+		template <std::ranges::input_range R> explicit prefix_table_v6(R&& __rules): prefix_table_v6() {
+			assign(std::forward<R>(__rules));
+		}
+
+		template <std::ranges::input_range R> void assign(R&& __rules) {
+			auto __sorted = detail::sorted_rules<network_v6, T>(std::forward<R>(__rules));
+			clear();
+			M_nodes.reserve(2 * __sorted.size() + 1);
+			M_parents.reserve(2 * __sorted.size() + 1);
+			for(auto& [__network, __value]: __sorted)
+				insert(__network, std::move(__value));
+		}
+		/* true when the network is new, otherwise its value is replaced */
+		bool insert(network_v6 const& __network, T __value) {
+			uint128_type const __key = bits(__network.network());
+			int const __length = __network.prefix_length();
+			std::uint32_t __at = 0;
+			for(;;) {
+				if(M_nodes[__at].length == __length) {
+					if(M_nodes[__at].slot) {
+						M_values[M_nodes[__at].slot] = std::move(__value);
+						return false;
+					}
+					M_nodes[__at].slot = M_values.emplace(std::move(__value));
+					M_size ++;
+					reindex(__key, __length);
+					return true;
+				}
+				int const __side = bit(__key, M_nodes[__at].length);
+				std::uint32_t const __child = M_nodes[__at].child[__side];
+				if(0 == __child) {
+					link(__at, __side, make(__key, __length, M_values.emplace(std::move(__value))));
+					M_size ++;
+					reindex(__key, __length);
+					return true;
+				}
+				int const __common = std::min({__length, static_cast<int>(M_nodes[__child].length), common(__key, M_nodes[__child].key())});
+				if(__common == M_nodes[__child].length) {
+					__at = __child;
+					continue;
+				}
+				/* the new network sits above the child, or both hang off a new branching node */
+				std::uint32_t const __slot = M_values.emplace(std::move(__value));
+				std::uint32_t const __above = __common == __length ? make(__key, __length, __slot) : make(__key & conet::detail::mask_v6(__common), __common, 0);
+				link(__above, bit(M_nodes[__child].key(), __common), __child);
+				if(__common != __length)
+					link(__above, bit(__key, __common), make(__key, __length, __slot));
+				link(__at, __side, __above);
+				M_size ++;
+				reindex(__key, __common);
+				return true;
+			}
+		}
+		bool erase(network_v6 const& __network) {
+			std::uint32_t __at = locate(__network);
+			if(none == __at or 0 == M_nodes[__at].slot)
+				return false;
+			M_values.erase(M_nodes[__at].slot);
+			M_nodes[__at].slot = 0;
+			M_size --;
+			int __top = __network.prefix_length();
+			/* drop the nodes that no longer hold a value nor branch */
+			while(0 != __at and 0 == M_nodes[__at].slot and not (M_nodes[__at].child[0] and M_nodes[__at].child[1])) {
+				std::uint32_t const __parent = M_parents[__at];
+				std::uint32_t const __only = M_nodes[__at].child[0] | M_nodes[__at].child[1];
+				link(__parent, bit(M_nodes[__at].key(), M_nodes[__parent].length), __only);
+				__top = M_nodes[__at].length;
+				M_nodes[__at] = node{};
+				M_free.push_back(__at);
+				__at = __parent;
+			}
+			reindex(bits(__network.network()), __top);
+			return true;
+		}
+		void clear() {
+			M_nodes.assign(1, node{});
+			M_parents.assign(1, 0);
+			std::ranges::fill(M_index, bucket{none, 0});
+			M_free.clear();
+			M_values.clear();
+			M_size = 0;
+		}
+
+		/* as prefix_table_v4; the scope of the address is not looked at */
+		[[nodiscard]] T const* lookup(address_v6 const& __address) const noexcept {
+			uint128_type const __a = bits(__address);
+			bucket const __b = M_index[static_cast<std::size_t>(__a >> 112)];
+			std::uint32_t __best = __b.slot;
+			for(std::uint32_t __at = __b.node; none != __at;) {
+				node const& __n = M_nodes[__at];
+				if((__a ^ __n.key()) & conet::detail::mask_v6(__n.length))
+					break;
+				if(__n.slot)
+					__best = __n.slot;
+				if(128 == __n.length or 0 == (__at = __n.child[bit(__a, __n.length)]))
+					break;
+			}
+			return __best ? std::addressof(M_values[__best]) : nullptr;
+		}
+		[[nodiscard]] T const* find(network_v6 const& __network) const noexcept {
+			std::uint32_t const __at = locate(__network);
+			return none == __at or 0 == M_nodes[__at].slot ? nullptr : std::addressof(M_values[M_nodes[__at].slot]);
+		}
+		[[nodiscard]] bool contains(address_v6 const& __address) const noexcept { return nullptr != lookup(__address); }
+		[[nodiscard]] std::size_t size() const noexcept { return M_size; }
+		[[nodiscard]] bool empty() const noexcept { return 0 == M_size; }
+		[[nodiscard]] std::size_t memory_usage() const noexcept {
+			return M_nodes.capacity() * sizeof(node) + M_parents.capacity() * sizeof(std::uint32_t) + M_index.capacity() * sizeof(bucket)
+				+ M_free.capacity() * sizeof(std::uint32_t) + M_values.memory_usage();
+		}
+
+	private:
+		typedef conet::detail::uint128_type uint128_type;
+
+		static constexpr std::uint32_t none = ~std::uint32_t{};
+
+		/* the root is node 0, a ::/0 that holds a value only once one is inserted */
+		struct node {
+			/* two halves rather than one uint128_type, which would pad the node to 48 bytes */
+			std::uint64_t 	high = 0;
+			std::uint64_t 	low = 0;
+			std::uint32_t 	child[2] = {0, 0};
+			std::uint32_t 	slot = 0;
+			std::uint8_t 	length = 0;
+			
+			constexpr uint128_type key() const noexcept { return uint128_type{high} << 64 | low; }
+		};
+		/*
+			Where lookups of addresses with the same first 16 bits start: the
+			value of the longest prefix of at most 16 bits above them, and the
+			first node on their path that is longer, none if there is none
+		*/
+		struct bucket {
+			std::uint32_t 	node;
+			std::uint32_t 	slot;
+		};
+
+		static constexpr uint128_type bits(address_v6 const& __address) noexcept {
+			auto const __bytes = __address.to_bytes();
+			return conet::detail::load_v6(__bytes.data());
+		}
+		static constexpr int bit(uint128_type __key, int __index) noexcept {
+			return static_cast<int>(__key >> (127 - __index) & 1);
+		}
+		/* the number of leading bits __a and __b share */
+		static constexpr int common(uint128_type __a, uint128_type __b) noexcept {
+			uint128_type const __x = __a ^ __b;
+			std::uint64_t const __high = static_cast<std::uint64_t>(__x >> 64);
+			return __high ? std::countl_zero(__high) : 64 + std::countl_zero(static_cast<std::uint64_t>(__x));
+		}
+		std::uint32_t make(uint128_type __key, int __length, std::uint32_t __slot) {
+			node __n;
+			__n.high = static_cast<std::uint64_t>(__key >> 64);
+			__n.low = static_cast<std::uint64_t>(__key);
+			__n.length = static_cast<std::uint8_t>(__length);
+			__n.slot = __slot;
+			if(M_free.empty()) {
+				M_nodes.push_back(__n);
+				M_parents.push_back(0);
+				return static_cast<std::uint32_t>(M_nodes.size() - 1);
+			}
+			std::uint32_t const __at = M_free.back();
+			M_free.pop_back();
+			M_nodes[__at] = __n;
+			return __at;
+		}
+		void link(std::uint32_t __parent, int __side, std::uint32_t __child) noexcept {
+			M_nodes[__parent].child[__side] = __child;
+			if(__child)
+				M_parents[__child] = __parent;
+		}
+		/* refreshes the buckets under the first __length bits of __key, where nodes changed */
+		void reindex(uint128_type __key, int __length) noexcept {
+			std::size_t const __first = static_cast<std::size_t>((__key & conet::detail::mask_v6(__length)) >> 112);
+			std::size_t const __count = std::size_t{1} << (16 - std::min(__length, 16));
+			for(std::size_t __index = __first; __index != __first + __count; __index ++) {
+				uint128_type const __a = uint128_type{__index} << 112;
+				bucket __b { none, 0 };
+				for(std::uint32_t __at = 0;;) {
+					node const& __n = M_nodes[__at];
+					if((__a ^ __n.key()) & conet::detail::mask_v6(std::min<int>(__n.length, 16)))
+						break;
+					if(__n.length >= 16) {
+						__b.node = __at;
+						break;
+					}
+					if(__n.slot)
+						__b.slot = __n.slot;
+					if(0 == (__at = __n.child[bit(__a, __n.length)]))
+						break;
+				}
+				M_index[__index] = __b;
+			}
+		}
+		/* the node of exactly this network, with or without a value */
+		std::uint32_t locate(network_v6 const& __network) const noexcept {
+			uint128_type const __key = bits(__network.network());
+			int const __length = __network.prefix_length();
+			std::uint32_t __at = 0;
+			while(M_nodes[__at].length < __length) {
+				__at = M_nodes[__at].child[bit(__key, M_nodes[__at].length)];
+				if(0 == __at or M_nodes[__at].length > __length or ((__key ^ M_nodes[__at].key()) & conet::detail::mask_v6(M_nodes[__at].length)))
+					return none;
+			}
+			return __at;
+		}
+
+		std::vector<node> 			M_nodes;
+		/* only erase() walks up, so the links to parents are kept out of the way of lookups */
+		std::vector<std::uint32_t> 	M_parents;
+		std::vector<bucket> 		M_index;
+		std::vector<std::uint32_t> 	M_free;
+		detail::prefix_values<T> 	M_values;
+		std::size_t 				M_size = 0;
+	};
+
+	/*
+		Both families behind one lookup. IPv4-mapped IPv6 addresses, as dual
+		stack sockets report IPv4 peers, are looked up among the IPv4 networks
+	*/
+	template <typename T> struct prefix_table {
+		typedef T value_type;
+
+		bool insert(network_v4 const& __network, T __value) { return M_v4.insert(__network, std::move(__value)); }
+		bool insert(network_v6 const& __network, T __value) { return M_v6.insert(__network, std::move(__value)); }
+		bool erase(network_v4 const& __network) { return M_v4.erase(__network); }
+		bool erase(network_v6 const& __network) { return M_v6.erase(__network); }
+		void clear() {
+			M_v4.clear();
+			M_v6.clear();
+		}
+
+		[[nodiscard]] T const* lookup(address_v4 const& __address) const noexcept { return M_v4.lookup(__address); }
+		[[nodiscard]] T const* lookup(address_v6 const& __address) const noexcept {
+			if(__address.is_v4_mapped())
+				return M_v4.lookup(make_address_v4(v4_mapped, __address));
+			return M_v6.lookup(__address);
+		}
+		[[nodiscard]] T const* lookup(address const& __address) const noexcept {
+			return __address.is_v4() ? lookup(__address.to_v4()) : lookup(__address.to_v6());
+		}
+		[[nodiscard]] bool contains(address const& __address) const noexcept { return nullptr != lookup(__address); }
+		[[nodiscard]] std::size_t size() const noexcept { return M_v4.size() + M_v6.size(); }
+		[[nodiscard]] bool empty() const noexcept { return M_v4.empty() and M_v6.empty(); }
+		[[nodiscard]] std::size_t memory_usage() const noexcept { return M_v4.memory_usage() + M_v6.memory_usage(); }
+
+		/* for bulk assign() per family */
+		[[nodiscard]] prefix_table_v4<T>& v4() noexcept { return M_v4; }
+		[[nodiscard]] prefix_table_v4<T> const& v4() const noexcept { return M_v4; }
+		[[nodiscard]] prefix_table_v6<T>& v6() noexcept { return M_v6; }
+		[[nodiscard]] prefix_table_v6<T> const& v6() const noexcept { return M_v6; }
+
+	private:
+		prefix_table_v4<T> 	M_v4;
+		prefix_table_v6<T> 	M_v6;
+	};
+
+} // namespace conet::net::ip
+} // namespace conet::net
+} // namespace conet
+
+#endif // #ifndef __CONET_PREFIX_INCLUDED
@@ -0,0 +1,825 @@
+#ifndef __CONET_SOCKET_INCLUDED
+#define __CONET_SOCKET_INCLUDED
+
+#if defined(__linux__)
+
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <coroutine>
+#include <system_error>
+#include <array>
+#include <vector>
+#include <optional>
+#include <iterator>
+#include <new>
+#include "./internet.hpp"
+#include "./buffer.hpp"
+#include "../IOSchedule/Epoll.hpp"
+
+/*
+	Coroutine sockets over the reactor:
+
+		net::reactor_type reactor;
+		tcp::acceptor acceptor { reactor, tcp::endpoint { tcp::v4(), 8080 } };
+		for(;;) {
+			tcp::socket peer = co_await acceptor.async_accept();
+			...
+			std::size_t length = co_await peer.async_read_some(net::buffer(data));
+			co_await peer.async_write(net::buffer(data, length));
+		}
+
+	Every descriptor is non-blocking. An operation first tries the system call
+	right away and only suspends when it would block; the reactor then resumes
+	the coroutine once the call has gone through, so a connection costs one
+	coroutine and no thread. Each operation has two forms: one throws
+	std::system_error, the one taking a std::error_code& reports through it.
+	A socket allows one pending operation per direction, which must be awaited
+	on the thread running the reactor
+*/
+
+namespace conet __attribute__((__visibility__("default"))) {
+namespace net __attribute__((__visibility__("default"))) {
+
+	typedef Kelpa::IOSchedule::Reactor reactor_type;
+
+namespace ip __attribute__((__visibility__("default"))) {
+namespace detail {
+
+	[[nodiscard]] constexpr int domain_of(address_family __family) noexcept { return __family == ipv6_address ? AF_INET6 : AF_INET; }
+	[[nodiscard]] constexpr int type_of(socket_type __type) noexcept { return __type == datagram_socket ? SOCK_DGRAM : SOCK_STREAM; }
+
+	template <typename Protocol>
+	[[nodiscard]] inline socklen_t to_sockaddr(basic_endpoint<Protocol> const& __endpoint, sockaddr_storage& __storage) noexcept {
+		std::memset(std::addressof(__storage), 0, sizeof __storage);
+		auto const __address = __endpoint.address();
+		if(__address.is_v4()) {
+			auto& __in = reinterpret_cast<sockaddr_in &>(__storage);
+			__in.sin_family = AF_INET;
+			__in.sin_port = htons(__endpoint.port());
+			auto const __bytes = __address.to_v4().to_bytes();
+			std::memcpy(std::addressof(__in.sin_addr), __bytes.data(), __bytes.size());
+			return sizeof(sockaddr_in);
+		}
+		auto& __in6 = reinterpret_cast<sockaddr_in6 &>(__storage);
+		__in6.sin6_family = AF_INET6;
+		__in6.sin6_port = htons(__endpoint.port());
+		auto const __v6 = __address.to_v6();
+		auto const __bytes = __v6.to_bytes();
+		std::memcpy(std::addressof(__in6.sin6_addr), __bytes.data(), __bytes.size());
+		__in6.sin6_scope_id = __v6.scope_id();
+		return sizeof(sockaddr_in6);
+	}
+	template <typename Protocol>
+	[[nodiscard]] inline basic_endpoint<Protocol> from_sockaddr(sockaddr_storage const& __storage) noexcept {
+		if(__storage.ss_family == AF_INET6) {
+			auto const& __in6 = reinterpret_cast<sockaddr_in6 const &>(__storage);
+			address_v6::bytes_type __bytes;
+			std::memcpy(__bytes.data(), std::addressof(__in6.sin6_addr), __bytes.size());
+			return { address_v6{__bytes, __in6.sin6_scope_id}, ntohs(__in6.sin6_port) };
+		}
+		auto const& __in = reinterpret_cast<sockaddr_in const &>(__storage);
+		address_v4::bytes_type __bytes;
+		std::memcpy(__bytes.data(), std::addressof(__in.sin_addr), __bytes.size());
+		return { address_v4{__bytes}, ntohs(__in.sin_port) };
+	}
+	[[nodiscard]] inline std::error_code last_error() noexcept { return {errno, std::system_category()}; }
+	inline void throw_if(std::error_code const& __ec, char const* __what) {
+		if(__ec)
+			throw std::system_error(__ec, __what);
+	}
+
+	/* what a socket knows about the operation suspended on one of its directions */
+	struct pending_operation {
+		void complete(std::error_code const& __error) noexcept {
+			M_error = __error;
+			return std::exchange(M_coroutine, nullptr).resume();
+		}
+		std::coroutine_handle<> M_coroutine = {};
+		std::error_code 		M_error = {};
+	};
+
+	/*
+		Operation is tried by await_ready(); on EAGAIN the awaitable registers a
+		level-triggered callback that retries it each time the descriptor turns
+		ready and resumes the coroutine once it no longer would block
+	*/
+	template <typename Socket, typename Operation> struct [[nodiscard("io_awaitable")]] io_awaitable: pending_operation {
+		typedef Kelpa::IOSchedule::Event 			event_type;
+		typedef typename Operation::result_type 	result_type;
+
+		io_awaitable(Socket& __socket, event_type __event, Operation __operation, std::error_code* __error) noexcept
+		: M_socket(std::addressof(__socket)), M_reactor(std::addressof(__socket.context())), M_event(__event), M_operation(std::move(__operation)), M_report(__error) {}
+
+		bool await_ready() noexcept {
+			if(not M_socket->is_open()) {
+				M_error = std::make_error_code(std::errc::bad_file_descriptor);
+				return true;
+			}
+			return attempt();
+		}
+		bool await_suspend(std::coroutine_handle<> __coroutine) noexcept {
+			M_event = wanted();
+			pending_operation*& __slot = M_socket->pending(M_event);
+			if(__slot) {
+				M_error = std::make_error_code(std::errc::operation_in_progress);
+				return false;
+			}
+			int const __fd = M_socket->native_handle();
+			M_coroutine = __coroutine;
+			__slot = this;
+			(void) M_reactor->Listen(M_event, __fd, [this] { return retry(); });
+			if(Kelpa::IOSchedule::HasEvent(M_reactor->LookUp(__fd) & M_event))
+				return true;
+			/* descriptors epoll refuses (regular files) */
+			__slot = nullptr;
+			M_coroutine = nullptr;
+			M_error = std::make_error_code(std::errc::operation_not_supported);
+			return false;
+		}
+		/* the socket may be gone by now if it was closed while the operation was pending */
+		result_type await_resume() {
+			if(M_report)
+				* M_report = M_error;
+			else if(M_error)
+				throw std::system_error(M_error);
+			return M_operation.finish(* M_reactor, M_result);
+		}
+
+	private:
+		bool attempt() noexcept {
+			for(;;) {
+				ssize_t const __result = M_operation(M_socket->native_handle());
+				if(__result >= 0) {
+					M_result = __result;
+					return true;
+				}
+				if(errno == EINTR)
+					continue;
+				if(errno == EAGAIN or errno == EWOULDBLOCK)
+					return false;
+				M_error = last_error();
+				return true;
+			}
+		}
+		/* operations that wait on something else once they are halfway, e.g. zero-copy completions */
+		event_type wanted() const noexcept {
+			if constexpr (requires (Operation const& __operation) { __operation.waits(); })
+				return M_operation.waits().value_or(M_event);
+			return M_event;
+		}
+		void retry() noexcept {
+			if(not attempt()) {
+				if(event_type const __event = wanted(); __event != M_event) {
+					(void) M_reactor->Cancel(M_socket->native_handle(), M_event);
+					(void) M_reactor->Listen(M_event = __event, M_socket->native_handle(), [this] { return retry(); });
+				}
+				return;
+			}
+			M_socket->pending(M_event) = nullptr;
+			(void) M_reactor->Cancel(M_socket->native_handle(), M_event);
+			return complete(M_error);
+		}
+
+		Socket* 			M_socket;
+		reactor_type* 		M_reactor;
+		event_type 			M_event;
+		Operation 			M_operation;
+		std::error_code* 	M_report;
+		ssize_t 			M_result = -1;
+	};
+
+	struct read_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept { return ::recv(__fd, M_buffer.data(), M_buffer.size(), 0); }
+		result_type finish(reactor_type&, ssize_t __result) const noexcept { return __result < 0 ? 0 : static_cast<std::size_t>(__result); }
+		mutable_buffer M_buffer;
+	};
+	/* sends until every byte is out, picking up where the last attempt stopped */
+	struct write_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			while(M_written < M_buffer.size()) {
+				ssize_t const __sent = ::send(__fd, static_cast<char const *>(M_buffer.data()) + M_written, M_buffer.size() - M_written, MSG_NOSIGNAL);
+				if(__sent < 0)
+					return -1;
+				M_written += __sent;
+			}
+			return static_cast<ssize_t>(M_written);
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_written; }
+		const_buffer 	M_buffer;
+		std::size_t 	M_written = 0;
+	};
+	/* the first call starts the handshake, the ones after readiness collect its outcome */
+	struct connect_operation {
+		typedef void result_type;
+		ssize_t operator()(int __fd) noexcept {
+			if(not M_started) {
+				M_started = true;
+				if(not ::connect(__fd, reinterpret_cast<sockaddr const *>(std::addressof(M_address)), M_length))
+					return 0;
+				if(errno == EINPROGRESS)
+					errno = EAGAIN;
+				return -1;
+			}
+			int __error = 0;
+			socklen_t __length = sizeof __error;
+			if(::getsockopt(__fd, SOL_SOCKET, SO_ERROR, std::addressof(__error), std::addressof(__length)))
+				return -1;
+			if(__error == EINPROGRESS or __error == EALREADY)
+				__error = EAGAIN;
+			return __error ? (errno = __error, -1) : 0;
+		}
+		void finish(reactor_type&, ssize_t) const noexcept {}
+		sockaddr_storage 	M_address;
+		socklen_t 			M_length;
+		bool 				M_started = false;
+	};
+	template <typename Protocol> struct accept_operation {
+		typedef basic_stream_socket<Protocol> result_type;
+		ssize_t operator()(int __fd) noexcept { return ::accept4(__fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC); }
+		result_type finish(reactor_type& __reactor, ssize_t __result) const noexcept {
+			return __result < 0 ? result_type(__reactor) : result_type(__reactor, static_cast<int>(__result));
+		}
+	};
+	struct send_to_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			return ::sendto(__fd, M_buffer.data(), M_buffer.size(), MSG_NOSIGNAL, reinterpret_cast<sockaddr const *>(std::addressof(M_address)), M_length);
+		}
+		result_type finish(reactor_type&, ssize_t __result) const noexcept { return __result < 0 ? 0 : static_cast<std::size_t>(__result); }
+		const_buffer 		M_buffer;
+		sockaddr_storage 	M_address;
+		socklen_t 			M_length;
+	};
+	template <typename Protocol> struct receive_from_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			sockaddr_storage __address {};
+			socklen_t __length = sizeof __address;
+			ssize_t const __result = ::recvfrom(__fd, M_buffer.data(), M_buffer.size(), 0, reinterpret_cast<sockaddr *>(std::addressof(__address)), std::addressof(__length));
+			if(__result >= 0)
+				* M_sender = from_sockaddr<Protocol>(__address);
+			return __result;
+		}
+		result_type finish(reactor_type&, ssize_t __result) const noexcept { return __result < 0 ? 0 : static_cast<std::size_t>(__result); }
+		mutable_buffer 				M_buffer;
+		basic_endpoint<Protocol>* 	M_sender;
+	};
+
+	inline constexpr std::size_t iovec_batch = 64;
+
+	struct scatter_read_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			iovec __vector[iovec_batch];
+			std::size_t const __count = std::min(M_buffers.size(), iovec_batch);
+			for(std::size_t __index = 0; __index < __count; __index ++)
+				__vector[__index] = iovec{M_buffers[__index].data(), M_buffers[__index].size()};
+			return ::readv(__fd, __vector, static_cast<int>(__count));
+		}
+		result_type finish(reactor_type&, ssize_t __result) const noexcept { return __result < 0 ? 0 : static_cast<std::size_t>(__result); }
+		std::span<mutable_buffer const> M_buffers;
+	};
+	/* receives into the chain's tailroom and commits what arrived, nothing is copied afterwards */
+	struct chain_read_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			mutable_buffer __room;
+			try {
+				__room = M_chain->prepare(M_size);
+			} catch(std::bad_alloc const&) {
+				errno = ENOMEM;
+				return -1;
+			}
+			ssize_t const __result = ::recv(__fd, __room.data(), std::min(__room.size(), M_size), 0);
+			if(__result > 0)
+				M_chain->commit(static_cast<std::size_t>(__result));
+			return __result;
+		}
+		result_type finish(reactor_type&, ssize_t __result) const noexcept { return __result < 0 ? 0 : static_cast<std::size_t>(__result); }
+		buffer_chain* 	M_chain;
+		std::size_t 	M_size;
+	};
+	/* sendmsg over the buffers, remembering which buffer and offset the last attempt stopped at */
+	struct gather_write_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			for(;;) {
+				iovec __vector[iovec_batch];
+				std::size_t __count = 0;
+				for(std::size_t __index = M_index, __skip = M_offset; __index < M_buffers.size() and __count < iovec_batch; __index ++, __skip = 0)
+					if(M_buffers[__index].size() > __skip)
+						__vector[__count ++] = iovec{const_cast<char *>(static_cast<char const *>(M_buffers[__index].data())) + __skip, M_buffers[__index].size() - __skip};
+				if(not __count)
+					return static_cast<ssize_t>(M_written);
+				msghdr __message {};
+				__message.msg_iov = __vector;
+				__message.msg_iovlen = __count;
+				ssize_t const __sent = ::sendmsg(__fd, std::addressof(__message), MSG_NOSIGNAL);
+				if(__sent < 0)
+					return -1;
+				M_written += __sent;
+				for(std::size_t __left = __sent; __left and M_index < M_buffers.size(); ) {
+					std::size_t const __rest = M_buffers[M_index].size() - M_offset;
+					if(__left < __rest) {
+						M_offset += __left;
+						break;
+					}
+					__left -= __rest;
+					M_index ++;
+					M_offset = 0;
+				}
+			}
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_written; }
+		std::span<const_buffer const> 	M_buffers;
+		std::size_t 					M_index = 0;
+		std::size_t 					M_offset = 0;
+		std::size_t 					M_written = 0;
+	};
+	/* sends the chain and consumes what went out, so a failed write leaves the unsent rest in it */
+	struct chain_write_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			while(not M_chain->empty()) {
+				iovec __vector[iovec_batch];
+				msghdr __message {};
+				__message.msg_iov = __vector;
+				__message.msg_iovlen = M_chain->to_iovec(__vector);
+				ssize_t const __sent = ::sendmsg(__fd, std::addressof(__message), MSG_NOSIGNAL);
+				if(__sent < 0)
+					return -1;
+				M_written += __sent;
+				M_chain->consume(__sent);
+			}
+			return static_cast<ssize_t>(M_written);
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_written; }
+		buffer_chain* 	M_chain;
+		std::size_t 	M_written = 0;
+	};
+
+	/* per socket: whether SO_ZEROCOPY could be enabled, and whether the kernel fell back to copying last time */
+	struct zerocopy_state {
+		signed char 	M_enabled = -1;
+		bool 			M_copied = false;
+	};
+	/*
+		sendmsg(MSG_ZEROCOPY) pins the pages instead of copying them, and the
+		kernel reports on the socket's error queue when it is done with each
+		send. The operation keeps references on the blocks of what it sent and
+		completes only once every one of its sends is reported back, so the
+		bytes may be reused or freed as soon as the co_await returns.
+		Until then it waits on EPOLLERR rather than on writability
+	*/
+	struct zerocopy_write_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			if(M_state->M_enabled < 0) {
+				int const __one = 1;
+				M_state->M_enabled = not ::setsockopt(__fd, SOL_SOCKET, SO_ZEROCOPY, std::addressof(__one), sizeof __one);
+			}
+			for(;;) {
+				while(not M_chain->empty() and not M_starved) {
+					iovec __vector[iovec_batch];
+					msghdr __message {};
+					__message.msg_iov = __vector;
+					__message.msg_iovlen = M_chain->to_iovec(__vector);
+					int const __flags = MSG_NOSIGNAL | (M_state->M_enabled ? MSG_ZEROCOPY : 0);
+					ssize_t const __sent = ::sendmsg(__fd, std::addressof(__message), __flags);
+					if(__sent < 0) {
+						/* out of option memory: wait for completions to free it, or copy if there are none */
+						if(errno == ENOBUFS and (__flags & MSG_ZEROCOPY)) {
+							if(M_issued == M_confirmed)
+								M_state->M_enabled = false;
+							else
+								M_starved = true;
+							continue;
+						}
+						/* EPOLLERR stays up while completions are queued, take them off before waiting for room */
+						if(errno == EAGAIN and M_confirmed != M_issued) {
+							while(drain(__fd));
+							errno = EAGAIN;
+						}
+						return -1;
+					}
+					if(__flags & MSG_ZEROCOPY) {
+						M_issued ++;
+						(void) M_pinned.Append(M_chain->share(__sent));
+					}
+					M_written += __sent;
+					M_chain->consume(__sent);
+				}
+				if(M_confirmed == M_issued)
+					return static_cast<ssize_t>(M_written);
+				if(not drain(__fd))
+					return -1;
+				M_starved = false;
+			}
+		}
+		std::optional<Kelpa::IOSchedule::Event> waits() const noexcept {
+			if(M_starved or (M_chain->empty() and M_confirmed != M_issued))
+				return Kelpa::IOSchedule::Event::EXCEPT;
+			return std::nullopt;
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_written; }
+
+		/* reads one notification; false with errno EAGAIN when the queue is empty */
+		bool drain(int __fd) noexcept {
+			alignas(cmsghdr) char __control[128];
+			msghdr __message {};
+			__message.msg_control = __control;
+			__message.msg_controllen = sizeof __control;
+			if(::recvmsg(__fd, std::addressof(__message), MSG_ERRQUEUE) < 0)
+				return false;
+			for(cmsghdr* __header = CMSG_FIRSTHDR(std::addressof(__message)); __header; __header = CMSG_NXTHDR(std::addressof(__message), __header)) {
+				if(not ((__header->cmsg_level == SOL_IP and __header->cmsg_type == IP_RECVERR) or (__header->cmsg_level == SOL_IPV6 and __header->cmsg_type == IPV6_RECVERR)))
+					continue;
+				sock_extended_err __error;
+				std::memcpy(std::addressof(__error), CMSG_DATA(__header), sizeof __error);
+				if(__error.ee_errno or __error.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+					continue;
+				/* [ee_info, ee_data] is a range of completed sends, ranges may be merged */
+				M_confirmed += __error.ee_data - __error.ee_info + 1;
+				M_state->M_copied = __error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED;
+			}
+			return true;
+		}
+
+		buffer_chain* 							M_chain;
+		zerocopy_state* 						M_state;
+		buffer_chain::storage_type 				M_pinned = {};
+		std::uint32_t 							M_issued = 0;
+		std::uint32_t 							M_confirmed = 0;
+		std::size_t 							M_written = 0;
+		bool 									M_starved = false;
+	};
+
+	/* sendfile(2): file pages go to the socket without passing through user space */
+	struct sendfile_operation {
+		typedef std::size_t result_type;
+		ssize_t operator()(int __fd) noexcept {
+			while(M_sent < M_count) {
+				ssize_t const __result = ::sendfile(__fd, M_file, M_offset < 0 ? nullptr : std::addressof(M_offset), M_count - M_sent);
+				if(__result < 0)
+					return -1;
+				if(0 == __result)
+					break;
+				M_sent += __result;
+			}
+			return static_cast<ssize_t>(M_sent);
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_sent; }
+		int 			M_file;
+		off_t 			M_offset;
+		std::size_t 	M_count;
+		std::size_t 	M_sent = 0;
+	};
+	/* splice(2) socket -> pipe -> file, the receiving counterpart of sendfile for large uploads */
+	struct splice_operation {
+		typedef std::size_t result_type;
+		splice_operation(int __file, off_t __offset, std::size_t __count) noexcept: M_file(__file), M_offset(__offset), M_count(__count) {}
+		splice_operation(splice_operation&& __other) noexcept
+		: M_file(__other.M_file), M_offset(__other.M_offset), M_count(__other.M_count), M_received(__other.M_received),
+		  M_pipe{std::exchange(__other.M_pipe[0], -1), std::exchange(__other.M_pipe[1], -1)} {}
+		~splice_operation() noexcept {
+			for(int __end: M_pipe)
+				if(__end >= 0)
+					(void) ::close(__end);
+		}
+		ssize_t operator()(int __fd) noexcept {
+			if(M_pipe[0] < 0 and ::pipe2(M_pipe, O_CLOEXEC))
+				return -1;
+			while(M_received < M_count) {
+				ssize_t const __in = ::splice(__fd, nullptr, M_pipe[1], nullptr, std::min<std::size_t>(M_count - M_received, 1 << 16), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+				if(__in < 0)
+					return -1;
+				if(0 == __in)
+					break;
+				for(ssize_t __left = __in; __left; ) {
+					ssize_t const __out = ::splice(M_pipe[0], nullptr, M_file, M_offset < 0 ? nullptr : std::addressof(M_offset), __left, SPLICE_F_MOVE);
+					if(__out < 0 and errno == EINTR)
+						continue;
+					/* bytes already taken off the socket are lost, never report this as would-block */
+					if(__out <= 0) {
+						if(0 == __out or errno == EAGAIN)
+							errno = EIO;
+						return -1;
+					}
+					__left -= __out;
+					M_received += __out;
+				}
+			}
+			return static_cast<ssize_t>(M_received);
+		}
+		result_type finish(reactor_type&, ssize_t) const noexcept { return M_received; }
+		int 			M_file;
+		off_t 			M_offset;
+		std::size_t 	M_count;
+		std::size_t 	M_received = 0;
+		int 			M_pipe[2] = {-1, -1};
+	};
+} // namespace conet::net::ip::detail
+
+	/*
+		Owns a non-blocking descriptor watched by a reactor. Closing the socket
+		resumes its pending operations with operation_canceled
+	*/
+	template <typename Protocol> struct basic_socket {
+		typedef Protocol 					protocol_type;
+		typedef basic_endpoint<Protocol> 	endpoint_type;
+		typedef int 						native_handle_type;
+
+		explicit basic_socket(reactor_type& __reactor) noexcept: M_reactor(std::addressof(__reactor)) {}
+		/* adopts __fd and switches it to non-blocking mode */
+		basic_socket(reactor_type& __reactor, native_handle_type __fd) noexcept: M_reactor(std::addressof(__reactor)), M_fd(__fd) {
+			int const __flags = __fd < 0 ? -1 : ::fcntl(__fd, F_GETFL, 0);
+			if(__flags >= 0 and not (__flags & O_NONBLOCK))
+				(void) ::fcntl(__fd, F_SETFL, __flags | O_NONBLOCK);
+		}
+		basic_socket(basic_socket const&) = delete;
+		basic_socket& operator=(basic_socket const&) = delete;
+		/* a socket with a pending operation must not be moved */
+		basic_socket(basic_socket&& __other) noexcept: M_reactor(__other.M_reactor), M_fd(std::exchange(__other.M_fd, -1)) {}
+		basic_socket& operator=(basic_socket&& __other) noexcept {
+			if(this != std::addressof(__other)) {
+				close();
+				M_reactor = __other.M_reactor;
+				M_fd = std::exchange(__other.M_fd, -1);
+			}
+			return *this;
+		}
+		~basic_socket() noexcept { close(); }
+
+		[[nodiscard]] reactor_type& context() const noexcept { return * M_reactor; }
+		[[nodiscard]] native_handle_type native_handle() const noexcept { return M_fd; }
+		[[nodiscard]] bool is_open() const noexcept { return M_fd >= 0; }
+
+		void open(protocol_type const& __protocol, std::error_code& __ec) noexcept {
+			close();
+			M_fd = ::socket(detail::domain_of(__protocol.family()), detail::type_of(__protocol.type()) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			M_fd < 0 ? (void) (__ec = detail::last_error()) : __ec.clear();
+		}
+		void open(protocol_type const& __protocol) {
+			std::error_code __ec;
+			open(__protocol, __ec);
+			detail::throw_if(__ec, "open");
+		}
+		void bind(endpoint_type const& __endpoint, std::error_code& __ec) noexcept {
+			sockaddr_storage __address;
+			socklen_t const __length = detail::to_sockaddr(__endpoint, __address);
+			::bind(M_fd, reinterpret_cast<sockaddr const *>(std::addressof(__address)), __length) ? (void) (__ec = detail::last_error()) : __ec.clear();
+		}
+		void bind(endpoint_type const& __endpoint) {
+			std::error_code __ec;
+			bind(__endpoint, __ec);
+			detail::throw_if(__ec, "bind");
+		}
+		/* set_option(SOL_SOCKET, SO_REUSEADDR, 1), set_option(IPPROTO_TCP, TCP_NODELAY, 1), ... */
+		void set_option(int __level, int __name, int __value, std::error_code& __ec) noexcept {
+			::setsockopt(M_fd, __level, __name, std::addressof(__value), sizeof __value) ? (void) (__ec = detail::last_error()) : __ec.clear();
+		}
+		void set_option(int __level, int __name, int __value) {
+			std::error_code __ec;
+			set_option(__level, __name, __value, __ec);
+			detail::throw_if(__ec, "setsockopt");
+		}
+
+		[[nodiscard]] endpoint_type local_endpoint(std::error_code& __ec) const noexcept { return query(::getsockname, __ec); }
+		[[nodiscard]] endpoint_type local_endpoint() const {
+			std::error_code __ec;
+			endpoint_type const __endpoint = local_endpoint(__ec);
+			detail::throw_if(__ec, "getsockname");
+			return __endpoint;
+		}
+		[[nodiscard]] endpoint_type remote_endpoint(std::error_code& __ec) const noexcept { return query(::getpeername, __ec); }
+		[[nodiscard]] endpoint_type remote_endpoint() const {
+			std::error_code __ec;
+			endpoint_type const __endpoint = remote_endpoint(__ec);
+			detail::throw_if(__ec, "getpeername");
+			return __endpoint;
+		}
+
+		/*
+			Both end by resuming the pending operations with operation_canceled;
+			the socket is not touched after that, so a resumed coroutine may destroy it
+		*/
+		void cancel() noexcept {
+			if(not is_open())
+				return;
+			(void) M_reactor->Cancel(M_fd);
+			return abort(take_pending());
+		}
+		void close() noexcept {
+			if(not is_open())
+				return;
+			(void) M_reactor->Cancel(M_fd);
+			(void) ::close(std::exchange(M_fd, -1));
+			return abort(take_pending());
+		}
+		/* gives up ownership without closing, pending operations are canceled */
+		[[nodiscard]] native_handle_type release() noexcept {
+			if(is_open())
+				(void) M_reactor->Cancel(M_fd);
+			native_handle_type const __fd = std::exchange(M_fd, -1);
+			return abort(take_pending()), __fd;
+		}
+
+	protected:
+		template <typename, typename> friend struct detail::io_awaitable;
+		typedef std::array<detail::pending_operation *, 2> pending_type;
+
+		detail::pending_operation*& pending(Kelpa::IOSchedule::Event __event) noexcept {
+			return M_pending[__event == Kelpa::IOSchedule::Event::READ ? 0 : 1];
+		}
+		template <typename Operation>
+		[[nodiscard]] auto await(Kelpa::IOSchedule::Event __event, Operation&& __operation, std::error_code* __ec) noexcept {
+			return detail::io_awaitable<basic_socket, std::decay_t<Operation>>(* this, __event, std::forward<Operation>(__operation), __ec);
+		}
+
+	private:
+		pending_type take_pending() noexcept { return std::exchange(M_pending, pending_type{}); }
+		static void abort(pending_type const& __pending) noexcept {
+			for(detail::pending_operation* __operation: __pending)
+				if(__operation)
+					__operation->complete(std::make_error_code(std::errc::operation_canceled));
+		}
+		endpoint_type query(int (* __query)(int, sockaddr *, socklen_t *) noexcept, std::error_code& __ec) const noexcept {
+			sockaddr_storage __address {};
+			socklen_t __length = sizeof __address;
+			if(__query(M_fd, reinterpret_cast<sockaddr *>(std::addressof(__address)), std::addressof(__length))) {
+				__ec = detail::last_error();
+				return {};
+			}
+			__ec.clear();
+			return detail::from_sockaddr<Protocol>(__address);
+		}
+
+		reactor_type* 		M_reactor;
+		native_handle_type 	M_fd = -1;
+		/* [0] the pending read, accept or receive; [1] the pending write, connect or send */
+		pending_type 		M_pending = {};
+	};
+
+	template <typename Protocol> struct basic_stream_socket: basic_socket<Protocol> {
+		typedef typename basic_socket<Protocol>::endpoint_type endpoint_type;
+		using basic_socket<Protocol>::basic_socket;
+
+		/* opens the socket for the endpoint's family when it is not open yet */
+		[[nodiscard]] auto async_connect(endpoint_type const& __endpoint) noexcept { return connect(__endpoint, nullptr); }
+		[[nodiscard]] auto async_connect(endpoint_type const& __endpoint, std::error_code& __ec) noexcept { return connect(__endpoint, std::addressof(__ec)); }
+
+		/* yields the number of bytes read, 0 once the peer has shut down its side */
+		[[nodiscard]] auto async_read_some(mutable_buffer const& __buffer) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::read_operation{__buffer}, nullptr); }
+		[[nodiscard]] auto async_read_some(mutable_buffer const& __buffer, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::read_operation{__buffer}, std::addressof(__ec)); }
+
+		/* completes once the whole buffer is sent and yields its size */
+		[[nodiscard]] auto async_write(const_buffer const& __buffer) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::write_operation{__buffer}, nullptr); }
+		[[nodiscard]] auto async_write(const_buffer const& __buffer, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::write_operation{__buffer}, std::addressof(__ec)); }
+
+		/* scatter read, fills the buffers in order */
+		[[nodiscard]] auto async_read_some(std::span<mutable_buffer const> __buffers) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::scatter_read_operation{__buffers}, nullptr); }
+		[[nodiscard]] auto async_read_some(std::span<mutable_buffer const> __buffers, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::scatter_read_operation{__buffers}, std::addressof(__ec)); }
+
+		/* gather write, one sendmsg per attempt for up to 64 buffers; the span must outlive the co_await */
+		[[nodiscard]] auto async_write(std::span<const_buffer const> __buffers) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::gather_write_operation{__buffers}, nullptr); }
+		[[nodiscard]] auto async_write(std::span<const_buffer const> __buffers, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::gather_write_operation{__buffers}, std::addressof(__ec)); }
+
+		/* appends up to __size received bytes to the chain, yields how many, 0 once the peer has shut down */
+		[[nodiscard]] auto async_read_some(buffer_chain& __chain, std::size_t __size) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::chain_read_operation{std::addressof(__chain), __size}, nullptr); }
+		[[nodiscard]] auto async_read_some(buffer_chain& __chain, std::size_t __size, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::chain_read_operation{std::addressof(__chain), __size}, std::addressof(__ec)); }
+
+		/* sends the chain and consumes it, on error the unsent rest stays in the chain */
+		[[nodiscard]] auto async_write(buffer_chain& __chain) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::chain_write_operation{std::addressof(__chain)}, nullptr); }
+		[[nodiscard]] auto async_write(buffer_chain& __chain, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::chain_write_operation{std::addressof(__chain)}, std::addressof(__ec)); }
+
+		/*
+			MSG_ZEROCOPY send of the chain, for large payloads (tens of KiB and up)
+			where pinning pages beats copying them. Completes once the kernel has
+			released every page; falls back to copying when SO_ZEROCOPY is unavailable
+		*/
+		[[nodiscard]] auto async_write_zerocopy(buffer_chain& __chain) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::zerocopy_write_operation{std::addressof(__chain), std::addressof(M_zerocopy)}, nullptr); }
+		[[nodiscard]] auto async_write_zerocopy(buffer_chain& __chain, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::zerocopy_write_operation{std::addressof(__chain), std::addressof(M_zerocopy)}, std::addressof(__ec)); }
+		/* true when the kernel had to copy the last zero-copy send anyway (loopback, unsupported device) */
+		[[nodiscard]] bool zerocopy_copied() const noexcept { return M_zerocopy.M_copied; }
+
+		/* sendfile(2) of __count bytes of __file from __offset, or from its file position when __offset is -1 */
+		[[nodiscard]] auto async_send_file(int __file, off_t __offset, std::size_t __count) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::sendfile_operation{__file, __offset, __count}, nullptr); }
+		[[nodiscard]] auto async_send_file(int __file, off_t __offset, std::size_t __count, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::WRITE, detail::sendfile_operation{__file, __offset, __count}, std::addressof(__ec)); }
+
+		/* splices up to __count received bytes into __file, stops early when the peer shuts down */
+		[[nodiscard]] auto async_receive_file(int __file, off_t __offset, std::size_t __count) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::splice_operation{__file, __offset, __count}, nullptr); }
+		[[nodiscard]] auto async_receive_file(int __file, off_t __offset, std::size_t __count, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::splice_operation{__file, __offset, __count}, std::addressof(__ec)); }
+
+		void shutdown(int __how, std::error_code& __ec) noexcept {
+			::shutdown(this->native_handle(), __how) ? (void) (__ec = detail::last_error()) : __ec.clear();
+		}
+		void shutdown(int __how = SHUT_WR) {
+			std::error_code __ec;
+			shutdown(__how, __ec);
+			detail::throw_if(__ec, "shutdown");
+		}
+
+	private:
+		auto connect(endpoint_type const& __endpoint, std::error_code* __ec) noexcept {
+			detail::connect_operation __operation;
+			__operation.M_length = detail::to_sockaddr(__endpoint, __operation.M_address);
+			if(not this->is_open()) {
+				std::error_code __ignored;
+				this->open(__endpoint.protocol(), __ignored);
+			}
+			return this->await(Kelpa::IOSchedule::Event::WRITE, __operation, __ec);
+		}
+
+		detail::zerocopy_state M_zerocopy;
+	};
+
+	template <typename Protocol> struct basic_socket_acceptor: basic_socket<Protocol> {
+		typedef typename basic_socket<Protocol>::endpoint_type endpoint_type;
+		using basic_socket<Protocol>::basic_socket;
+
+		/* opens, binds with SO_REUSEADDR and listens, throws std::system_error on failure */
+		basic_socket_acceptor(reactor_type& __reactor, endpoint_type const& __endpoint, int __backlog = SOMAXCONN): basic_socket<Protocol>(__reactor) {
+			this->open(__endpoint.protocol());
+			this->set_option(SOL_SOCKET, SO_REUSEADDR, 1);
+			this->bind(__endpoint);
+			listen(__backlog);
+		}
+
+		void listen(int __backlog, std::error_code& __ec) noexcept {
+			::listen(this->native_handle(), __backlog) ? (void) (__ec = detail::last_error()) : __ec.clear();
+		}
+		void listen(int __backlog = SOMAXCONN) {
+			std::error_code __ec;
+			listen(__backlog, __ec);
+			detail::throw_if(__ec, "listen");
+		}
+
+		/* yields the accepted connection, already non-blocking and bound to the same reactor */
+		[[nodiscard]] auto async_accept() noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::accept_operation<Protocol>{}, nullptr); }
+		[[nodiscard]] auto async_accept(std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::accept_operation<Protocol>{}, std::addressof(__ec)); }
+	};
+
+	template <typename Protocol> struct basic_datagram_socket: basic_socket<Protocol> {
+		typedef typename basic_socket<Protocol>::endpoint_type endpoint_type;
+		using basic_socket<Protocol>::basic_socket;
+
+		/* opens and binds, throws std::system_error on failure */
+		basic_datagram_socket(reactor_type& __reactor, endpoint_type const& __endpoint): basic_socket<Protocol>(__reactor) {
+			this->open(__endpoint.protocol());
+			this->bind(__endpoint);
+		}
+
+		[[nodiscard]] auto async_send_to(const_buffer const& __buffer, endpoint_type const& __destination) noexcept
+		{ 	return send_to(__buffer, __destination, nullptr); }
+		[[nodiscard]] auto async_send_to(const_buffer const& __buffer, endpoint_type const& __destination, std::error_code& __ec) noexcept
+		{ 	return send_to(__buffer, __destination, std::addressof(__ec)); }
+
+		/* __sender is filled in when the datagram arrives and must outlive the co_await */
+		[[nodiscard]] auto async_receive_from(mutable_buffer const& __buffer, endpoint_type& __sender) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::receive_from_operation<Protocol>{__buffer, std::addressof(__sender)}, nullptr); }
+		[[nodiscard]] auto async_receive_from(mutable_buffer const& __buffer, endpoint_type& __sender, std::error_code& __ec) noexcept
+		{ 	return this->await(Kelpa::IOSchedule::Event::READ, detail::receive_from_operation<Protocol>{__buffer, std::addressof(__sender)}, std::addressof(__ec)); }
+
+	private:
+		auto send_to(const_buffer const& __buffer, endpoint_type const& __destination, std::error_code* __ec) noexcept {
+			detail::send_to_operation __operation { .M_buffer = __buffer, .M_address = {}, .M_length = 0 };
+			__operation.M_length = detail::to_sockaddr(__destination, __operation.M_address);
+			return this->await(Kelpa::IOSchedule::Event::WRITE, __operation, __ec);
+		}
+	};
+
+} // namespace conet::net::ip
+} // namespace conet::net
+} // namespace conet
+
+#endif // #if defined(__linux__)
+
+#endif // #ifndef __CONET_SOCKET_INCLUDED
@@ -6,6 +6,7 @@
  * 		@Dependency	./ { Logger.hpp }
  * 					../Utility/Macros {  #define DEFINES_STRUCT_MEMBER_TYPES }
  * 					../Utility/Singleton { struct Singleton }
+ * 					../Thread/Snapshot { struct Snapshot }
  * 		@Since 		2024/04/22
  * 		@Version	1st		
  **/
@@ -21,6 +22,9 @@
 #include "./LoggerAndAppender.hpp"			/* imports ./ { 
 	struct Logger 
 }*/
+#include "../Thread/Snapshot.hpp"	/* imports ./ { 
+	struct Snapshot 
+}*/
 namespace Kelpa {
 namespace Journal {
 	
@@ -34,17 +38,20 @@ __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Manager)
 	Manager::reference						Erase(std::string_view) 			noexcept;
 	std::size_t 							Size() 								const noexcept;
 	bool 									Contains(std::string_view) 			const noexcept;
-	static std::unordered_map<std::string, Logger::shared_pointer>				Sink;
+	typedef std::unordered_map<std::string, Logger::shared_pointer> 			Registry;
+	/* every log call looks a logger up, binding one is rare: readers never lock */
+	static Thread::Snapshot<Registry>											Sink;
 };
-std::unordered_map<std::string, Logger::shared_pointer>				Manager::Sink {};
+Thread::Snapshot<Manager::Registry>									Manager::Sink {};
 Manager::Manager() noexcept {
-	Sink.reserve(8);
+	Sink.Update([] (Registry& registry) { registry.reserve(8); });
 	(void) 	Create("root").Create("system");
 }
 std::optional<Logger::shared_pointer>	Manager::TryGet(std::string_view name) 			const noexcept {
-	return Sink.contains(name.data()) ? 
-			std::make_optional(const_cast<std::decay_t<decltype((* this).Sink)> &>(Sink)[name.data()]) 
-		: 	std::nullopt;
+	return Sink.Visit([&] (Registry const& registry) -> std::optional<Logger::shared_pointer> {
+		auto iterator = registry.find(name.data());
+		return iterator == registry.end() ? std::nullopt : std::make_optional(iterator -> second);
+	});
 }
 Manager::reference						Manager::Create(std::string_view name) 			noexcept {
 	auto logger = 	Logger::Shared(name);
@@ -52,18 +59,18 @@ Manager::reference						Manager::Create(std::string_view name) 			noexcept {
 	return 			Bind(logger);	
 }
 Manager::reference						Manager::Bind(Logger::shared_pointer logger) 	noexcept {
-	(void)   Sink.emplace((* logger).name, logger);
+	Sink.Update([&] (Registry& registry) { (void) registry.emplace((* logger).name, logger); });
 	return * this;
 }
 Manager::reference						Manager::Erase(std::string_view name) 			noexcept {
-	(void)	Sink.erase(name.data());
+	Sink.Update([&] (Registry& registry) { (void) registry.erase(name.data()); });
 	return * this;
 }
 std::size_t 							Manager::Size() 								const noexcept {
-	return Sink.size();
+	return Sink.Visit([] (Registry const& registry) { return registry.size(); });
 }
 bool 									Manager::Contains(std::string_view name) 		const noexcept {
-	return Sink.contains(name.data());
+	return Sink.Visit([&] (Registry const& registry) { return registry.contains(name.data()); });
 }
 	
 	
@@ -4,7 +4,7 @@
  * 				are extracted by type extraction to form a metadata cluster, 
  * 				which is convenient for serialization
  * @Dependency	./ { FunctionTraits.hpp, VariableTraits.hpp }
- * 				../Utility/ { Concepts.hpp }
+ * 				../Utility/ { Concepts.hpp, Hash.hpp }
  * @Since		2024/04/22
  * @Version     1st
  **/
@@ -33,6 +33,10 @@
 #include "../Utility/Concepts.hpp"			/* imports ./ { 
 	concept function_pointer
 }*/
+#include "../Utility/Hash.hpp"				/* imports ./ { 
+	HashBytes, 
+	HashCombine 
+}*/
 namespace Kelpa {
 namespace Serde {
 //UnitType {};
@@ -71,10 +75,14 @@ template <typename T> std::ostream& operator<<(std::ostream& Os, Field<T> const&
 namespace std {
 
 template <typename T> struct hash<Kelpa::Serde::Field<T>> {
-	constexpr std::size_t operator()(Kelpa::Serde::Field<T> const& field) const noexcept {
-		std::size_t result { std::hash<T>{} (field.pointer) | std::hash<std::string_view>{} (field.idnetifier) };
+	/* member pointers have no std::hash, their bytes are hashed instead */
+	std::size_t operator()(Kelpa::Serde::Field<T> const& field) const noexcept {
+		std::uint64_t result { Kelpa::Utility::HashCombine(
+			Kelpa::Utility::HashBytes(std::addressof(field.pointer), sizeof field.pointer), 
+			Kelpa::Utility::HashBytes(field.identifier.data(), field.identifier.size())
+		) };
 		if constexpr(requires { typename Kelpa::Serde::Field<T>::class_type; }) 
-			result |= std::type_index(typeid(typename Kelpa::Serde::Field<T>::class_type)).hash_code();
+			result = Kelpa::Utility::HashCombine(result, std::type_index(typeid(typename Kelpa::Serde::Field<T>::class_type)).hash_code());
 		return result;	
 	}	
 };
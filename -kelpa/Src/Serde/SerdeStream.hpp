@@ -3,7 +3,7 @@
  * @Brief		c++ style character stream manager that overloads various types of 
  * 				extract and disextract operators
  * @Dependency	./ { Util.hpp }
- * 				../Utility/ { Concepts.hpp, Functions.hpp, ScopeGuard.hpp, SelfWrap.hpp }
+ * 				../Utility/ { Concepts.hpp, Functions.hpp, IOBuf.hpp, ScopeGuard.hpp, SelfWrap.hpp }
  * @Since		2024/04/22
  * @Version     1st
  **/
@@ -34,6 +34,13 @@
 #include "../Utility/ScopeGuard.hpp"	/* imports ./ { 
 	struct ScopeGuard
 }*/
+#include "../Utility/IOBuf.hpp"			/* imports ./ { 
+	struct IOBuf,
+	struct IOBuf::StreamBuffer
+}*/
+#include <memory>						/* imports ./ { 
+	std::unique_ptr
+}*/
 #include "../Compress/Varint.hpp"		/* imports ./ { 
 	to/fromVariint 
 }*/
@@ -80,8 +87,25 @@ struct SerdeStream: public std::stringstream {
 		std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out 
 	) noexcept: std::stringstream(s, mode) {};
 	
-	SerdeStream(SerdeStream&&) noexcept = 				default;
-	SerdeStream& operator=(SerdeStream&&) noexcept = 	default;
+	/* encodes into and decodes from the IOBuf in place, with no string in between */
+	explicit SerdeStream(Utility::IOBuf& buffer) noexcept(false)
+		: std::stringstream(std::ios_base::in | std::ios_base::out)
+		, channel(std::make_unique<Utility::IOBuf::StreamBuffer>(buffer)) 
+	{ 	(void) std::basic_ios<char_type>::rdbuf(channel.get()); 	}
+
+	SerdeStream(SerdeStream&& other) noexcept
+		: std::stringstream(std::move(other))
+		, channel(std::move(other.channel)) {
+		if(channel) 
+			(void) std::basic_ios<char_type>::rdbuf(channel.get());
+	}
+	SerdeStream& operator=(SerdeStream&& other) noexcept {
+		std::stringstream::operator=(std::move(other));
+		channel = std::move(other.channel);
+		if(channel) 
+			(void) std::basic_ios<char_type>::rdbuf(channel.get());
+		return *this;
+	}
 	SerdeStream(SerdeStream const&) = 					delete;
 	SerdeStream& operator=(SerdeStream const&) = 		delete;
 	
@@ -102,9 +126,10 @@ struct SerdeStream: public std::stringstream {
 	
 		if constexpr(!std::integral<T>) 	
 			return Write(reinterpret_cast<char_type const *>(std::addressof(value)), sizeof(T));
-
-		auto v = Compress::ToVarint(Compress::ToZigZag(value));
-		return Write(reinterpret_cast<char_type const*>(v.data()), v.size());	
+		else {
+			auto v = Compress::ToVarint(Compress::ToZigZag(value));
+			return Write(reinterpret_cast<char_type const*>(v.data()), v.size());	
+		}
 	}
 	template <Detail::Structure T> std::basic_ostream<char_type>& operator<<(T value) noexcept {
 		(void) Write(reinterpret_cast<char_type const *>(std::addressof(Information<T>::code)), sizeof(CodecTraits::code_type));
@@ -152,16 +177,18 @@ struct SerdeStream: public std::stringstream {
 
 		if constexpr(! std::integral<T>) 
 			return Read(reinterpret_cast<char_type *>(std::addressof(value)), sizeof(T));
-
-		std::vector<unsigned char> v;
-		while(~peek() && static_cast<unsigned char>(peek()) & 0x00FF) v.emplace_back(static_cast<unsigned char>(get()));
-
-		if constexpr(! std::unsigned_integral<T>)
-			(void) std::exchange(value, Compress::FromVarint<T>(v));
-		else (void) 
-			std::exchange(value, Compress::FromZigZag(Compress::FromVarint<T>(v)));
-
-		return static_cast<std::basic_istream<char_type>& >(*this);
+		else {
+			/* varint bytes up to and including the first one without the continuation bit */
+			std::vector<unsigned char> v;
+			while(~peek() && (v.empty() || v.back() & 0x80)) v.emplace_back(static_cast<unsigned char>(get()));
+
+			if constexpr(std::unsigned_integral<T>)
+				(void) std::exchange(value, Compress::FromVarint<T>(v));
+			else (void) 
+				std::exchange(value, Compress::FromZigZag(Compress::FromVarint<std::make_unsigned_t<T>>(v)));
+
+			return static_cast<std::basic_istream<char_type>& >(*this);
+		}
 	}
 	template <Detail::Structure T> std::basic_istream<char_type>& operator>>(T& value) noexcept {
 		CodecTraits::code_type code;
@@ -230,7 +257,8 @@ struct SerdeStream: public std::stringstream {
 		std::streamsize 			size;
 	
 		Utility::ScopeGuard guard ( [&] { for(std::streamsize count {}; count < size; count ++) (void) unget(); } );
-		size = readsome(reinterpret_cast<char_type *>(std::addressof(code)), sizeof(CodecTraits::code_type));
+		/* straight from the buffer: readsome() stops at the end of an IOBuf slice */
+		size = std::basic_ios<char_type>::rdbuf() -> sgetn(reinterpret_cast<char_type *>(std::addressof(code)), sizeof(CodecTraits::code_type));
 
 		return size == sizeof(CodecTraits::code_type) ? std::make_optional(code) : std::nullopt;
 	}
@@ -271,6 +299,8 @@ struct SerdeStream: public std::stringstream {
 			self_type::Arouse("Writeback buffer error"): self_type::Enwrap(*this);
 	}
 private: 
+	std::unique_ptr<Utility::IOBuf::StreamBuffer> 	channel;
+
 	template <typename T> constexpr SerdeStream& Verify(CodecTraits::code_type code) noexcept {
 		if(code == Information<T>::code) 
 			return *this;
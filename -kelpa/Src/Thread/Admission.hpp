@@ -0,0 +1,426 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Admission.hpp
+ * 		@Brief	Admission control for servers: lock-free token and leaky buckets,
+ * 				a concurrency limiter with adaptive (AIMD, gradient) limits and
+ * 				per-key limiters sharded by Utility::Hash
+ * 		@Dependency	../Utility/ { Hash.hpp, Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_ADMISSION_HPP__
+#define __KELPA_THREAD_ADMISSION_HPP__
+
+#include <algorithm>				/* imports ./ {
+	std::clamp,
+	std::max,
+	std::min
+}*/
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic,
+	std::atomic_flag
+}*/
+#include <chrono>					/* imports ./ {
+	std::chrono::steady_clock,
+	std::chrono::nanoseconds
+}*/
+#include <cmath>					/* imports ./ {
+	std::sqrt
+}*/
+#include <cstdint>					/* imports ./ {
+	std::int64_t,
+	std::uint64_t
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::lock_guard
+}*/
+#include <memory>					/* imports ./ {
+	std::addressof
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <unordered_map>			/* imports ./ {
+	std::unordered_map
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange,
+	std::forward
+}*/
+#include "../Utility/Hash.hpp"		/* imports ./ {
+	struct Hash
+}*/
+#include "../Utility/Interfaces.hpp"/* imports ./ {
+	struct nonXXXable
+}*/
+
+namespace Kelpa {
+namespace Thread {
+
+/*
+	Left alone, a server under overload accepts everything: every connection
+	is accepted, every task queued, and the queue turns extra load into extra
+	latency for everyone until requests time out before they are served. The
+	pieces here refuse work at the door instead, so what is admitted is still
+	served on time and what is refused fails fast and can be retried:
+
+		TokenBucket 		at most `rate` a second, bursts of up to `burst` at once
+		LeakyBucket 		exactly `rate` a second, excess turned into a bounded wait
+		ConcurrencyLimiter 	at most `limit` at once, the limit following the latency
+		KeyedLimiter 		one of the above per client, so one client cannot starve the rest
+
+	Executor takes any of them through SetAdmission(), ShardedReactor through
+	SetAdmission() with the peer's address, and http::server through the
+	`admission` and `max_connections` options. Every time argument defaults to
+	now and exists so a caller that already read the clock need not read it again
+*/
+typedef std::chrono::steady_clock 			AdmissionClock;
+
+namespace Detail {
+	inline std::int64_t Ticks(AdmissionClock::time_point now) noexcept
+	{ 	return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count(); 	}
+	inline std::int64_t Interval(double rate) noexcept
+	{ 	return static_cast<std::int64_t>(1e9 / std::max(rate, 1e-9)); 	}
+}	// namespace Detail
+
+/*
+	A token bucket kept as a single word, the time at which the bucket would
+	be full again (GCRA): taking n tokens moves that time n intervals into the
+	future, and is refused if it would then lie more than `burst` intervals
+	ahead of now. One compare-exchange per acquisition, no refill thread
+*/
+struct TokenBucket {
+	typedef AdmissionClock 					clock_type;
+	typedef clock_type::time_point 			time_point;
+	typedef std::chrono::nanoseconds 		duration_type;
+
+	/* `rate` tokens a second, of which up to `burst` can be saved up; starts full */
+	TokenBucket(double rate, double burst) noexcept
+		: interval(Detail::Interval(rate)), tolerance(static_cast<std::int64_t>(std::max(burst, 1.0) * interval)) {}
+	/* the same rate and burst, and the same tokens left */
+	TokenBucket(TokenBucket const& other) noexcept
+		: interval(other.interval), tolerance(other.tolerance), full(other.full.load(std::memory_order_relaxed)) {}
+
+	bool 			TryAcquire(std::uint64_t tokens = 1, time_point now = clock_type::now()) noexcept {
+		std::int64_t const current { Detail::Ticks(now) }, cost { static_cast<std::int64_t>(tokens) * interval };
+		std::int64_t expected { full.load(std::memory_order_relaxed) };
+		do {
+			std::int64_t const next { std::max(expected, current) + cost };
+			if(next - current > tolerance)
+				return false;
+			if(full.compare_exchange_weak(expected, next, std::memory_order_relaxed))
+				return true;
+		} while(true);
+	}
+	/* how long until `tokens` could be taken, zero if they can be now */
+	duration_type 	WaitTime(std::uint64_t tokens = 1, time_point now = clock_type::now()) const noexcept {
+		std::int64_t const current { Detail::Ticks(now) };
+		std::int64_t const next { std::max(full.load(std::memory_order_relaxed), current) + static_cast<std::int64_t>(tokens) * interval };
+		return duration_type { std::max<std::int64_t>(next - current - tolerance, 0) };
+	}
+	double 			Available(time_point now = clock_type::now()) const noexcept {
+		std::int64_t const current { Detail::Ticks(now) };
+		return static_cast<double>(tolerance - (std::max(full.load(std::memory_order_relaxed), current) - current)) / interval;
+	}
+	/* a full bucket is as good as a new one, and can be forgotten */
+	bool 			Idle(time_point now = clock_type::now()) const noexcept
+	{ 	return full.load(std::memory_order_relaxed) <= Detail::Ticks(now);	}
+
+private:
+	std::int64_t const 						interval;
+	std::int64_t const 						tolerance;
+	std::atomic<std::int64_t> 				full 		{ 0 };
+};
+
+/*
+	A leaky bucket used as a queue: requests leave it exactly one interval
+	apart, and Reserve() tells each one how long to wait for its turn. Unlike
+	the token bucket nothing saved up lets a burst through at once; excess
+	load becomes a delay that grows smoothly up to `capacity` requests' worth
+	and is refused beyond it. Pair it with a timer:
+
+		if(auto const wait { bucket.Reserve() })
+			reactor.Schedule(* wait, [=] { Handle(request); });
+		else
+			Refuse(request);
+*/
+struct LeakyBucket {
+	typedef AdmissionClock 					clock_type;
+	typedef clock_type::time_point 			time_point;
+	typedef std::chrono::nanoseconds 		duration_type;
+
+	/* `rate` requests a second, with up to `capacity` of them waiting */
+	LeakyBucket(double rate, double capacity) noexcept
+		: interval(Detail::Interval(rate)), tolerance(static_cast<std::int64_t>(std::max(capacity, 0.0) * interval)) {}
+	LeakyBucket(LeakyBucket const& other) noexcept
+		: interval(other.interval), tolerance(other.tolerance), next(other.next.load(std::memory_order_relaxed)) {}
+
+	/* how long to wait before going ahead, nothing if the bucket is full */
+	std::optional<duration_type> 	Reserve(std::uint64_t count = 1, time_point now = clock_type::now()) noexcept {
+		std::int64_t const current { Detail::Ticks(now) };
+		std::int64_t expected { next.load(std::memory_order_relaxed) };
+		do {
+			std::int64_t const start { std::max(expected, current) };
+			if(start - current > tolerance)
+				return std::nullopt;
+			if(next.compare_exchange_weak(expected, start + static_cast<std::int64_t>(count) * interval, std::memory_order_relaxed))
+				return duration_type { start - current };
+		} while(true);
+	}
+	/* admits only what may go ahead at once, for callers that cannot wait */
+	bool 			TryAcquire(std::uint64_t count = 1, time_point now = clock_type::now()) noexcept {
+		std::int64_t const current { Detail::Ticks(now) };
+		std::int64_t expected { next.load(std::memory_order_relaxed) };
+		while(expected <= current)
+			if(next.compare_exchange_weak(expected, current + static_cast<std::int64_t>(count) * interval, std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+	/* requests still waiting for their turn */
+	double 			Pending(time_point now = clock_type::now()) const noexcept {
+		std::int64_t const current { Detail::Ticks(now) };
+		return static_cast<double>(std::max<std::int64_t>(next.load(std::memory_order_relaxed) - current, 0)) / interval;
+	}
+	bool 			Idle(time_point now = clock_type::now()) const noexcept
+	{ 	return next.load(std::memory_order_relaxed) <= Detail::Ticks(now);	}
+
+private:
+	std::int64_t const 						interval;
+	std::int64_t const 						tolerance;
+	std::atomic<std::int64_t> 				next 		{ 0 };
+};
+
+/*
+	Additive increase, multiplicative decrease: one more for every sample that
+	came back while the limit was at least half used, `backoff` times the limit
+	for every one that was dropped or slower than `timeout`. Finds the limit
+	quickly and reacts only to outright failure
+*/
+struct AIMDLimit {
+	double 						minimum 	{ 1 };
+	double 						maximum 	{ 1000 };
+	double 						backoff 	{ 0.9 };
+	std::chrono::nanoseconds 	timeout 	{ std::chrono::seconds(1) };
+
+	double Update(double limit, std::size_t inflight, std::chrono::nanoseconds latency, bool dropped) noexcept {
+		if(dropped || latency > timeout)
+			limit *= backoff;
+		else if(static_cast<double>(inflight) * 2 >= limit)
+			limit += 1;
+		return std::clamp(limit, minimum, maximum);
+	}
+};
+
+/*
+	Scales the limit by how far the recent latency strays from the long-term
+	one: gradient = tolerance * long / short, held within [0.5, 1], then
+	limit = limit * gradient + sqrt(limit), smoothed. While requests are
+	served as fast as usual the sqrt(limit) headroom lets the limit grow;
+	once they start to queue, the short average rises and the limit shrinks
+	before latency runs away. The long average drifts down while the short
+	one stays far below it, so it recovers after a slow period
+*/
+struct GradientLimit {
+	double 						minimum 	{ 1 };
+	double 						maximum 	{ 1000 };
+	/* how much slower than usual a sample may be before the limit shrinks */
+	double 						tolerance 	{ 1.5 };
+	double 						smoothing 	{ 0.2 };
+	/* samples remembered by the long-term and the recent average */
+	double 						history 	{ 600 };
+	double 						recent 		{ 10 };
+
+	double Update(double limit, std::size_t inflight, std::chrono::nanoseconds latency, bool dropped) noexcept {
+		double const sample { static_cast<double>(std::max<std::int64_t>(latency.count(), 1)) };
+		samples ++;
+		/* a plain mean while there are fewer samples than the window, an exponential one after */
+		longterm 	+= (sample - longterm) / std::min(static_cast<double>(samples), history);
+		shortterm 	+= (sample - shortterm) / std::min(static_cast<double>(samples), recent);
+		if(longterm / shortterm > 2)
+			longterm *= 0.95;
+		/* a limit that is not being used tells nothing about whether it is too high */
+		if(not dropped && static_cast<double>(inflight) * 2 < limit)
+			return limit;
+		double const gradient { dropped ? 0.5 : std::clamp(tolerance * longterm / shortterm, 0.5, 1.0) };
+		double const target { limit * gradient + std::sqrt(limit) };
+		return std::clamp(limit * (1 - smoothing) + target * smoothing, minimum, maximum);
+	}
+private:
+	double 						longterm 	{};
+	double 						shortterm 	{};
+	std::uint64_t 				samples 	{};
+};
+
+/*
+	At most Limit() requests in flight. Admission is one compare-exchange on
+	the in-flight count; each Release() reports how long the request took and
+	lets Algorithm move the limit. Releases that find another thread already
+	updating skip the update rather than wait for it, so neither side ever
+	blocks:
+
+		ConcurrencyLimiter<GradientLimit> limiter { 32 };
+		if(auto permit { limiter.Acquire() })
+			Handle(request);			// the permit reports the latency when it goes
+		else
+			Refuse(request);
+*/
+template <typename Algorithm = GradientLimit>
+struct ConcurrencyLimiter {
+	typedef AdmissionClock 					clock_type;
+	typedef clock_type::time_point 			time_point;
+	typedef std::chrono::nanoseconds 		duration_type;
+
+	/* one admitted request; releases it on destruction, as dropped if Drop() was called */
+	struct Permit : Utility::noncopyable {
+		Permit() noexcept = default;
+		Permit(Permit&& other) noexcept
+			: owner(std::exchange(other.owner, nullptr)), start(other.start), dropped(other.dropped) {}
+		Permit& operator=(Permit&& other) noexcept {
+			if(this != std::addressof(other)) {
+				Release();
+				owner 	= std::exchange(other.owner, nullptr);
+				start 	= other.start;
+				dropped = other.dropped;
+			}
+			return *this;
+		}
+		~Permit() noexcept 	{ 	Release(); 		}
+
+		explicit operator bool() const noexcept 	{ 	return owner != nullptr; 	}
+		/* the request failed in a way that means overload: timed out, was shed downstream */
+		void 	Drop() noexcept 	{ 	dropped = true; 	}
+		void 	Release() noexcept {
+			if(auto* const limiter { std::exchange(owner, nullptr) })
+				(* limiter).Release(clock_type::now() - start, dropped);
+		}
+	private:
+		friend struct ConcurrencyLimiter;
+		Permit(ConcurrencyLimiter* owner, time_point start) noexcept: owner(owner), start(start) {}
+
+		ConcurrencyLimiter* 				owner 	{ nullptr };
+		time_point 							start 	{};
+		bool 								dropped { false };
+	};
+
+	explicit ConcurrencyLimiter(double initial = 20, Algorithm algorithm = {}) noexcept
+		: algorithm(std::move(algorithm)), limit(initial) {}
+	/* the same limit and algorithm state, nothing in flight */
+	ConcurrencyLimiter(ConcurrencyLimiter const& other) noexcept
+		: algorithm(other.algorithm), limit(other.limit.load(std::memory_order_relaxed)) {}
+
+	bool 			TryAcquire() noexcept {
+		std::size_t current { inflight.load(std::memory_order_relaxed) };
+		do {
+			if(static_cast<double>(current) + 1 > limit.load(std::memory_order_relaxed))
+				return false;
+		} while(not inflight.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed));
+		return true;
+	}
+	Permit 			Acquire(time_point now = clock_type::now()) noexcept
+	{ 	return TryAcquire() ? Permit { this, now } : Permit {};		}
+
+	void 			Release(duration_type latency, bool dropped = false) noexcept {
+		std::size_t const current { inflight.fetch_sub(1, std::memory_order_release) };
+		if(updating.test_and_set(std::memory_order_acquire))
+			return;
+		limit.store(algorithm.Update(limit.load(std::memory_order_relaxed), current, latency, dropped), std::memory_order_relaxed);
+		updating.clear(std::memory_order_release);
+	}
+
+	std::size_t 	Limit() 	const noexcept 	{ 	return static_cast<std::size_t>(limit.load(std::memory_order_relaxed)); 	}
+	std::size_t 	InFlight() 	const noexcept 	{ 	return inflight.load(std::memory_order_relaxed); 	}
+	bool 			Idle(time_point = clock_type::now()) const noexcept 	{ 	return InFlight() == 0; 	}
+
+private:
+	Algorithm 								algorithm;
+	std::atomic<double> 					limit;
+	std::atomic<std::size_t> 				inflight 	{ 0 };
+	std::atomic_flag 						updating 	= ATOMIC_FLAG_INIT;
+};
+
+/*
+	One limiter per key, typically the client's address or its /24 or /64
+	(network_v4 { address, 24 }.canonical()), so a single client that floods
+	gets refused while everyone else is still let in. New keys start as a copy
+	of the prototype. The keys are spread over Shards maps, each under its own
+	mutex held only to find the limiter, and at most `capacity` keys are
+	tracked: past that, idle limiters are swept, and keys that still find no
+	room share one overflow limiter instead of growing the table. The hash is
+	seeded per process, so peers cannot choose addresses that land in one shard
+*/
+template <typename Key, typename Limiter, typename Hash = Utility::Hash<Key>>
+struct KeyedLimiter : Utility::noncopyable, Utility::nonmoveable {
+	typedef AdmissionClock 					clock_type;
+	typedef clock_type::time_point 			time_point;
+	static constexpr std::size_t 			Shards 		{ 64 };
+
+	explicit KeyedLimiter(Limiter const& prototype, std::size_t capacity = 1 << 16)
+		: prototype(prototype), overflow(prototype), quota(std::max<std::size_t>(capacity / Shards, 1)) {}
+
+	/* runs f on the key's limiter and returns what it returns */
+	template <typename F>
+	decltype(auto) 	Visit(Key const& key, F&& f, time_point now = clock_type::now()) {
+		Shard& shard { shards[static_cast<std::uint64_t>(Hash {}(key)) >> 58] };
+		std::lock_guard guard { shard.mutex };
+		auto found { shard.limiters.find(key) };
+		if(found == shard.limiters.end()) {
+			if(shard.limiters.size() >= quota)
+				(void) Sweep(shard, now);
+			if(shard.limiters.size() >= quota)
+				return std::forward<F>(f)(overflow);
+			found = shard.limiters.try_emplace(key, prototype).first;
+		}
+		return std::forward<F>(f)((* found).second);
+	}
+	template <typename... Args>
+	bool 			TryAcquire(Key const& key, Args&&... args) {
+		return Visit(key, [&] (Limiter& limiter) -> bool {
+			return limiter.TryAcquire(std::forward<Args>(args) ...);
+		});
+	}
+	/* for concurrency limiters: a permit bound to the key's limiter, which is not swept while it is held */
+	auto 			Acquire(Key const& key, time_point now = clock_type::now()) requires requires(Limiter& limiter, time_point at) { limiter.Acquire(at); } {
+		return Visit(key, [now] (Limiter& limiter) { return limiter.Acquire(now); }, now);
+	}
+
+	/* forgets every limiter that is idle, returns how many */
+	std::size_t 	Sweep(time_point now = clock_type::now()) {
+		std::size_t swept {};
+		for(Shard& shard: shards) {
+			std::lock_guard guard { shard.mutex };
+			swept += Sweep(shard, now);
+		}
+		return swept;
+	}
+	std::size_t 	Size() {
+		std::size_t size {};
+		for(Shard& shard: shards) {
+			std::lock_guard guard { shard.mutex };
+			size += shard.limiters.size();
+		}
+		return size;
+	}
+
+private:
+	struct alignas(64) Shard {
+		std::mutex 							mutex;
+		std::unordered_map<Key, Limiter, Hash> limiters;
+	};
+	static std::size_t 	Sweep(Shard& shard, time_point now) {
+		return std::erase_if(shard.limiters, [now] (auto const& entry) { return entry.second.Idle(now); });
+	}
+
+	Limiter const 							prototype;
+	Limiter 								overflow;
+	std::size_t const 						quota;
+	std::array<Shard, Shards> 				shards;
+};
+
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
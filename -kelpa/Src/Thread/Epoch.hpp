@@ -0,0 +1,245 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Epoch.hpp
+ * 		@Brief	Epoch-based memory reclamation for lock-free structures: readers pin
+ * 				the current epoch, writers retire unlinked objects into per-thread
+ * 				lists that are freed in batches two epochs later
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_EPOCH_HPP__
+#define __KELPA_THREAD_EPOCH_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <vector>					/* imports ./ {
+	std::vector
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::lock_guard,
+	std::unique_lock
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint64_t
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange
+}*/
+
+namespace Kelpa {
+namespace Thread {
+
+/*
+	{
+		Epoch::Guard guard;
+		Node* node { head.load(std::memory_order_acquire) };
+		... 								// node cannot be freed while pinned
+	}
+	if(head.compare_exchange_strong(node, next))
+		Epoch::Retire(node); 				// freed once no pinned thread can still see it
+
+	The global epoch only advances when every pinned thread has observed it, so
+	anything retired in epoch E is unreachable once the epoch reaches E + 2.
+	Each thread pays for reclamation every `Threshold` retirements; a thread that
+	exits hands its leftovers to a shared orphan list drained by the survivors
+*/
+struct Epoch {
+	struct Guard {
+		Guard(Guard const&) 			= delete;
+		Guard& operator=(Guard const&) 	= delete;
+
+		Guard() 	noexcept { 	Epoch::Enter(); 	}
+	   ~Guard() 	noexcept { 	Epoch::Leave(); 	}
+	};
+
+	static constexpr std::size_t Threshold { 64 };
+
+	template <typename T>
+	static void 		Retire(T* pointer)
+	{	Retire(pointer, [] (void* object) { delete static_cast<T *>(object); });	}
+	static void 		Retire(void* pointer, void(* deleter)(void *));
+
+	/* call where this thread holds no protected pointers, e.g. between two tasks */
+	static void 		Quiescent() noexcept;
+
+	static bool 		IsPinned() 	noexcept 	{ 	return Mine().nesting; 				}
+	/* objects retired by this thread and not freed yet */
+	static std::size_t 	Pending() 	noexcept 	{ 	return Mine().bag.size(); 			}
+	static std::uint64_t Current() 	noexcept 	{ 	return domain.epoch.load(std::memory_order_acquire); 	}
+private:
+	struct Retired {
+		void * 			pointer;
+		void(* 			deleter)(void *);
+		std::uint64_t 	epoch;
+	};
+
+	/* one per thread, never freed while the process runs and recycled across threads */
+	struct alignas(64) Record {
+		std::atomic<std::uint64_t> 	local 		{};			/* epoch << 1 | pinned */
+		std::atomic<bool> 			claimed 	{ true };
+		Record * 					next 		{ nullptr };
+		unsigned int 				nesting 	{};
+		std::size_t 				since 		{};
+		std::vector<Retired> 		bag;
+	};
+
+	struct Domain {
+	   ~Domain() noexcept {
+			for(Retired& retired: orphans)
+				retired.deleter(retired.pointer);
+		}
+
+		std::atomic<std::uint64_t> 	epoch 		{};
+		std::atomic<Record *> 		records 	{ nullptr };
+		std::atomic<std::size_t> 	orphaned 	{};
+		std::mutex 					mutex;
+		std::vector<Retired> 		orphans;
+	};
+
+	struct Local {
+		Local() noexcept;
+	   ~Local() noexcept;
+		Record* record;
+	};
+
+	static Record& Mine() noexcept {
+		thread_local Local local;
+		return * local.record;
+	}
+
+	static void Enter() noexcept;
+	static void Leave() noexcept;
+	static bool TryAdvance() noexcept;
+	static void Collect(std::vector<Retired>& bag) noexcept;
+	static void CollectOrphans() noexcept;
+
+	static Domain domain;
+};
+
+inline Epoch::Domain Epoch::domain {};
+
+inline Epoch::Local::Local() noexcept: record(nullptr) {
+	for(Record* current { domain.records.load(std::memory_order_acquire) }; current; current = (* current).next) {
+		bool expected { false };
+		if((* current).claimed.compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+			record = current;
+			return;
+		}
+	}
+	record = new Record {};
+	(* record).next = domain.records.load(std::memory_order_relaxed);
+	while(! domain.records.compare_exchange_weak((* record).next, record, std::memory_order_release, std::memory_order_relaxed));
+}
+
+inline Epoch::Local::~Local() noexcept {
+	(void) TryAdvance();
+	Collect((* record).bag);
+	if(! (* record).bag.empty()) {
+		std::lock_guard guard { domain.mutex };
+		for(Retired& retired: (* record).bag)
+			domain.orphans.push_back(retired);
+		domain.orphaned.store(domain.orphans.size(), std::memory_order_release);
+		(* record).bag.clear();
+	}
+	(* record).nesting 	= 0;
+	(* record).since 	= 0;
+	(* record).local.store(0, std::memory_order_release);
+	(* record).claimed.store(false, std::memory_order_release);
+}
+
+inline void Epoch::Enter() noexcept {
+	Record& record { Mine() };
+	if(record.nesting ++)
+		return;
+	/* publish, then make sure the epoch did not move under us; both sides are seq_cst so the re-read cannot pass the store */
+	std::uint64_t current { domain.epoch.load(std::memory_order_relaxed) };
+	while(true) {
+		record.local.store(current << 1 | 1, std::memory_order_seq_cst);
+		std::uint64_t const latest { domain.epoch.load(std::memory_order_seq_cst) };
+		if(latest == current)
+			return;
+		current = latest;
+	}
+}
+
+inline void Epoch::Leave() noexcept {
+	Record& record { Mine() };
+	if(-- record.nesting)
+		return;
+	record.local.store(0, std::memory_order_release);
+}
+
+inline bool Epoch::TryAdvance() noexcept {
+	std::uint64_t current { domain.epoch.load(std::memory_order_seq_cst) };
+	for(Record* record { domain.records.load(std::memory_order_acquire) }; record; record = (* record).next) {
+		std::uint64_t const local { (* record).local.load(std::memory_order_seq_cst) };
+		if((local & 1) && (local >> 1) != current)
+			return false;
+	}
+	return domain.epoch.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+/* bags are filled in epoch order, so the reclaimable part is always a prefix */
+inline void Epoch::Collect(std::vector<Retired>& bag) noexcept {
+	std::uint64_t const current { domain.epoch.load(std::memory_order_acquire) };
+	std::size_t 		ready 	{};
+	while(ready < bag.size() && bag[ready].epoch + 2 <= current)
+		ready ++;
+	if(! ready)
+		return;
+	/* deleters may retire again, so detach the batch before running them */
+	std::vector<Retired> batch { bag.begin(), bag.begin() + static_cast<std::ptrdiff_t>(ready) };
+	bag.erase(bag.begin(), bag.begin() + static_cast<std::ptrdiff_t>(ready));
+	for(Retired& retired: batch)
+		retired.deleter(retired.pointer);
+}
+
+inline void Epoch::CollectOrphans() noexcept {
+	if(! domain.orphaned.load(std::memory_order_acquire))
+		return;
+	std::vector<Retired> batch;
+{
+	std::unique_lock lock { domain.mutex, std::try_to_lock };
+	if(! lock.owns_lock())
+		return;
+	std::uint64_t const current { domain.epoch.load(std::memory_order_acquire) };
+	std::vector<Retired> keep;
+	for(Retired& retired: domain.orphans)
+		(retired.epoch + 2 <= current ? batch : keep).push_back(retired);
+	domain.orphans = std::move(keep);
+	domain.orphaned.store(domain.orphans.size(), std::memory_order_release);
+}
+	for(Retired& retired: batch)
+		retired.deleter(retired.pointer);
+}
+
+inline void Epoch::Retire(void* pointer, void(* deleter)(void *)) {
+	Record& record { Mine() };
+	record.bag.push_back({ pointer, deleter, domain.epoch.load(std::memory_order_seq_cst) });
+	if(++ record.since < Threshold)
+		return;
+	record.since = 0;
+	(void) TryAdvance();
+	Collect(record.bag);
+	CollectOrphans();
+}
+
+inline void Epoch::Quiescent() noexcept {
+	Record& record { Mine() };
+	if(record.nesting || (record.bag.empty() && ! domain.orphaned.load(std::memory_order_relaxed)))
+		return;
+	(void) TryAdvance();
+	Collect(record.bag);
+	CollectOrphans();
+}
+
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
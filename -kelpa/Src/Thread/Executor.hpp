@@ -1,7 +1,8 @@
 /** 
  * 		@Path 	Kelpa/Src/Thread/Executor.hpp
  * 		@Brief	High availability multi-configuration thread pool
- * 		@Dependency	../Utility/ { Interfaces.hpp, ScopeGuard.hpp }
+ * 		@Dependency	../Utility/ { Interfaces.hpp, ScopeGuard.hpp }, ./ { Epoch.hpp }
+ * 					./ { Admission.hpp } for the limiters SetAdmission() takes
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
@@ -19,11 +20,14 @@
 	std::future, 
 	std::packaged_task 
 }*/
-#include <list>						/* imports ./ { 
-	std::list 
+#include <deque>					/* imports ./ { 
+	std::deque 
+}*/
+#include <array>					/* imports ./ { 
+	std::array 
 }*/
 #include <queue>					/* imports ./ { 
-	std::priority_queue 
+	std::queue 
 }*/
 #include <cmath>					/* imports ./ { 
 	std::log 
@@ -56,6 +60,9 @@
 #include "../Utility/ScopeGuard.hpp"/* imports ./ { 
 	struct ScopeGuard 
 }*/
+#include "./Epoch.hpp"				/* imports ./ { 
+	struct Epoch 
+}*/
 
 #include <iostream>
 #include <syncstream>
@@ -120,6 +127,9 @@ struct FormulateHandle: IRefer<Executor> {
 	template<typename F, typename... Args, typename Rep = std::int64_t, typename Period = std::milli> requires std::invocable<F, Args ...>
 	FormulateHandle const& 	SetWaitingInterval(std::chrono::duration<Rep,Period> const& duration, F&&f, Args&&... args)  const noexcept;
 	FormulateHandle const& 	SetDynamicUpdateRange(signed int min, signed int max) 	const noexcept;	
+	FormulateHandle const& 	SetPriorityWeights(signed int unhurried, signed int standard, signed int urgent, signed int harsh) 	const noexcept;
+	template<typename Limiter> requires requires(Limiter& limiter) { { limiter.TryAcquire() } -> std::convertible_to<bool>; }
+	FormulateHandle const& 	SetAdmission(Limiter& limiter) 							const noexcept;
 };
 
 struct Executor: Utility::noncopyable, Utility::nonmoveable {
@@ -137,15 +147,26 @@ private:
 bool 	ShrinkSome(signed int) 				noexcept;
 bool 	ExtendSome(signed int) 				noexcept; 	
 
-	typedef typename std::list<Executable>::iterator 	Iterator;
-	struct Compare {
-		bool operator()(Iterator one, Iterator two) const noexcept
-		{	return std::greater<>{} (* one, * two);		} 
-	};
-	std::list<Executable>								Container;
-	std::priority_queue<
-		Iterator, 	std::vector<Iterator>,	Compare
-		>												Indexer;
+/*
+	One FIFO lane per priority, served by weighted round-robin: every lane 
+	spends one credit per dequeue and credits are refilled from `Weights` 
+	once no non-empty lane has any left, so lower priorities keep making progress
+*/
+	static constexpr std::size_t 						Levels 		{ static_cast<std::size_t>(Priority::HARSH) + 1 };
+	Executable 	Dequeue() 							noexcept;
+	bool 		DiscardOldest() 					noexcept;
+
+/*
+	Admission control, see SetAdmission(). Declared ahead of the lanes: tasks 
+	still queued when the executor goes report to `settle` as they are destroyed
+*/
+	struct 		Admitted;
+	std::function<bool()>								admit 		{ nullptr };
+	std::function<void(std::chrono::nanoseconds, bool)>	settle 		{ nullptr };
+
+	std::array<std::deque<Executable>, Levels>			Lanes;
+	std::array<signed int, Levels>						Weights 	{ 0, 1, 2, 4, 8 };
+	std::array<signed int, Levels>						Credits 	{ 0, 1, 2, 4, 8 };
 	RejectedPolicy										policy 		{ RejectedPolicy::ABORT };
 	signed int 											throttle 	{ (signed int) (std::thread::hardware_concurrency() << 1 | 1) };
 	
@@ -175,6 +196,29 @@ bool 	ExtendSome(signed int) 				noexcept;
 	std::atomic<signed int>								shrink		{};
 	std::queue<std::size_t>								expire		{};
 };
+/* 
+	travels with an admitted task and hands its slot back: with the time since
+	Submit() once it has run, or as dropped if it is discarded unrun
+*/
+struct Executor::Admitted {
+	explicit Admitted(Executor* owner) noexcept: owner(owner) {}
+	Admitted(Admitted&& other) noexcept: owner(std::exchange(other.owner, nullptr)), start(other.start) {}
+	Admitted& operator=(Admitted&& other) noexcept {
+		Settle(true);
+		owner = std::exchange(other.owner, nullptr);
+		start = other.start;
+		return *this;
+	}
+   ~Admitted() noexcept 	{ 	Settle(true); 	}
+
+	void Settle(bool dropped) noexcept {
+		if(Executor* const executor { std::exchange(owner, nullptr) }; executor && (* executor).settle) 
+			(* executor).settle(std::chrono::steady_clock::now() - start, dropped);
+	}
+private:
+	Executor* 								owner;
+	std::chrono::steady_clock::time_point 	start 	{ std::chrono::steady_clock::now() };
+};
 Executor::Executor() noexcept: busyloop([this] (std::size_t index) mutable {
 	survive ++;
 	Utility::ScopeGuard elapse( [this] { 
@@ -214,17 +258,11 @@ Executor::Executor() noexcept: busyloop([this] (std::size_t index) mutable {
 			}
 			if(! active.load(std::memory_order_seq_cst) ) return;	
 		}
-		if((* Indexer.top()).priority == Priority::DISCARD) {
-			(* Indexer.top()).assignment.make_ready_at_thread_exit();
-			Container.erase(Indexer.top());	Indexer.pop();
-			continue;
-		}
-		assignment = std::move((* Indexer.top()).assignment);
-		Container.erase(Indexer.top());		Indexer.pop();
+		assignment = std::move(Dequeue().assignment);
 		
 		rest --;			unique.unlock();
 		engage ++;	 		assignment();			
-		engage --;	 				
+		engage --;	 		Epoch::Quiescent();	/* between tasks the worker holds no protected pointers */
 	}	
 }), watchloop([this] {
 	static auto dyn_dura = duration;
@@ -237,6 +275,34 @@ Executor::Executor() noexcept: busyloop([this] (std::size_t index) mutable {
 			std::this_thread::sleep_for(std::exchange(dyn_dura, std::chrono::milliseconds((std::uint_least64_t) std::log2(dyn_dura.count() + 60)))); 
 	} 
 }) {}
+Executable Executor::Dequeue() noexcept {
+	for(signed int round {}; round < 2; round ++) {
+		for(std::size_t level { Levels }; -- level > static_cast<std::size_t>(Priority::DISCARD); ) {
+			if(Lanes[level].empty() || Credits[level] <= 0) 
+				continue;
+			Credits[level] --;
+			Executable executable { std::move(Lanes[level].front()) };
+			Lanes[level].pop_front();
+			return executable;
+		}
+		Credits = Weights;
+	}
+	/* all non-empty lanes are weighted zero: fall back to strict priority */
+	std::size_t level { Levels };
+	while(Lanes[-- level].empty());
+	Executable executable { std::move(Lanes[level].front()) };
+	Lanes[level].pop_front();
+	return executable;
+}
+bool Executor::DiscardOldest() noexcept {
+	for(std::size_t level { static_cast<std::size_t>(Priority::UNHURRIED) }; level < Levels; level ++) {
+		if(Lanes[level].empty()) 
+			continue;
+		Lanes[level].pop_front();
+		return true;
+	}
+	return false;
+}
 bool Executor::ShrinkSome(signed int many) noexcept {
 	if(many <= 0 || survive <= min) 		
 		return false;
@@ -307,6 +373,30 @@ FormulateHandle const& 			FormulateHandle::SetDynamicUpdateRange(signed int min,
 	return *this;
 }	
 
+FormulateHandle const& 			FormulateHandle::SetPriorityWeights(signed int unhurried, signed int standard, signed int urgent, signed int harsh) const noexcept {
+	deref().Weights = deref().Credits = { 0, unhurried, standard, urgent, harsh };
+	return *this;
+}
+
+/*
+	Consults `limiter` before queueing anything but HARSH tasks, which keep the
+	pool itself running. A refused task meets the rejection policy exactly as one
+	over the throttle does, DISCARD_OLDEST trying once more after dropping the 
+	oldest task. Limiters with Release(latency, dropped), as ConcurrencyLimiter,
+	also learn how long every admitted task took from Submit() to completion, 
+	queueing included, so a backlog lowers the limit before it grows long. 
+	The limiter must outlive the executor; set it before the first Submit()
+*/
+template<typename Limiter> requires requires(Limiter& limiter) { { limiter.TryAcquire() } -> std::convertible_to<bool>; }
+FormulateHandle const& 			FormulateHandle::SetAdmission(Limiter& limiter) 			const noexcept {
+	deref().admit = [&limiter] { return static_cast<bool>(limiter.TryAcquire()); };
+	if constexpr (requires { limiter.Release(std::chrono::nanoseconds {}, true); })
+		deref().settle = [&limiter] (std::chrono::nanoseconds latency, bool dropped) { limiter.Release(latency, dropped); };
+	else 
+		deref().settle = nullptr;
+	return *this;
+}
+
 SubmitHandle ActiveHandle::Activate() const noexcept {
 	deref().active.store(true, std::memory_order_seq_cst);
 	
@@ -329,31 +419,42 @@ auto SubmitHandle::Submit(Priority priority, F&& f, Args&& ...args) const
 	-> std::future<std::invoke_result_t<F, Args ...>>{
 	using ReturnType = std::invoke_result_t<F, Args ...>;
 	
-	std::shared_lock share { deref().mutex };
-	if(deref().rest.load(std::memory_order_seq_cst) == deref().throttle) {
+	if(priority == Priority::DISCARD) 
+		return std::future<ReturnType> {};
+
+	/* the admission check runs outside the lock; a slot it takes is given back by `admitted` on every way out */
+	bool const 			controlled 	{ priority != Priority::HARSH && deref().admit };
+	bool 				admissible 	{ ! controlled || deref().admit() };
+	Executor::Admitted 	admitted 	{ controlled && admissible ? std::addressof(deref()) : nullptr };
+
+	std::unique_lock unique { deref().mutex };
+	if(! admissible && deref().policy == RejectionPolicy::DISCARD_OLDEST && deref().DiscardOldest()) {
+		deref().rest --;
+		if((admissible = deref().admit()))
+			admitted = Executor::Admitted { std::addressof(deref()) };
+	}
+	if(! admissible || deref().rest.load(std::memory_order_seq_cst) >= deref().throttle) {
 		if(deref().policy == RejectionPolicy::ABORT) 
-			throw RejectedExecutionError { "too many tasks" };
+			throw RejectedExecutionError { admissible ? "too many tasks" : "refused by admission control" };
 		if(deref().policy == RejectionPolicy::CALLER_RUNS) 
 			return std::async(std::launch::deferred, std::forward<F>(f), std::forward<Args>(args) ...);
-		if(deref().policy == RejectionPolicy::DISCARD) 
+		if(deref().policy == RejectionPolicy::DISCARD || ! admissible) 
 			return std::future<ReturnType> {};
-		if(deref().policy == RejectionPolicy::DISCARD_OLDEST) {
-			(void) std::exchange(deref().Container.front().priority, Priority::DISCARD);
+		if(deref().policy == RejectionPolicy::DISCARD_OLDEST && deref().DiscardOldest()) 
 			deref().rest --;
-		}
 	}
-	share.unlock();
 	
 	auto temporary = std::make_shared<std::packaged_task<ReturnType()>>(
 		std::bind(std::forward<F>(f), std::forward<Args>(args) ...)
 	);
 	auto future = (* temporary).get_future();
-{
-	std::lock_guard guard { deref().mutex };
-	deref().Container.emplace_back(priority, [temporary] { (void) std::invoke(* temporary); });
-	deref().Indexer.emplace(std::prev(deref().Container.end()));
-}	
-	deref().rest ++;	deref().condition.notify_one();
+	deref().Lanes[static_cast<std::size_t>(priority)].emplace_back(priority, [temporary, admitted = std::move(admitted)] () mutable { 
+		(void) std::invoke(* temporary); 
+		admitted.Settle(false);
+	});
+	deref().rest ++;	unique.unlock();
+	
+	deref().condition.notify_one();
 	return future;	
 }
 	
@@ -0,0 +1,219 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Futex.hpp
+ * 		@Brief	Lightweight synchronization primitives parking on std::atomic::wait
+ * 				(a futex on Linux): counting semaphore, latch, barrier and event count
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_FUTEX_HPP__
+#define __KELPA_THREAD_FUTEX_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic,
+	std::atomic::wait,
+	std::atomic::notify_xxx
+}*/
+#include <cstddef>					/* imports ./ {
+	std::ptrdiff_t
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint32_t
+}*/
+#include <thread>					/* imports ./ {
+	std::this_thread::yield
+}*/
+#include <utility>					/* imports ./ {
+	std::move
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Detail {
+
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/* spins for a while before parking, returns as soon as `ready` holds */
+template <typename T, typename Predicate>
+void SpinThenWait(std::atomic<T> const& atomic, Predicate&& ready, unsigned spins = 64) noexcept {
+	for(unsigned round {}; round < spins; round ++) {
+		if(ready(atomic.load(std::memory_order_acquire)))
+			return;
+		CpuRelax();
+	}
+	for(T value { atomic.load(std::memory_order_acquire) }; ! ready(value); value = atomic.load(std::memory_order_acquire))
+		atomic.wait(value, std::memory_order_acquire);
+}
+
+}
+
+struct CountingSemaphore {
+	CountingSemaphore(CountingSemaphore const&) 			= delete;
+	CountingSemaphore& operator=(CountingSemaphore const&) 	= delete;
+
+	constexpr explicit CountingSemaphore(std::ptrdiff_t initial = {}) noexcept: count(initial) {}
+
+	bool TryAcquire() noexcept {
+		std::ptrdiff_t value { count.load(std::memory_order_relaxed) };
+		while(value > 0)
+			if(count.compare_exchange_weak(value, value - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+
+	void Acquire() noexcept {
+		for(unsigned round {}; round < 64; round ++) {
+			if(TryAcquire())
+				return;
+			Detail::CpuRelax();
+		}
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		while(! TryAcquire())
+			count.wait(0, std::memory_order_seq_cst);
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void Release(std::ptrdiff_t update = 1) noexcept {
+		count.fetch_add(update, std::memory_order_seq_cst);
+		/* uncontended path: nobody parked, no syscall */
+		if(! waiters.load(std::memory_order_seq_cst))
+			return;
+		if(update == 1) count.notify_one();
+		else 			count.notify_all();
+	}
+
+	std::ptrdiff_t GetValue() const noexcept
+	{	return count.load(std::memory_order_relaxed);	}
+private:
+	std::atomic<std::ptrdiff_t> 		count;
+	std::atomic<std::uint32_t> 			waiters 	{};
+};
+
+struct Latch {
+	Latch(Latch const&) 			= delete;
+	Latch& operator=(Latch const&) 	= delete;
+
+	constexpr explicit Latch(std::ptrdiff_t expected) noexcept: count(expected) {}
+
+	void CountDown(std::ptrdiff_t update = 1) noexcept {
+		if(count.fetch_sub(update, std::memory_order_acq_rel) == update)
+			count.notify_all();
+	}
+
+	bool TryWait() const noexcept
+	{	return ! count.load(std::memory_order_acquire);		}
+
+	void Wait() const noexcept
+	{	Detail::SpinThenWait(count, [] (std::ptrdiff_t value) { return ! value; });		}
+
+	void ArriveAndWait(std::ptrdiff_t update = 1) noexcept {
+		CountDown(update);
+		Wait();
+	}
+private:
+	std::atomic<std::ptrdiff_t> 		count;
+};
+
+struct NoopCompletion {
+	constexpr void operator()() const noexcept {}
+};
+
+template <typename Completion = NoopCompletion> struct Barrier {
+	Barrier(Barrier const&) 			= delete;
+	Barrier& operator=(Barrier const&) 	= delete;
+
+	constexpr explicit Barrier(std::ptrdiff_t expected, Completion completion = {}) noexcept
+		: expected(expected), remaining(expected), completion(std::move(completion)) {}
+
+	/* the last thread to arrive runs the completion and opens the next phase */
+	void ArriveAndWait() noexcept {
+		std::uint32_t const current { phase.load(std::memory_order_acquire) };
+		if(Arrive())
+			return;
+		Detail::SpinThenWait(phase, [current] (std::uint32_t value) { return value != current; });
+	}
+
+	void ArriveAndDrop() noexcept {
+		expected.fetch_sub(1, std::memory_order_relaxed);
+		(void) Arrive();
+	}
+private:
+	bool Arrive() noexcept {
+		if(remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return false;
+		completion();
+		remaining.store(expected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		phase.fetch_add(1, std::memory_order_release);
+		phase.notify_all();
+		return true;
+	}
+
+	std::atomic<std::ptrdiff_t> 		expected;
+	std::atomic<std::ptrdiff_t> 		remaining;
+	std::atomic<std::uint32_t> 			phase 		{};
+	Completion 							completion;
+};
+
+/*
+	Lets a consumer of a lock-free queue park without losing wakeups:
+
+		auto key = events.PrepareWait();
+		if(queue.TryPop(item)) 	events.CancelWait();
+		else 					events.Wait(key);
+
+	producers call Notify() after publishing, which costs a fence and a load
+	when nobody is parked
+*/
+struct EventCount {
+	struct Key { std::uint32_t epoch; };
+
+	EventCount(EventCount const&) 				= delete;
+	EventCount& operator=(EventCount const&) 	= delete;
+	constexpr EventCount() 	noexcept 			= default;
+
+	Key PrepareWait() noexcept {
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		return { epoch.load(std::memory_order_seq_cst) };
+	}
+
+	void CancelWait() noexcept
+	{	waiters.fetch_sub(1, std::memory_order_seq_cst);	}
+
+	void Wait(Key key) noexcept {
+		Detail::SpinThenWait(epoch, [key] (std::uint32_t value) { return value != key.epoch; }, 16);
+		waiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	void Notify() noexcept {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(! waiters.load(std::memory_order_seq_cst))
+			return;
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		epoch.notify_one();
+	}
+
+	void NotifyAll() noexcept {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(! waiters.load(std::memory_order_seq_cst))
+			return;
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		epoch.notify_all();
+	}
+private:
+	std::atomic<std::uint32_t> 			epoch 		{};
+	std::atomic<std::uint32_t> 			waiters 	{};
+};
+
+}
+}
+
+#endif
@@ -10,6 +10,8 @@
 #define __KELPA_THREAD_SEMAPHORE_HPP__
 
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 namespace Kelpa {
 namespace Thread {
@@ -39,9 +41,10 @@ template <typename Mutex = std::mutex> struct Semaphore {
 	}
 	
 	constexpr bool TryWait() noexcept {
-		if(value.fetch_sub(1, std::memory_order_relaxed) > 0) return true;
-		value.fetch_add(1, std::memory_order_relaxed);
-		return false;
+		std::unique_lock lock {mutex};
+		if(value <= 0) return false;
+		value --;
+		return true;
 	}
 	
 private:
@@ -0,0 +1,133 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/SeqLock.hpp
+ * 		@Brief	Sequence lock for small trivially-copyable values: readers copy
+ * 				optimistically and retry on a concurrent write, never storing anything
+ * 		@Dependency	./ { Futex.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_SEQLOCK_HPP__
+#define __KELPA_THREAD_SEQLOCK_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <bit>						/* imports ./ {
+	std::bit_cast
+}*/
+#include <cstring>					/* imports ./ {
+	std::memcpy
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint64_t
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <type_traits>				/* imports ./ {
+	std::is_trivially_copyable_v
+}*/
+#include "./Futex.hpp"				/* imports ./ {
+	Detail::CpuRelax
+}*/
+
+namespace Kelpa {
+namespace Thread {
+
+/*
+	The payload is kept in atomic words so a torn read is merely discarded
+	rather than being a data race: odd sequence numbers mean a write is in
+	progress, and a reader retries whenever the number moved under it
+*/
+template <typename T> requires std::is_trivially_copyable_v<T> struct SeqLock {
+	SeqLock(SeqLock const&) 			= delete;
+	SeqLock& operator=(SeqLock const&) 	= delete;
+
+	explicit SeqLock(T const& value = T {}) noexcept 	{ 	Write(value); 	}
+
+	T Load() const noexcept {
+		while(true) {
+			std::uint64_t const before { sequence.load(std::memory_order_acquire) };
+			if(before & 1) {
+				Detail::CpuRelax();
+				continue;
+			}
+			Bytes const bytes { Read() };
+			if(sequence.load(std::memory_order_relaxed) == before)
+				return Decode(bytes);
+		}
+	}
+
+	template <typename F> requires std::invocable<F, T const&>
+	decltype(auto) Visit(F&& f) const
+	{	return std::invoke(std::forward<F>(f), Load());		}
+
+	void Store(T const& value) noexcept {
+		Lock();
+		Write(value);
+		Unlock();
+	}
+
+	T Exchange(T const& value) noexcept {
+		Lock();
+		T const previous { Decode(Read()) };
+		Write(value);
+		Unlock();
+		return previous;
+	}
+
+	template <typename F> requires std::invocable<F, T&>
+	void Update(F&& f) noexcept(std::is_nothrow_invocable_v<F, T&>) {
+		Lock();
+		T value { Decode(Read()) };
+		std::invoke(std::forward<F>(f), value);
+		Write(value);
+		Unlock();
+	}
+private:
+	static constexpr std::size_t Words { (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t) };
+	typedef std::array<std::uint64_t, Words> Bytes;
+
+	static T Decode(Bytes const& bytes) noexcept {
+		std::array<unsigned char, sizeof(T)> raw;
+		std::memcpy(raw.data(), bytes.data(), sizeof(T));
+		return std::bit_cast<T>(raw);
+	}
+
+	/* acquire loads keep the closing sequence check behind the payload */
+	Bytes Read() const noexcept {
+		Bytes bytes;
+		for(std::size_t index {}; index < Words; index ++)
+			bytes[index] = words[index].load(std::memory_order_acquire);
+		return bytes;
+	}
+
+	/* release stores: a reader that sees new data also sees the odd sequence */
+	void Write(T const& value) noexcept {
+		Bytes bytes {};
+		std::memcpy(bytes.data(), &value, sizeof(T));
+		for(std::size_t index {}; index < Words; index ++)
+			words[index].store(bytes[index], std::memory_order_release);
+	}
+
+	void Lock() noexcept {
+		std::uint64_t current { sequence.load(std::memory_order_relaxed) };
+		while((current & 1) || ! sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+			Detail::CpuRelax();
+			current = sequence.load(std::memory_order_relaxed);
+		}
+	}
+	void Unlock() noexcept 	{ 	sequence.fetch_add(1, std::memory_order_release); 	}
+
+	std::atomic<std::uint64_t> 						sequence 	{};
+	std::array<std::atomic<std::uint64_t>, Words> 	words 		{};
+};
+
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
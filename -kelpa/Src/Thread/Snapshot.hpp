@@ -0,0 +1,127 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Snapshot.hpp
+ * 		@Brief	Read-copy-update cell: readers pin an immutable version without
+ * 				locking, writers publish a fresh copy and retire the old one
+ * 		@Dependency	./ { Epoch.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_SNAPSHOT_HPP__
+#define __KELPA_THREAD_SNAPSHOT_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::lock_guard
+}*/
+#include <memory>					/* imports ./ {
+	std::unique_ptr,
+	std::make_unique
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <concepts>					/* imports ./ {
+	std::invocable
+}*/
+#include <type_traits>				/* imports ./ {
+	std::is_void_v,
+	std::invoke_result_t
+}*/
+#include "./Epoch.hpp"				/* imports ./ {
+	struct Epoch
+}*/
+
+namespace Kelpa {
+namespace Thread {
+
+/*
+	{
+		auto version = snapshot.Read(); 	// pinned, no lock, no shared write
+		use(version -> field);
+	}
+	snapshot.Update([] (T& copy) { copy.field = ...; });
+
+	a reader only touches its own epoch record, so readers never contend with
+	each other; writers are serialized and pay for a full copy
+*/
+template <typename T> struct Snapshot {
+	struct Reader {
+		Reader(Reader const&) 				= delete;
+		Reader& operator=(Reader const&) 	= delete;
+
+		T const& 	operator*() 	const noexcept 	{ 	return * pointer; 	}
+		T const* 	operator->() 	const noexcept 	{ 	return pointer; 	}
+		T const* 	get() 			const noexcept 	{ 	return pointer; 	}
+	private:
+		friend struct Snapshot;
+		explicit Reader(std::atomic<T *> const& source) noexcept
+			: pointer(source.load(std::memory_order_acquire)) {}
+
+		/* pinned before the pointer is loaded */
+		Epoch::Guard 	guard;
+		T const * 		pointer;
+	};
+
+	Snapshot(Snapshot const&) 				= delete;
+	Snapshot& operator=(Snapshot const&) 	= delete;
+
+	template <typename... Args> requires std::constructible_from<T, Args ...>
+	explicit Snapshot(Args&&... args): current(new T(std::forward<Args>(args) ...)) {}
+   ~Snapshot() noexcept { 	delete current.load(std::memory_order_relaxed); 	}
+
+	/* the version stays valid as long as the reader lives */
+	Reader 	Read() 	const noexcept 	{ 	return Reader { current }; 	}
+	T 		Load() 	const 			{ 	return * Read(); 			}
+
+	template <typename F> requires std::invocable<F, T const&>
+	decltype(auto) Visit(F&& f) const {
+		Reader version { current };
+		return std::invoke(std::forward<F>(f), * version);
+	}
+
+	void Store(T value) {
+		std::lock_guard guard { writer };
+		Publish(std::make_unique<T>(std::move(value)));
+	}
+
+	T Exchange(T value) {
+		std::lock_guard guard { writer };
+		Epoch::Guard 	pinned;
+		T const* previous { Publish(std::make_unique<T>(std::move(value))) };
+		return * previous;
+	}
+
+	/* copy, modify, publish */
+	template <typename F> requires std::invocable<F, T&>
+	decltype(auto) Update(F&& f) {
+		std::lock_guard guard { writer };
+		auto next { std::make_unique<T>(* current.load(std::memory_order_relaxed)) };
+		if constexpr (std::is_void_v<std::invoke_result_t<F, T&>>) {
+			std::invoke(std::forward<F>(f), * next);
+			(void) Publish(std::move(next));
+		} else {
+			auto result { std::invoke(std::forward<F>(f), * next) };
+			(void) Publish(std::move(next));
+			return result;
+		}
+	}
+private:
+	/* the returned version is retired, callers must be pinned to dereference it */
+	T const* Publish(std::unique_ptr<T> next) {
+		T* previous { current.exchange(next.release(), std::memory_order_acq_rel) };
+		Epoch::Retire(previous);
+		return previous;
+	}
+
+	std::atomic<T *> 		current;
+	std::mutex 				writer;
+};
+
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -1,6 +1,6 @@
 /** 
- * 		@Path 	Kelpa/Src/Thread/SyncQueue.hpp
- * 		@Brief	Thread-safe counter holding a lock	
+ * 		@Path 	Kelpa/Src/Thread/Sync/Counter.hpp
+ * 		@Brief	Lock-free counters, gauges and min/max kept in per-thread striped cells
  * 		@Dependency	None
  * 		@Since  2024/04/25
  * 		@Version 1st
@@ -8,39 +8,147 @@
 
 #ifndef __KELPA_THREAD_SYNCCOUNTER_HPP__
 #define __KELPA_THREAD_SYNCCOUNTER_HPP__
-#include <shared_mutex>				/* imports ./ { 
-	std::shared_mutex, 
-	std::shared_lock 
-	./mutex/ { std::unique_lock } 
+#include <atomic>					/* imports ./ { 
+	std::atomic, 
+	std::memory_order 
 }*/
-#include <utility>					/* imports ./ { 
-	std::exchange 
+#include <array>					/* imports ./ { 
+	std::array 
+}*/
+#include <limits>					/* imports ./ { 
+	std::numeric_limits 
+}*/
+#include <cstdint>					/* imports ./ { 
+	std::int64_t 
 }*/
 namespace Kelpa {
 namespace Thread {
 namespace Sync {
+namespace Detail {
+	
+/* threads are dealt stripes round-robin on first use, so up to N writers never share a line */
+inline std::size_t StripeIndex() noexcept {
+	static std::atomic<std::size_t> 	next 	{};
+	thread_local std::size_t const 		index 	{ next.fetch_add(1, std::memory_order_relaxed) };
+	return index;
+}
+template <typename T> struct alignas(64) Stripe {
+	std::atomic<T> 		value;
+};
+
+template <typename T, std::size_t N> requires (N > 0 && (N & (N - 1)) == 0) struct Striped {
+	Striped(Striped const&) 				= delete;
+	Striped& operator=(Striped const&) 		= delete;
+	
+	explicit Striped(T initial = {}) noexcept { 
+		for(auto& stripe: stripes) 
+			stripe.value.store(initial, std::memory_order_relaxed); 
+	}
+protected:
+	std::atomic<T>& Local() noexcept 
+	{	return stripes[StripeIndex() & (N - 1)].value;		}
+
+	template <typename Combine>
+	T Fold(T initial, Combine&& combine) const noexcept {
+		for(auto const& stripe: stripes) 
+			initial = combine(initial, stripe.value.load(std::memory_order_relaxed));
+		return initial;
+	}
+	template <typename Combine>
+	T Drain(T initial, T identity, Combine&& combine) noexcept {
+		for(auto& stripe: stripes) 
+			initial = combine(initial, stripe.value.exchange(identity, std::memory_order_relaxed));
+		return initial;
+	}
+	
+	std::array<Stripe<T>, N> 	stripes;
+};
+
+}
+
+/* 
+	Sums per-thread, cache-line padded stripes on read: add() is one relaxed 
+	fetch_add on the caller's own stripe, read() and reset() walk all of them 
+	and are not linearizable with concurrent writers
+*/
+template <typename T = std::int64_t, std::size_t N = 64> struct StripedCounter: Detail::Striped<T, N> {
+	StripedCounter() 	noexcept: Detail::Striped<T, N>(T {}) {}
+	
+	void add(T value) 		noexcept 
+	{	this -> Local().fetch_add(value, std::memory_order_relaxed);		}
+	void increment() 		noexcept 
+	{	add(T { 1 });	}
+	void decrement() 		noexcept 
+	{	add(static_cast<T>(-1));	}
+	T read() 				const noexcept 
+	{	return this -> Fold(T {}, [] (T sum, T value) { return sum + value; });	}
+	T reset() 				noexcept 
+	{	return this -> Drain(T {}, T {}, [] (T sum, T value) { return sum + value; });		}
+};
+
+/* 
+	An up-down counter. set() swaps the value into the caller's stripe and 
+	zero into every other one, so each add() lands wholly before or after the 
+	swap of its own stripe and none is half-counted; across stripes it is no 
+	more linearizable than reset() 
+*/
+template <typename T = std::int64_t, std::size_t N = 64> struct StripedGauge: StripedCounter<T, N> {
+	void set(T value) 		noexcept {
+		std::size_t const 	local 	{ Detail::StripeIndex() & (N - 1) };
+		for(std::size_t index {}; index < N; index ++) 
+			this -> stripes[index].value.exchange(index == local ? value : T {}, std::memory_order_relaxed);
+	}
+};
+
+template <typename T = std::int64_t, std::size_t N = 64> struct StripedMax: Detail::Striped<T, N> {
+	StripedMax() 		noexcept: Detail::Striped<T, N>(std::numeric_limits<T>::lowest()) {}
+	
+	void add(T value) 		noexcept {
+		auto& 	local 	= this -> Local();
+		T 		current { local.load(std::memory_order_relaxed) };
+		while(value > current && ! local.compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+	T read() 				const noexcept 
+	{	return this -> Fold(std::numeric_limits<T>::lowest(), [] (T one, T two) { return one < two ? two : one; });	}
+	T reset() 				noexcept {
+		return this -> Drain(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), 
+			[] (T one, T two) { return one < two ? two : one; });
+	}
+};
+
+template <typename T = std::int64_t, std::size_t N = 64> struct StripedMin: Detail::Striped<T, N> {
+	StripedMin() 		noexcept: Detail::Striped<T, N>(std::numeric_limits<T>::max()) {}
+	
+	void add(T value) 		noexcept {
+		auto& 	local 	= this -> Local();
+		T 		current { local.load(std::memory_order_relaxed) };
+		while(value < current && ! local.compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+	T read() 				const noexcept 
+	{	return this -> Fold(std::numeric_limits<T>::max(), [] (T one, T two) { return two < one ? two : one; });	}
+	T reset() 				noexcept {
+		return this -> Drain(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), 
+			[] (T one, T two) { return two < one ? two : one; });
+	}
+};
 	
 struct  SyncCounter{
 	SyncCounter(SyncCounter const&) 				= delete;
 	SyncCounter& operator=(SyncCounter const&) 		= delete;
 	
     SyncCounter() 						noexcept 	= default;
- 	SyncCounter(unsigned int __value) 	noexcept: value(__value) {}
+ 	SyncCounter(unsigned int __value) 	noexcept 	{ counter.add(__value); }
     unsigned int get() 		const noexcept {
-        std::shared_lock lock(mutex);
-        return value;
+        return counter.read();
     }
     void increment() 		noexcept {
-        std::unique_lock lock(mutex);
-        value ++;
+        counter.increment();
     }
     unsigned int reset()	noexcept {
-        std::unique_lock lock(mutex);
-        return std::exchange(value, 0);
+        return counter.reset();
     }
 private:
-    mutable std::shared_mutex 	mutex;
-    unsigned int 				value	{};
+    StripedCounter<unsigned int> 	counter;
 };	
 	
 }		//namespace Sync
@@ -1,7 +1,185 @@
-/** 
+/**
  * 		@Path 	Kelpa/Src/Thread/Sync/List.hpp
- * 		@Brief	Thread-safe list holding a lock	
+ * 		@Brief	Singly linked list with one lock per node (hand-over-hand locking)
  * 		@Dependency	None
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
+
+#ifndef __KELPA_THREAD_SYNCLIST_HPP__
+#define __KELPA_THREAD_SYNCLIST_HPP__
+
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::unique_lock,
+	std::lock_guard
+}*/
+#include <memory>					/* imports ./ {
+	std::shared_ptr,
+	std::unique_ptr,
+	std::make_shared,
+	std::make_unique
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <concepts>					/* imports ./ {
+	std::predicate,
+	std::invocable
+}*/
+#include <utility>					/* imports ./ {
+	std::as_const,
+	std::move
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Every traversal holds at most two adjacent node locks, so inserts and
+	removals in different parts of the list proceed in parallel. Elements are
+	handed out as shared_ptr: a value found by find_first_if stays valid even
+	if another thread removes it from the list afterwards
+*/
+template <typename T, typename Mutex = std::mutex> struct List {
+	typedef T 							value_type;
+	typedef std::size_t 				size_type;
+
+	List(List const&) 				= delete;
+	List& operator=(List const&) 	= delete;
+
+	List() 				noexcept = default;
+   ~List() 				noexcept { 	clear(); 	}
+
+	template <typename... Args> requires std::constructible_from<T, Args ...>
+	void emplace_front(Args&&... args) {
+		auto node { std::make_unique<Node>(std::make_shared<T>(std::forward<Args>(args) ...)) };
+		std::lock_guard guard { head.mutex };
+		(* node).next = std::move(head.next);
+		head.next = std::move(node);
+		count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void push_front(T const& value) { 	emplace_front(value); 				}
+	void push_front(T&& value) 		{ 	emplace_front(std::move(value)); 	}
+
+	/* inserts after the first element satisfying `where`, or at the back when none does */
+	template <typename Predicate> requires std::predicate<Predicate, T const&>
+	void insert_after(Predicate&& where, T value) {
+		auto node { std::make_unique<Node>(std::make_shared<T>(std::move(value))) };
+		Node* current { &head };
+		std::unique_lock lock { head.mutex };
+		while(Node* next { (* current).next.get() }) {
+			std::unique_lock successor { (* next).mutex };
+			lock.unlock();
+			if(std::invoke(where, std::as_const(* (* next).data))) {
+				(* node).next = std::move((* next).next);
+				(* next).next = std::move(node);
+				count.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			current = next;
+			lock = std::move(successor);
+		}
+		(* current).next = std::move(node);
+		count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	template <typename F> requires std::invocable<F, T&>
+	void for_each(F&& f) {
+		Node* current { &head };
+		std::unique_lock lock { head.mutex };
+		while(Node* next { (* current).next.get() }) {
+			std::unique_lock successor { (* next).mutex };
+			lock.unlock();
+			std::invoke(f, * (* next).data);
+			current = next;
+			lock = std::move(successor);
+		}
+	}
+
+	template <typename Predicate> requires std::predicate<Predicate, T const&>
+	std::shared_ptr<T> find_first_if(Predicate&& p) {
+		Node* current { &head };
+		std::unique_lock lock { head.mutex };
+		while(Node* next { (* current).next.get() }) {
+			std::unique_lock successor { (* next).mutex };
+			lock.unlock();
+			if(std::invoke(p, std::as_const(* (* next).data)))
+				return (* next).data;
+			current = next;
+			lock = std::move(successor);
+		}
+		return {};
+	}
+
+	/* returns the number of removed elements */
+	template <typename Predicate> requires std::predicate<Predicate, T const&>
+	size_type remove_if(Predicate&& p) {
+		size_type 	removed 	{};
+		Node* 		current 	{ &head };
+		std::unique_lock lock { head.mutex };
+		while(Node* next { (* current).next.get() }) {
+			std::unique_lock successor { (* next).mutex };
+			if(std::invoke(p, std::as_const(* (* next).data))) {
+				std::unique_ptr<Node> victim { std::move((* current).next) };
+				(* current).next = std::move((* next).next);
+				successor.unlock();
+				removed ++;
+				continue;
+			}
+			lock.unlock();
+			current = next;
+			lock = std::move(successor);
+		}
+		count.fetch_sub(removed, std::memory_order_relaxed);
+		return removed;
+	}
+
+	std::shared_ptr<T> pop_front() {
+		std::unique_ptr<Node> victim;
+	{
+		std::lock_guard guard { head.mutex };
+		if(! head.next)
+			return {};
+		std::lock_guard successor { (* head.next).mutex };
+		victim = std::move(head.next);
+		head.next = std::move((* victim).next);
+	}
+		count.fetch_sub(1, std::memory_order_relaxed);
+		return std::move((* victim).data);
+	}
+
+	void clear() noexcept { 	(void) remove_if([] (T const&) { return true; }); 	}
+
+	/* approximate while writers are active */
+	size_type size() 	const noexcept 	{ 	return count.load(std::memory_order_relaxed); 	}
+	bool empty() 		const noexcept 	{ 	return ! size(); 								}
+private:
+	struct Node {
+		Node() noexcept = default;
+		explicit Node(std::shared_ptr<T> data) noexcept: data(std::move(data)) {}
+		/* unlinks iteratively so a long list cannot overflow the stack */
+	   ~Node() noexcept {
+			for(std::unique_ptr<Node> rest { std::move(next) }; rest; )
+				rest = std::move((* rest).next);
+		}
+
+		Mutex 					mutex;
+		std::shared_ptr<T> 		data;
+		std::unique_ptr<Node> 	next;
+	};
+
+	Node 						head;
+	std::atomic<size_type> 		count 	{};
+};
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
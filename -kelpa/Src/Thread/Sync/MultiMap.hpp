@@ -1,7 +1,320 @@
-/** 
+/**
  * 		@Path 	Kelpa/Src/Thread/Sync/MultiMap.hpp
- * 		@Brief	Thread-safe multimap holding a lock	
- * 		@Dependency	None
+ * 		@Brief	Ordered multimap built on a lazy skip list: wait-free lookups,
+ * 				per-node locks only around the links an update touches
+ * 		@Dependency	../ { Epoch.hpp }
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
+
+#ifndef __KELPA_THREAD_SYNCMULTIMAP_HPP__
+#define __KELPA_THREAD_SYNCMULTIMAP_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::unique_lock
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <functional>				/* imports ./ {
+	std::less,
+	std::invoke
+}*/
+#include <concepts>					/* imports ./ {
+	std::invocable
+}*/
+#include <utility>					/* imports ./ {
+	std::pair,
+	std::move
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint64_t,
+	std::uintptr_t
+}*/
+#include "../Epoch.hpp"				/* imports ./ {
+	struct Epoch
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Herlihy, Lev, Luchangco and Shavit's lazy skip list. Equal keys are kept in
+	insertion order by tagging every node with a sequence number, so the list
+	itself only ever holds distinct (key, sequence) pairs. Removal marks a node
+	before unlinking it; readers skip marked nodes and never lock. Every operation
+	pins the epoch and unlinked nodes go through Epoch::Retire, because a reader
+	may still be walking through them
+*/
+template <typename Key, typename T, typename Compare = std::less<Key>, std::size_t MaxLevel = 24> struct MultiMap {
+	typedef Key 								key_type;
+	typedef T 									mapped_type;
+	typedef std::pair<Key const, T> 			value_type;
+	typedef std::size_t 						size_type;
+
+	MultiMap(MultiMap const&) 				= delete;
+	MultiMap& operator=(MultiMap const&) 	= delete;
+
+	MultiMap(Compare compare = {}): compare(std::move(compare)) {
+		for(auto& next: head.next)
+			next.store(&tail, std::memory_order_relaxed);
+	}
+   ~MultiMap() noexcept;
+
+	/* equal keys keep insertion order */
+	void 					insert(Key key, T value);
+
+	/* erases the oldest element with an equal key */
+	bool 					erase(Key const& key);
+
+	std::optional<T> 		find(Key const& key) 		const;
+	bool 					contains(Key const& key) 	const 	{ 	return find(key).has_value(); 	}
+	size_type 				count(Key const& key) 		const;
+
+	/* removes and returns the smallest element, useful as a concurrent priority queue */
+	std::optional<std::pair<Key, T>> pop_front();
+
+	template <typename F> requires std::invocable<F, Key const&, T const&>
+	void 					for_each(F&& f) 				const;
+	template <typename F> requires std::invocable<F, T const&>
+	void 					for_each(Key const& key, F&& f) const;
+
+	/* approximate while writers are active */
+	size_type 				size() 	const noexcept 	{ 	return elements.load(std::memory_order_relaxed); 	}
+	bool 					empty() const noexcept 	{ 	return ! size(); 									}
+private:
+	struct Node {
+		enum class Kind { HEAD, ITEM, TAIL };
+
+		Node(Kind kind, std::size_t top) noexcept: kind(kind), top(top) {}
+		Node(Key key, T value, std::uint64_t sequence, std::size_t top)
+			: kind(Kind::ITEM), top(top), sequence(sequence), item(std::in_place, std::move(key), std::move(value)) {}
+
+		Kind 										kind;
+		std::size_t 								top;
+		std::uint64_t 								sequence 	{};
+		std::optional<value_type> 					item;
+		std::array<std::atomic<Node *>, MaxLevel> 	next 		{};
+		std::mutex 									mutex;
+		std::atomic<bool> 							marked 		{ false };
+		std::atomic<bool> 							linked 		{ false };
+	};
+
+	typedef std::array<Node *, MaxLevel> Path;
+
+	/* strict (key, sequence) ordering with HEAD below and TAIL above everything */
+	bool Before(Node const* node, Key const& key, std::uint64_t sequence) const {
+		if((* node).kind != Node::Kind::ITEM)
+			return (* node).kind == Node::Kind::HEAD;
+		Key const& other { (* (* node).item).first };
+		if(compare(other, key)) return true;
+		if(compare(key, other)) return false;
+		return (* node).sequence < sequence;
+	}
+	bool Equivalent(Node const* node, Key const& key) const {
+		return (* node).kind == Node::Kind::ITEM
+			&& ! compare((* (* node).item).first, key) && ! compare(key, (* (* node).item).first);
+	}
+
+	/* fills predecessors and successors of (key, sequence) on every level, returns the highest level it was found on */
+	int 	Find(Key const& key, std::uint64_t sequence, Path& preds, Path& succs) const;
+	bool 	Remove(Node* victim);
+
+	static std::size_t RandomLevel() noexcept {
+		thread_local std::uint64_t state { 0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state) };
+		state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+		std::size_t level { 0 };
+		/* p = 1/2 per level */
+		for(std::uint64_t bits { state }; (bits & 1) && level + 1 < MaxLevel; bits >>= 1)
+			level ++;
+		return level;
+	}
+
+	[[no_unique_address]] Compare 	compare;
+	Node 							tail 		{ Node::Kind::TAIL, MaxLevel - 1 };
+	Node 							head 		{ Node::Kind::HEAD, MaxLevel - 1 };
+	std::atomic<std::uint64_t> 		sequences 	{ 1 };
+	std::atomic<size_type> 			elements 	{};
+};
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+MultiMap<Key, T, Compare, MaxLevel>::~MultiMap() noexcept {
+	for(Node* node { head.next[0].load(std::memory_order_relaxed) }; node != &tail; ) {
+		Node* next { (* node).next[0].load(std::memory_order_relaxed) };
+		delete node;
+		node = next;
+	}
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+int MultiMap<Key, T, Compare, MaxLevel>::Find(Key const& key, std::uint64_t sequence, Path& preds, Path& succs) const {
+	int 	found 	{ -1 };
+	Node* 	pred 	{ const_cast<Node *>(&head) };
+	for(std::size_t level { MaxLevel }; level --; ) {
+		Node* current { (* pred).next[level].load(std::memory_order_acquire) };
+		while(Before(current, key, sequence)) {
+			pred 	= current;
+			current = (* pred).next[level].load(std::memory_order_acquire);
+		}
+		if(found == -1 && (* current).kind == Node::Kind::ITEM && (* current).sequence == sequence && Equivalent(current, key))
+			found = static_cast<int>(level);
+		preds[level] = pred;
+		succs[level] = current;
+	}
+	return found;
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+void MultiMap<Key, T, Compare, MaxLevel>::insert(Key key, T value) {
+	std::size_t const 	top 		{ RandomLevel() };
+	std::uint64_t const sequence 	{ sequences.fetch_add(1, std::memory_order_relaxed) };
+	Path 				preds, succs;
+	Epoch::Guard 		guard;
+	while(true) {
+		(void) Find(key, sequence, preds, succs);
+		std::array<std::unique_lock<std::mutex>, MaxLevel> locks;
+		bool  valid 	{ true };
+		Node* previous 	{ nullptr };
+		for(std::size_t level {}; valid && level <= top; level ++) {
+			Node* pred { preds[level] };
+			Node* succ { succs[level] };
+			if(pred != previous) {
+				locks[level] = std::unique_lock { (* pred).mutex };
+				previous = pred;
+			}
+			valid = ! (* pred).marked.load(std::memory_order_acquire)
+				 && ! (* succ).marked.load(std::memory_order_acquire)
+				 && (* pred).next[level].load(std::memory_order_acquire) == succ;
+		}
+		if(! valid)
+			continue;
+		Node* node { new Node(std::move(key), std::move(value), sequence, top) };
+		for(std::size_t level {}; level <= top; level ++)
+			(* node).next[level].store(succs[level], std::memory_order_relaxed);
+		for(std::size_t level {}; level <= top; level ++)
+			(* preds[level]).next[level].store(node, std::memory_order_release);
+		(* node).linked.store(true, std::memory_order_release);
+		elements.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+bool MultiMap<Key, T, Compare, MaxLevel>::Remove(Node* victim) {
+	Key const& 			key 		{ (* (* victim).item).first };
+	std::uint64_t const sequence 	{ (* victim).sequence };
+	std::size_t const 	top 		{ (* victim).top };
+	Path 				preds, succs;
+	std::unique_lock 	owner 		{ (* victim).mutex };
+	if((* victim).marked.load(std::memory_order_acquire))
+		return false;
+	(* victim).marked.store(true, std::memory_order_release);
+	while(true) {
+		(void) Find(key, sequence, preds, succs);
+		std::array<std::unique_lock<std::mutex>, MaxLevel> locks;
+		bool  valid 	{ true };
+		Node* previous 	{ nullptr };
+		for(std::size_t level {}; valid && level <= top; level ++) {
+			Node* pred { preds[level] };
+			if(pred != previous) {
+				locks[level] = std::unique_lock { (* pred).mutex };
+				previous = pred;
+			}
+			valid = ! (* pred).marked.load(std::memory_order_acquire)
+				 && (* pred).next[level].load(std::memory_order_acquire) == victim;
+		}
+		if(! valid)
+			continue;
+		for(std::size_t level { top + 1 }; level --; )
+			(* preds[level]).next[level].store((* victim).next[level].load(std::memory_order_relaxed), std::memory_order_release);
+		break;
+	}
+	owner.unlock();
+	elements.fetch_sub(1, std::memory_order_relaxed);
+	Epoch::Retire(victim);
+	return true;
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+bool MultiMap<Key, T, Compare, MaxLevel>::erase(Key const& key) {
+	Path 			preds, succs;
+	Epoch::Guard 	guard;
+	while(true) {
+		(void) Find(key, 0, preds, succs);
+		Node* candidate { succs[0] };
+		/* skip elements that are already being removed by someone else */
+		while(Equivalent(candidate, key) && ((* candidate).marked.load(std::memory_order_acquire) || ! (* candidate).linked.load(std::memory_order_acquire)))
+			candidate = (* candidate).next[0].load(std::memory_order_acquire);
+		if(! Equivalent(candidate, key))
+			return false;
+		if(Remove(candidate))
+			return true;
+	}
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+auto MultiMap<Key, T, Compare, MaxLevel>::pop_front() -> std::optional<std::pair<Key, T>> {
+	Epoch::Guard guard;
+	while(true) {
+		Node* candidate { head.next[0].load(std::memory_order_acquire) };
+		while(candidate != &tail && ((* candidate).marked.load(std::memory_order_acquire) || ! (* candidate).linked.load(std::memory_order_acquire)))
+			candidate = (* candidate).next[0].load(std::memory_order_acquire);
+		if(candidate == &tail)
+			return std::nullopt;
+		/* copied rather than moved: a pinned reader may still be looking at the retired node */
+		if(Remove(candidate))
+			return std::pair<Key, T> { (* (* candidate).item).first, (* (* candidate).item).second };
+	}
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+std::optional<T> MultiMap<Key, T, Compare, MaxLevel>::find(Key const& key) const {
+	Path 			preds, succs;
+	Epoch::Guard 	guard;
+	(void) Find(key, 0, preds, succs);
+	for(Node* node { succs[0] }; Equivalent(node, key); node = (* node).next[0].load(std::memory_order_acquire))
+		if((* node).linked.load(std::memory_order_acquire) && ! (* node).marked.load(std::memory_order_acquire))
+			return (* (* node).item).second;
+	return std::nullopt;
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+auto MultiMap<Key, T, Compare, MaxLevel>::count(Key const& key) const -> size_type {
+	size_type result {};
+	for_each(key, [&result] (T const&) { result ++; });
+	return result;
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+template <typename F> requires std::invocable<F, Key const&, T const&>
+void MultiMap<Key, T, Compare, MaxLevel>::for_each(F&& f) const {
+	Epoch::Guard guard;
+	for(Node* node { head.next[0].load(std::memory_order_acquire) }; node != &tail; node = (* node).next[0].load(std::memory_order_acquire))
+		if((* node).linked.load(std::memory_order_acquire) && ! (* node).marked.load(std::memory_order_acquire))
+			std::invoke(f, (* (* node).item).first, std::as_const((* (* node).item).second));
+}
+
+template <typename Key, typename T, typename Compare, std::size_t MaxLevel>
+template <typename F> requires std::invocable<F, T const&>
+void MultiMap<Key, T, Compare, MaxLevel>::for_each(Key const& key, F&& f) const {
+	Path 			preds, succs;
+	Epoch::Guard 	guard;
+	(void) Find(key, 0, preds, succs);
+	for(Node* node { succs[0] }; Equivalent(node, key); node = (* node).next[0].load(std::memory_order_acquire))
+		if((* node).linked.load(std::memory_order_acquire) && ! (* node).marked.load(std::memory_order_acquire))
+			std::invoke(f, std::as_const((* (* node).item).second));
+}
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Sync/RingQueue.hpp
+ * 		@Brief	Bounded lock-free multi-producer multi-consumer ring, allocation-free
+ * 				after construction
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_SYNC_RINGQUEUE_HPP__
+#define __KELPA_THREAD_SYNC_RINGQUEUE_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <bit>						/* imports ./ {
+	std::bit_ceil
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t
+}*/
+#include <memory>					/* imports ./ {
+	std::unique_ptr
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <type_traits>				/* imports ./ {
+	std::is_nothrow_move_assignable_v
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Vyukov's bounded queue: every cell carries a sequence number that says
+	whose turn it is, so a producer claims a cell with one compare-exchange on
+	the enqueue position and publishes it with a release store of the
+	sequence, and a consumer does the same on the other side. Nothing is ever
+	allocated after construction and nothing waits; a full ring refuses the
+	push and an empty one the pop. Values are kept in place, so T must be
+	default-constructible and cheap to move, such as a coroutine handle
+*/
+template <typename T> requires std::is_default_constructible_v<T> struct RingQueue {
+	typedef T 				value_type;
+	typedef std::size_t 	size_type;
+
+	RingQueue(RingQueue const&) 				= delete;
+	RingQueue& operator=(RingQueue const&) 		= delete;
+
+	/* rounded up to a power of two */
+	explicit RingQueue(size_type capacity) noexcept(false)
+		: mask(std::bit_ceil(capacity < 2 ? size_type(2) : capacity) - 1), cells(new Cell[mask + 1]) {
+		for(size_type index {}; index <= mask; index ++)
+			cells[index].sequence.store(index, std::memory_order_relaxed);
+	}
+
+	bool TryPush(T value) noexcept(std::is_nothrow_move_assignable_v<T>) {
+		size_type position { enqueue.load(std::memory_order_relaxed) };
+		for(;;) {
+			Cell& cell { cells[position & mask] };
+			size_type const sequence { cell.sequence.load(std::memory_order_acquire) };
+			if(sequence == position) {
+				if(enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.value = std::move(value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			/* the cell still holds the value pushed a lap ago: full */
+			else if(static_cast<std::ptrdiff_t>(sequence - position) < 0)
+				return false;
+			else
+				position = enqueue.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::optional<T> TryPop() noexcept(std::is_nothrow_move_constructible_v<T>) {
+		size_type position { dequeue.load(std::memory_order_relaxed) };
+		for(;;) {
+			Cell& cell { cells[position & mask] };
+			size_type const sequence { cell.sequence.load(std::memory_order_acquire) };
+			if(sequence == position + 1) {
+				if(dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					std::optional<T> value { std::move(cell.value) };
+					cell.sequence.store(position + mask + 1, std::memory_order_release);
+					return value;
+				}
+			}
+			else if(static_cast<std::ptrdiff_t>(sequence - (position + 1)) < 0)
+				return std::nullopt;
+			else
+				position = dequeue.load(std::memory_order_relaxed);
+		}
+	}
+
+	/* a hint under concurrent use */
+	bool 		Empty() 	const noexcept
+	{ 	return dequeue.load(std::memory_order_relaxed) >= enqueue.load(std::memory_order_relaxed); 	}
+	size_type 	Capacity() 	const noexcept 	{ 	return mask + 1; 	}
+private:
+	struct Cell {
+		std::atomic<size_type> 		sequence;
+		T 							value 	{};
+	};
+
+	size_type const 				mask;
+	std::unique_ptr<Cell[]> 		cells;
+	alignas(64) std::atomic<size_type> 	enqueue 	{};
+	alignas(64) std::atomic<size_type> 	dequeue 	{};
+};
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Sync/SPSCQueue.hpp
+ * 		@Brief	Unbounded single-producer single-consumer queue made of fixed segments,
+ * 				wait-free on both ends apart from allocating a segment
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_SYNC_SPSCQUEUE_HPP__
+#define __KELPA_THREAD_SYNC_SPSCQUEUE_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t
+}*/
+#include <memory>					/* imports ./ {
+	std::construct_at,
+	std::destroy_at
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <concepts>					/* imports ./ {
+	std::constructible_from
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Exactly one thread pushes and exactly one thread pops. The producer fills a
+	segment and publishes each slot with a release store of its count; when the
+	segment is full it links a fresh one, so a push never waits for the consumer
+	and two shards posting to each other cannot deadlock on a full ring. The
+	consumer frees a segment once it has drained it and moved to the next
+*/
+template <typename T, std::size_t SegmentSize = 256> requires (SegmentSize > 0) struct SPSCQueue {
+	typedef T 				value_type;
+	typedef std::size_t 	size_type;
+
+	SPSCQueue(SPSCQueue const&) 				= delete;
+	SPSCQueue& operator=(SPSCQueue const&) 		= delete;
+
+	SPSCQueue() noexcept(false): head(new Segment), tail(head) {}
+   ~SPSCQueue() noexcept {
+		while(TryPop());
+		delete head;
+	}
+
+	/* producer side */
+	template <typename... Args> requires std::constructible_from<T, Args ...>
+	void Emplace(Args&&... args) {
+		if(pushed == SegmentSize) [[unlikely]] {
+			Segment* const segment { new Segment };
+			(* tail).next.store(segment, std::memory_order_release);
+			tail 	= segment;
+			pushed 	= 0;
+		}
+		std::construct_at((* tail).Slot(pushed), std::forward<Args>(args) ...);
+		(* tail).count.store(++ pushed, std::memory_order_release);
+	}
+	void Push(T const& value) 	{ 	Emplace(value); 				}
+	void Push(T&& value) 		{ 	Emplace(std::move(value)); 		}
+
+	/* consumer side */
+	std::optional<T> TryPop() noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if(popped == SegmentSize) {
+			Segment* const next { (* head).next.load(std::memory_order_acquire) };
+			if(! next)
+				return std::nullopt;
+			delete std::exchange(head, next);
+			popped = 0;
+		}
+		if(popped == (* head).count.load(std::memory_order_acquire))
+			return std::nullopt;
+		T* const slot { (* head).Slot(popped ++) };
+		std::optional<T> value { std::move(* slot) };
+		std::destroy_at(slot);
+		return value;
+	}
+	/* consumer side, a hint when called from the producer */
+	bool Empty() const noexcept {
+		if(popped == SegmentSize)
+			return ! (* head).next.load(std::memory_order_acquire);
+		return popped == (* head).count.load(std::memory_order_acquire);
+	}
+private:
+	struct Segment {
+		T* Slot(std::size_t index) noexcept 	{ 	return reinterpret_cast<T *>(storage) + index; 	}
+
+		alignas(T) unsigned char 		storage[sizeof(T) * SegmentSize];
+		alignas(64) std::atomic<std::size_t> 	count 	{};
+		std::atomic<Segment *> 			next 	{ nullptr };
+	};
+
+	alignas(64) Segment * 		head;
+	std::size_t 				popped 	{};
+	alignas(64) Segment * 		tail;
+	std::size_t 				pushed 	{};
+};
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/Sync/StealingDeque.hpp
+ * 		@Brief	Bounded Chase-Lev work-stealing deque: the owner pushes and pops at
+ * 				the bottom, any other thread steals from the top
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_SYNC_STEALINGDEQUE_HPP__
+#define __KELPA_THREAD_SYNC_STEALINGDEQUE_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic,
+	std::atomic_thread_fence
+}*/
+#include <bit>						/* imports ./ {
+	std::bit_ceil
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::ptrdiff_t
+}*/
+#include <memory>					/* imports ./ {
+	std::unique_ptr
+}*/
+#include <optional>					/* imports ./ {
+	std::optional
+}*/
+#include <type_traits>				/* imports ./ {
+	std::is_trivially_copyable_v
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Chase and Lev's deque with the C11 orderings of Le et al. The owning
+	thread treats the bottom as a stack, so the task it pushed last, whose
+	data is still in its cache, is the one it runs next; thieves take the
+	oldest task from the top with one compare-exchange, which only contends
+	with the owner when a single task is left. The ring does not grow: a full
+	deque refuses the push and the owner spills elsewhere. Values are copied
+	through atomics, so T must be trivially copyable and lock-free, such as a
+	pointer or a coroutine handle
+*/
+template <typename T> requires std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free
+struct StealingDeque {
+	typedef T 				value_type;
+	typedef std::size_t 	size_type;
+
+	StealingDeque(StealingDeque const&) 			= delete;
+	StealingDeque& operator=(StealingDeque const&) 	= delete;
+
+	/* rounded up to a power of two */
+	explicit StealingDeque(size_type capacity) noexcept(false)
+		: mask(std::bit_ceil(capacity < 2 ? size_type(2) : capacity) - 1), cells(new std::atomic<T>[mask + 1]) {}
+
+	/* owner only */
+	bool TryPush(T value) noexcept {
+		std::ptrdiff_t const bottom_ { bottom.load(std::memory_order_relaxed) };
+		std::ptrdiff_t const top_ 	 { top.load(std::memory_order_acquire) };
+		if(static_cast<size_type>(bottom_ - top_) > mask)
+			return false;
+		cells[bottom_ & mask].store(value, std::memory_order_relaxed);
+		bottom.store(bottom_ + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* owner only: the newest value */
+	std::optional<T> TryPop() noexcept {
+		std::ptrdiff_t const bottom_ { bottom.load(std::memory_order_relaxed) - 1 };
+		bottom.store(bottom_, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::ptrdiff_t top_ { top.load(std::memory_order_relaxed) };
+		if(top_ > bottom_) {
+			bottom.store(bottom_ + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+		std::optional<T> value { cells[bottom_ & mask].load(std::memory_order_relaxed) };
+		if(top_ == bottom_) {
+			/* the last one: race the thieves for it */
+			if(not top.compare_exchange_strong(top_, top_ + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				value.reset();
+			bottom.store(bottom_ + 1, std::memory_order_relaxed);
+		}
+		return value;
+	}
+
+	/* any thread: the oldest value, or nothing when empty or when another thread won it */
+	std::optional<T> TrySteal() noexcept {
+		std::ptrdiff_t top_ { top.load(std::memory_order_acquire) };
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::ptrdiff_t const bottom_ { bottom.load(std::memory_order_acquire) };
+		if(top_ >= bottom_)
+			return std::nullopt;
+		T const value { cells[top_ & mask].load(std::memory_order_relaxed) };
+		if(not top.compare_exchange_strong(top_, top_ + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return std::nullopt;
+		return value;
+	}
+
+	/* hints under concurrent use */
+	size_type 	Size() 		const noexcept {
+		std::ptrdiff_t const size { bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed) };
+		return size > 0 ? static_cast<size_type>(size) : 0;
+	}
+	bool 		Empty() 	const noexcept 	{ 	return not Size(); 	}
+	size_type 	Capacity() 	const noexcept 	{ 	return mask + 1; 	}
+private:
+	size_type const 					mask;
+	std::unique_ptr<std::atomic<T>[]> 	cells;
+	alignas(64) std::atomic<std::ptrdiff_t> 	top 	{};
+	alignas(64) std::atomic<std::ptrdiff_t> 	bottom 	{};
+};
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -1,7 +1,202 @@
-/** 
+/**
  * 		@Path 	Kelpa/Src/Thread/Sync/Vector.hpp
- * 		@Brief	Thread-safe vector holding a lock	
+ * 		@Brief	Segmented append-only vector with lock-free push_back and stable references
  * 		@Dependency	None
  * 		@Since  2024/04/25
  * 		@Version 1st
  **/
+
+#ifndef __KELPA_THREAD_SYNCVECTOR_HPP__
+#define __KELPA_THREAD_SYNCVECTOR_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <bit>						/* imports ./ {
+	std::bit_width
+}*/
+#include <memory>					/* imports ./ {
+	std::allocator,
+	std::allocator_traits,
+	std::addressof
+}*/
+#include <new>						/* imports ./ {
+	std::launder
+}*/
+#include <stdexcept>				/* imports ./ {
+	std::out_of_range
+}*/
+#include <limits>					/* imports ./ {
+	std::numeric_limits
+}*/
+#include <functional>				/* imports ./ {
+	std::invoke
+}*/
+#include <concepts>					/* imports ./ {
+	std::constructible_from,
+	std::invocable
+}*/
+
+namespace Kelpa {
+namespace Thread {
+namespace Sync {
+
+/*
+	Segment 0 holds the first 2^FirstBits slots and segment k > 0 the next
+	2^(FirstBits + k - 1), so elements never move once constructed. push_back
+	claims a slot with one fetch_add and allocates a missing segment with a CAS.
+	Each slot carries its state; size() counts the slots before the first one
+	still under construction, so every index below it may be read concurrently
+	with push_back. A slot whose constructor threw stays behind as a hole:
+	at() throws on it, for_each skips it and operator[] must not be given it
+*/
+template <typename T, typename Allocator = std::allocator<T>, std::size_t FirstBits = 3> struct Vector {
+	typedef T 										value_type;
+	typedef std::size_t 							size_type;
+	typedef T& 										reference;
+	typedef T const& 								const_reference;
+	typedef Allocator 								allocator_type;
+
+	static constexpr std::size_t 	Segments 	{ std::numeric_limits<std::size_t>::digits - FirstBits };
+
+	Vector(Vector const&) 				= delete;
+	Vector& operator=(Vector const&) 	= delete;
+
+	constexpr Vector() 			noexcept = default;
+	explicit Vector(Allocator const& alloc) noexcept: allocator(alloc) {}
+   ~Vector() 					noexcept;
+
+	template <typename... Args> requires std::constructible_from<T, Args ...>
+	reference 		emplace_back(Args&&... args);
+
+	reference 		push_back(T const& value) 	{ 	return emplace_back(value); 				}
+	reference 		push_back(T&& value) 		{ 	return emplace_back(std::move(value)); 		}
+
+	reference 		operator[](size_type index) 		noexcept
+	{	return Locate(index);	}
+	const_reference operator[](size_type index) const 	noexcept
+	{	return const_cast<Vector &>(*this).Locate(index);	}
+
+	reference 		at(size_type index) {
+		if(index >= size())
+			throw std::out_of_range { "Sync::Vector::at" };
+		if(SlotOf(index).state.load(std::memory_order_acquire) != State::READY)
+			throw std::out_of_range { "Sync::Vector::at: element failed to construct" };
+		return Locate(index);
+	}
+	const_reference at(size_type index) const
+	{	return const_cast<Vector &>(*this).at(index);	}
+
+	size_type 		size() 		const noexcept 	{ 	return published.load(std::memory_order_acquire); 	}
+	bool 			empty() 	const noexcept 	{ 	return ! size(); 									}
+
+	template <typename F> requires std::invocable<F, reference>
+	void 			for_each(F&& f) noexcept(std::is_nothrow_invocable_v<F, reference>) {
+		for(size_type index {}, last { size() }; index < last; index ++)
+			if(SlotOf(index).state.load(std::memory_order_acquire) == State::READY)
+				std::invoke(f, Locate(index));
+	}
+private:
+	enum class State: unsigned char { EMPTY, READY, BROKEN };
+	struct Slot {
+		std::atomic<State> 						state 		{ State::EMPTY };
+		alignas(T) unsigned char 				storage[sizeof(T)];
+	};
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Slot> 	slot_allocator;
+	typedef std::allocator_traits<slot_allocator> 	traits;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> 		element_allocator;
+
+	static constexpr size_type SegmentOf(size_type index) noexcept
+	{	return static_cast<size_type>(std::bit_width(index >> FirstBits));		}
+	static constexpr size_type BaseOf(size_type segment) noexcept
+	{	return segment ? (size_type(1) << FirstBits) << (segment - 1) : 0;		}
+	static constexpr size_type CapacityOf(size_type segment) noexcept
+	{	return segment ? (size_type(1) << FirstBits) << (segment - 1) : (size_type(1) << FirstBits);	}
+
+	Slot* 	Segment(size_type segment);
+	void 	Publish() noexcept;
+	Slot& 	SlotOf(size_type index) noexcept {
+		size_type const segment { SegmentOf(index) };
+		return segments[segment].load(std::memory_order_acquire)[index - BaseOf(segment)];
+	}
+	T& 		Locate(size_type index) noexcept
+	{	return * std::launder(reinterpret_cast<T *>(SlotOf(index).storage));	}
+
+	std::array<std::atomic<Slot *>, Segments> 	segments 	{};
+	std::atomic<size_type> 						claimed 	{};
+	std::atomic<size_type> 						published 	{};
+	[[no_unique_address]] slot_allocator 		allocator 	{};
+};
+
+template <typename T, typename Allocator, std::size_t FirstBits>
+auto Vector<T, Allocator, FirstBits>::Segment(size_type segment) -> Slot* {
+	Slot* storage { segments[segment].load(std::memory_order_acquire) };
+	if(storage)
+		return storage;
+	Slot* fresh { traits::allocate(allocator, CapacityOf(segment)) };
+	for(size_type index {}; index < CapacityOf(segment); index ++)
+		traits::construct(allocator, fresh + index);
+	if(segments[segment].compare_exchange_strong(storage, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+		return fresh;
+	traits::deallocate(allocator, fresh, CapacityOf(segment));
+	return storage;
+}
+
+/*
+	moves published over every finished slot in front of it; whichever thread
+	finishes the slot it stopped at carries it further, so none of them waits
+*/
+template <typename T, typename Allocator, std::size_t FirstBits>
+void Vector<T, Allocator, FirstBits>::Publish() noexcept {
+	size_type last { published.load(std::memory_order_seq_cst) };
+	while(last < claimed.load(std::memory_order_seq_cst)) {
+		Slot* const storage { segments[SegmentOf(last)].load(std::memory_order_seq_cst) };
+		if(! storage || storage[last - BaseOf(SegmentOf(last))].state.load(std::memory_order_seq_cst) == State::EMPTY)
+			return;
+		published.compare_exchange_strong(last, last + 1, std::memory_order_seq_cst);
+		last = published.load(std::memory_order_seq_cst);
+	}
+}
+
+template <typename T, typename Allocator, std::size_t FirstBits>
+template <typename... Args> requires std::constructible_from<T, Args ...>
+auto Vector<T, Allocator, FirstBits>::emplace_back(Args&&... args) -> reference {
+	size_type const index 	{ claimed.fetch_add(1, std::memory_order_seq_cst) };
+	size_type const segment { SegmentOf(index) };
+	Slot& 			slot 	{ Segment(segment)[index - BaseOf(segment)] };
+	try {
+		element_allocator element { allocator };
+		std::allocator_traits<element_allocator>::construct(element, reinterpret_cast<T *>(slot.storage), std::forward<Args>(args) ...);
+	} catch(...) {
+		slot.state.store(State::BROKEN, std::memory_order_seq_cst);
+		Publish();
+		throw;
+	}
+	slot.state.store(State::READY, std::memory_order_seq_cst);
+	Publish();
+	return Locate(index);
+}
+
+template <typename T, typename Allocator, std::size_t FirstBits>
+Vector<T, Allocator, FirstBits>::~Vector() noexcept {
+	element_allocator 	element { allocator };
+	size_type const 	last 	{ claimed.load(std::memory_order_acquire) };
+	for(size_type index {}; index < last; index ++) {
+		/* the segment is missing when allocating it threw */
+		Slot* const storage { segments[SegmentOf(index)].load(std::memory_order_relaxed) };
+		if(storage && storage[index - BaseOf(SegmentOf(index))].state.load(std::memory_order_relaxed) == State::READY)
+			std::allocator_traits<element_allocator>::destroy(element, std::addressof(Locate(index)));
+	}
+	for(size_type segment {}; segment < Segments; segment ++)
+		if(Slot* storage { segments[segment].load(std::memory_order_relaxed) })
+			traits::deallocate(allocator, storage, CapacityOf(segment));
+}
+
+}		//namespace Sync
+}		//namespace Thread
+}		//namespace Kelpa
+
+#endif
@@ -12,13 +12,19 @@
 #include "./Sync/Counter.hpp"
 #include "./Sync/HashMap.hpp"
 #include "./Sync/Queue.hpp"
+#include "./Sync/SPSCQueue.hpp"
 #include "./Sync/Vector.hpp"
 #include "./Sync/List.hpp"
 #include "./Sync/MultiMap.hpp"
 #include "./CASLock.hpp"
+#include "./Epoch.hpp"
+#include "./SeqLock.hpp"
+#include "./Snapshot.hpp"
 #include "./Executor.hpp"
+#include "./Futex.hpp"
 #include "./SpinLock.hpp"
 #include "./Timer.hpp"
+#include "./TimingWheel.hpp"
 
 
 #endif
@@ -31,8 +31,20 @@
 	std::mutex, 
 	std::lock_guard 
 }*/
+#include <condition_variable>		/* imports ./ { 
+	std::condition_variable 
+}*/
+#include <vector>					/* imports ./ { 
+	std::vector 
+}*/
+#include <atomic>					/* imports ./ { 
+	std::atomic 
+}*/
+#include <limits>					/* imports ./ { 
+	std::numeric_limits 
+}*/
 #include "../Utility/Functions.hpp"	/* imports ./ { 
-	MilliNow() 
+	SteadyNow() 
 }*/
 #include "../Utility/Interfaces.hpp"/* imports ./ { 
 	struct nonXXXable 
@@ -47,6 +59,15 @@ namespace Thread {
 struct 		Timer;
 struct 		TimerFormulateHandle;
 struct 		Intervalometer;
+struct 		TimingWheel;
+
+struct TimerHandle {
+	std::uint32_t 		index 		{ std::numeric_limits<std::uint32_t>::max() };
+	std::uint32_t 		generation 	{};
+
+	constexpr explicit operator bool() const noexcept
+	{	return index != std::numeric_limits<std::uint32_t>::max();	}
+};
 
 struct TimerFormulateHandle {
 	std::reference_wrapper<Timer> 		proxy;
@@ -61,11 +82,12 @@ struct TimerFormulateHandle {
 struct Timer {
 __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Timer)
 	typedef std::chrono::milliseconds 				duration_type;
-	typedef std::chrono::system_clock 				clock_type;
-	typedef std::chrono::system_clock::time_point 	time_point_type;
+	typedef std::chrono::steady_clock 				clock_type;
+	typedef std::chrono::steady_clock::time_point 	time_point_type;
 	
 	static constexpr long long signed 				infinite { -1 };
 	friend 			struct Intervalometer;
+	friend 			struct TimingWheel;
 	friend 			struct TimerFormulateHandle;
 
 	constexpr TimerFormulateHandle Build() noexcept 
@@ -96,6 +118,7 @@ protected:
 	long long signed 			repeat 		{ infinite };
 	std::function<void()> 		func 		{ 	[] { std::puts("default callback");	}	};
 	std::chrono::milliseconds 	timeout		{};
+	std::uint32_t 				slot 		{};
 };
 
 template<typename Rep, typename Period>	
@@ -116,6 +139,12 @@ Timer& TimerFormulateHandle::Continue() const noexcept
 {	return static_cast<Timer&>(proxy);		}
 
 
+/*
+	Cues are keyed by their wake-up time, which may lag behind the timer's own 
+	deadline: Extend() only moves the deadline, and a cue that surfaces early is 
+	re-keyed instead of fired. Node handles move the Timer between positions, 
+	so the callback is never copied and a slot can keep a stable pointer to it
+*/
 struct Intervalometer : Utility::noncopyable {
 __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Intervalometer)
 
@@ -124,42 +153,180 @@ __KELPA_DEFINES_STRUCT_MEMBER_TYPES__(Intervalometer)
 	typedef typename Timer::time_point_type 			time_point_type;
 			
 	template <typename U> requires std::convertible_to<U, Timer>
-	constexpr void Schedule(U&& timer) noexcept {	
-		std::lock_guard lock { Mutex }; 
-		Cues.emplace((timer.timeout = Utility::Now<>() + (std::forward<U>(timer)).duration), std::forward<U>(timer));	
-	}
-	void Update() noexcept {
-		auto next { Cues.begin() };
-		while(next != Cues.end()) {
-			auto [timeout, timer] = std::move(* next);
-			
-			auto now = Utility::Now<>();
-			std::this_thread::sleep_for(timeout > now ? timeout - now: std::chrono::system_clock::duration::zero());
-			
-		SCOPE_BEGIN() std::lock_guard lock { Mutex };
-			next = Cues.erase(next);
-			
-			if(timer.Advance().StillAlive()) 	{
-				auto current = Cues.emplace(timer.UntilWhen(), timer);
-				if(next == Cues.end() || (* current).first < (* next).first) {
-					(void) std::exchange(next, current);
-				}
-			}
-		SCOPE_END()	
-			WhenNextComes.store(next == Cues.end() ? std::chrono::milliseconds::max() : (* next).first, std::memory_order_seq_cst);
-			timer.Callback();
-		} 
-	}	
+	TimerHandle Schedule(U&& timer) noexcept;
+
+	bool Cancel(TimerHandle handle) noexcept;
+
+	template <typename Rep, typename Period>
+	bool Reschedule(TimerHandle handle, std::chrono::duration<Rep, Period> const& duration) noexcept;
+
+	template <typename Rep, typename Period>
+	bool Extend(TimerHandle handle, std::chrono::duration<Rep, Period> const& duration) noexcept;
+
+	template <typename Rep, typename Period>
+	Intervalometer& SetSlack(std::chrono::duration<Rep, Period> const& duration) noexcept;
+
+	void Update() noexcept;
+
 	bool Finish() const noexcept { 		
-		std::lock_guard lock {const_cast<Intervalometer &>(*this).Mutex}; 
+		std::lock_guard lock { Mutex }; 
 		return Cues.empty(); 											
 	}
 
-	std::atomic<std::chrono::milliseconds>			WhenNextComes;
+	std::atomic<std::chrono::milliseconds>			WhenNextComes 	{ std::chrono::milliseconds::max() };
 private:
-	std::multimap<std::chrono::milliseconds, Timer> Cues;
+	typedef std::multimap<std::chrono::milliseconds, Timer> 	container_type;
+
+	enum class State: unsigned char { FREE, PENDING, RUNNING, CANCELLED };
+	struct Slot {
+		typename container_type::iterator 		cue 		{};
+		Timer * 								timer 		{ nullptr };
+		std::uint32_t 							generation 	{};
+		State 									state 		{ State::FREE };
+	};
+
+	static std::chrono::milliseconds Now() noexcept 
+	{	return Utility::SteadyNow<typename std::chrono::milliseconds::rep>();	}
+
+	std::chrono::milliseconds Coalesce(std::chrono::milliseconds deadline) const noexcept {
+		if(slack <= std::chrono::milliseconds(1)) 	
+			return deadline;
+		return (deadline + slack - std::chrono::milliseconds(1)) / slack * slack;
+	}
+
+	Slot* Lookup(TimerHandle handle) noexcept {
+		if(! handle || handle.index >= Slots.size()) 
+			return nullptr;
+		Slot& slot = Slots[handle.index];
+		return slot.generation == handle.generation && slot.state != State::FREE ? std::addressof(slot) : nullptr;
+	}
+
+	void Enqueue(container_type::node_type&& node) noexcept {
+		auto const key { node.key() = Coalesce(node.mapped().timeout) };
+		Slots[node.mapped().slot].cue = Cues.insert(std::move(node));
+		if((* Cues.begin()).first == key) 
+			Condition.notify_all();
+		WhenNextComes.store((* Cues.begin()).first, std::memory_order_seq_cst);
+	}
+
+	void Retire(std::uint32_t index) noexcept {
+		Slots[index] = Slot { .generation = Slots[index].generation + 1 };
+		Vacant.push_back(index);
+	}
+
+	container_type 									Cues;
+	std::vector<Slot> 								Slots;
+	std::vector<std::uint32_t> 						Vacant;
+	std::chrono::milliseconds 						slack 	{};
 	mutable std::mutex 								Mutex;
+	std::condition_variable 						Condition;
 };	
+
+template <typename U> requires std::convertible_to<U, Timer>
+TimerHandle Intervalometer::Schedule(U&& timer) noexcept {	
+	container_type::node_type node;
+SCOPE_BEGIN() 
+	container_type 	staging;
+	node = staging.extract(staging.emplace(std::chrono::milliseconds {}, std::forward<U>(timer)));
+SCOPE_END()
+	std::lock_guard lock { Mutex }; 
+	std::uint32_t index {};
+	if(Vacant.empty()) {
+		index = static_cast<std::uint32_t>(Slots.size());
+		Slots.emplace_back();
+	} else {
+		index = Vacant.back();
+		Vacant.pop_back();
+	}
+	Timer& scheduled 	= node.mapped();
+	scheduled.timeout 	= Now() + scheduled.duration;
+	scheduled.slot 		= index;
+	Slots[index].timer 	= std::addressof(scheduled);
+	Slots[index].state 	= State::PENDING;
+	Enqueue(std::move(node));
+	return { index, Slots[index].generation };
+}
+
+bool Intervalometer::Cancel(TimerHandle handle) noexcept {
+	std::lock_guard lock { Mutex };
+	Slot* slot { Lookup(handle) };
+	if(! slot || (* slot).state == State::CANCELLED) 
+		return false;
+	if((* slot).state == State::RUNNING) {
+		(* slot).state = State::CANCELLED;
+		return true;
+	}
+	Cues.erase((* slot).cue);
+	Retire(handle.index);
+	WhenNextComes.store(Cues.empty() ? std::chrono::milliseconds::max() : (* Cues.begin()).first, std::memory_order_seq_cst);
+	return true;
+}
+
+template <typename Rep, typename Period>
+bool Intervalometer::Reschedule(TimerHandle handle, std::chrono::duration<Rep, Period> const& duration) noexcept {
+	std::lock_guard lock { Mutex };
+	Slot* slot { Lookup(handle) };
+	if(! slot || (* slot).state != State::PENDING) 
+		return false;
+	Timer& timer 	= * (* slot).timer;
+	timer.duration 	= std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+	timer.timeout 	= Now() + timer.duration;
+	/* a later deadline is picked up lazily when the current cue surfaces */
+	if(Coalesce(timer.timeout) < (* (* slot).cue).first) 
+		Enqueue(Cues.extract((* slot).cue));
+	return true;
+}
+
+template <typename Rep, typename Period>
+bool Intervalometer::Extend(TimerHandle handle, std::chrono::duration<Rep, Period> const& duration) noexcept {
+	std::lock_guard lock { Mutex };
+	Slot* slot { Lookup(handle) };
+	if(! slot || (* slot).state != State::PENDING) 
+		return false;
+	(* (* slot).timer).timeout += std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+	return true;
+}
+
+template <typename Rep, typename Period>
+Intervalometer& Intervalometer::SetSlack(std::chrono::duration<Rep, Period> const& duration) noexcept {
+	std::lock_guard lock { Mutex };
+	slack = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+	return *this;
+}
+
+void Intervalometer::Update() noexcept {
+	std::unique_lock lock { Mutex };
+	while(! Cues.empty()) {
+		auto const key { (* Cues.begin()).first };
+		if(key > Now()) {
+			/* woken early whenever an earlier cue is scheduled */
+			Condition.wait_until(lock, time_point_type(std::chrono::duration_cast<typename clock_type::duration>(key)));
+			continue;
+		}
+		auto node { Cues.extract(Cues.begin()) };
+		Timer& timer = node.mapped();
+		if(timer.timeout > key) {
+			Enqueue(std::move(node));
+			continue;
+		}
+		std::uint32_t const index { timer.slot };
+		Slots[index].state = State::RUNNING;
+		WhenNextComes.store(Cues.empty() ? std::chrono::milliseconds::max() : (* Cues.begin()).first, std::memory_order_seq_cst);
+		
+		timer.Advance();
+		lock.unlock();
+		timer.Callback();
+		lock.lock();
+		
+		if(Slots[index].state == State::CANCELLED || ! timer.StillAlive()) {
+			Retire(index);
+			continue;
+		}
+		Slots[index].state = State::PENDING;
+		Enqueue(std::move(node));
+	} 
+	WhenNextComes.store(std::chrono::milliseconds::max(), std::memory_order_seq_cst);
+}	
 	
 	
 }
@@ -0,0 +1,425 @@
+/**
+ * 		@Path 	Kelpa/Src/Thread/TimingWheel.hpp
+ * 		@Brief	Hierarchical timing wheel: O(1) insertion and cancellation by handle,
+ * 				expiry batched per slot, driven either by its own thread or by an
+ * 				external event loop through NextDeadline()/Advance()
+ * 		@Dependency	./ { Timer.hpp }
+ * 					../Utility/ { Interfaces.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_THREAD_TIMINGWHEEL_HPP__
+#define __KELPA_THREAD_TIMINGWHEEL_HPP__
+
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <deque>					/* imports ./ {
+	std::deque
+}*/
+#include <vector>					/* imports ./ {
+	std::vector
+}*/
+#include <bit>						/* imports ./ {
+	std::countr_zero
+}*/
+#include <chrono>					/* imports ./ {
+	std::chrono::steady_clock,
+	std::chrono::duration
+}*/
+#include <functional>				/* imports ./ {
+	std::function,
+	std::bind
+}*/
+#include <mutex>					/* imports ./ {
+	std::mutex,
+	std::unique_lock
+}*/
+#include <condition_variable>		/* imports ./ {
+	std::condition_variable
+}*/
+#include <thread>					/* imports ./ {
+	std::thread
+}*/
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <limits>					/* imports ./ {
+	std::numeric_limits
+}*/
+#include <memory>					/* imports ./ {
+	std::addressof
+}*/
+#include "./Timer.hpp"				/* imports ./ {
+	struct Timer,
+	struct TimerHandle
+}*/
+#include "../Utility/Interfaces.hpp"/* imports ./ {
+	struct nonXXXable
+}*/
+
+namespace Kelpa {
+namespace Thread {
+
+/*
+	Slots are laid out as 256 root slots of one tick each, followed by three
+	levels of 64 slots whose granularity grows by 64 each time. A timer lives
+	in exactly one slot; a non-empty upper slot is cascaded downwards once the
+	lower levels wrap round to it
+*/
+struct TimingWheel : Utility::noncopyable, Utility::nonmoveable {
+	typedef std::chrono::steady_clock 					clock_type;
+	typedef typename clock_type::time_point 			time_point_type;
+	typedef typename clock_type::duration 				duration_type;
+	typedef std::uint64_t 								tick_type;
+
+	static constexpr tick_type 		Never 		{ std::numeric_limits<tick_type>::max() };
+	static constexpr std::size_t 	RootBits 	{ 8 };
+	static constexpr std::size_t 	LevelBits 	{ 6 };
+	static constexpr std::size_t 	Levels 		{ 3 };
+	static constexpr std::size_t 	RootSlots 	{ std::size_t(1) << RootBits };
+	static constexpr std::size_t 	LevelSlots 	{ std::size_t(1) << LevelBits };
+	static constexpr std::size_t 	Slots 		{ RootSlots + Levels * LevelSlots };
+	static constexpr tick_type 		Horizon 	{ tick_type(1) << (RootBits + Levels * LevelBits) };
+
+	explicit TimingWheel(duration_type resolution = std::chrono::milliseconds(1)) noexcept
+		: resolution(resolution), origin(clock_type::now()) {}
+	~TimingWheel() noexcept { 	Stop();		}
+
+	template <typename Rep, typename Period, typename F, typename... Args> requires std::invocable<F, Args ...>
+	TimerHandle 	Schedule(std::chrono::duration<Rep, Period> const& delay, F&& f, Args&&... args) noexcept;
+
+	template <typename Rep, typename Period, typename IRep, typename IPeriod, typename F, typename... Args> requires std::invocable<F, Args ...>
+	TimerHandle 	Schedule(std::chrono::duration<Rep, Period> const& delay, std::chrono::duration<IRep, IPeriod> const& interval,
+							 long long signed repeat, F&& f, Args&&... args) noexcept;
+
+	TimerHandle 	Schedule(Timer&& timer) noexcept;
+
+	bool 			Cancel(TimerHandle handle) 					noexcept;
+	template <typename Rep, typename Period>
+	bool 			Reschedule(TimerHandle handle, std::chrono::duration<Rep, Period> const& delay) noexcept;
+	bool 			Pending(TimerHandle handle) 		const 	noexcept;
+	std::size_t 	Size() 								const 	noexcept;
+
+/*
+	an external event loop may sleep until NextDeadline() and then Advance(); 
+	callbacks run on the advancing thread, so drive a wheel either this way or by Start(), never both
+*/
+	time_point_type NextDeadline() 						const 	noexcept;
+	std::size_t 	Advance(time_point_type now = clock_type::now()) noexcept;
+
+	TimingWheel& 	Start() 									noexcept;
+	TimingWheel& 	Stop() 										noexcept;
+private:
+	enum class State: unsigned char { FREE, PENDING, RUNNING, CANCELLED };
+	struct Node {
+		Node * 					prev 		{ nullptr };
+		Node * 					next 		{ nullptr };
+		tick_type 				expires 	{};
+		tick_type 				interval 	{};
+		long long signed 		repeat 		{};
+		std::function<void()> 	callback 	{};
+		std::uint32_t 			index 		{};
+		std::uint32_t 			generation 	{};
+		std::uint16_t 			slot 		{};
+		State 					state 		{ State::FREE };
+	};
+
+	tick_type 		ExpiryOf(duration_type delay) const noexcept
+	{	return std::max(TickOf(clock_type::now() + delay + resolution - duration_type(1)), current);	}
+	TimerHandle 	Insert(duration_type delay, tick_type interval, long long signed repeat, std::function<void()>&& callback) noexcept;
+	void 			Link(Node& node) 					noexcept;
+	void 			Unlink(Node& node) 					noexcept;
+	void 			Release(Node& node) 				noexcept;
+	void 			Cascade(std::size_t level) 			noexcept;
+	tick_type 		NextEventTick() 			const 	noexcept;
+	Node * 			Lookup(TimerHandle handle) 	const 	noexcept;
+
+	tick_type 		TickOf(time_point_type point) const noexcept {
+		return point <= origin ? 0 : static_cast<tick_type>((point - origin) / resolution);
+	}
+	time_point_type DeadlineOf(tick_type tick) const noexcept
+	{	return origin + resolution * static_cast<typename duration_type::rep>(tick);	}
+	template <typename Rep, typename Period>
+	tick_type 		TicksOf(std::chrono::duration<Rep, Period> const& duration) const noexcept {
+		auto const span = std::chrono::duration_cast<duration_type>(duration);
+		return span <= duration_type::zero() ? 0 : static_cast<tick_type>((span + resolution - duration_type(1)) / resolution);
+	}
+
+	duration_type 						resolution;
+	time_point_type 					origin;
+	tick_type 							current 	{};
+	tick_type 							wake 		{ Never };
+
+	std::array<Node *, Slots> 			Heads 		{};
+	std::array<std::uint64_t, Slots / 64> Occupied 	{};
+	std::deque<Node> 					Nodes;
+	std::vector<Node *> 				Vacant;
+	std::vector<Node *> 				Batch;
+	std::size_t 						pending 	{};
+
+	mutable std::mutex 					Mutex;
+	std::condition_variable 			Condition;
+	std::thread 						Worker;
+	std::atomic<bool> 					exit 		{ false };
+};
+
+template <typename Rep, typename Period, typename F, typename... Args> requires std::invocable<F, Args ...>
+TimerHandle TimingWheel::Schedule(std::chrono::duration<Rep, Period> const& delay, F&& f, Args&&... args) noexcept
+{	return Insert(std::chrono::duration_cast<duration_type>(delay), 0, 1, std::bind(std::forward<F>(f), std::forward<Args>(args) ...));	}
+
+template <typename Rep, typename Period, typename IRep, typename IPeriod, typename F, typename... Args> requires std::invocable<F, Args ...>
+TimerHandle TimingWheel::Schedule(std::chrono::duration<Rep, Period> const& delay, std::chrono::duration<IRep, IPeriod> const& interval,
+								  long long signed repeat, F&& f, Args&&... args) noexcept {
+	return Insert(std::chrono::duration_cast<duration_type>(delay), std::max<tick_type>(TicksOf(interval), 1), repeat,
+				  std::bind(std::forward<F>(f), std::forward<Args>(args) ...));
+}
+
+TimerHandle TimingWheel::Schedule(Timer&& timer) noexcept
+{	return Insert(std::chrono::duration_cast<duration_type>(timer.duration), std::max<tick_type>(TicksOf(timer.duration), 1), timer.repeat, std::move(timer.func));	}
+
+TimerHandle TimingWheel::Insert(duration_type delay, tick_type interval, long long signed repeat, std::function<void()>&& callback) noexcept {
+	if(! repeat)
+		return {};
+	std::lock_guard guard { Mutex };
+	Node* node { nullptr };
+	if(Vacant.empty()) {
+		node = std::addressof(Nodes.emplace_back());
+		(* node).index = static_cast<std::uint32_t>(Nodes.size() - 1);
+	} else {
+		node = Vacant.back();
+		Vacant.pop_back();
+	}
+	(* node).expires 	= ExpiryOf(delay);
+	(* node).interval 	= interval;
+	(* node).repeat 	= repeat;
+	(* node).callback 	= std::move(callback);
+	(* node).state 		= State::PENDING;
+	Link(* node);
+	pending ++;
+	if((* node).expires < wake) {
+		wake = (* node).expires;
+		Condition.notify_one();
+	}
+	return { (* node).index, (* node).generation };
+}
+
+void TimingWheel::Link(Node& node) noexcept {
+	tick_type const expires { std::max(node.expires, current) };
+	tick_type const delta 	{ expires - current };
+	std::size_t 	slot 	{};
+	if(delta < RootSlots)
+		slot = expires & (RootSlots - 1);
+	else {
+		/* beyond the horizon: park in the farthest slot, re-placed when cascaded */
+		tick_type const placed 	{ delta < Horizon ? expires : current + Horizon - (tick_type(1) << (RootBits + (Levels - 1) * LevelBits)) };
+		std::size_t 	level 	{ 1 };
+		while(level < Levels && placed - current >= (tick_type(1) << (RootBits + level * LevelBits)))
+			level ++;
+		slot = RootSlots + (level - 1) * LevelSlots + ((placed >> (RootBits + (level - 1) * LevelBits)) & (LevelSlots - 1));
+	}
+	node.slot = static_cast<std::uint16_t>(slot);
+	node.prev = nullptr;
+	node.next = Heads[slot];
+	if(node.next)
+		(* node.next).prev = std::addressof(node);
+	Heads[slot] = std::addressof(node);
+	Occupied[slot / 64] |= std::uint64_t(1) << (slot % 64);
+}
+
+void TimingWheel::Unlink(Node& node) noexcept {
+	if(node.prev) 	(* node.prev).next = node.next;
+	else 			Heads[node.slot] = node.next;
+	if(node.next) 	(* node.next).prev = node.prev;
+	if(! Heads[node.slot])
+		Occupied[node.slot / 64] &= ~(std::uint64_t(1) << (node.slot % 64));
+	node.prev = node.next = nullptr;
+}
+
+void TimingWheel::Release(Node& node) noexcept {
+	node.state = State::FREE;
+	node.generation ++;
+	std::function<void()>().swap(node.callback);
+	Vacant.push_back(std::addressof(node));
+	pending --;
+}
+
+void TimingWheel::Cascade(std::size_t level) noexcept {
+	std::size_t const slot { RootSlots + (level - 1) * LevelSlots + ((current >> (RootBits + (level - 1) * LevelBits)) & (LevelSlots - 1)) };
+	Node* node { std::exchange(Heads[slot], nullptr) };
+	Occupied[slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+	while(node) {
+		Node* next { (* node).next };
+		Link(* node);
+		node = next;
+	}
+}
+
+TimingWheel::tick_type TimingWheel::NextEventTick() const noexcept {
+	tick_type 		 result { Never };
+	std::size_t const base 	{ current & (RootSlots - 1) };
+	/* root slots: the first occupied slot at or after the cursor, wrapping round */
+	for(std::size_t step {}; step < RootSlots; ) {
+		std::size_t const position 	{ (base + step) & (RootSlots - 1) };
+		std::uint64_t const word 	{ Occupied[position / 64] >> (position % 64) };
+		if(word) {
+			std::size_t const found { step + std::countr_zero(word) };
+			if(found < RootSlots)
+				result = current + found;
+			break;
+		}
+		step += 64 - position % 64;
+	}
+	/* upper levels: the tick at which the lower levels wrap round to an occupied slot */
+	for(std::size_t level { 1 }; level <= Levels; level ++) {
+		std::size_t const 	shift 	{ RootBits + (level - 1) * LevelBits };
+		std::uint64_t const word 	{ Occupied[(RootSlots + (level - 1) * LevelSlots) / 64] };
+		if(! word)
+			continue;
+		std::size_t const 	cursor 	{ (current >> shift) & (LevelSlots - 1) };
+		std::uint64_t const rotated { std::rotr(word, static_cast<int>(cursor)) };
+		tick_type 			tick 	{ ((current >> shift) + std::countr_zero(rotated)) << shift };
+		/* the cursor slot once its cascade has passed holds timers a whole revolution away */
+		if(tick < current)
+			tick += tick_type(LevelSlots) << shift;
+		result = std::min(result, tick);
+	}
+	return result;
+}
+
+TimingWheel::Node * TimingWheel::Lookup(TimerHandle handle) const noexcept {
+	if(! handle || handle.index >= Nodes.size())
+		return nullptr;
+	Node& node { const_cast<Node &>(Nodes[handle.index]) };
+	return node.generation == handle.generation && node.state != State::FREE ? std::addressof(node) : nullptr;
+}
+
+bool TimingWheel::Cancel(TimerHandle handle) noexcept {
+	std::lock_guard guard { Mutex };
+	Node* node { Lookup(handle) };
+	if(! node || (* node).state == State::CANCELLED)
+		return false;
+	if((* node).state == State::RUNNING) {
+		/* reaped by Advance() once the callback returns */
+		(* node).state = State::CANCELLED;
+		return true;
+	}
+	Unlink(* node);
+	Release(* node);
+	return true;
+}
+
+template <typename Rep, typename Period>
+bool TimingWheel::Reschedule(TimerHandle handle, std::chrono::duration<Rep, Period> const& delay) noexcept {
+	std::lock_guard guard { Mutex };
+	Node* node { Lookup(handle) };
+	if(! node || (* node).state != State::PENDING)
+		return false;
+	Unlink(* node);
+	(* node).expires = ExpiryOf(std::chrono::duration_cast<duration_type>(delay));
+	Link(* node);
+	if((* node).expires < wake) {
+		wake = (* node).expires;
+		Condition.notify_one();
+	}
+	return true;
+}
+
+bool TimingWheel::Pending(TimerHandle handle) const noexcept {
+	std::lock_guard guard { Mutex };
+	Node* node { Lookup(handle) };
+	return node && (* node).state != State::CANCELLED;
+}
+
+std::size_t TimingWheel::Size() const noexcept {
+	std::lock_guard guard { Mutex };
+	return pending;
+}
+
+TimingWheel::time_point_type TimingWheel::NextDeadline() const noexcept {
+	std::lock_guard guard { Mutex };
+	tick_type const next { NextEventTick() };
+	return next == Never ? time_point_type::max() : DeadlineOf(next);
+}
+
+std::size_t TimingWheel::Advance(time_point_type now) noexcept {
+	std::unique_lock lock { Mutex };
+	tick_type const target { TickOf(now) };
+	std::size_t 	fired 	{};
+	for(tick_type next { NextEventTick() }; next <= target; next = NextEventTick()) {
+		current = next;
+		for(std::size_t level { 1 }; level <= Levels; level ++) {
+			if(current & ((tick_type(1) << (RootBits + (level - 1) * LevelBits)) - 1))
+				break;
+			Cascade(level);
+		}
+		std::size_t const slot { current & (RootSlots - 1) };
+		for(Node* node { std::exchange(Heads[slot], nullptr) }; node; node = (* node).next) {
+			(* node).state = State::RUNNING;
+			Batch.push_back(node);
+		}
+		Occupied[slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+		current ++;
+		if(Batch.empty())
+			continue;
+
+		lock.unlock();
+		for(Node* node: Batch)
+			std::invoke((* node).callback);
+		lock.lock();
+
+		for(Node* node: Batch) {
+			fired ++;
+			if((* node).repeat > 0)
+				(* node).repeat --;
+			if((* node).state == State::CANCELLED || ! (* node).repeat || ! (* node).interval) {
+				Release(* node);
+				continue;
+			}
+			(* node).state 		= State::PENDING;
+			(* node).expires 	+= (* node).interval;
+			Link(* node);
+		}
+		Batch.clear();
+	}
+	current = std::max(current, target + 1);
+	wake 	= NextEventTick();
+	return fired;
+}
+
+TimingWheel& TimingWheel::Start() noexcept {
+	if(Worker.joinable())
+		return *this;
+	exit.store(false, std::memory_order_seq_cst);
+	Worker = std::thread([this] {
+		while(! exit.load(std::memory_order_seq_cst)) {
+		SCOPE_BEGIN() std::unique_lock lock { Mutex };
+			tick_type const next { wake = NextEventTick() };
+			auto const predicate = [this, next] { return exit.load(std::memory_order_seq_cst) || wake < next; };
+			if(next == Never)
+				Condition.wait(lock, predicate);
+			else
+				Condition.wait_until(lock, DeadlineOf(next), predicate);
+		SCOPE_END()
+			(void) Advance();
+		}
+	});
+	return *this;
+}
+
+TimingWheel& TimingWheel::Stop() noexcept {
+SCOPE_BEGIN() std::lock_guard guard { Mutex };
+	exit.store(true, std::memory_order_seq_cst);
+SCOPE_END()
+	Condition.notify_all();
+	if(Worker.joinable())
+		Worker.join();
+	return *this;
+}
+
+
+}
+}
+
+#endif
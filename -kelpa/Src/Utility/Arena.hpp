@@ -0,0 +1,165 @@
+/**
+ * 		@Path 	Kelpa/Src/Utility/Arena.hpp
+ * 		@Brief	Monotonic bump arena usable as std::pmr::memory_resource, for
+ * 				batches of short-lived allocations freed all at once
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_UTILITY_ARENA_HPP__
+#define __KELPA_UTILITY_ARENA_HPP__
+
+#include <memory_resource>			/* imports ./ {
+	std::pmr::memory_resource,
+	std::pmr::get_default_resource
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::byte,
+	std::max_align_t
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uintptr_t
+}*/
+#include <algorithm>				/* imports ./ {
+	std::max
+}*/
+
+namespace Kelpa {
+namespace Utility {
+
+/*
+	std::pmr::vector<Node> nodes { &arena };
+	...
+	arena.Reset(); 		// every allocation is gone, the largest chunk is kept for the next round
+
+	deallocate() is a no-op, chunks grow geometrically from the upstream resource.
+	Unlike std::pmr::monotonic_buffer_resource, Reset() rewinds without giving the
+	memory back, so a per-request or per-tree arena stops touching the upstream
+	after warming up. Not thread-safe: one arena per thread or per task
+*/
+struct MonotonicArena: std::pmr::memory_resource {
+	MonotonicArena(MonotonicArena const&) 				= delete;
+	MonotonicArena& operator=(MonotonicArena const&) 	= delete;
+
+	explicit MonotonicArena(
+		std::size_t 				initial 	= 4096,
+		std::pmr::memory_resource* 	upstream 	= std::pmr::get_default_resource()
+	) noexcept: upstream(upstream), growth(std::max<std::size_t>(initial, 256)) {}
+
+	/* starts from a caller-owned buffer, typically on the stack */
+	MonotonicArena(
+		void* 						buffer,
+		std::size_t 				size,
+		std::pmr::memory_resource* 	upstream 	= std::pmr::get_default_resource()
+	) noexcept: upstream(upstream), buffer(static_cast<std::byte *>(buffer)), capacity(size),
+		cursor(static_cast<std::byte *>(buffer)), limit(static_cast<std::byte *>(buffer) + size),
+		growth(std::max<std::size_t>(size, 256) * 2) {}
+
+   ~MonotonicArena() noexcept override { 	Release(); 		}
+
+	/* drops every allocation, keeps the largest chunk */
+	void Reset() noexcept;
+	/* drops every allocation and returns all chunks to the upstream */
+	void Release() noexcept;
+
+	/* bytes handed out since the last reset, including alignment padding */
+	std::size_t Used() 		const noexcept 	{ 	return used + static_cast<std::size_t>(cursor - start); 		}
+	/* bytes obtained from the upstream */
+	std::size_t Reserved() 	const noexcept 	{ 	return reserved; 	}
+
+	std::pmr::memory_resource* Upstream() const noexcept { 	return upstream; 	}
+private:
+	struct Chunk {
+		Chunk * 		next;
+		std::size_t 	size;
+	};
+	static constexpr std::size_t HeaderSize { (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1) };
+
+	void* 	do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void 	do_deallocate(void*, std::size_t, std::size_t) noexcept override {}
+	bool 	do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+	{	return this == &other;	}
+
+	static std::byte* Align(std::byte* pointer, std::size_t alignment) noexcept {
+		std::uintptr_t const address { reinterpret_cast<std::uintptr_t>(pointer) };
+		return pointer + (((address + alignment - 1) & ~(alignment - 1)) - address);
+	}
+	void 	Grow(std::size_t bytes, std::size_t alignment);
+
+	std::pmr::memory_resource* 	upstream;
+	Chunk * 					chunks 		{ nullptr };
+	std::byte * 				buffer 		{ nullptr };
+	std::size_t 				capacity 	{};
+	std::byte * 				start 		{ buffer };
+	std::byte * 				cursor 		{ nullptr };
+	std::byte * 				limit 		{ nullptr };
+	std::size_t 				growth;
+	std::size_t 				used 		{};
+	std::size_t 				reserved 	{};
+};
+
+inline void* MonotonicArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+	std::byte* pointer { Align(cursor, alignment) };
+	if(! cursor || pointer > limit || static_cast<std::size_t>(limit - pointer) < bytes) [[unlikely]] {
+		Grow(bytes, alignment);
+		pointer = Align(cursor, alignment);
+	}
+	cursor = pointer + bytes;
+	return pointer;
+}
+
+inline void MonotonicArena::Grow(std::size_t bytes, std::size_t alignment) {
+	std::size_t const size { std::max(growth, HeaderSize + bytes + alignment) };
+	auto* chunk { static_cast<Chunk *>((* upstream).allocate(size, alignof(std::max_align_t))) };
+	* chunk = Chunk { chunks, size };
+	chunks 		= chunk;
+	reserved 	+= size;
+	used 		+= static_cast<std::size_t>(cursor - start);
+	start 		= cursor = reinterpret_cast<std::byte *>(chunk) + HeaderSize;
+	limit 		= reinterpret_cast<std::byte *>(chunk) + size;
+	growth 		= size * 2;
+}
+
+inline void MonotonicArena::Reset() noexcept {
+	Chunk* largest { chunks };
+	for(Chunk* chunk { chunks }; chunk; chunk = (* chunk).next)
+		if((* chunk).size > (* largest).size)
+			largest = chunk;
+	for(Chunk* chunk { chunks }; chunk; ) {
+		Chunk* next { (* chunk).next };
+		if(chunk != largest) {
+			reserved -= (* chunk).size;
+			(* upstream).deallocate(chunk, (* chunk).size, alignof(std::max_align_t));
+		}
+		chunk = next;
+	}
+	used = 0;
+	if((chunks = largest)) {
+		(* largest).next = nullptr;
+		start = cursor 	= reinterpret_cast<std::byte *>(largest) + HeaderSize;
+		limit 			= reinterpret_cast<std::byte *>(largest) + (* largest).size;
+	} else {
+		start = cursor 	= buffer;
+		limit 			= buffer ? buffer + capacity : nullptr;
+	}
+}
+
+inline void MonotonicArena::Release() noexcept {
+	for(Chunk* chunk { chunks }; chunk; ) {
+		Chunk* next { (* chunk).next };
+		(* upstream).deallocate(chunk, (* chunk).size, alignof(std::max_align_t));
+		chunk = next;
+	}
+	chunks 		= nullptr;
+	used 		= 0;
+	reserved 	= 0;
+	start = cursor 	= buffer;
+	limit 			= buffer ? buffer + capacity : nullptr;
+}
+
+}		//namespace Utility
+}		//namespace Kelpa
+
+#endif
@@ -11,10 +11,19 @@
 #include <cstring>								/* imports ./ { 
 	std::strerror 
 }*/
+#ifdef _WIN32
 #include <windows.h>  
 #include <DbgHelp.h>  							/* imports ./ { 
 	WindowsAPIs... 
 }*/
+#else
+#include <execinfo.h>							/* imports ./ { 
+	backtrace, backtrace_symbols 
+}*/
+#include <cstdlib>								/* imports ./ { 
+	std::free 
+}*/
+#endif
 #include <iostream>  							/* imports ./ { 
 	./stdio_s.h/ { sprintf_s }, 
 	extern std::cout, std::cerr	
@@ -58,6 +67,7 @@
 
 namespace Kelpa {
 namespace Utility {
+#ifdef _WIN32
 namespace Detail {
 BOOL CALLBACK SymEnumSymbolsProc(const char *symbolName, ULONG64 symbolAddress, ULONG symbolSize, void *userData) {  
     std::vector<std::string>* symbols = reinterpret_cast<std::vector<std::string> *>(userData);  
@@ -120,6 +130,20 @@ void PrintCallStack() {
   
     SymCleanup(process);  
 }  
+#else
+/* POSIX counterparts: socket errors are reported through errno, the call stack through glibc's backtrace */
+inline void WSAError() {
+	std::fprintf(stderr, "error: %s", std::strerror(errno));
+}
+inline void PrintCallStack() {
+	void * 		frames[64];
+	int 		depth = 	::backtrace(frames, 64);
+	char ** 	symbols = 	::backtrace_symbols(frames, depth);
+	if(symbols == nullptr) return;
+	for(int index = depth - 1; index >= 0; index --) std::cout << symbols[index] << "\n";
+	std::free(symbols);
+}
+#endif
 	
 	
 	
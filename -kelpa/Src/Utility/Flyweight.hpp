@@ -2,7 +2,7 @@
  * @Path   		Kelpa/Src/Utility/Flyweight.hpp
  * @Brief			The calculation results corresponding to different parameters 
  * 					are cached and then repeated calculation is not performed
- * @Dependency	./ 			{ Concepts.hpp }
+ * @Dependency	./ 			{ Concepts.hpp, Hash.hpp }
  * 				../Serde/ 	{ FunctionTraits.hpp }
  * @Since		2024/04/22
  * @Version     1st
@@ -23,40 +23,39 @@
 	non_reference, 
 	non_void 
 }*/
+#include "./Hash.hpp"				/* imports ./ { 
+	struct Hash 
+}*/
 #include "../Serde/FunctionTraits.hpp" /* imports ./ { 
 	struct FunctionTraits 
 }*/
 
 namespace std {  
 template <typename... Args> 	struct hash<std::tuple<Args...>> {  
-    size_t operator()(std::tuple<Args...> const& tup) const noexcept {  
-        std::size_t 	result {};  
-        return std::apply([&](auto&&... args) mutable -> std::size_t {  
-            ((result = 	Combine(result, std::hash<std::decay_t<decltype(args)>>{}(args))), ...);  
-            return 		result;
-        }, 				tup);  
-    }  
-    template <typename T>  static constexpr std::size_t Combine(size_t hash_code, T const& value) noexcept 
-	{  	return hash_code ^ (std::hash<T>{}(value) + (hash_code << 6) + (hash_code >> 2));  }  
+    size_t operator()(std::tuple<Args...> const& tup) const noexcept 
+	{ 	return Kelpa::Utility::Hash<std::tuple<Args...>>{} (tup);	}  
 }; 	}; 
 
 namespace Kelpa {
 namespace Utility {
 	
-template <typename> struct Flyweight { static_assert(std::bool_constant<false>::value, "non-void/non-reference return required"); };
+template <typename F> struct Flyweight { static_assert(! std::is_same_v<F, F>, "non-void/non-reference return required"); };
 template <typename R, typename... Args> requires (non_void<R> && non_reference<R>) 
 struct Flyweight<R(Args ...)>: Serde::FunctionTraits<R(Args ...)> {
 	template <typename F> constexpr Flyweight(F&& __f) noexcept: f(std::forward<F>(__f)) {}
+	/* keyed by the arguments themselves: two that merely hash alike must not share a result */
 	constexpr R& operator()(Args ...args) noexcept {
-		auto hash_code { std::hash<std::tuple<Args ...>>{} (std::forward_as_tuple(args ...)) };
+		key_type key { args ... };
 
-		if(m.contains(hash_code)) 		
-			return m[hash_code]; 
-		return (* m.emplace(hash_code, std::invoke(f, std::forward<Args>(args) ...)).first).second;
+		if(auto found { m.find(key) }; found != m.end()) 		
+			return found->second; 
+		return (* m.emplace(std::move(key), std::invoke(f, std::forward<Args>(args) ...)).first).second;
 	}
 private:
+	typedef std::tuple<std::decay_t<Args> ...> 		key_type;
+	
 	std::function<R(Args ...)>						f;
-	std::unordered_map<std::size_t, R> 				m;
+	std::unordered_map<key_type, R, Hash<key_type>> m;
 };
 template <typename F> Flyweight(F&&) -> Flyweight<typename Serde::FunctionTraits<std::decay_t<F>>::function_type>;	
 	
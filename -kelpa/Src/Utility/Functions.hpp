@@ -36,6 +36,9 @@
 #include <sstream>						/* imports ./ { 
 	std::stringstream 
 }*/
+#include <iterator>						/* imports ./ { 
+	std::distance 
+}*/
 namespace Kelpa {
 namespace Utility {
 	
@@ -65,6 +68,15 @@ template <typename T> std::optional<T> FromChars(std::string_view haystack) noex
 	return std::nullopt;
 }	
 
+/* std::distance that also takes output iterators able to tell how far apart they are */
+template <typename It>
+constexpr auto Distance(It first, It last) noexcept {
+	if constexpr (requires { last - first; })
+		return last - first;
+	else
+		return std::distance(first, last);
+}
+
 template<typename Rep = unsigned long long, typename Period = std::milli>
 std::chrono::duration<Rep, Period> Now() 			noexcept {
 	return std::chrono::time_point_cast<std::chrono::duration<Rep, Period>>(
@@ -72,6 +84,13 @@ std::chrono::duration<Rep, Period> Now() 			noexcept {
 	).time_since_epoch();
 }
 
+template<typename Rep = unsigned long long, typename Period = std::milli>
+std::chrono::duration<Rep, Period> SteadyNow() 		noexcept {
+	return std::chrono::time_point_cast<std::chrono::duration<Rep, Period>>(
+		std::chrono::steady_clock::now()
+	).time_since_epoch();
+}
+
 template <typename _Callable, typename... _Args>
 constexpr auto Curry(_Callable&& f, _Args&&... args) noexcept {
     return [=]<typename... _OtherArgs>
@@ -0,0 +1,210 @@
+/**
+ * 		@Path 	Kelpa/Src/Utility/Hash.hpp
+ * 		@Brief	Keyed hashing for hash tables: a wyhash-style hash of bytes and
+ * 				words under a per-process random seed, and a Hash functor for
+ * 				integers, byte ranges and tuples
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_UTILITY_HASH_HPP__
+#define __KELPA_UTILITY_HASH_HPP__
+
+#include <bit>						/* imports ./ {
+	std::endian,
+	std::rotl
+}*/
+#include <chrono>					/* imports ./ {
+	std::chrono::steady_clock
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint64_t,
+	std::uint32_t,
+	std::uintptr_t
+}*/
+#include <cstring>					/* imports ./ {
+	std::memcpy
+}*/
+#include <functional>				/* imports ./ {
+	std::hash
+}*/
+#include <random>					/* imports ./ {
+	std::random_device
+}*/
+#include <ranges>					/* imports ./ {
+	std::ranges::contiguous_range,
+	std::ranges::data,
+	std::ranges::size
+}*/
+#include <tuple>					/* imports ./ {
+	std::apply,
+	std::tuple_size
+}*/
+#include <type_traits>				/* imports ./ {
+	std::has_unique_object_representations_v,
+	std::is_integral_v,
+	std::is_enum_v,
+	std::is_pointer_v
+}*/
+
+namespace Kelpa {
+namespace Utility {
+
+/*
+	std::hash is the identity for integers and pointers, and the usual ways of
+	combining it (a ^ b, a | b, a ^ (b << 6)) leave keys that differ in a few
+	bits, such as the peers of one subnet or the ports of one client, in a
+	handful of buckets. Anyone who picks the keys, as a remote peer picks its
+	port, can also pick them to collide. These hashes follow wyhash: every
+	input bit reaches every output bit through 64x64->128 bit multiplies, and
+	the seed is drawn once per process, so which keys collide cannot be known
+	from outside. That makes flooding a table impractical, it does not make
+	the hash a MAC; use SipHash where the hash itself is exposed.
+
+		std::unordered_map<std::tuple<std::uint32_t, std::uint16_t>, Session, Utility::Hash<...>> sessions;
+		std::size_t const h { Utility::HashCombine(Utility::HashWord(address), port) };
+
+	Hashes differ from one run to the next: never store or send them
+*/
+
+namespace Detail {
+	inline constexpr std::uint64_t HashSecret[4] {
+		0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+	};
+
+	inline std::uint64_t Load64(unsigned char const* p) noexcept {
+		std::uint64_t value;
+		std::memcpy(&value, p, sizeof value);
+		if constexpr (std::endian::native == std::endian::big)
+			value = __builtin_bswap64(value);
+		return value;
+	}
+	inline std::uint64_t Load32(unsigned char const* p) noexcept {
+		std::uint32_t value;
+		std::memcpy(&value, p, sizeof value);
+		if constexpr (std::endian::native == std::endian::big)
+			value = __builtin_bswap32(value);
+		return value;
+	}
+	/* the 128-bit product of a and b, low half into a, high half into b */
+	constexpr void Multiply(std::uint64_t& a, std::uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+		__extension__ unsigned __int128 const product { static_cast<unsigned __int128>(a) * b };
+		a = static_cast<std::uint64_t>(product);
+		b = static_cast<std::uint64_t>(product >> 64);
+#else
+		std::uint64_t const al { a & 0xffffffff }, ah { a >> 32 }, bl { b & 0xffffffff }, bh { b >> 32 };
+		std::uint64_t const ll { al * bl }, lh { al * bh }, hl { ah * bl }, hh { ah * bh };
+		std::uint64_t const middle { (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff) };
+		a = (middle << 32) | (ll & 0xffffffff);
+		b = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+	}
+	/* contiguous values whose bytes are all there is to them */
+	template <typename T> concept ByteRange = std::ranges::contiguous_range<T const> && std::ranges::sized_range<T const>
+		&& std::has_unique_object_representations_v<std::ranges::range_value_t<T const>>;
+}	// namespace Detail
+
+/* folds the 128-bit product of a and b into 64 bits */
+constexpr std::uint64_t HashMix(std::uint64_t a, std::uint64_t b) noexcept {
+	Detail::Multiply(a, b);
+	return a ^ b;
+}
+
+/* drawn on first use; the same for every thread of the process */
+inline std::uint64_t HashSeed() noexcept {
+	static std::uint64_t const seed { [] {
+		std::uint64_t entropy { static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) };
+		entropy ^= reinterpret_cast<std::uintptr_t>(&entropy);
+		try {
+			std::random_device device;
+			entropy ^= static_cast<std::uint64_t>(device()) << 32 | device();
+		} catch(...) {}
+		return entropy ^ HashMix(entropy ^ Detail::HashSecret[0], Detail::HashSecret[1]);
+	} () };
+	return seed;
+}
+
+/* wyhash of `size` bytes */
+inline std::uint64_t HashBytes(void const* data, std::size_t size, std::uint64_t seed = HashSeed()) noexcept {
+	auto const* p { static_cast<unsigned char const*>(data) };
+	std::uint64_t a {}, b {};
+	if(size <= 16) {
+		if(size >= 4) {
+			std::size_t const step { (size >> 3) << 2 };
+			a = Detail::Load32(p) << 32 | Detail::Load32(p + step);
+			b = Detail::Load32(p + size - 4) << 32 | Detail::Load32(p + size - 4 - step);
+		}
+		else if(size > 0) {
+			a = static_cast<std::uint64_t>(p[0]) << 16 | static_cast<std::uint64_t>(p[size >> 1]) << 8 | p[size - 1];
+		}
+	}
+	else {
+		std::size_t remaining { size };
+		if(remaining >= 48) {
+			std::uint64_t lane1 { seed }, lane2 { seed };
+			do {
+				seed = HashMix(Detail::Load64(p) ^ Detail::HashSecret[1], Detail::Load64(p + 8) ^ seed);
+				lane1 = HashMix(Detail::Load64(p + 16) ^ Detail::HashSecret[2], Detail::Load64(p + 24) ^ lane1);
+				lane2 = HashMix(Detail::Load64(p + 32) ^ Detail::HashSecret[3], Detail::Load64(p + 40) ^ lane2);
+				p += 48;
+				remaining -= 48;
+			} while(remaining >= 48);
+			seed ^= lane1 ^ lane2;
+		}
+		for(; remaining > 16; p += 16, remaining -= 16)
+			seed = HashMix(Detail::Load64(p) ^ Detail::HashSecret[1], Detail::Load64(p + 8) ^ seed);
+		a = Detail::Load64(p + remaining - 16);
+		b = Detail::Load64(p + remaining - 8);
+	}
+	a ^= Detail::HashSecret[1];
+	b ^= seed;
+	Detail::Multiply(a, b);
+	return HashMix(a ^ Detail::HashSecret[0] ^ size, b ^ Detail::HashSecret[1]);
+}
+
+/* HashBytes of the eight bytes of value, little-endian, without touching memory */
+inline std::uint64_t HashWord(std::uint64_t value, std::uint64_t seed = HashSeed()) noexcept {
+	std::uint64_t a { std::rotl(value, 32) ^ Detail::HashSecret[1] }, b { value ^ seed };
+	Detail::Multiply(a, b);
+	return HashMix(a ^ Detail::HashSecret[0] ^ 8, b ^ Detail::HashSecret[1]);
+}
+
+/* the hash of a sequence whose hash so far is `hash` and whose next element hashes to `value` */
+constexpr std::uint64_t HashCombine(std::uint64_t hash, std::uint64_t value) noexcept {
+	return HashMix(hash ^ Detail::HashSecret[2], value ^ Detail::HashSecret[3]);
+}
+
+/*
+	A drop-in for std::hash: integers, enums and pointers go through HashWord,
+	contiguous ranges of plain bytes-alike values (strings, string_views,
+	arrays, vectors of integers) through HashBytes, tuples and pairs element
+	by element, and anything else has its std::hash finalized by HashWord
+*/
+template <typename T> struct Hash {
+	std::size_t operator()(T const& value) const noexcept {
+		if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+			return HashWord(static_cast<std::uint64_t>(value));
+		else if constexpr (std::is_pointer_v<T>)
+			return HashWord(reinterpret_cast<std::uintptr_t>(value));
+		else if constexpr (Detail::ByteRange<T>)
+			return HashBytes(std::ranges::data(value), std::ranges::size(value) * sizeof(std::ranges::range_value_t<T const>));
+		else if constexpr (requires { std::tuple_size<T>::value; })
+			return std::apply([](auto const&... elements) {
+				std::uint64_t hash { HashSeed() };
+				((hash = HashCombine(hash, Hash<std::remove_cvref_t<decltype(elements)>>{}(elements))), ...);
+				return static_cast<std::size_t>(hash);
+			}, value);
+		else
+			return HashWord(std::hash<T>{}(value));
+	}
+};
+
+}	// namespace Utility
+}	// namespace Kelpa
+
+#endif
@@ -0,0 +1,650 @@
+/**
+ * 		@Path 	Kelpa/Src/Utility/IOBuf.hpp
+ * 		@Brief	Chained byte buffer: slices of pooled, reference-counted blocks with
+ * 				headroom and tailroom, shared between sockets, Serde and Compress
+ * 		@Dependency	./ { Slab.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_UTILITY_IOBUF_HPP__
+#define __KELPA_UTILITY_IOBUF_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <algorithm>				/* imports ./ {
+	std::min,
+	std::max
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::byte,
+	std::ptrdiff_t
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uint32_t
+}*/
+#include <cstring>					/* imports ./ {
+	std::memcpy
+}*/
+#include <deque>					/* imports ./ {
+	std::deque
+}*/
+#include <iterator>					/* imports ./ {
+	std::forward_iterator_tag,
+	std::output_iterator_tag
+}*/
+#include <memory>					/* imports ./ {
+	std::shared_ptr,
+	std::make_shared,
+	std::addressof
+}*/
+#include <new>						/* imports ./ {
+	::operator new
+}*/
+#include <ranges>					/* imports ./ {
+	std::ranges::contiguous_range,
+	std::ranges::data,
+	std::ranges::size
+}*/
+#include <span>						/* imports ./ {
+	std::span
+}*/
+#include <streambuf>				/* imports ./ {
+	std::streambuf
+}*/
+#include <type_traits>				/* imports ./ {
+	std::is_lvalue_reference_v,
+	std::is_trivially_copyable_v,
+	std::remove_cvref_t
+}*/
+#include <utility>					/* imports ./ {
+	std::exchange
+}*/
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>				/* imports ./ {
+	struct iovec
+}*/
+#endif
+#include "./Slab.hpp"				/* imports ./ {
+	struct Slab
+}*/
+
+namespace Kelpa {
+namespace Utility {
+
+/*
+	An IOBuf is a sequence of slices, each a window onto a block. Blocks come
+	from the slab (a 4 KiB block is one slab class) and are reference counted,
+	so copying an IOBuf, splitting it or appending it to another only moves
+	slice descriptors and never the bytes. Memory owned by something else (a
+	string, a cached file, a static table) is wrapped in place and released
+	through its std::shared_ptr.
+
+		IOBuf message;
+		message.Append(body.data(), body.size());				// written once, into pooled memory
+		message.Prepend(header, sizeof header);					// lands in the headroom kept in front
+		socket.async_write(chain.append(std::move(message)));	// handed to writev as it is
+
+	A slice may be written to, past its end or in front of its start, only
+	while its block is referenced by nothing else; shared and wrapped blocks
+	are read-only and writing grows a fresh block instead. An IOBuf is not
+	synchronized, but blocks may be released on any thread
+*/
+struct IOBuf {
+	/* blocks of one slab class, header included */
+	static constexpr std::size_t 	BlockSize 		{ Slab::MaxSize };
+	/* kept in front of the first block, room for a frame or protocol header */
+	static constexpr std::size_t 	DefaultHeadroom { 64 };
+
+	struct Cursor;
+	template <typename T = unsigned char> requires std::is_trivially_copyable_v<T> struct Appender;
+	struct StreamBuffer;
+
+	IOBuf() 												noexcept = default;
+	IOBuf(IOBuf const& other);
+	IOBuf(IOBuf&& other) 									noexcept;
+	IOBuf& operator=(IOBuf const& other);
+	IOBuf& operator=(IOBuf&& other) 						noexcept;
+   ~IOBuf() 												noexcept 	{ 	Clear(); 	}
+
+	/* an empty buffer whose first block holds at least `capacity` bytes behind `headroom` */
+	static IOBuf 		Create(std::size_t capacity, std::size_t headroom = DefaultHeadroom);
+	static IOBuf 		Copy(void const* data, std::size_t size, std::size_t headroom = DefaultHeadroom);
+	/* no copy: the bytes stay where they are, `owner` keeps them alive (none: the caller does) */
+	static IOBuf 		Wrap(void const* data, std::size_t size, std::shared_ptr<void const> owner = nullptr);
+	/* moves the container into shared storage and wraps it */
+	template <std::ranges::contiguous_range R> requires (! std::is_lvalue_reference_v<R>)
+		&& std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+	static IOBuf 		Take(R&& range);
+
+	std::size_t 		Size() 					const noexcept 	{ 	return size; 			}
+	bool 				Empty() 				const noexcept 	{ 	return ! size; 			}
+	std::size_t 		Slices() 				const noexcept;
+	/* writable bytes in front of the first slice and behind the last one */
+	std::size_t 		Headroom() 				const noexcept;
+	std::size_t 		Tailroom() 				const noexcept;
+
+	IOBuf& 				Append(void const* data, std::size_t count);
+	IOBuf& 				Append(IOBuf const& other);
+	IOBuf& 				Append(IOBuf&& other);
+	IOBuf& 				Prepend(void const* data, std::size_t count);
+	IOBuf& 				Prepend(IOBuf&& other);
+
+	/* at least `minimum` writable bytes behind the data, for recv() or an encoder to fill, then Commit() */
+	std::span<std::byte> Reserve(std::size_t minimum);
+	IOBuf& 				Commit(std::size_t count) 		noexcept;
+
+	/* detaches the first `count` bytes; a slice cut in two is shared by both halves */
+	IOBuf 				Split(std::size_t count);
+	/* shares the first `count` bytes, this buffer is left as it was */
+	IOBuf 				Clone(std::size_t count) 		const;
+	IOBuf& 				Consume(std::size_t count) 		noexcept;
+	void 				Clear() 						noexcept;
+
+	/* makes the bytes contiguous, copying once only when they span several slices */
+	std::span<std::byte const> 	Coalesce();
+
+	/* calls f(std::span<std::byte const>) for each slice in order */
+	template <typename F>
+	void 				Visit(F&& f) 					const;
+#if __has_include(<sys/uio.h>)
+	/* describes the leading slices for writev/sendmsg, returns how many entries were filled */
+	std::size_t 		ToIovec(std::span<iovec> out) 	const noexcept;
+#endif
+
+	Cursor 				begin() 						const noexcept;
+	Cursor 				end() 							const noexcept;
+private:
+	struct Block {
+		std::atomic<std::uint32_t> 		refs 		{ 1 };
+		bool 							foreign 	{ false };
+		std::size_t 					capacity;
+		std::byte * 					base;
+		std::shared_ptr<void const> 	owner 		{};
+	};
+	struct Slice {
+		Block * 		block;
+		std::byte * 	data;
+		std::size_t 	size;
+
+		std::size_t 	Headroom() const noexcept { 	return data - (* block).base; 	}
+		std::size_t 	Tailroom() const noexcept { 	return (* block).base + (* block).capacity - data - size; }
+		/* only the one slice of an unshared, owned block may grow */
+		bool 			Writable() const noexcept {
+			return ! (* block).foreign && (* block).refs.load(std::memory_order_acquire) == 1;
+		}
+	};
+
+	static Block* 		Allocate(std::size_t capacity);
+	static Block* 		Acquire(Block* block) 	noexcept {
+		(* block).refs.fetch_add(1, std::memory_order_relaxed);
+		return block;
+	}
+	static void 		Release(Block* block) 	noexcept;
+
+	/* the trailing slice left empty by Reserve() is not data */
+	void 				Drop() 					noexcept;
+
+	std::deque<Slice> 	slices;
+	std::size_t 		size 	{};
+};
+
+inline auto IOBuf::Allocate(std::size_t capacity) -> Block* {
+	std::size_t bytes { sizeof(Block) + capacity };
+	/* use the whole slab class the block falls in */
+	if(bytes <= Slab::MaxSize)
+		bytes = Slab::SizeOf(Slab::ClassOf(bytes));
+	std::byte* const memory { static_cast<std::byte *>(Slab::Allocate(bytes)) };
+	Block* const block { ::new (memory) Block {} };
+	(* block).capacity 	= bytes - sizeof(Block);
+	(* block).base 		= memory + sizeof(Block);
+	return block;
+}
+
+inline void IOBuf::Release(Block* block) noexcept {
+	if((* block).refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+	std::size_t const bytes { (* block).foreign ? sizeof(Block) : sizeof(Block) + (* block).capacity };
+	block -> ~Block();
+	Slab::Deallocate(block, bytes);
+}
+
+inline IOBuf::IOBuf(IOBuf const& other): slices(other.slices), size(other.size) {
+	for(Slice const& slice: slices)
+		(void) Acquire(slice.block);
+}
+
+inline IOBuf::IOBuf(IOBuf&& other) noexcept: slices(std::move(other.slices)), size(std::exchange(other.size, 0)) {
+	other.slices.clear();
+}
+
+inline IOBuf& IOBuf::operator=(IOBuf const& other) {
+	if(this != std::addressof(other))
+		* this = IOBuf { other };
+	return *this;
+}
+
+inline IOBuf& IOBuf::operator=(IOBuf&& other) noexcept {
+	if(this == std::addressof(other))
+		return *this;
+	Clear();
+	slices 	= std::move(other.slices);
+	size 	= std::exchange(other.size, 0);
+	other.slices.clear();
+	return *this;
+}
+
+inline IOBuf IOBuf::Create(std::size_t capacity, std::size_t headroom) {
+	IOBuf buffer;
+	Block* const block { Allocate(headroom + capacity) };
+	buffer.slices.push_back(Slice { block, (* block).base + headroom, 0 });
+	return buffer;
+}
+
+inline IOBuf IOBuf::Copy(void const* data, std::size_t size, std::size_t headroom) {
+	IOBuf buffer { Create(size, headroom) };
+	std::memcpy(buffer.slices.front().data, data, size);
+	buffer.slices.front().size 	= size;
+	buffer.size 				= size;
+	return buffer;
+}
+
+inline IOBuf IOBuf::Wrap(void const* data, std::size_t size, std::shared_ptr<void const> owner) {
+	IOBuf buffer;
+	if(! size)
+		return buffer;
+	std::byte* const bytes { static_cast<std::byte *>(const_cast<void *>(data)) };
+	Block* const block { ::new (Slab::Allocate(sizeof(Block))) Block {} };
+	(* block).foreign 	= true;
+	(* block).capacity 	= size;
+	(* block).base 		= bytes;
+	(* block).owner 	= std::move(owner);
+	buffer.slices.push_back(Slice { block, bytes, size });
+	buffer.size = size;
+	return buffer;
+}
+
+template <std::ranges::contiguous_range R> requires (! std::is_lvalue_reference_v<R>)
+	&& std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+inline IOBuf IOBuf::Take(R&& range) {
+	auto const owner { std::make_shared<std::remove_cvref_t<R> const>(std::move(range)) };
+	return Wrap(std::ranges::data(* owner), std::ranges::size(* owner) * sizeof(std::ranges::range_value_t<R>), owner);
+}
+
+inline std::size_t IOBuf::Slices() const noexcept {
+	return slices.size() - (! slices.empty() && ! slices.back().size);
+}
+
+inline std::size_t IOBuf::Headroom() const noexcept {
+	return slices.empty() || ! slices.front().Writable() ? 0 : slices.front().Headroom();
+}
+
+inline std::size_t IOBuf::Tailroom() const noexcept {
+	return slices.empty() || ! slices.back().Writable() ? 0 : slices.back().Tailroom();
+}
+
+inline void IOBuf::Drop() noexcept {
+	if(! slices.empty() && ! slices.back().size) {
+		Release(slices.back().block);
+		slices.pop_back();
+	}
+}
+
+inline std::span<std::byte> IOBuf::Reserve(std::size_t minimum) {
+	if(std::size_t const room { Tailroom() }; room && room >= minimum)
+		return { slices.back().data + slices.back().size, room };
+	Drop();
+	Block* const block { Allocate(std::max(minimum, BlockSize - sizeof(Block))) };
+	slices.push_back(Slice { block, (* block).base, 0 });
+	return { (* block).base, (* block).capacity };
+}
+
+inline IOBuf& IOBuf::Commit(std::size_t count) noexcept {
+	slices.back().size 	+= count;
+	size 				+= count;
+	return *this;
+}
+
+inline IOBuf& IOBuf::Append(void const* data, std::size_t count) {
+	std::byte const* source { static_cast<std::byte const *>(data) };
+	while(count) {
+		std::span<std::byte> const room { Reserve(1) };
+		std::size_t const chunk { std::min(count, room.size()) };
+		std::memcpy(room.data(), source, chunk);
+		(void) Commit(chunk);
+		source 	+= chunk;
+		count 	-= chunk;
+	}
+	return *this;
+}
+
+inline IOBuf& IOBuf::Append(IOBuf const& other) {
+	return Append(IOBuf { other });
+}
+
+inline IOBuf& IOBuf::Append(IOBuf&& other) {
+	if(this == std::addressof(other))
+		return Append(IOBuf { other });
+	Drop();
+	for(Slice const& slice: other.slices)
+		if(slice.size)
+			slices.push_back(slice);
+		else
+			Release(slice.block);
+	size += std::exchange(other.size, 0);
+	other.slices.clear();
+	return *this;
+}
+
+inline IOBuf& IOBuf::Prepend(void const* data, std::size_t count) {
+	if(! count)
+		return *this;
+	if(Headroom() >= count) {
+		slices.front().data -= count;
+		slices.front().size += count;
+		size 				+= count;
+		std::memcpy(slices.front().data, data, count);
+		return *this;
+	}
+	return Prepend(Copy(data, count, DefaultHeadroom));
+}
+
+inline IOBuf& IOBuf::Prepend(IOBuf&& other) {
+	if(this == std::addressof(other))
+		return Prepend(IOBuf { other });
+	/* an empty slice of the other buffer, as Create() leaves one, would sit mid-chain; only the last slice may be empty */
+	for(auto slice { other.slices.rbegin() }; slice != other.slices.rend(); ++ slice)
+		if((* slice).size)
+			slices.push_front(* slice);
+		else
+			Release((* slice).block);
+	size += std::exchange(other.size, 0);
+	other.slices.clear();
+	return *this;
+}
+
+inline IOBuf IOBuf::Split(std::size_t count) {
+	IOBuf head;
+	count = std::min(count, size);
+	while(count) {
+		Slice& front { slices.front() };
+		if(count < front.size) {
+			head.slices.push_back(Slice { Acquire(front.block), front.data, count });
+			head.size 	+= count;
+			front.data 	+= count;
+			front.size 	-= count;
+			size 		-= count;
+			break;
+		}
+		head.slices.push_back(front);
+		head.size 	+= front.size;
+		size 		-= front.size;
+		count 		-= front.size;
+		slices.pop_front();
+	}
+	return head;
+}
+
+inline IOBuf IOBuf::Clone(std::size_t count) const {
+	IOBuf head;
+	for(auto slice { slices.begin() }; count && slice != slices.end(); ++ slice) {
+		std::size_t const taken { std::min(count, (* slice).size) };
+		if(! taken)
+			continue;
+		head.slices.push_back(Slice { Acquire((* slice).block), (* slice).data, taken });
+		head.size 	+= taken;
+		count 		-= taken;
+	}
+	return head;
+}
+
+inline IOBuf& IOBuf::Consume(std::size_t count) noexcept {
+	count = std::min(count, size);
+	size -= count;
+	while(count) {
+		Slice& front { slices.front() };
+		if(count < front.size) {
+			front.data += count;
+			front.size -= count;
+			break;
+		}
+		count -= front.size;
+		Release(front.block);
+		slices.pop_front();
+	}
+	return *this;
+}
+
+inline void IOBuf::Clear() noexcept {
+	for(Slice const& slice: slices)
+		Release(slice.block);
+	slices.clear();
+	size = 0;
+}
+
+inline std::span<std::byte const> IOBuf::Coalesce() {
+	Drop();
+	if(slices.size() > 1) {
+		IOBuf whole { Create(size, Headroom()) };
+		Slice& target { whole.slices.front() };
+		for(Slice const& slice: slices) {
+			std::memcpy(target.data + target.size, slice.data, slice.size);
+			target.size += slice.size;
+		}
+		whole.size = size;
+		* this = std::move(whole);
+	}
+	return slices.empty() ? std::span<std::byte const> {} : std::span<std::byte const> { slices.front().data, slices.front().size };
+}
+
+template <typename F>
+inline void IOBuf::Visit(F&& f) const {
+	for(Slice const& slice: slices)
+		if(slice.size)
+			f(std::span<std::byte const> { slice.data, slice.size });
+}
+
+#if __has_include(<sys/uio.h>)
+inline std::size_t IOBuf::ToIovec(std::span<iovec> out) const noexcept {
+	std::size_t filled {};
+	for(auto slice { slices.begin() }; filled < out.size() && slice != slices.end(); ++ slice)
+		if((* slice).size)
+			out[filled ++] = iovec { (* slice).data, (* slice).size };
+	return filled;
+}
+#endif
+
+/* reads the bytes in order across the slices, for Compress readers and other iterator-based code */
+struct IOBuf::Cursor {
+	typedef std::forward_iterator_tag 	iterator_category;
+	typedef unsigned char 				value_type;
+	typedef std::ptrdiff_t 				difference_type;
+	typedef unsigned char const * 		pointer;
+	typedef unsigned char const& 		reference;
+
+	Cursor() 															noexcept = default;
+	Cursor(IOBuf const* buffer, std::size_t slice, std::size_t offset) 	noexcept: buffer(buffer), slice(slice), offset(offset) 	{ 	Skip(); 	}
+
+	reference 	operator*() 				const noexcept {
+		return * reinterpret_cast<unsigned char const *>((* buffer).slices[slice].data + offset);
+	}
+	Cursor& 	operator++() 					  noexcept {
+		offset ++;
+		Skip();
+		return *this;
+	}
+	Cursor 		operator++(int) 				  noexcept {
+		Cursor const previous { *this };
+		(void) operator++();
+		return previous;
+	}
+	bool 		operator==(Cursor const& other) const noexcept 	{ 	return slice == other.slice && offset == other.offset; 	}
+private:
+	void 		Skip() noexcept {
+		while(buffer && slice < (* buffer).slices.size() && offset == (* buffer).slices[slice].size) {
+			slice ++;
+			offset = 0;
+		}
+	}
+
+	IOBuf const * 	buffer 	{ nullptr };
+	std::size_t 	slice 	{};
+	std::size_t 	offset 	{};
+};
+
+inline auto IOBuf::begin() 	const noexcept -> Cursor 	{ 	return Cursor { this, 0, 0 }; 				}
+inline auto IOBuf::end() 	const noexcept -> Cursor 	{ 	return Cursor { this, slices.size(), 0 }; 	}
+
+/*
+	appends the object representation of every T assigned through it, for
+	Compress writers; it counts its steps, so two appenders tell how much was
+	written between them, and a default one is an unreachable end
+*/
+template <typename T> requires std::is_trivially_copyable_v<T>
+struct IOBuf::Appender {
+	typedef std::output_iterator_tag 	iterator_category;
+	typedef void 						value_type;
+	typedef std::ptrdiff_t 				difference_type;
+	typedef void 						pointer;
+	typedef void 						reference;
+
+	Appender() 							noexcept = default;
+	explicit Appender(IOBuf& buffer) 	noexcept: buffer(std::addressof(buffer)) {}
+
+	Appender& 	operator=(T const& value) {
+		(void) (* buffer).Append(std::addressof(value), sizeof(T));
+		return *this;
+	}
+	Appender& 	operator*() 	noexcept { 	return *this; 	}
+	Appender& 	operator++() 	noexcept { 	steps ++; 	return *this; 	}
+	Appender& 	operator++(int) noexcept { 	steps ++; 	return *this; 	}
+
+	bool 			operator==(Appender const& other) const noexcept 	{ 	return buffer == other.buffer && steps == other.steps; 	}
+	difference_type operator-(Appender const& other)  const noexcept 	{ 	return steps - other.steps; 	}
+private:
+	IOBuf * 		buffer 	{ nullptr };
+	difference_type steps 	{};
+};
+
+/*
+	std::streambuf over an IOBuf, so iostream-based code such as SerdeStream
+	writes straight into pooled blocks and reads the slices in place. Output
+	goes to the tailroom and is committed on sync() and whenever the get area
+	needs it; input walks the slices without consuming them. The buffer must
+	not be changed by anything else while the stream is in use
+*/
+struct IOBuf::StreamBuffer : std::streambuf {
+	explicit StreamBuffer(IOBuf& buffer) noexcept: buffer(buffer) {}
+
+	StreamBuffer(StreamBuffer const&) 				= delete;
+	StreamBuffer& operator=(StreamBuffer const&) 	= delete;
+   ~StreamBuffer() noexcept override 				{ 	(void) Flush(); 	}
+
+	IOBuf& 			Buffer() noexcept 	{ 	(void) Flush(); 	return buffer; 	}
+protected:
+	int_type 		overflow(int_type c) override {
+		(void) Flush();
+		if(traits_type::eq_int_type(c, traits_type::eof()))
+			return traits_type::not_eof(c);
+		std::span<std::byte> const room { buffer.Reserve(1) };
+		setp(reinterpret_cast<char_type *>(room.data()), reinterpret_cast<char_type *>(room.data() + room.size()));
+		* pptr() = traits_type::to_char_type(c);
+		pbump(1);
+		return c;
+	}
+	std::streamsize xsputn(char_type const* data, std::streamsize count) override {
+		(void) Flush();
+		(void) buffer.Append(data, static_cast<std::size_t>(count));
+		return count;
+	}
+	int 			sync() override 	{ 	return Flush(); 	}
+
+	int_type 		underflow() override {
+		(void) Flush();
+		/* the slice may have grown since the get area was set */
+		std::size_t offset { gptr() ? static_cast<std::size_t>(gptr() - eback()) : 0 };
+		while(slice < buffer.slices.size()) {
+			Slice const& current { buffer.slices[slice] };
+			if(offset < current.size) {
+				char_type* const data { reinterpret_cast<char_type *>(current.data) };
+				setg(data, data + offset, data + current.size);
+				return traits_type::to_int_type(* gptr());
+			}
+			slice ++;
+			offset = 0;
+		}
+		setg(nullptr, nullptr, nullptr);
+		return traits_type::eof();
+	}
+	/* steps back into the previous slice, for unget() across a slice boundary */
+	int_type 		pbackfail(int_type c) override {
+		std::size_t previous { std::min(slice, buffer.slices.size()) };
+		while(previous && ! buffer.slices[previous - 1].size)
+			previous --;
+		if(gptr() != eback() || ! previous)
+			return traits_type::eof();
+		Slice const& current { buffer.slices[slice = previous - 1] };
+		char_type* const data { reinterpret_cast<char_type *>(current.data) };
+		setg(data, data + current.size - 1, data + current.size);
+		if(! traits_type::eq_int_type(c, traits_type::eof()) && ! traits_type::eq(traits_type::to_char_type(c), * gptr()))
+			return traits_type::eof();
+		return traits_type::to_int_type(* gptr());
+	}
+	std::streamsize showmanyc() override {
+		(void) Flush();
+		std::streamsize left {};
+		for(std::size_t index { slice }; index < buffer.slices.size(); index ++)
+			left += static_cast<std::streamsize>(buffer.slices[index].size);
+		return left ? left - (gptr() ? gptr() - eback() : 0) : -1;
+	}
+
+	pos_type 		seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override {
+		(void) Flush();
+		if(mode & std::ios_base::out)
+			return offset == 0 && direction != std::ios_base::beg ? pos_type(buffer.Size()) : pos_type(off_type(-1));
+		off_type position {};
+		for(std::size_t index {}; index < std::min(slice, buffer.slices.size()); index ++)
+			position += buffer.slices[index].size;
+		position += gptr() ? gptr() - eback() : 0;
+		switch(direction) {
+			case std::ios_base::beg: 	position = offset; 									break;
+			case std::ios_base::cur: 	position += offset; 								break;
+			default: 					position = off_type(buffer.Size()) + offset; 		break;
+		}
+		return seekpos(pos_type(position), mode);
+	}
+	pos_type 		seekpos(pos_type position, std::ios_base::openmode mode) override {
+		(void) Flush();
+		off_type const target { position };
+		if(mode & std::ios_base::out || target < 0 || target > off_type(buffer.Size()))
+			return pos_type(off_type(-1));
+		std::size_t left { static_cast<std::size_t>(target) };
+		for(slice = 0; slice < buffer.slices.size() && left >= buffer.slices[slice].size; slice ++)
+			left -= buffer.slices[slice].size;
+		if(slice == buffer.slices.size())
+			setg(nullptr, nullptr, nullptr);
+		else {
+			char_type* const data { reinterpret_cast<char_type *>(buffer.slices[slice].data) };
+			setg(data, data + left, data + buffer.slices[slice].size);
+		}
+		return position;
+	}
+private:
+	/* commits what was written into the reserved tailroom */
+	int 			Flush() noexcept {
+		if(pbase())
+			(void) buffer.Commit(static_cast<std::size_t>(pptr() - pbase()));
+		setp(nullptr, nullptr);
+		return 0;
+	}
+
+	IOBuf& 			buffer;
+	std::size_t 	slice 	{};
+};
+
+}		//namespace Utility
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * 		@Path 	Kelpa/Src/Utility/ObjectPool.hpp
+ * 		@Brief	Typed object pools on top of the slab: explicit create/destroy,
+ * 				a pooled unique_ptr and a base that routes class new/delete
+ * 		@Dependency	./ { Slab.hpp }
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_UTILITY_OBJECTPOOL_HPP__
+#define __KELPA_UTILITY_OBJECTPOOL_HPP__
+
+#include <memory>					/* imports ./ {
+	std::unique_ptr,
+	std::construct_at,
+	std::destroy_at
+}*/
+#include <concepts>					/* imports ./ {
+	std::constructible_from
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::max_align_t
+}*/
+#include "./Slab.hpp"				/* imports ./ {
+	struct Slab
+}*/
+
+namespace Kelpa {
+namespace Utility {
+
+template <typename T> requires (alignof(T) <= alignof(std::max_align_t)) struct ObjectPool {
+	template <typename... Args> requires std::constructible_from<T, Args ...>
+	[[nodiscard]] static T* Create(Args&&... args) {
+		void* memory { Slab::Allocate(sizeof(T)) };
+		try {
+			return std::construct_at(static_cast<T *>(memory), std::forward<Args>(args) ...);
+		} catch(...) {
+			Slab::Deallocate(memory, sizeof(T));
+			throw;
+		}
+	}
+
+	/* may be called from any thread, the block returns to the thread that allocated it */
+	static void Destroy(T* object) noexcept {
+		if(! object)
+			return;
+		std::destroy_at(object);
+		Slab::Deallocate(object, sizeof(T));
+	}
+};
+
+template <typename T> struct PoolDeleter {
+	void operator()(T* object) const noexcept { 	ObjectPool<T>::Destroy(object); 	}
+};
+
+template <typename T> using PooledPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+template <typename T, typename... Args> requires std::constructible_from<T, Args ...>
+PooledPtr<T> MakePooled(Args&&... args)
+{	return PooledPtr<T> { ObjectPool<T>::Create(std::forward<Args>(args) ...) };	}
+
+/*
+	struct Node: Utility::Pooled<Node> { ... };
+	new Node / delete node 		// served by the slab
+*/
+template <typename Derived> struct Pooled {
+	static void* operator new(std::size_t size) 					{ 	return Slab::Allocate(size); 		}
+	static void  operator delete(void* pointer, std::size_t size) noexcept 	{ 	Slab::Deallocate(pointer, size); 	}
+};
+
+}		//namespace Utility
+}		//namespace Kelpa
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * 		@Path 	Kelpa/Src/Utility/Slab.hpp
+ * 		@Brief	Size-class slab allocator: every thread owns a heap of 64 KiB
+ * 				chunks, frees from other threads go to the owner's lock-free lists
+ * 		@Dependency	None
+ * 		@Since  2024/04/25
+ * 		@Version 1st
+ **/
+
+#ifndef __KELPA_UTILITY_SLAB_HPP__
+#define __KELPA_UTILITY_SLAB_HPP__
+
+#include <atomic>					/* imports ./ {
+	std::atomic
+}*/
+#include <array>					/* imports ./ {
+	std::array
+}*/
+#include <bit>						/* imports ./ {
+	std::bit_width
+}*/
+#include <cstddef>					/* imports ./ {
+	std::size_t,
+	std::byte,
+	std::max_align_t
+}*/
+#include <cstdint>					/* imports ./ {
+	std::uintptr_t,
+	std::uint32_t
+}*/
+#include <new>						/* imports ./ {
+	::operator new,
+	::operator delete,
+	std::align_val_t
+}*/
+#include <memory_resource>			/* imports ./ {
+	std::pmr::memory_resource
+}*/
+
+namespace Kelpa {
+namespace Utility {
+
+/*
+	Requests up to 4096 bytes are rounded to one of 28 size classes (16-byte
+	steps to 128, then four steps per power of two) and served from the calling
+	thread's heap without any atomic operation. A chunk header records the
+	owning heap, so a block released on another thread is pushed onto that
+	heap's per-class remote list and reclaimed by the owner in one exchange.
+	Larger requests fall through to ::operator new. Chunks are never handed back
+	to the system: the slab keeps its high-water mark, and the heap of an exited
+	thread is adopted by the next thread that starts
+*/
+struct Slab {
+	static constexpr std::size_t 	ChunkSize 	{ 64 * 1024 };
+	static constexpr std::size_t 	MaxSize 	{ 4096 };
+	static constexpr std::size_t 	Classes 	{ 28 };
+
+	[[nodiscard]] static void* 	Allocate(std::size_t size);
+	static void 				Deallocate(void* pointer, std::size_t size) noexcept;
+
+	static constexpr std::size_t ClassOf(std::size_t size) noexcept {
+		if(size <= 128)
+			return size ? (size - 1) >> 4 : 0;
+		std::size_t const power { static_cast<std::size_t>(std::bit_width(size - 1)) };
+		return 8 + (power - 8) * 4 + ((size - 1 - (std::size_t(1) << (power - 1))) >> (power - 3));
+	}
+	static constexpr std::size_t SizeOf(std::size_t index) noexcept {
+		if(index < 8)
+			return (index + 1) << 4;
+		std::size_t const power { (index - 8) / 4 + 8 };
+		return (std::size_t(1) << (power - 1)) + ((index - 8) % 4 + 1) * (std::size_t(1) << (power - 3));
+	}
+private:
+	struct Block { 	Block* next; 	};
+
+	struct alignas(64) Remote {
+		std::atomic<Block *> 	head 	{ nullptr };
+	};
+
+	struct alignas(64) Heap {
+		struct Class {
+			Block * 		local 	{ nullptr };
+			std::byte * 	cursor 	{ nullptr };
+			std::byte * 	limit 	{ nullptr };
+		};
+		std::array<Class, Classes> 		classes 	{};
+		std::array<Remote, Classes> 	remote 		{};
+		std::atomic<bool> 				claimed 	{ true };
+		Heap * 							next 		{ nullptr };
+	};
+
+	struct alignas(64) Chunk {
+		Heap * 			owner;
+		std::size_t 	index;
+	};
+	static constexpr std::size_t HeaderSize { (sizeof(Chunk) + 63) & ~std::size_t(63) };
+
+	struct Releaser {
+	   ~Releaser() noexcept {
+			if(! current)
+				return;
+			(* current).claimed.store(false, std::memory_order_release);
+			current = nullptr;
+		}
+	};
+
+	static Heap& Mine() {
+		if(! current) [[unlikely]]
+			current = Adopt();
+		return * current;
+	}
+	static Heap* Adopt();
+	static void  Carve(Heap& heap, std::size_t index);
+
+	static inline thread_local Heap * 	current { nullptr };
+	static inline std::atomic<Heap *> 	heaps 	{ nullptr };
+};
+
+inline auto Slab::Adopt() -> Heap* {
+	static thread_local Releaser releaser;
+	(void) releaser;
+	for(Heap* heap { heaps.load(std::memory_order_acquire) }; heap; heap = (* heap).next) {
+		bool expected { false };
+		if((* heap).claimed.compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed))
+			return heap;
+	}
+	Heap* heap { new Heap {} };
+	(* heap).next = heaps.load(std::memory_order_relaxed);
+	while(! heaps.compare_exchange_weak((* heap).next, heap, std::memory_order_release, std::memory_order_relaxed));
+	return heap;
+}
+
+inline void Slab::Carve(Heap& heap, std::size_t index) {
+	std::byte* const memory { static_cast<std::byte *>(::operator new(ChunkSize, std::align_val_t { ChunkSize })) };
+	::new (memory) Chunk { &heap, index };
+	heap.classes[index].cursor 	= memory + HeaderSize;
+	heap.classes[index].limit 	= memory + ChunkSize;
+}
+
+inline void* Slab::Allocate(std::size_t size) {
+	if(size > MaxSize)
+		return ::operator new(size);
+	std::size_t const 	index 	{ ClassOf(size) };
+	Heap& 				heap 	{ Mine() };
+	auto& 				slot 	{ heap.classes[index] };
+	if(Block* block { slot.local }) [[likely]] {
+		slot.local = (* block).next;
+		return block;
+	}
+	if(heap.remote[index].head.load(std::memory_order_relaxed)) {
+		Block* block { heap.remote[index].head.exchange(nullptr, std::memory_order_acquire) };
+		slot.local = (* block).next;
+		return block;
+	}
+	std::size_t const bytes { SizeOf(index) };
+	if(static_cast<std::size_t>(slot.limit - slot.cursor) < bytes)
+		Carve(heap, index);
+	void* block { slot.cursor };
+	slot.cursor += bytes;
+	return block;
+}
+
+inline void Slab::Deallocate(void* pointer, std::size_t size) noexcept {
+	if(! pointer)
+		return;
+	if(size > MaxSize)
+		return ::operator delete(pointer, size);
+	Chunk const& 	chunk 	{ * reinterpret_cast<Chunk const *>(reinterpret_cast<std::uintptr_t>(pointer) & ~(ChunkSize - 1)) };
+	Block* const 	block 	{ static_cast<Block *>(pointer) };
+	if(chunk.owner == current) {
+		(* block).next = (* current).classes[chunk.index].local;
+		(* current).classes[chunk.index].local = block;
+		return;
+	}
+	std::atomic<Block *>& remote { (* chunk.owner).remote[chunk.index].head };
+	(* block).next = remote.load(std::memory_order_relaxed);
+	while(! remote.compare_exchange_weak((* block).next, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+/* std-style allocator drawing from the slab */
+template <typename T> struct SlabAllocator {
+	typedef T value_type;
+
+	constexpr SlabAllocator() 									noexcept = default;
+	template <typename U> constexpr SlabAllocator(SlabAllocator<U> const&) 	noexcept {}
+
+	[[nodiscard]] T* allocate(std::size_t n) {
+		if constexpr (alignof(T) > alignof(std::max_align_t))
+			return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t { alignof(T) }));
+		else
+			return static_cast<T *>(Slab::Allocate(n * sizeof(T)));
+	}
+	void deallocate(T* pointer, std::size_t n) noexcept {
+		if constexpr (alignof(T) > alignof(std::max_align_t))
+			::operator delete(pointer, n * sizeof(T), std::align_val_t { alignof(T) });
+		else
+			Slab::Deallocate(pointer, n * sizeof(T));
+	}
+
+	template <typename U> constexpr bool operator==(SlabAllocator<U> const&) const noexcept { 	return true; 	}
+};
+
+/* the slab as a polymorphic resource, e.g. the upstream of a MonotonicArena */
+struct SlabResource: std::pmr::memory_resource {
+	static SlabResource* Get() noexcept {
+		static SlabResource resource;
+		return &resource;
+	}
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		if(alignment > alignof(std::max_align_t))
+			return ::operator new(bytes, std::align_val_t { alignment });
+		return Slab::Allocate(bytes);
+	}
+	void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override {
+		if(alignment > alignof(std::max_align_t))
+			return ::operator delete(pointer, bytes, std::align_val_t { alignment });
+		Slab::Deallocate(pointer, bytes);
+	}
+	bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+	{	return this == &other;	}
+};
+
+}		//namespace Utility
+}		//namespace Kelpa
+
+#endif
@@ -9,6 +9,7 @@
 #ifdef 	__KELPA_UTILITY_UTILITY_HPP__
 #define __KELPA_UTILITY_UTILITY_HPP__
 
+#include "./Arena.hpp"
 #include "./Concepts.hpp"
 #include "./Deferrable.hpp"
 #include "./Error.hpp"
@@ -16,10 +17,13 @@
 #include "./Functions.hpp"
 #include "./Ignore.hpp"
 #include "./Interfaces.hpp"
+#include "./IOBuf.hpp"
 #include "./Macros.h"
+#include "./ObjectPool.hpp"
 #include "./observer_ptr.hpp"
 #include "./ScopeGuard.hpp"
 #include "./SelfWrap.hpp"
+#include "./Slab.hpp"
 #include "./Singleton.hpp"
 #include "./StringLiteral.hpp"
 #include "./Torrent.hpp"